@@ -37,6 +37,43 @@
 #define BCSLIB_USE_SSE41
 
 
+/**
+ * Whether to use the built-in BLAS implementation
+ * (engine/native_blas.h) instead of an external BLAS library
+ *
+ * Note: this can also be set from the compiler command line
+ */
+// #define BCSLIB_USE_NATIVE_BLAS
+
+
+/**
+ * Whether to make reductions (e.g. sum, dot) bit-reproducible
+ *
+ * Note: by default, reductions of long vectors with associative
+ * reductors use multiple (SIMD) accumulators, whose results may
+ * differ in the last bits from those of a sequential sum, and may
+ * vary with the instruction set in use. With this option, elements
+ * are always accumulated sequentially (on the calling thread).
+ *
+ * Note: without this option, results still do not depend on the
+ * number of threads, since large full reductions are partitioned
+ * by the operand shapes only (see ParallelReducChunk).
+ */
+// #define BCSLIB_DETERMINISTIC_REDUCTION
+
+
+/**
+ * Whether to disable multi-threaded evaluation
+ *
+ * Note: by default, large evaluations (e.g. element-wise
+ * evaluation, column-wise and full reduction, and transposition) are
+ * run in parallel on a library-owned thread pool (see
+ * core/parallel.h). With this option, everything is run
+ * on the calling thread.
+ */
+// #define BCSLIB_NO_THREADS
+
+
 /**
  * Whether to turn off extensive checks (e.g. array bound)
  */
@@ -19,5 +19,6 @@
 #include <bcslib/core/type_traits.h>
 #include <bcslib/core/iterator.h>
 #include <bcslib/core/block.h>
+#include <bcslib/core/scratch_pool.h>
 
 #endif 
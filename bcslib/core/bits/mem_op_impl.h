@@ -14,6 +14,7 @@
 #define BCSLIB_MEM_OP_IMPL_H_
 
 #include <bcslib/core/basic_defs.h>
+#include <bcslib/core/bits/mem_op_simd.h>
 #include <cstring>
 
 // for platform-dependent aligned allocation
@@ -73,33 +74,139 @@ namespace bcs { namespace detail  {
 		std::memset(dst, 0, static_cast<size_t>(n) * sizeof(T));
 	}
 
+	/********************************************
+	 *
+	 *  Element kernels
+	 *
+	 *  mem_kernel<T> provides fill, copy (of one
+	 *  column in a 2D copy), and equal. The generic
+	 *  version uses scalar loops, while float and
+	 *  double use SIMD kernels when available
+	 *  (see mem_op_simd.h).
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct mem_kernel
+	{
+		BCS_ENSURE_INLINE
+		static void fill(const index_t n, T* __restrict__ dst, const T& v)
+		{
+			for (index_t i = 0; i < n; ++i) dst[i] = v;
+		}
+
+		BCS_ENSURE_INLINE
+		static void copy(const index_t n, const T* __restrict__ src, T* __restrict__ dst)
+		{
+			copy_elems(n, src, dst);
+		}
+
+		BCS_ENSURE_INLINE
+		static bool equal(const index_t n, const T* __restrict__ s1, const T* __restrict__ s2)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				if (s1[i] != s2[i]) return false;
+			}
+			return true;
+		}
+
+		BCS_ENSURE_INLINE
+		static bool equal(const index_t n, const T* __restrict__ s, const T& v)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				if (s[i] != v) return false;
+			}
+			return true;
+		}
+	};
+
+#ifdef BCS_HAS_SIMD_MEMOP
+
+	template<typename T>
+	struct simd_mem_kernel
+	{
+		// below this length, the scalar loop beats the dispatch
+		static const index_t min_simd_len = 16;
+
+		// beyond this length, a column copy is left to memcpy
+		static const index_t max_simd_copy_len = 256;
+
+		BCS_ENSURE_INLINE
+		static void fill(const index_t n, T* __restrict__ dst, const T& v)
+		{
+			if (n < min_simd_len)
+			{
+				for (index_t i = 0; i < n; ++i) dst[i] = v;
+			}
+			else
+				simd_memop<T>::fill(simd_level(), n, dst, v);
+		}
+
+		BCS_ENSURE_INLINE
+		static void copy(const index_t n, const T* __restrict__ src, T* __restrict__ dst)
+		{
+			if (n < min_simd_len || n > max_simd_copy_len)
+				copy_elems(n, src, dst);
+			else
+				simd_memop<T>::copy(simd_level(), n, src, dst);
+		}
+
+		BCS_ENSURE_INLINE
+		static bool equal(const index_t n, const T* __restrict__ s1, const T* __restrict__ s2)
+		{
+			if (n < min_simd_len)
+			{
+				for (index_t i = 0; i < n; ++i)
+				{
+					if (s1[i] != s2[i]) return false;
+				}
+				return true;
+			}
+			else return simd_memop<T>::equal(simd_level(), n, s1, s2);
+		}
+
+		BCS_ENSURE_INLINE
+		static bool equal(const index_t n, const T* __restrict__ s, const T& v)
+		{
+			if (n < min_simd_len)
+			{
+				for (index_t i = 0; i < n; ++i)
+				{
+					if (s[i] != v) return false;
+				}
+				return true;
+			}
+			else return simd_memop<T>::equal(simd_level(), n, s, v);
+		}
+	};
+
+	template<> struct mem_kernel<double> : public simd_mem_kernel<double> { };
+	template<> struct mem_kernel<float> : public simd_mem_kernel<float> { };
+
+#endif
+
+
 	template<typename T>
 	BCS_ENSURE_INLINE
 	static void fill_elems(const index_t n, T* __restrict__ dst, const T& v)
 	{
-		for (index_t i = 0; i < n; ++i) dst[i] = v;
+		mem_kernel<T>::fill(n, dst, v);
 	}
 
 	template<typename T>
 	BCS_ENSURE_INLINE
 	static bool elems_equal(const index_t n, const T* __restrict__ s1, const T* __restrict__ s2)
 	{
-		for (index_t i = 0; i < n; ++i)
-		{
-			if (s1[i] != s2[i]) return false;
-		}
-		return true;
+		return mem_kernel<T>::equal(n, s1, s2);
 	}
 
 	template<typename T>
 	BCS_ENSURE_INLINE
 	static bool elems_equal(const index_t n, const T* __restrict__ s, const T& v)
 	{
-		for (index_t i = 0; i < n; ++i)
-		{
-			if (s[i] != v) return false;
-		}
-		return true;
+		return mem_kernel<T>::equal(n, s, v);
 	}
 
 
@@ -107,9 +214,16 @@ namespace bcs { namespace detail  {
 	inline void copy_elems_2d(const index_t inner_dim, const index_t outer_dim,
 			const T* __restrict__ src, index_t src_ext, T* __restrict__ dst, index_t dst_ext)
 	{
-		for (index_t j = 0; j < outer_dim; ++j, src += src_ext, dst += dst_ext)
+		if (inner_dim == src_ext && inner_dim == dst_ext)
+		{
+			copy_elems(inner_dim * outer_dim, src, dst);
+		}
+		else
 		{
-			copy_elems(inner_dim, src, dst);
+			for (index_t j = 0; j < outer_dim; ++j, src += src_ext, dst += dst_ext)
+			{
+				mem_kernel<T>::copy(inner_dim, src, dst);
+			}
 		}
 	}
 
@@ -134,9 +248,16 @@ namespace bcs { namespace detail  {
 	inline void fill_elems_2d(const index_t inner_dim, const index_t outer_dim,
 			T* __restrict__ dst, const index_t dst_ext, const T& v)
 	{
-		for (index_t j = 0; j < outer_dim; ++j, dst += dst_ext)
+		if (inner_dim == dst_ext)
+		{
+			mem_kernel<T>::fill(inner_dim * outer_dim, dst, v);
+		}
+		else
 		{
-			for (index_t i = 0; i < inner_dim; ++i) dst[i] = v;
+			for (index_t j = 0; j < outer_dim; ++j, dst += dst_ext)
+			{
+				mem_kernel<T>::fill(inner_dim, dst, v);
+			}
 		}
 	}
 
@@ -144,12 +265,14 @@ namespace bcs { namespace detail  {
 	inline bool elems_equal_2d(const index_t inner_dim, const index_t outer_dim,
 			const T* __restrict__ s1, index_t s1_ext, const T* __restrict__ s2, index_t s2_ext)
 	{
-		for (index_t i = 0; i < outer_dim; ++i, s1 += s1_ext, s2 += s2_ext)
+		if (inner_dim == s1_ext && inner_dim == s2_ext)
 		{
-			for (index_t i = 0; i < inner_dim; ++i)
-			{
-				if (s1[i] != s2[i]) return false;
-			}
+			return mem_kernel<T>::equal(inner_dim * outer_dim, s1, s2);
+		}
+
+		for (index_t j = 0; j < outer_dim; ++j, s1 += s1_ext, s2 += s2_ext)
+		{
+			if (!mem_kernel<T>::equal(inner_dim, s1, s2)) return false;
 		}
 		return true;
 	}
@@ -158,12 +281,14 @@ namespace bcs { namespace detail  {
 	inline bool elems_equal_2d(const index_t inner_dim, const index_t outer_dim,
 			const T* __restrict__ s1, index_t s1_ext, const T& v)
 	{
-		for (index_t i = 0; i < outer_dim; ++i, s1 += s1_ext)
+		if (inner_dim == s1_ext)
 		{
-			for (index_t i = 0; i < inner_dim; ++i)
-			{
-				if (s1[i] != v) return false;
-			}
+			return mem_kernel<T>::equal(inner_dim * outer_dim, s1, v);
+		}
+
+		for (index_t j = 0; j < outer_dim; ++j, s1 += s1_ext)
+		{
+			if (!mem_kernel<T>::equal(inner_dim, s1, v)) return false;
 		}
 		return true;
 	}
@@ -0,0 +1,366 @@
+/*
+ * @file mem_op_simd.h
+ *
+ * SIMD kernels for memory operations (with runtime dispatch)
+ *
+ * The kernels for SSE2, AVX2 and AVX-512 are all compiled in
+ * (via per-function target attributes), and the one to use is
+ * selected once, based on what the running CPU supports.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_MEM_OP_SIMD_H_
+#define BCSLIB_MEM_OP_SIMD_H_
+
+#include <bcslib/core/basic_defs.h>
+
+#if defined(BCSLIB_USE_SSE2) && defined(__SSE2__) && \
+	(BCSLIB_COMPILER == BCSLIB_GCC || BCSLIB_COMPILER == BCSLIB_CLANG)
+
+#define BCS_HAS_SIMD_MEMOP
+
+#if (BCSLIB_COMPILER == BCSLIB_CLANG) || (__GNUC__ >= 5)
+#define BCS_HAS_SIMD_MEMOP_AVX
+#endif
+
+#endif
+
+
+#ifdef BCS_HAS_SIMD_MEMOP
+
+#include <emmintrin.h>
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+#include <immintrin.h>
+#endif
+
+#define BCS_SIMD_OP(isa) __attribute__(( always_inline, target(isa) )) static inline
+#define BCS_SIMD_KER(isa) __attribute__(( noinline, target(isa) )) static
+
+
+namespace bcs { namespace detail {
+
+	/********************************************
+	 *
+	 *  SIMD level detection
+	 *
+	 ********************************************/
+
+	enum simd_level_t
+	{
+		SIMD_SSE2 = 1,
+		SIMD_AVX2 = 2,
+		SIMD_AVX512 = 3
+	};
+
+	inline int detect_simd_level()
+	{
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+		if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#endif
+		return SIMD_SSE2;
+	}
+
+	// detected once, on first use
+	inline int simd_level()
+	{
+		static const int level = detect_simd_level();
+		return level;
+	}
+
+
+	/********************************************
+	 *
+	 *  Generic kernels
+	 *
+	 *  Ops provides: value_type, vec_t, width,
+	 *  set1, load, loadu, store, storeu, all_eq
+	 *
+	 *  The stores to dst are aligned to the vector
+	 *  size after a scalar head (no head is needed
+	 *  when dst meets the alignment already).
+	 *
+	 ********************************************/
+
+	inline bool simd_is_aligned(const void *p, size_t a)
+	{
+		return (reinterpret_cast<size_t>(p) & (a - 1)) == 0;
+	}
+
+#define BCS_DEFINE_SIMD_MEMOP_KERNELS(isa) \
+	template<class Ops> \
+	struct kernels \
+	{ \
+		typedef typename Ops::value_type T; \
+		typedef typename Ops::vec_t V; \
+		static const index_t W = Ops::width; \
+		\
+		BCS_SIMD_KER(isa) void fill(const index_t n, T* __restrict__ dst, const T v) \
+		{ \
+			index_t i = 0; \
+			for (; i < n && !simd_is_aligned(dst + i, sizeof(V)); ++i) dst[i] = v; \
+			const V x = Ops::set1(v); \
+			for (; i + W <= n; i += W) Ops::store(dst + i, x); \
+			for (; i < n; ++i) dst[i] = v; \
+		} \
+		\
+		BCS_SIMD_KER(isa) void copy(const index_t n, const T* __restrict__ src, T* __restrict__ dst) \
+		{ \
+			index_t i = 0; \
+			for (; i < n && !simd_is_aligned(dst + i, sizeof(V)); ++i) dst[i] = src[i]; \
+			if (simd_is_aligned(src + i, sizeof(V))) \
+				for (; i + W <= n; i += W) Ops::store(dst + i, Ops::load(src + i)); \
+			else \
+				for (; i + W <= n; i += W) Ops::store(dst + i, Ops::loadu(src + i)); \
+			for (; i < n; ++i) dst[i] = src[i]; \
+		} \
+		\
+		BCS_SIMD_KER(isa) bool equal(const index_t n, const T* __restrict__ a, const T* __restrict__ b) \
+		{ \
+			index_t i = 0; \
+			for (; i < n && !simd_is_aligned(a + i, sizeof(V)); ++i) if (a[i] != b[i]) return false; \
+			if (simd_is_aligned(b + i, sizeof(V))) \
+			{ \
+				for (; i + W <= n; i += W) \
+					if (!Ops::all_eq(Ops::load(a + i), Ops::load(b + i))) return false; \
+			} \
+			else \
+			{ \
+				for (; i + W <= n; i += W) \
+					if (!Ops::all_eq(Ops::load(a + i), Ops::loadu(b + i))) return false; \
+			} \
+			for (; i < n; ++i) if (a[i] != b[i]) return false; \
+			return true; \
+		} \
+		\
+		BCS_SIMD_KER(isa) bool equal(const index_t n, const T* __restrict__ a, const T v) \
+		{ \
+			index_t i = 0; \
+			for (; i < n && !simd_is_aligned(a + i, sizeof(V)); ++i) if (a[i] != v) return false; \
+			const V x = Ops::set1(v); \
+			for (; i + W <= n; i += W) \
+				if (!Ops::all_eq(Ops::load(a + i), x)) return false; \
+			for (; i < n; ++i) if (a[i] != v) return false; \
+			return true; \
+		} \
+	};
+
+
+	/********************************************
+	 *
+	 *  SSE2
+	 *
+	 ********************************************/
+
+	namespace sse2
+	{
+		struct ops_d
+		{
+			typedef double value_type;
+			typedef __m128d vec_t;
+			static const int width = 2;
+
+			BCS_SIMD_OP("sse2") vec_t set1(double v) { return _mm_set1_pd(v); }
+			BCS_SIMD_OP("sse2") vec_t load(const double *p) { return _mm_load_pd(p); }
+			BCS_SIMD_OP("sse2") vec_t loadu(const double *p) { return _mm_loadu_pd(p); }
+			BCS_SIMD_OP("sse2") void store(double *p, vec_t v) { _mm_store_pd(p, v); }
+			BCS_SIMD_OP("sse2") bool all_eq(vec_t a, vec_t b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)) == 0x3; }
+		};
+
+		struct ops_f
+		{
+			typedef float value_type;
+			typedef __m128 vec_t;
+			static const int width = 4;
+
+			BCS_SIMD_OP("sse2") vec_t set1(float v) { return _mm_set1_ps(v); }
+			BCS_SIMD_OP("sse2") vec_t load(const float *p) { return _mm_load_ps(p); }
+			BCS_SIMD_OP("sse2") vec_t loadu(const float *p) { return _mm_loadu_ps(p); }
+			BCS_SIMD_OP("sse2") void store(float *p, vec_t v) { _mm_store_ps(p, v); }
+			BCS_SIMD_OP("sse2") bool all_eq(vec_t a, vec_t b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xF; }
+		};
+
+		BCS_DEFINE_SIMD_MEMOP_KERNELS("sse2")
+	}
+
+
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+
+	/********************************************
+	 *
+	 *  AVX2
+	 *
+	 ********************************************/
+
+	namespace avx2
+	{
+		struct ops_d
+		{
+			typedef double value_type;
+			typedef __m256d vec_t;
+			static const int width = 4;
+
+			BCS_SIMD_OP("avx2") vec_t set1(double v) { return _mm256_set1_pd(v); }
+			BCS_SIMD_OP("avx2") vec_t load(const double *p) { return _mm256_load_pd(p); }
+			BCS_SIMD_OP("avx2") vec_t loadu(const double *p) { return _mm256_loadu_pd(p); }
+			BCS_SIMD_OP("avx2") void store(double *p, vec_t v) { _mm256_store_pd(p, v); }
+			BCS_SIMD_OP("avx2") bool all_eq(vec_t a, vec_t b)
+			{
+				return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)) == 0xF;
+			}
+		};
+
+		struct ops_f
+		{
+			typedef float value_type;
+			typedef __m256 vec_t;
+			static const int width = 8;
+
+			BCS_SIMD_OP("avx2") vec_t set1(float v) { return _mm256_set1_ps(v); }
+			BCS_SIMD_OP("avx2") vec_t load(const float *p) { return _mm256_load_ps(p); }
+			BCS_SIMD_OP("avx2") vec_t loadu(const float *p) { return _mm256_loadu_ps(p); }
+			BCS_SIMD_OP("avx2") void store(float *p, vec_t v) { _mm256_store_ps(p, v); }
+			BCS_SIMD_OP("avx2") bool all_eq(vec_t a, vec_t b)
+			{
+				return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)) == 0xFF;
+			}
+		};
+
+		BCS_DEFINE_SIMD_MEMOP_KERNELS("avx2")
+	}
+
+
+	/********************************************
+	 *
+	 *  AVX-512
+	 *
+	 ********************************************/
+
+	namespace avx512
+	{
+		struct ops_d
+		{
+			typedef double value_type;
+			typedef __m512d vec_t;
+			static const int width = 8;
+
+			BCS_SIMD_OP("avx512f") vec_t set1(double v) { return _mm512_set1_pd(v); }
+			BCS_SIMD_OP("avx512f") vec_t load(const double *p) { return _mm512_load_pd(p); }
+			BCS_SIMD_OP("avx512f") vec_t loadu(const double *p) { return _mm512_loadu_pd(p); }
+			BCS_SIMD_OP("avx512f") void store(double *p, vec_t v) { _mm512_store_pd(p, v); }
+			BCS_SIMD_OP("avx512f") bool all_eq(vec_t a, vec_t b)
+			{
+				return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ) == 0xFF;
+			}
+		};
+
+		struct ops_f
+		{
+			typedef float value_type;
+			typedef __m512 vec_t;
+			static const int width = 16;
+
+			BCS_SIMD_OP("avx512f") vec_t set1(float v) { return _mm512_set1_ps(v); }
+			BCS_SIMD_OP("avx512f") vec_t load(const float *p) { return _mm512_load_ps(p); }
+			BCS_SIMD_OP("avx512f") vec_t loadu(const float *p) { return _mm512_loadu_ps(p); }
+			BCS_SIMD_OP("avx512f") void store(float *p, vec_t v) { _mm512_store_ps(p, v); }
+			BCS_SIMD_OP("avx512f") bool all_eq(vec_t a, vec_t b)
+			{
+				return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ) == 0xFFFF;
+			}
+		};
+
+		BCS_DEFINE_SIMD_MEMOP_KERNELS("avx512f")
+	}
+
+#endif
+
+
+	/********************************************
+	 *
+	 *  Dispatch
+	 *
+	 ********************************************/
+
+	template<typename T> struct simd_ops_of;
+
+	template<> struct simd_ops_of<double>
+	{
+		typedef sse2::ops_d sse2_t;
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+		typedef avx2::ops_d avx2_t;
+		typedef avx512::ops_d avx512_t;
+#endif
+	};
+
+	template<> struct simd_ops_of<float>
+	{
+		typedef sse2::ops_f sse2_t;
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+		typedef avx2::ops_f avx2_t;
+		typedef avx512::ops_f avx512_t;
+#endif
+	};
+
+
+	template<typename T>
+	struct simd_memop
+	{
+		typedef typename simd_ops_of<T>::sse2_t sse2_ops;
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+		typedef typename simd_ops_of<T>::avx2_t avx2_ops;
+		typedef typename simd_ops_of<T>::avx512_t avx512_ops;
+#endif
+
+		static void fill(const int level, const index_t n, T* __restrict__ dst, const T v)
+		{
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+			if (level >= SIMD_AVX512) { avx512::kernels<avx512_ops>::fill(n, dst, v); return; }
+			if (level >= SIMD_AVX2) { avx2::kernels<avx2_ops>::fill(n, dst, v); return; }
+#endif
+			sse2::kernels<sse2_ops>::fill(n, dst, v);
+		}
+
+		static void copy(const int level, const index_t n, const T* __restrict__ src, T* __restrict__ dst)
+		{
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+			if (level >= SIMD_AVX512) { avx512::kernels<avx512_ops>::copy(n, src, dst); return; }
+			if (level >= SIMD_AVX2) { avx2::kernels<avx2_ops>::copy(n, src, dst); return; }
+#endif
+			sse2::kernels<sse2_ops>::copy(n, src, dst);
+		}
+
+		static bool equal(const int level, const index_t n, const T* __restrict__ a, const T* __restrict__ b)
+		{
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+			if (level >= SIMD_AVX512) return avx512::kernels<avx512_ops>::equal(n, a, b);
+			if (level >= SIMD_AVX2) return avx2::kernels<avx2_ops>::equal(n, a, b);
+#endif
+			return sse2::kernels<sse2_ops>::equal(n, a, b);
+		}
+
+		static bool equal(const int level, const index_t n, const T* __restrict__ a, const T v)
+		{
+#ifdef BCS_HAS_SIMD_MEMOP_AVX
+			if (level >= SIMD_AVX512) return avx512::kernels<avx512_ops>::equal(n, a, v);
+			if (level >= SIMD_AVX2) return avx2::kernels<avx2_ops>::equal(n, a, v);
+#endif
+			return sse2::kernels<sse2_ops>::equal(n, a, v);
+		}
+	};
+
+} }
+
+#undef BCS_SIMD_OP
+#undef BCS_SIMD_KER
+#undef BCS_DEFINE_SIMD_MEMOP_KERNELS
+
+#endif /* BCS_HAS_SIMD_MEMOP */
+
+#endif /* BCSLIB_MEM_OP_SIMD_H_ */
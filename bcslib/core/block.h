@@ -15,6 +15,7 @@
 
 #include <bcslib/core/mem_op.h>
 #include <algorithm>
+#include <utility>
 
 namespace bcs
 {
@@ -188,6 +189,15 @@ namespace bcs
 			copy_elems(m_len, s.ptr_begin(), m_ptr);
 		}
 
+		block(block&& s) BCS_NOEXCEPT
+		: m_allocator(s.m_allocator)
+		, m_len(s.m_len)
+		, m_ptr(s.m_ptr)
+		{
+			s.m_len = 0;
+			s.m_ptr = BCS_NULL;
+		}
+
 		template<class OtherDerived>
 		block(const IBlock<OtherDerived, T>& s, const allocator_type& allocator = allocator_type())
 		: m_allocator(allocator)
@@ -218,6 +228,22 @@ namespace bcs
 			return *this;
 		}
 
+		block& operator = (block&& r) BCS_NOEXCEPT
+		{
+			if (this != &r)
+			{
+				dealloc(m_ptr);
+
+				m_allocator = r.m_allocator;
+				m_len = r.m_len;
+				m_ptr = r.m_ptr;
+
+				r.m_len = 0;
+				r.m_ptr = BCS_NULL;
+			}
+			return *this;
+		}
+
 		template<class OtherDerived>
 		block& operator = (const IBlock<OtherDerived, T>& r)
 		{
@@ -376,6 +402,31 @@ namespace bcs
 			copy_elems(len, src, m_ptr);
 		}
 
+		scoped_block(scoped_block&& s) BCS_NOEXCEPT
+		: m_allocator(s.m_allocator)
+		, m_len(s.m_len)
+		, m_ptr(s.m_ptr)
+		{
+			s.m_len = 0;
+			s.m_ptr = BCS_NULL;
+		}
+
+		scoped_block& operator = (scoped_block&& r) BCS_NOEXCEPT
+		{
+			if (this != &r)
+			{
+				dealloc(m_ptr);
+
+				m_allocator = r.m_allocator;
+				m_len = r.m_len;
+				m_ptr = r.m_ptr;
+
+				r.m_len = 0;
+				r.m_ptr = BCS_NULL;
+			}
+			return *this;
+		}
+
 		~scoped_block()
 		{
 			dealloc(m_ptr);
@@ -26,6 +26,12 @@
 	template<typename T> struct is_reductor<Name<T>, N> { static const bool value = true; }; \
 	template<typename T> struct num_arguments<Name<T> > { static const bool value = N; };
 
+#define BCS_DECLARE_ASSOCIATIVE_REDUCTOR(Name) \
+	template<typename T> struct is_associative_reductor<Name<T> > { static const bool value = true; };
+
+#define BCS_DECLARE_ARG_REDUCTOR(Name) \
+	template<typename T> struct is_arg_reductor<Name<T> > { static const bool value = true; };
+
 
 namespace bcs
 {
@@ -44,6 +50,30 @@ namespace bcs
 		static const bool value = false;
 	};
 
+	/**
+	 * A reductor is associative if its add/combine operations are
+	 * (mathematically) associative and commutative, such that the
+	 * elements may be accumulated in any order and grouping
+	 * (e.g. with multiple independent accumulators).
+	 */
+	template<typename F>
+	struct is_associative_reductor
+	{
+		static const bool value = false;
+	};
+
+	/**
+	 * An arg reductor (e.g. argmin_reductor) finds an extreme element
+	 * together with its index, where better(x, y) tells whether x is
+	 * to replace the current extreme y (and, with packets, yields a
+	 * lane mask). This allows compare-and-blend kernels on dense data.
+	 */
+	template<typename F>
+	struct is_arg_reductor
+	{
+		static const bool value = false;
+	};
+
 }
 
 #endif /* FUNCTIONAL_H_ */
@@ -202,6 +202,12 @@ namespace bcs
     	{
     	}
 
+    	aligned_allocator& operator = (const aligned_allocator& r)
+    	{
+    		m_alignment = r.alignment();
+    		return *this;
+    	}
+
     	template<typename U>
     	aligned_allocator(const aligned_allocator<U>& r)
     	: m_alignment(r.alignment())
@@ -236,7 +242,7 @@ namespace bcs
 
     	void deallocate(pointer p, size_type)
     	{
-    		aligned_release(p);
+    		bcs::aligned_release(p);
     	}
 
     	void construct (pointer p, const_reference val)
@@ -0,0 +1,584 @@
+/**
+ * @file packet.h
+ *
+ * SIMD packets for vectorized element-wise evaluation
+ *
+ * A packet is a short vector of scalars held in a SIMD
+ * register. The instruction set is fixed at compile time:
+ * AVX is used when the compiler targets it (e.g. with
+ * -mavx or -march=native), otherwise SSE2.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_PACKET_H_
+#define BCSLIB_PACKET_H_
+
+#include <bcslib/core/basic_defs.h>
+
+#if defined(BCSLIB_USE_SSE2) && defined(__SSE2__)
+#define BCS_HAS_PACKET
+#include <emmintrin.h>
+
+#ifdef __AVX__
+#define BCS_HAS_PACKET_AVX
+#include <immintrin.h>
+#endif
+
+#endif
+
+
+namespace bcs
+{
+
+	/********************************************
+	 *
+	 *  packet traits
+	 *
+	 *  supported:  whether T has a packet type
+	 *  width:      the number of scalars in a packet
+	 *  type:       the packet type (nil_type if
+	 *              not supported)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct packet_traits
+	{
+		static const bool supported = false;
+		static const int width = 1;
+		static const int alignment = sizeof(T);
+		typedef nil_type type;
+	};
+
+#ifdef BCS_HAS_PACKET
+
+#ifdef BCS_HAS_PACKET_AVX
+
+	template<>
+	struct packet_traits<double>
+	{
+		static const bool supported = true;
+		static const int width = 4;
+		static const int alignment = 32;
+		typedef __m256d type;
+	};
+
+	template<>
+	struct packet_traits<float>
+	{
+		static const bool supported = true;
+		static const int width = 8;
+		static const int alignment = 32;
+		typedef __m256 type;
+	};
+
+#else
+
+	template<>
+	struct packet_traits<double>
+	{
+		static const bool supported = true;
+		static const int width = 2;
+		static const int alignment = 16;
+		typedef __m128d type;
+	};
+
+	template<>
+	struct packet_traits<float>
+	{
+		static const bool supported = true;
+		static const int width = 4;
+		static const int alignment = 16;
+		typedef __m128 type;
+	};
+
+#endif
+
+#endif
+
+
+	/**
+	 * has_packet_op<F>::value indicates whether the functor F
+	 * can be applied to packets.
+	 */
+	template<typename F>
+	struct has_packet_op
+	{
+		static const bool value = false;
+	};
+
+#define BCS_DECLARE_PACKET_FUNCTOR(Name) \
+	template<typename T> struct has_packet_op<Name<T> > { static const bool value = packet_traits<T>::supported; };
+
+
+	/**
+	 * Returns the number of leading elements to be processed
+	 * one by one, such that p + (returned value) is aligned
+	 * to a packet boundary. (Returns -1 if p is not even
+	 * aligned to the scalar size).
+	 */
+	template<typename T>
+	BCS_ENSURE_INLINE
+	inline index_t packet_head(const T *p)
+	{
+		const size_t a = (size_t)packet_traits<T>::alignment;
+		const size_t r = (size_t)(p) & (a - 1);
+
+		if (r % sizeof(T) != 0) return -1;
+		return (index_t)(((a - r) & (a - 1)) / sizeof(T));
+	}
+
+
+	/********************************************
+	 *
+	 *  packet operations
+	 *
+	 ********************************************/
+
+#ifdef BCS_HAS_PACKET
+
+	namespace simd
+	{
+
+#ifdef BCS_HAS_PACKET_AVX
+
+		// double
+
+		BCS_ENSURE_INLINE inline __m256d set1(const double x) { return _mm256_set1_pd(x); }
+		BCS_ENSURE_INLINE inline __m256d load(const double *p) { return _mm256_load_pd(p); }
+		BCS_ENSURE_INLINE inline __m256d loadu(const double *p) { return _mm256_loadu_pd(p); }
+		BCS_ENSURE_INLINE inline void store(double *p, const __m256d x) { _mm256_store_pd(p, x); }
+		BCS_ENSURE_INLINE inline void storeu(double *p, const __m256d x) { _mm256_storeu_pd(p, x); }
+
+		BCS_ENSURE_INLINE inline __m256d add(const __m256d x, const __m256d y) { return _mm256_add_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m256d sub(const __m256d x, const __m256d y) { return _mm256_sub_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m256d mul(const __m256d x, const __m256d y) { return _mm256_mul_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m256d div(const __m256d x, const __m256d y) { return _mm256_div_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m256d sqrt(const __m256d x) { return _mm256_sqrt_pd(x); }
+
+		// min/max follow the semantics of std::min/max (x is returned on NaN)
+		BCS_ENSURE_INLINE inline __m256d min(const __m256d x, const __m256d y) { return _mm256_min_pd(y, x); }
+		BCS_ENSURE_INLINE inline __m256d max(const __m256d x, const __m256d y) { return _mm256_max_pd(y, x); }
+
+		BCS_ENSURE_INLINE inline __m256d neg(const __m256d x) { return _mm256_xor_pd(x, _mm256_set1_pd(-0.0)); }
+		BCS_ENSURE_INLINE inline __m256d abs(const __m256d x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+
+		// comparisons yield lane masks (false on NaN), and select(m, x, y) is m ? x : y
+		BCS_ENSURE_INLINE inline __m256d lt(const __m256d x, const __m256d y) { return _mm256_cmp_pd(x, y, _CMP_LT_OQ); }
+		BCS_ENSURE_INLINE inline __m256d gt(const __m256d x, const __m256d y) { return _mm256_cmp_pd(x, y, _CMP_GT_OQ); }
+		BCS_ENSURE_INLINE inline __m256d select(const __m256d m, const __m256d x, const __m256d y) { return _mm256_blendv_pd(y, x, m); }
+
+		// float
+
+		BCS_ENSURE_INLINE inline __m256 set1(const float x) { return _mm256_set1_ps(x); }
+		BCS_ENSURE_INLINE inline __m256 load(const float *p) { return _mm256_load_ps(p); }
+		BCS_ENSURE_INLINE inline __m256 loadu(const float *p) { return _mm256_loadu_ps(p); }
+		BCS_ENSURE_INLINE inline void store(float *p, const __m256 x) { _mm256_store_ps(p, x); }
+		BCS_ENSURE_INLINE inline void storeu(float *p, const __m256 x) { _mm256_storeu_ps(p, x); }
+
+		BCS_ENSURE_INLINE inline __m256 add(const __m256 x, const __m256 y) { return _mm256_add_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m256 sub(const __m256 x, const __m256 y) { return _mm256_sub_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m256 mul(const __m256 x, const __m256 y) { return _mm256_mul_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m256 div(const __m256 x, const __m256 y) { return _mm256_div_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m256 sqrt(const __m256 x) { return _mm256_sqrt_ps(x); }
+
+		BCS_ENSURE_INLINE inline __m256 min(const __m256 x, const __m256 y) { return _mm256_min_ps(y, x); }
+		BCS_ENSURE_INLINE inline __m256 max(const __m256 x, const __m256 y) { return _mm256_max_ps(y, x); }
+
+		BCS_ENSURE_INLINE inline __m256 neg(const __m256 x) { return _mm256_xor_ps(x, _mm256_set1_ps(-0.0f)); }
+		BCS_ENSURE_INLINE inline __m256 abs(const __m256 x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+
+		BCS_ENSURE_INLINE inline __m256 lt(const __m256 x, const __m256 y) { return _mm256_cmp_ps(x, y, _CMP_LT_OQ); }
+		BCS_ENSURE_INLINE inline __m256 gt(const __m256 x, const __m256 y) { return _mm256_cmp_ps(x, y, _CMP_GT_OQ); }
+		BCS_ENSURE_INLINE inline __m256 select(const __m256 m, const __m256 x, const __m256 y) { return _mm256_blendv_ps(y, x, m); }
+
+#else
+
+		// double
+
+		BCS_ENSURE_INLINE inline __m128d set1(const double x) { return _mm_set1_pd(x); }
+		BCS_ENSURE_INLINE inline __m128d load(const double *p) { return _mm_load_pd(p); }
+		BCS_ENSURE_INLINE inline __m128d loadu(const double *p) { return _mm_loadu_pd(p); }
+		BCS_ENSURE_INLINE inline void store(double *p, const __m128d x) { _mm_store_pd(p, x); }
+		BCS_ENSURE_INLINE inline void storeu(double *p, const __m128d x) { _mm_storeu_pd(p, x); }
+
+		BCS_ENSURE_INLINE inline __m128d add(const __m128d x, const __m128d y) { return _mm_add_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d sub(const __m128d x, const __m128d y) { return _mm_sub_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d mul(const __m128d x, const __m128d y) { return _mm_mul_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d div(const __m128d x, const __m128d y) { return _mm_div_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d sqrt(const __m128d x) { return _mm_sqrt_pd(x); }
+
+		// min/max follow the semantics of std::min/max (x is returned on NaN)
+		BCS_ENSURE_INLINE inline __m128d min(const __m128d x, const __m128d y) { return _mm_min_pd(y, x); }
+		BCS_ENSURE_INLINE inline __m128d max(const __m128d x, const __m128d y) { return _mm_max_pd(y, x); }
+
+		BCS_ENSURE_INLINE inline __m128d neg(const __m128d x) { return _mm_xor_pd(x, _mm_set1_pd(-0.0)); }
+		BCS_ENSURE_INLINE inline __m128d abs(const __m128d x) { return _mm_andnot_pd(_mm_set1_pd(-0.0), x); }
+
+		// comparisons yield lane masks (false on NaN), and select(m, x, y) is m ? x : y
+		BCS_ENSURE_INLINE inline __m128d lt(const __m128d x, const __m128d y) { return _mm_cmplt_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d gt(const __m128d x, const __m128d y) { return _mm_cmpgt_pd(x, y); }
+		BCS_ENSURE_INLINE inline __m128d select(const __m128d m, const __m128d x, const __m128d y)
+		{
+			return _mm_or_pd(_mm_and_pd(m, x), _mm_andnot_pd(m, y));
+		}
+
+		// float
+
+		BCS_ENSURE_INLINE inline __m128 set1(const float x) { return _mm_set1_ps(x); }
+		BCS_ENSURE_INLINE inline __m128 load(const float *p) { return _mm_load_ps(p); }
+		BCS_ENSURE_INLINE inline __m128 loadu(const float *p) { return _mm_loadu_ps(p); }
+		BCS_ENSURE_INLINE inline void store(float *p, const __m128 x) { _mm_store_ps(p, x); }
+		BCS_ENSURE_INLINE inline void storeu(float *p, const __m128 x) { _mm_storeu_ps(p, x); }
+
+		BCS_ENSURE_INLINE inline __m128 add(const __m128 x, const __m128 y) { return _mm_add_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 sub(const __m128 x, const __m128 y) { return _mm_sub_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 mul(const __m128 x, const __m128 y) { return _mm_mul_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 div(const __m128 x, const __m128 y) { return _mm_div_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 sqrt(const __m128 x) { return _mm_sqrt_ps(x); }
+
+		BCS_ENSURE_INLINE inline __m128 min(const __m128 x, const __m128 y) { return _mm_min_ps(y, x); }
+		BCS_ENSURE_INLINE inline __m128 max(const __m128 x, const __m128 y) { return _mm_max_ps(y, x); }
+
+		BCS_ENSURE_INLINE inline __m128 neg(const __m128 x) { return _mm_xor_ps(x, _mm_set1_ps(-0.0f)); }
+		BCS_ENSURE_INLINE inline __m128 abs(const __m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+
+		BCS_ENSURE_INLINE inline __m128 lt(const __m128 x, const __m128 y) { return _mm_cmplt_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 gt(const __m128 x, const __m128 y) { return _mm_cmpgt_ps(x, y); }
+		BCS_ENSURE_INLINE inline __m128 select(const __m128 m, const __m128 x, const __m128 y)
+		{
+			return _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y));
+		}
+
+#endif
+	}
+
+#endif
+
+
+	/********************************************
+	 *
+	 *  interleaving (structure-of-arrays)
+	 *
+	 *  W sources (e.g. W columns or W small
+	 *  matrices) are interleaved into a buffer
+	 *  as buf[e * W + l], such that each lane of
+	 *  a packet works on a different source.
+	 *
+	 ********************************************/
+
+	// W x W in-register transposition between W runs (one per source)
+	// and W interleaved packets
+
+	template<typename T> struct soa_block;
+
+	template<typename T> struct soa_width
+	{
+		static const int value = 1;
+	};
+
+#ifdef BCS_HAS_PACKET
+
+#ifdef BCS_HAS_PACKET_AVX
+
+	template<>
+	struct soa_block<double>
+	{
+		static const int W = 4;
+
+		BCS_ENSURE_INLINE
+		static void trans(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3)
+		{
+			__m256d t0 = _mm256_unpacklo_pd(r0, r1);
+			__m256d t1 = _mm256_unpackhi_pd(r0, r1);
+			__m256d t2 = _mm256_unpacklo_pd(r2, r3);
+			__m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+			r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+			r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+			r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+			r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+
+		// r[k][l] = s[l][off + k]
+		BCS_ENSURE_INLINE
+		static void load_packets(const double* const *s, const index_t off, __m256d *r)
+		{
+			r[0] = _mm256_loadu_pd(s[0] + off);
+			r[1] = _mm256_loadu_pd(s[1] + off);
+			r[2] = _mm256_loadu_pd(s[2] + off);
+			r[3] = _mm256_loadu_pd(s[3] + off);
+
+			trans(r[0], r[1], r[2], r[3]);
+		}
+
+		// r[k][l] = s[l * ld + k]
+		BCS_ENSURE_INLINE
+		static void load_packets(const double *s, const index_t ld, __m256d *r)
+		{
+			r[0] = _mm256_loadu_pd(s);
+			r[1] = _mm256_loadu_pd(s + ld);
+			r[2] = _mm256_loadu_pd(s + 2 * ld);
+			r[3] = _mm256_loadu_pd(s + 3 * ld);
+
+			trans(r[0], r[1], r[2], r[3]);
+		}
+
+		// d[k * W + l] = s[l][off + k]
+		BCS_ENSURE_INLINE
+		static void load(const double* const *s, const index_t off, double *d)
+		{
+			__m256d r[4];
+			load_packets(s, off, r);
+
+			_mm256_store_pd(d, r[0]);
+			_mm256_store_pd(d + 4, r[1]);
+			_mm256_store_pd(d + 8, r[2]);
+			_mm256_store_pd(d + 12, r[3]);
+		}
+
+		// d[l][off + k] = s[k * W + l]
+		BCS_ENSURE_INLINE
+		static void store(const double *s, double* const *d, const index_t off)
+		{
+			__m256d r0 = _mm256_load_pd(s);
+			__m256d r1 = _mm256_load_pd(s + 4);
+			__m256d r2 = _mm256_load_pd(s + 8);
+			__m256d r3 = _mm256_load_pd(s + 12);
+
+			trans(r0, r1, r2, r3);
+
+			_mm256_storeu_pd(d[0] + off, r0);
+			_mm256_storeu_pd(d[1] + off, r1);
+			_mm256_storeu_pd(d[2] + off, r2);
+			_mm256_storeu_pd(d[3] + off, r3);
+		}
+	};
+
+	template<>
+	struct soa_block<float>
+	{
+		static const int W = 8;
+
+		BCS_ENSURE_INLINE
+		static void trans(__m256 *r)
+		{
+			__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+			__m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+			__m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+			__m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+			__m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+			__m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+			__m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+			__m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+			__m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+			__m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+			__m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+			__m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+			__m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+			__m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+			__m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+			__m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+			r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+			r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+			r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+			r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+			r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+			r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+			r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+			r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+		}
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const float* const *s, const index_t off, __m256 *r)
+		{
+			for (int k = 0; k < 8; ++k) r[k] = _mm256_loadu_ps(s[k] + off);
+			trans(r);
+		}
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const float *s, const index_t ld, __m256 *r)
+		{
+			for (int k = 0; k < 8; ++k) r[k] = _mm256_loadu_ps(s + k * ld);
+			trans(r);
+		}
+
+		BCS_ENSURE_INLINE
+		static void load(const float* const *s, const index_t off, float *d)
+		{
+			__m256 r[8];
+			load_packets(s, off, r);
+			for (int k = 0; k < 8; ++k) _mm256_store_ps(d + k * 8, r[k]);
+		}
+
+		BCS_ENSURE_INLINE
+		static void store(const float *s, float* const *d, const index_t off)
+		{
+			__m256 r[8];
+			for (int k = 0; k < 8; ++k) r[k] = _mm256_load_ps(s + k * 8);
+			trans(r);
+			for (int k = 0; k < 8; ++k) _mm256_storeu_ps(d[k] + off, r[k]);
+		}
+	};
+
+#else
+
+	template<>
+	struct soa_block<double>
+	{
+		static const int W = 2;
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const double* const *s, const index_t off, __m128d *r)
+		{
+			__m128d r0 = _mm_loadu_pd(s[0] + off);
+			__m128d r1 = _mm_loadu_pd(s[1] + off);
+
+			r[0] = _mm_unpacklo_pd(r0, r1);
+			r[1] = _mm_unpackhi_pd(r0, r1);
+		}
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const double *s, const index_t ld, __m128d *r)
+		{
+			__m128d r0 = _mm_loadu_pd(s);
+			__m128d r1 = _mm_loadu_pd(s + ld);
+
+			r[0] = _mm_unpacklo_pd(r0, r1);
+			r[1] = _mm_unpackhi_pd(r0, r1);
+		}
+
+		BCS_ENSURE_INLINE
+		static void load(const double* const *s, const index_t off, double *d)
+		{
+			__m128d r[2];
+			load_packets(s, off, r);
+
+			_mm_store_pd(d, r[0]);
+			_mm_store_pd(d + 2, r[1]);
+		}
+
+		BCS_ENSURE_INLINE
+		static void store(const double *s, double* const *d, const index_t off)
+		{
+			__m128d r0 = _mm_load_pd(s);
+			__m128d r1 = _mm_load_pd(s + 2);
+
+			_mm_storeu_pd(d[0] + off, _mm_unpacklo_pd(r0, r1));
+			_mm_storeu_pd(d[1] + off, _mm_unpackhi_pd(r0, r1));
+		}
+	};
+
+	template<>
+	struct soa_block<float>
+	{
+		static const int W = 4;
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const float* const *s, const index_t off, __m128 *r)
+		{
+			__m128 r0 = _mm_loadu_ps(s[0] + off);
+			__m128 r1 = _mm_loadu_ps(s[1] + off);
+			__m128 r2 = _mm_loadu_ps(s[2] + off);
+			__m128 r3 = _mm_loadu_ps(s[3] + off);
+
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			r[0] = r0;
+			r[1] = r1;
+			r[2] = r2;
+			r[3] = r3;
+		}
+
+		BCS_ENSURE_INLINE
+		static void load_packets(const float *s, const index_t ld, __m128 *r)
+		{
+			__m128 r0 = _mm_loadu_ps(s);
+			__m128 r1 = _mm_loadu_ps(s + ld);
+			__m128 r2 = _mm_loadu_ps(s + 2 * ld);
+			__m128 r3 = _mm_loadu_ps(s + 3 * ld);
+
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			r[0] = r0;
+			r[1] = r1;
+			r[2] = r2;
+			r[3] = r3;
+		}
+
+		BCS_ENSURE_INLINE
+		static void load(const float* const *s, const index_t off, float *d)
+		{
+			__m128 r[4];
+			load_packets(s, off, r);
+
+			_mm_store_ps(d, r[0]);
+			_mm_store_ps(d + 4, r[1]);
+			_mm_store_ps(d + 8, r[2]);
+			_mm_store_ps(d + 12, r[3]);
+		}
+
+		BCS_ENSURE_INLINE
+		static void store(const float *s, float* const *d, const index_t off)
+		{
+			__m128 r0 = _mm_load_ps(s);
+			__m128 r1 = _mm_load_ps(s + 4);
+			__m128 r2 = _mm_load_ps(s + 8);
+			__m128 r3 = _mm_load_ps(s + 12);
+
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			_mm_storeu_ps(d[0] + off, r0);
+			_mm_storeu_ps(d[1] + off, r1);
+			_mm_storeu_ps(d[2] + off, r2);
+			_mm_storeu_ps(d[3] + off, r3);
+		}
+	};
+
+#endif
+
+	template<> struct soa_width<double> { static const int value = soa_block<double>::W; };
+	template<> struct soa_width<float>  { static const int value = soa_block<float>::W; };
+
+
+	// interleaves a contiguous run of L elements (starting at off)
+	template<typename T, int L>
+	BCS_ENSURE_INLINE
+	inline void soa_load_run(const T* const *s, const index_t off, T* __restrict__ buf)
+	{
+		const int W = soa_block<T>::W;
+
+		int e = 0;
+		for (; e + W <= L; e += W) soa_block<T>::load(s, off + e, buf + e * W);
+		for (; e < L; ++e)
+		{
+			for (int l = 0; l < W; ++l) buf[e * W + l] = s[l][off + e];
+		}
+	}
+
+	template<typename T, int L>
+	BCS_ENSURE_INLINE
+	inline void soa_store_run(const T* __restrict__ buf, T* const *d, const index_t off)
+	{
+		const int W = soa_block<T>::W;
+
+		int e = 0;
+		for (; e + W <= L; e += W) soa_block<T>::store(buf + e * W, d, off + e);
+		for (; e < L; ++e)
+		{
+			for (int l = 0; l < W; ++l) d[l][off + e] = buf[e * W + l];
+		}
+	}
+
+#endif
+
+}
+
+#endif /* BCSLIB_PACKET_H_ */
@@ -0,0 +1,436 @@
+/**
+ * @file parallel.h
+ *
+ * A library-owned thread pool and parallel_for
+ *
+ * Large evaluation steps (e.g. element-wise evaluation and
+ * column-wise reduction) are split into contiguous ranges,
+ * which are processed concurrently by a pool of worker threads
+ * together with the calling thread. Steps that are smaller than
+ * two grains are always run serially on the calling thread.
+ *
+ * The number of threads and the grain size can be set through
+ * the environment variables BCS_NUM_THREADS and BCS_PARALLEL_GRAIN,
+ * or through set_num_threads and set_parallel_grain.
+ *
+ * With BCSLIB_NO_THREADS defined, everything runs serially.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_PARALLEL_H_
+#define BCSLIB_PARALLEL_H_
+
+#include <bcslib/core/basic_defs.h>
+
+#include <cstdlib>
+
+#ifndef BCSLIB_NO_THREADS
+#include <vector>
+#include <memory>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace bcs
+{
+
+	/********************************************
+	 *
+	 *  settings
+	 *
+	 ********************************************/
+
+	const index_t DefaultParallelGrain = 32768;
+
+	namespace detail
+	{
+		inline long parallel_env_value(const char *name)
+		{
+			const char *s = std::getenv(name);
+			return s ? std::strtol(s, BCS_NULL, 10) : 0;
+		}
+
+		inline int default_num_threads()
+		{
+#ifndef BCSLIB_NO_THREADS
+			long n = parallel_env_value("BCS_NUM_THREADS");
+			if (n <= 0) n = (long)std::thread::hardware_concurrency();
+			return n > 0 ? (int)n : 1;
+#else
+			return 1;
+#endif
+		}
+
+		inline index_t default_parallel_grain()
+		{
+			long g = parallel_env_value("BCS_PARALLEL_GRAIN");
+			return g > 0 ? (index_t)g : DefaultParallelGrain;
+		}
+
+		struct parallel_settings
+		{
+			int num_threads;
+			index_t grain;
+
+			parallel_settings()
+			: num_threads(default_num_threads())
+			, grain(default_parallel_grain())
+			{ }
+		};
+
+		inline parallel_settings& par_settings()
+		{
+			static parallel_settings s;
+			return s;
+		}
+	}
+
+	/**
+	 * Returns the number of threads used in parallel evaluation
+	 * (including the calling thread)
+	 */
+	inline int get_num_threads()
+	{
+		return detail::par_settings().num_threads;
+	}
+
+	/**
+	 * Sets the number of threads used in parallel evaluation
+	 * (n <= 0 restores the default, which is taken from BCS_NUM_THREADS
+	 * or otherwise the number of hardware threads).
+	 *
+	 * Note: this should not be called while a parallel evaluation
+	 * is in progress.
+	 */
+	inline void set_num_threads(int n)
+	{
+		detail::par_settings().num_threads = n > 0 ? n : detail::default_num_threads();
+	}
+
+	/**
+	 * Returns the minimum number of elements to be processed by
+	 * a thread in parallel evaluation
+	 */
+	inline index_t get_parallel_grain()
+	{
+		return detail::par_settings().grain;
+	}
+
+	/**
+	 * Sets the minimum number of elements to be processed by
+	 * a thread in parallel evaluation (g <= 0 restores the default)
+	 */
+	inline void set_parallel_grain(index_t g)
+	{
+		detail::par_settings().grain = g > 0 ? g : detail::default_parallel_grain();
+	}
+
+
+	/********************************************
+	 *
+	 *  thread pool
+	 *
+	 ********************************************/
+
+#ifndef BCSLIB_NO_THREADS
+
+	/**
+	 * A fork-join thread pool
+	 *
+	 * run(ntasks, f, ctx) invokes f(ctx, k) for each k in [0, ntasks),
+	 * with the tasks shared among the workers and the calling thread,
+	 * and returns when all of them are done. The first exception
+	 * thrown by a task is re-thrown to the caller.
+	 */
+	class thread_pool : private noncopyable
+	{
+	public:
+		typedef void (*task_fun)(void *ctx, int k);
+
+		explicit thread_pool(int nworkers)
+		: m_fun(BCS_NULL), m_ctx(BCS_NULL), m_ntasks(0), m_next(0), m_pending(0), m_stop(false)
+		{
+			m_workers.reserve((size_t)nworkers);
+			for (int i = 0; i < nworkers; ++i)
+			{
+				m_workers.push_back(std::thread(&thread_pool::worker_loop, this, i + 1));
+			}
+		}
+
+		~thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lk(m_mutex);
+				m_stop = true;
+			}
+			m_cv_start.notify_all();
+
+			for (size_t i = 0; i < m_workers.size(); ++i) m_workers[i].join();
+		}
+
+		int num_workers() const
+		{
+			return (int)m_workers.size();
+		}
+
+		/**
+		 * Whether the calling thread is running a task of some pool
+		 */
+		static bool in_task()
+		{
+			return task_flag();
+		}
+
+		/**
+		 * The index of the calling thread within its pool
+		 * (0 for any thread that is not a worker)
+		 */
+		static int thread_index()
+		{
+			return index_ref();
+		}
+
+		/**
+		 * Runs the tasks. Returns false without running anything if the
+		 * pool is busy with the tasks issued by another thread.
+		 */
+		bool run(int ntasks, task_fun f, void *ctx)
+		{
+			std::unique_lock<std::mutex> run_lk(m_run_mutex, std::try_to_lock);
+			if (!run_lk.owns_lock()) return false;
+
+			{
+				std::lock_guard<std::mutex> lk(m_mutex);
+				m_fun = f;
+				m_ctx = ctx;
+				m_ntasks = ntasks;
+				m_next = 0;
+				m_pending = ntasks;
+				m_error = std::exception_ptr();
+			}
+			m_cv_start.notify_all();
+
+			std::unique_lock<std::mutex> lk(m_mutex);
+			while (m_next < m_ntasks)
+			{
+				int k = m_next++;
+				lk.unlock();
+				execute(k);
+				lk.lock();
+			}
+			while (m_pending > 0) m_cv_done.wait(lk);
+
+			m_ntasks = 0;
+			std::exception_ptr err = m_error;
+			m_error = std::exception_ptr();
+			lk.unlock();
+
+			if (err) std::rethrow_exception(err);
+			return true;
+		}
+
+	private:
+		static bool& task_flag()
+		{
+			static thread_local bool flag = false;
+			return flag;
+		}
+
+		static int& index_ref()
+		{
+			static thread_local int idx = 0;
+			return idx;
+		}
+
+		// to be called without holding m_mutex
+		void execute(int k)
+		{
+			bool& flag = task_flag();
+			bool saved = flag;
+			flag = true;
+
+			try
+			{
+				m_fun(m_ctx, k);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lk(m_mutex);
+				if (!m_error) m_error = std::current_exception();
+			}
+			flag = saved;
+
+			std::lock_guard<std::mutex> lk(m_mutex);
+			if (--m_pending == 0) m_cv_done.notify_all();
+		}
+
+		void worker_loop(int idx)
+		{
+			index_ref() = idx;
+
+			std::unique_lock<std::mutex> lk(m_mutex);
+			for(;;)
+			{
+				while (!m_stop && m_next >= m_ntasks) m_cv_start.wait(lk);
+				if (m_stop) return;
+
+				int k = m_next++;
+				lk.unlock();
+				execute(k);
+				lk.lock();
+			}
+		}
+
+	private:
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_run_mutex;
+		std::mutex m_mutex;
+		std::condition_variable m_cv_start;
+		std::condition_variable m_cv_done;
+
+		task_fun m_fun;
+		void *m_ctx;
+		int m_ntasks;
+		int m_next;
+		int m_pending;
+		bool m_stop;
+		std::exception_ptr m_error;
+	};
+
+
+	namespace detail
+	{
+		/**
+		 * Returns the global pool with (nthreads - 1) workers,
+		 * (re)creating it when necessary
+		 */
+		inline thread_pool& global_thread_pool(int nthreads)
+		{
+			static std::mutex mtx;
+			static std::unique_ptr<thread_pool> pool;
+
+			std::lock_guard<std::mutex> lk(mtx);
+			if (!pool || pool->num_workers() != nthreads - 1)
+			{
+				pool.reset();
+				pool.reset(new thread_pool(nthreads - 1));
+			}
+			return *pool;
+		}
+	}
+
+#endif
+
+
+	/********************************************
+	 *
+	 *  parallel_for
+	 *
+	 ********************************************/
+
+	namespace detail
+	{
+		template<class F>
+		struct parallel_for_ctx
+		{
+			F& fun;
+			index_t begin;
+			index_t len;
+			int nparts;
+
+			parallel_for_ctx(F& f, index_t b, index_t n, int np)
+			: fun(f), begin(b), len(n), nparts(np) { }
+
+			static void invoke(void *ctx, int k)
+			{
+				parallel_for_ctx& c = *static_cast<parallel_for_ctx*>(ctx);
+				index_t i0 = c.begin + (index_t)((long)c.len * k / c.nparts);
+				index_t i1 = c.begin + (index_t)((long)c.len * (k + 1) / c.nparts);
+				c.fun(i0, i1);
+			}
+		};
+	}
+
+	/**
+	 * Invokes f(i0, i1) over disjoint contiguous sub-ranges that
+	 * together cover [begin, end), each with at least grain indices
+	 * (unless the whole range is shorter than that).
+	 *
+	 * The sub-ranges are processed concurrently when more than one
+	 * thread is available and the range spans at least two grains.
+	 * Nested calls (from within f) run serially.
+	 */
+	template<class F>
+	inline void parallel_for(const index_t begin, const index_t end, const index_t grain, F f)
+	{
+		const index_t len = end - begin;
+		if (len <= 0) return;
+
+#ifndef BCSLIB_NO_THREADS
+		const int nthreads = get_num_threads();
+		const index_t g = grain > 0 ? grain : 1;
+		const index_t nparts = len / g < (index_t)nthreads ? len / g : (index_t)nthreads;
+
+		if (nparts > 1 && !thread_pool::in_task())
+		{
+			detail::parallel_for_ctx<F> ctx(f, begin, len, (int)nparts);
+			if (detail::global_thread_pool(nthreads).run((int)nparts,
+					&detail::parallel_for_ctx<F>::invoke, &ctx))
+			{
+				return;
+			}
+		}
+#endif
+		f(begin, end);
+	}
+
+
+	/**
+	 * The index of the calling thread in [0, get_num_threads()),
+	 * which can be used to pick per-thread scratch space
+	 * (0 for the calling thread of parallel_for, or any thread
+	 * outside the pool)
+	 */
+	inline int current_thread_index()
+	{
+#ifndef BCSLIB_NO_THREADS
+		return thread_pool::thread_index();
+#else
+		return 0;
+#endif
+	}
+
+	/**
+	 * Whether an evaluation step over nelems elements is large
+	 * enough to be run in parallel
+	 */
+	inline bool use_parallel(const index_t nelems)
+	{
+#ifndef BCSLIB_NO_THREADS
+		return get_num_threads() > 1 && nelems >= 2 * get_parallel_grain();
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * The grain (in columns) for a column-wise parallel step over
+	 * columns of length m
+	 */
+	inline index_t parallel_column_grain(const index_t m)
+	{
+		const index_t g = get_parallel_grain();
+		return m > 0 ? (g + m - 1) / m : g;
+	}
+
+}
+
+#endif /* BCSLIB_PARALLEL_H_ */
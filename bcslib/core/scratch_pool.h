@@ -0,0 +1,331 @@
+/**
+ * @file scratch_pool.h
+ *
+ * A thread-local scratch arena and the allocator built on it
+ *
+ * The temporaries made during expression evaluation (e.g. the
+ * caches of non-accessible arguments) are short-lived and mostly
+ * released in the reverse order of allocation. Instead of going
+ * to the system allocator each time, they are bumped off large
+ * chunks owned by a per-thread arena:
+ *
+ * - the most recent allocation is popped back on release;
+ * - the whole arena is rewound once nothing is live;
+ * - a scratch_scope rewinds it to where it was when the scope
+ *   was entered.
+ *
+ * Requests larger than ScratchMaxBytes go to aligned_allocate.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SCRATCH_POOL_H_
+#define BCSLIB_SCRATCH_POOL_H_
+
+#include <bcslib/core/mem_op.h>
+#include <vector>
+
+namespace bcs
+{
+
+	const size_t ScratchChunkBytes = 1024 * 1024;
+	const size_t ScratchMaxBytes = 256 * 1024;
+
+
+	/********************************************
+	 *
+	 *  scratch_arena
+	 *
+	 ********************************************/
+
+	class scratch_arena : private noncopyable
+	{
+	public:
+		struct marker
+		{
+			size_t chunk;
+			size_t top;
+			size_t nlive;
+		};
+
+	public:
+		scratch_arena()
+		: m_cur(0), m_top(0), m_nlive(0)
+		{
+		}
+
+		~scratch_arena()
+		{
+			for (size_t i = 0; i < m_chunks.size(); ++i) aligned_release(m_chunks[i]);
+		}
+
+		/**
+		 * The arena of the calling thread
+		 */
+		static scratch_arena& local()
+		{
+			static thread_local scratch_arena arena;
+			return arena;
+		}
+
+		/**
+		 * Whether a request of nbytes is served by the arena
+		 * (otherwise, it goes to aligned_allocate)
+		 */
+		static bool accepts(size_t nbytes)
+		{
+			return nbytes <= ScratchMaxBytes;
+		}
+
+		size_t num_live() const
+		{
+			return m_nlive;
+		}
+
+		size_t num_chunks() const
+		{
+			return m_chunks.size();
+		}
+
+		size_t used_bytes() const
+		{
+			return m_chunks.empty() ? 0 : m_cur * ScratchChunkBytes + m_top;
+		}
+
+		/**
+		 * Allocates nbytes (nbytes <= ScratchMaxBytes), aligned to
+		 * BCS_DEFAULT_ALIGNMENT
+		 */
+		void* allocate(size_t nbytes)
+		{
+			const size_t nb = round_size(nbytes);
+
+			if (m_chunks.empty())
+			{
+				add_chunk();
+			}
+			else if (m_top + nb > ScratchChunkBytes)
+			{
+				if (++m_cur == m_chunks.size()) add_chunk();
+				m_top = 0;
+			}
+
+			void *p = m_chunks[m_cur] + m_top;
+			m_top += nb;
+			++m_nlive;
+			return p;
+		}
+
+		/**
+		 * Releases a block obtained from allocate(nbytes). The space
+		 * is reclaimed immediately if it is the most recent one,
+		 * and otherwise when the arena is rewound.
+		 */
+		void release(void *p, size_t nbytes)
+		{
+			const size_t nb = round_size(nbytes);
+
+			if (static_cast<char*>(p) + nb == m_chunks[m_cur] + m_top)
+			{
+				m_top -= nb;
+			}
+
+			if (--m_nlive == 0)
+			{
+				m_cur = 0;
+				m_top = 0;
+			}
+		}
+
+		marker mark() const
+		{
+			marker mk;
+			mk.chunk = m_cur;
+			mk.top = m_top;
+			mk.nlive = m_nlive;
+			return mk;
+		}
+
+		/**
+		 * Discards everything allocated since mk was taken
+		 */
+		void rewind(const marker& mk)
+		{
+			m_cur = mk.chunk;
+			m_top = mk.top;
+			m_nlive = mk.nlive;
+		}
+
+		/**
+		 * Returns the chunks that are currently unused to the system
+		 * (not to be called within a scratch_scope)
+		 */
+		void trim()
+		{
+			const size_t nkeep = m_nlive > 0 || m_top > 0 ? m_cur + 1 : 0;
+
+			for (size_t i = nkeep; i < m_chunks.size(); ++i) aligned_release(m_chunks[i]);
+			m_chunks.resize(nkeep);
+			if (nkeep == 0) m_cur = 0;
+		}
+
+	private:
+		static size_t round_size(size_t nbytes)
+		{
+			const size_t a = BCS_DEFAULT_ALIGNMENT;
+			return (nbytes + (a - 1)) & ~(a - 1);
+		}
+
+		void add_chunk()
+		{
+			m_chunks.push_back(static_cast<char*>(
+					aligned_allocate(ScratchChunkBytes, BCS_DEFAULT_ALIGNMENT)));
+			m_cur = m_chunks.size() - 1;
+		}
+
+	private:
+		std::vector<char*> m_chunks;
+		size_t m_cur;
+		size_t m_top;
+		size_t m_nlive;
+
+	}; // end class scratch_arena
+
+
+	/**
+	 * Rewinds the arena of the calling thread on exit, so that
+	 * the space left behind by out-of-order releases within the
+	 * scope is reclaimed.
+	 *
+	 * Note: everything drawn from the arena within the scope must
+	 * have been released before the scope exits.
+	 */
+	class scratch_scope : private noncopyable
+	{
+	public:
+		scratch_scope()
+		: m_arena(scratch_arena::local()), m_mark(m_arena.mark())
+		{
+		}
+
+		~scratch_scope()
+		{
+			m_arena.rewind(m_mark);
+		}
+
+	private:
+		scratch_arena& m_arena;
+		scratch_arena::marker m_mark;
+	};
+
+
+	/********************************************
+	 *
+	 *  scratch_allocator
+	 *
+	 *  It draws from the arena of the thread
+	 *  that constructs it. Hence, a container
+	 *  using it should stay within that thread.
+	 *
+	 ********************************************/
+
+    template<typename T>
+    class scratch_allocator
+    {
+    public:
+    	typedef T value_type;
+    	typedef T* pointer;
+    	typedef T& reference;
+    	typedef const T* const_pointer;
+    	typedef const T& const_reference;
+    	typedef size_t size_type;
+    	typedef ptrdiff_t difference_type;
+
+    	template<typename TOther>
+    	struct rebind
+    	{
+    		typedef scratch_allocator<TOther> other;
+    	};
+
+    public:
+    	scratch_allocator()
+    	: m_arena(&scratch_arena::local())
+    	{
+    	}
+
+    	scratch_allocator(const scratch_allocator& r)
+    	: m_arena(r.arena())
+    	{
+    	}
+
+    	scratch_allocator& operator = (const scratch_allocator& r)
+    	{
+    		m_arena = r.arena();
+    		return *this;
+    	}
+
+    	template<typename U>
+    	scratch_allocator(const scratch_allocator<U>& r)
+    	: m_arena(r.arena())
+    	{
+    	}
+
+    	scratch_arena *arena() const
+    	{
+    		return m_arena;
+    	}
+
+    	pointer address( reference x ) const
+    	{
+    		return &x;
+    	}
+
+    	const_pointer address( const_reference x ) const
+    	{
+    		return &x;
+    	}
+
+    	size_type max_size() const
+    	{
+    		return std::numeric_limits<size_type>::max() / sizeof(value_type);
+    	}
+
+    	pointer allocate(size_type n, const void* hint=0)
+    	{
+    		const size_t nbytes = n * sizeof(value_type);
+    		return static_cast<pointer>(scratch_arena::accepts(nbytes) ?
+    				m_arena->allocate(nbytes) :
+    				aligned_allocate(nbytes, BCS_DEFAULT_ALIGNMENT));
+    	}
+
+    	void deallocate(pointer p, size_type n)
+    	{
+    		const size_t nbytes = n * sizeof(value_type);
+    		if (scratch_arena::accepts(nbytes))
+    			m_arena->release(p, nbytes);
+    		else
+    			aligned_release(p);
+    	}
+
+    	void construct (pointer p, const_reference val)
+    	{
+    		new (p) value_type(val);
+    	}
+
+    	void destroy (pointer p)
+    	{
+    		p->~value_type();
+    	}
+
+    private:
+    	scratch_arena *m_arena;
+
+    }; // end class scratch_allocator
+
+}
+
+#endif
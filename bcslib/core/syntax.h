@@ -33,6 +33,12 @@
 #define __restrict__ __restrict
 #endif
 
+#if BCS_PLATFORM_INTERFACE == BCS_WINDOWS_INTERFACE
+#define BCS_NOEXCEPT throw()
+#elif BCS_PLATFORM_INTERFACE == BCS_POSIX_INTERFACE
+#define BCS_NOEXCEPT noexcept
+#endif
+
 #define BCS_CRTP_REF \
 		BCS_ENSURE_INLINE const Derived& derived() const { return *(static_cast<const Derived*>(this)); } \
 		BCS_ENSURE_INLINE Derived& derived() { return *(static_cast<Derived*>(this)); }
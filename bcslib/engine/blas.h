@@ -14,10 +14,68 @@
 #define BCSLIB_BLAS_H_
 
 #include <bcslib/core/basic_defs.h>
-#include <bcslib/engine/blas_extern.h>
+#include <bcslib/engine/blas_backend.h>
+#include <bcslib/engine/small_blasL3.h>
+#include <bcslib/engine/small_blas_dispatch.h>
+#include <bcslib/engine/small_lapack.h>
+
+// the maximum compile-time dimension for which small kernels are used
+#ifndef BCS_SMALL_BLAS_MAX_CTDIM
+#define BCS_SMALL_BLAS_MAX_CTDIM 8
+#endif
+
+// the maximum number of multiply-adds for which runtime-size small kernels are used
+#ifndef BCS_SMALL_BLAS_MAX_RTOPS
+#define BCS_SMALL_BLAS_MAX_RTOPS 512
+#endif
 
 namespace bcs { namespace engine {
 
+	/********************************************
+	 *
+	 *  Small-size routing
+	 *
+	 *  Products whose dimensions are all fixed at
+	 *  compile-time and no larger than
+	 *  BCS_SMALL_BLAS_MAX_CTDIM are computed by
+	 *  the small kernels (small_blasL2/L3.h), and
+	 *  so are triangular solves (small_lapack.h).
+	 *
+	 *  Products with runtime dimensions all within
+	 *  [1, BCS_SMALL_BLAS_MAX_RTDIM] are dispatched
+	 *  to the same kernels through jump tables
+	 *  (small_blas_dispatch.h). Other ones that
+	 *  amount to no more than BCS_SMALL_BLAS_MAX_RTOPS
+	 *  multiply-adds are computed by the runtime-size
+	 *  small kernels, as the cost of calling external
+	 *  BLAS outweighs the computation. Everything
+	 *  else goes to the current BLAS backend
+	 *  (blas_backend.h).
+	 *
+	 ********************************************/
+
+	template<int M, int N, int K=1>
+	struct use_small_blas
+	{
+		static const bool value =
+				M > 0 && M <= BCS_SMALL_BLAS_MAX_CTDIM &&
+				N > 0 && N <= BCS_SMALL_BLAS_MAX_CTDIM &&
+				K > 0 && K <= BCS_SMALL_BLAS_MAX_CTDIM;
+	};
+
+	BCS_ENSURE_INLINE
+	inline bool use_small_blas_rt(const int m, const int n, const int k=1)
+	{
+		return m * n * k <= BCS_SMALL_BLAS_MAX_RTOPS;
+	}
+
+	BCS_ENSURE_INLINE
+	inline bool is_trans_flag(const char t)
+	{
+		return t != 'N' && t != 'n';
+	}
+
+
 	/********************************************
 	 *
 	 *  Level 1 functors
@@ -35,7 +93,7 @@ namespace bcs { namespace engine {
 		static double eval(const int n, const double *x)
 		{
 			const int incx = 1;
-			return BCS_DASUM(&n, x, &incx);
+			return backend::dasum(&n, x, &incx);
 		}
 	};
 
@@ -46,7 +104,7 @@ namespace bcs { namespace engine {
 		static float eval(const int n, const float *x)
 		{
 			const int incx = 1;
-			return BCS_SASUM(&n, x, &incx);
+			return backend::sasum(&n, x, &incx);
 		}
 	};
 
@@ -63,7 +121,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_DAXPY(&n, &a, x, &incx, y, &incy);
+			backend::daxpy(&n, &a, x, &incx, y, &incy);
 		}
 	};
 
@@ -76,7 +134,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_SAXPY(&n, &a, x, &incx, y, &incy);
+			backend::saxpy(&n, &a, x, &incx, y, &incy);
 		}
 	};
 
@@ -93,7 +151,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			return BCS_DDOT(&n, x, &incx, y, &incy);
+			return backend::ddot(&n, x, &incx, y, &incy);
 		}
 	};
 
@@ -106,7 +164,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			return BCS_SDOT(&n, x, &incx, y, &incy);
+			return backend::sdot(&n, x, &incx, y, &incy);
 		}
 	};
 
@@ -121,7 +179,7 @@ namespace bcs { namespace engine {
 		static double eval(const int n, const double *x)
 		{
 			const int incx = 1;
-			return BCS_DNRM2(&n, x, &incx);
+			return backend::dnrm2(&n, x, &incx);
 		}
 	};
 
@@ -132,7 +190,7 @@ namespace bcs { namespace engine {
 		static float eval(const int n, const float *x)
 		{
 			const int incx = 1;
-			return BCS_SNRM2(&n, x, &incx);
+			return backend::snrm2(&n, x, &incx);
 		}
 	};
 
@@ -149,7 +207,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_DROT(&n, x, &incx, y, &incy, &c, &s);
+			backend::drot(&n, x, &incx, y, &incy, &c, &s);
 		}
 	};
 
@@ -162,7 +220,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_SROT(&n, x, &incx, y, &incy, &c, &s);
+			backend::srot(&n, x, &incx, y, &incy, &c, &s);
 		}
 	};
 
@@ -173,99 +231,158 @@ namespace bcs { namespace engine {
 	 *
 	 ********************************************/
 
-	// gemv
+	// extern_gemv & extern_ger: call the BLAS backend
 
-	template<typename T, int M, int N> struct gemv;
-	template<typename T, int M, int N> struct gemv_ex;
+	template<typename T> struct extern_gemv;
 
-	template<int M, int N>
-	struct gemv<double, M, N>
+	template<>
+	struct extern_gemv<double>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(char trans, const int m, const int n,
-				const double alpha, const double *a, const int lda, const double *x,
-				const double beta, double *y)
+				const double alpha, const double *a, const int lda, const double *x, const int incx,
+				const double beta, double *y, const int incy)
 		{
-			const int incx = 1;
-			const int incy = 1;
-
-			BCS_DGEMV(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			backend::dgemv(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
 		}
 	};
 
-	template<int M, int N>
-	struct gemv<float, M, N>
+	template<>
+	struct extern_gemv<float>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(char trans, const int m, const int n,
-				const float alpha, const float *a, int lda, const float *x,
-				const float beta, float *y)
+				const float alpha, const float *a, const int lda, const float *x, const int incx,
+				const float beta, float *y, const int incy)
 		{
-			const int incx = 1;
-			const int incy = 1;
+			backend::sgemv(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+		}
+	};
+
+	template<typename T> struct extern_ger;
 
-			BCS_SGEMV(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+	template<>
+	struct extern_ger<double>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const int m, const int n,
+				const double alpha, const double *x, const int incx, const double *y, const int incy,
+				double *a, const int lda)
+		{
+			backend::dger(&m, &n, &alpha, x, &incx, y, &incy, a, &lda);
 		}
 	};
 
-	template<int M, int N>
-	struct gemv_ex<double, M, N>
+	template<>
+	struct extern_ger<float>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const int m, const int n,
+				const float alpha, const float *x, const int incx, const float *y, const int incy,
+				float *a, const int lda)
+		{
+			backend::sger(&m, &n, &alpha, x, &incx, y, &incy, a, &lda);
+		}
+	};
+
+
+	// gemv_ex
+
+	template<typename T, int M, int N, bool IsSmall=use_small_blas<M, N>::value>
+	struct gemv_ex
 	{
 		BCS_ENSURE_INLINE
 		static void eval(char trans, const int m, const int n,
-				const double alpha, const double *a, const int lda, const double *x, const int incx,
-				const double beta, double *y, const int incy)
+				const T alpha, const T *a, const int lda, const T *x, const int incx,
+				const T beta, T *y, const int incy)
 		{
-			BCS_DGEMV(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			if (in_small_dispatch_range(m, n))
+			{
+				detail::note_small_blas_call<T>(BLAS_GEMV);
+				small_gemv_dispatch<T>::eval(is_trans_flag(trans), m, n, alpha, a, lda, x, incx, beta, y, incy);
+			}
+			else if (use_small_blas_rt(m, n))
+			{
+				detail::note_small_blas_call<T>(BLAS_GEMV);
+				if (is_trans_flag(trans))
+					small_gemv_rt<T>::eval_t(m, n, alpha, a, lda, x, incx, beta, y, incy);
+				else
+					small_gemv_rt<T>::eval_n(m, n, alpha, a, lda, x, incx, beta, y, incy);
+			}
+			else
+			{
+				extern_gemv<T>::eval(trans, m, n, alpha, a, lda, x, incx, beta, y, incy);
+			}
 		}
 	};
 
-	template<int M, int N>
-	struct gemv_ex<float, M, N>
+	template<typename T, int M, int N>
+	struct gemv_ex<T, M, N, true>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(char trans, const int m, const int n,
-				const float alpha, const float *a, int lda, const float *x, const int incx,
-				const float beta, float *y, const int incy)
+				const T alpha, const T *a, const int lda, const T *x, const int incx,
+				const T beta, T *y, const int incy)
 		{
-			BCS_SGEMV(&trans, &m, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			if (is_trans_flag(trans))
+				small_gemv_t<T, M, N>::eval(alpha, a, lda, x, incx, beta, y, incy);
+			else
+				small_gemv_n<T, M, N>::eval(alpha, a, lda, x, incx, beta, y, incy);
 		}
 	};
 
 
+	// gemv
 
-	// ger
+	template<typename T, int M, int N>
+	struct gemv
+	{
+		BCS_ENSURE_INLINE
+		static void eval(char trans, const int m, const int n,
+				const T alpha, const T *a, const int lda, const T *x,
+				const T beta, T *y)
+		{
+			gemv_ex<T, M, N>::eval(trans, m, n, alpha, a, lda, x, 1, beta, y, 1);
+		}
+	};
 
-	template<typename T, int M, int N> struct ger;
 
-	template<int M, int N>
-	struct ger<double, M, N>
+	// ger
+
+	template<typename T, int M, int N, bool IsSmall=use_small_blas<M, N>::value>
+	struct ger
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const int m, const int n,
-				const double alpha, const double *x, const double *y,
-				double *a, const int lda)
+				const T alpha, const T *x, const T *y,
+				T *a, const int lda)
 		{
-			const int incx = 1;
-			const int incy = 1;
-
-			BCS_DGER(&m, &n, &alpha, x, &incx, y, &incy, a, &lda);
+			if (in_small_dispatch_range(m, n))
+			{
+				detail::note_small_blas_call<T>(BLAS_GER);
+				small_ger_dispatch<T>::eval(m, n, alpha, x, 1, y, 1, a, lda);
+			}
+			else if (use_small_blas_rt(m, n))
+			{
+				detail::note_small_blas_call<T>(BLAS_GER);
+				small_ger_rt<T>::eval(m, n, alpha, x, 1, y, 1, a, lda);
+			}
+			else
+			{
+				extern_ger<T>::eval(m, n, alpha, x, 1, y, 1, a, lda);
+			}
 		}
 	};
 
-
-	template<int M, int N>
-	struct ger<float, M, N>
+	template<typename T, int M, int N>
+	struct ger<T, M, N, true>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const int m, const int n,
-				const float alpha, const float *x, const float *y,
-				float *a, const int lda)
+				const T alpha, const T *x, const T *y,
+				T *a, const int lda)
 		{
-			const int incx = 1;
-			const int incy = 1;
-
-			BCS_SGER(&m, &n, &alpha, x, &incx, y, &incy, a, &lda);
+			small_ger<T, M, N>::eval(alpha, x, 1, y, 1, a, lda);
 		}
 	};
 
@@ -285,7 +402,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_DSYMV(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			backend::dsymv(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
 		}
 	};
 
@@ -301,7 +418,7 @@ namespace bcs { namespace engine {
 			const int incx = 1;
 			const int incy = 1;
 
-			BCS_SSYMV(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			backend::ssymv(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
 		}
 	};
 
@@ -318,7 +435,7 @@ namespace bcs { namespace engine {
 				const double alpha, const double *a, const int lda, const double *x, const int incx,
 				const double beta, double *y, const int incy)
 		{
-			BCS_DSYMV(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			backend::dsymv(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
 		}
 	};
 
@@ -330,7 +447,7 @@ namespace bcs { namespace engine {
 				const float alpha, const float *a, const int lda, const float *x, const int incx,
 				const float beta, float *y, const int incy)
 		{
-			BCS_SSYMV(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
+			backend::ssymv(&uplo, &n, &alpha, a, &lda, x, &incx, &beta, y, &incy);
 		}
 	};
 
@@ -348,7 +465,7 @@ namespace bcs { namespace engine {
 				const double *a, const int lda, double *b)
 		{
 			const int incx = 1;
-			BCS_DTRMV(&uplo, &transa, &diag, &n, a, &lda, b, &incx);
+			backend::dtrmv(&uplo, &transa, &diag, &n, a, &lda, b, &incx);
 		}
 	};
 
@@ -360,37 +477,48 @@ namespace bcs { namespace engine {
 				const float *a, const int lda, float *b)
 		{
 			const int incx = 1;
-			BCS_STRMV(&uplo, &transa, &diag, &n, a, &lda, b, &incx);
+			backend::strmv(&uplo, &transa, &diag, &n, a, &lda, b, &incx);
 		}
 	};
 
 
 	// trsv
 
-	template<typename T, int N> struct trsv;
+	template<typename T, int N, bool IsSmall=use_small_blas<N, N>::value> struct trsv;
+
+	template<typename T, int N>
+	struct trsv<T, N, true>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const char uplo, const char trans, const char diag, int n,
+				const T *a, const int lda, T *x)
+		{
+			small_trsv<T, N>::eval(uplo, trans, diag, a, lda, x);
+		}
+	};
 
 	template<int N>
-	struct trsv<double, N>
+	struct trsv<double, N, false>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const char uplo, const char trans, const char diag, int n,
 				const double *a, const int lda, double *x)
 		{
 			const int incx = 1;
-			BCS_DTRSV(&uplo, &trans, &diag, &n, a, &lda, x, &incx);
+			backend::dtrsv(&uplo, &trans, &diag, &n, a, &lda, x, &incx);
 		}
 	};
 
 
 	template<int N>
-	struct trsv<float, N>
+	struct trsv<float, N, false>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const char uplo, const char trans, const char diag, int n,
 				const float *a, const int lda, float *x)
 		{
 			const int incx = 1;
-			BCS_STRSV(&uplo, &trans, &diag, &n, a, &lda, x, &incx);
+			backend::strsv(&uplo, &trans, &diag, &n, a, &lda, x, &incx);
 		}
 	};
 
@@ -401,12 +529,12 @@ namespace bcs { namespace engine {
 	 *
 	 ********************************************/
 
-	// gemm
+	// extern_gemm: call the BLAS backend
 
-	template<typename T, int M, int N, int K> struct gemm;
+	template<typename T> struct extern_gemm;
 
-	template<int M, int N, int K>
-	struct gemm<double, M, N, K>
+	template<>
+	struct extern_gemm<double>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const char transa, const char transb,
@@ -414,12 +542,12 @@ namespace bcs { namespace engine {
 				const double alpha, const double *a, const int lda, const double *b, const int ldb,
 				const double beta, double *c, const int ldc)
 		{
-			BCS_DGEMM(&transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+			backend::dgemm(&transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
 		}
 	};
 
-	template<int M, int N, int K>
-	struct gemm<float, M, N, K>
+	template<>
+	struct extern_gemm<float>
 	{
 		BCS_ENSURE_INLINE
 		static void eval(const char transa, const char transb,
@@ -427,7 +555,80 @@ namespace bcs { namespace engine {
 				const float alpha, const float *a, const int lda, const float *b, const int ldb,
 				const float beta, float *c, const int ldc)
 		{
-			BCS_SGEMM(&transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+			backend::sgemm(&transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+		}
+	};
+
+
+	// gemm
+
+	template<typename T, int M, int N, int K, bool IsSmall=use_small_blas<M, N, K>::value>
+	struct gemm
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const char transa, const char transb,
+				const int m, const int n, const int k,
+				const T alpha, const T *a, const int lda, const T *b, const int ldb,
+				const T beta, T *c, const int ldc)
+		{
+			if (in_small_dispatch_range(m, n, k))
+			{
+				detail::note_small_blas_call<T>(BLAS_GEMM);
+				small_gemm_dispatch<T>::eval(is_trans_flag(transa), is_trans_flag(transb), m, n, k,
+						alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+			else if (use_small_blas_rt(m, n, k))
+			{
+				detail::note_small_blas_call<T>(BLAS_GEMM);
+				typedef small_gemm_rt<T> ker_t;
+
+				if (is_trans_flag(transa))
+				{
+					if (is_trans_flag(transb))
+						ker_t::eval_tt(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+					else
+						ker_t::eval_tn(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+				}
+				else
+				{
+					if (is_trans_flag(transb))
+						ker_t::eval_nt(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+					else
+						ker_t::eval_nn(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+				}
+			}
+			else
+			{
+				extern_gemm<T>::eval(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+		}
+	};
+
+	template<typename T, int M, int N, int K>
+	struct gemm<T, M, N, K, true>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const char transa, const char transb,
+				const int m, const int n, const int k,
+				const T alpha, const T *a, const int lda, const T *b, const int ldb,
+				const T beta, T *c, const int ldc)
+		{
+			typedef small_gemm<T, M, N, K> ker_t;
+
+			if (is_trans_flag(transa))
+			{
+				if (is_trans_flag(transb))
+					ker_t::eval_tt(alpha, a, lda, b, ldb, beta, c, ldc);
+				else
+					ker_t::eval_tn(alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+			else
+			{
+				if (is_trans_flag(transb))
+					ker_t::eval_nt(alpha, a, lda, b, ldb, beta, c, ldc);
+				else
+					ker_t::eval_nn(alpha, a, lda, b, ldb, beta, c, ldc);
+			}
 		}
 	};
 
@@ -444,7 +645,7 @@ namespace bcs { namespace engine {
 				const double alpha, const double *a, const int lda, const double *b, const int ldb,
 				const double beta, double *c, const int ldc)
 		{
-			BCS_DSYMM(&side, &uplo, &m, &n, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+			backend::dsymm(&side, &uplo, &m, &n, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
 		}
 	};
 
@@ -456,7 +657,35 @@ namespace bcs { namespace engine {
 				const float alpha, const float *a, const int lda, const float *b, const int ldb,
 				const float beta, float *c, const int ldc)
 		{
-			BCS_SSYMM(&side, &uplo, &m, &n, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+			backend::ssymm(&side, &uplo, &m, &n, &alpha, a, &lda, b, &ldb, &beta, c, &ldc);
+		}
+	};
+
+	// syrk
+
+	template<typename T, int N, int K> struct syrk;
+
+	template<int N, int K>
+	struct syrk<double, N, K>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const char uplo, const char trans, const int n, const int k,
+				const double alpha, const double *a, const int lda,
+				const double beta, double *c, const int ldc)
+		{
+			backend::dsyrk(&uplo, &trans, &n, &k, &alpha, a, &lda, &beta, c, &ldc);
+		}
+	};
+
+	template<int N, int K>
+	struct syrk<float, N, K>
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const char uplo, const char trans, const int n, const int k,
+				const float alpha, const float *a, const int lda,
+				const float beta, float *c, const int ldc)
+		{
+			backend::ssyrk(&uplo, &trans, &n, &k, &alpha, a, &lda, &beta, c, &ldc);
 		}
 	};
 
@@ -473,7 +702,7 @@ namespace bcs { namespace engine {
 				const double alpha, const double *a, const int lda,
 				const double beta, double *b, const int ldb)
 		{
-			BCS_DTRMM(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
+			backend::dtrmm(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
 		}
 	};
 
@@ -486,7 +715,7 @@ namespace bcs { namespace engine {
 				const float alpha, const float *a, const int lda,
 				const float beta, float *b, const int ldb)
 		{
-			BCS_STRMM(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
+			backend::strmm(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
 		}
 	};
 
@@ -503,7 +732,7 @@ namespace bcs { namespace engine {
 				const double alpha, const double *a, const int lda,
 				const double beta, double *b, const int ldb)
 		{
-			BCS_DTRSM(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
+			backend::dtrsm(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
 		}
 	};
 
@@ -516,7 +745,7 @@ namespace bcs { namespace engine {
 				const float alpha, const float *a, const int lda,
 				const float beta, float *b, const int ldb)
 		{
-			BCS_STRSM(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
+			backend::strsm(&side, &uplo, &transa, &diag, &m, &n, &alpha, a, &lda, b, &ldb);
 		}
 	};
 
@@ -0,0 +1,794 @@
+/**
+ * @file blas_backend.h
+ *
+ * Runtime-selectable BLAS backends, with per-routine profiling
+ *
+ * All calls that leave the library for BLAS go through a backend,
+ * i.e. a table of function pointers with the (Fortran) interface of
+ * the routines declared in blas_extern.h. The built-in backends are
+ *
+ *  - "native": the built-in implementation (native_blas.h)
+ *  - "extern": the linked external BLAS (unless BCSLIB_USE_NATIVE_BLAS
+ *              is defined)
+ *
+ * and any other table (e.g. one filled from a reference BLAS build
+ * loaded at runtime) can be installed with set_blas_backend. The
+ * default one is taken from the environment variable BCS_BLAS_BACKEND,
+ * or otherwise "extern" when available.
+ *
+ * When profiling is enabled, every routine keeps the number of calls,
+ * the estimated numbers of floating point operations and bytes moved,
+ * and the time spent in the backend, as well as the number of calls
+ * that were taken by the runtime-size small kernels (see blas.h)
+ * instead of the backend.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_BLAS_BACKEND_H_
+#define BCSLIB_BLAS_BACKEND_H_
+
+#include <bcslib/engine/blas_extern.h>
+#include <bcslib/engine/native_blas.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#ifndef BCSLIB_NO_THREADS
+#include <atomic>
+#endif
+
+namespace bcs { namespace engine {
+
+	/********************************************
+	 *
+	 *  backend tables
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct blas_fn
+	{
+		// Level 1
+
+		typedef T (*asum_t)(const int *n, const T *x, const int *incx);
+		typedef void (*axpy_t)(const int *n, const T *alpha, const T *x, const int *incx, T *y, const int *incy);
+		typedef T (*dot_t)(const int *n, const T *x, const int *incx, const T *y, const int *incy);
+		typedef T (*nrm2_t)(const int *n, const T *x, const int *incx);
+		typedef void (*rot_t)(const int *n, T *x, const int *incx, T *y, const int *incy, const T *c, const T *s);
+
+		// Level 2
+
+		typedef void (*gemv_t)(const char *trans, const int *m, const int *n, const T *alpha,
+				const T *a, const int *lda, const T *x, const int *incx,
+				const T *beta, T *y, const int *incy);
+
+		typedef void (*ger_t)(const int *m, const int *n, const T *alpha, const T *x, const int *incx,
+				const T *y, const int *incy, T *a, const int *lda);
+
+		typedef void (*symv_t)(const char *uplo, const int *n, const T *alpha, const T *a, const int *lda,
+				const T *x, const int *incx, const T *beta, T *y, const int *incy);
+
+		typedef void (*trmv_t)(const char *uplo, const char *transa, const char *diag, const int *n,
+				const T *a, const int *lda, T *b, const int *incx);
+
+		typedef void (*trsv_t)(const char *uplo, const char *trans, const char *diag, const int *n,
+				const T *a, const int *lda, T *x, const int *incx);
+
+		// Level 3
+
+		typedef void (*gemm_t)(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+				const T *alpha, const T *a, const int *lda, const T *b, const int *ldb,
+				const T *beta, T *c, const int *ldc);
+
+		typedef void (*symm_t)(const char *side, const char *uplo, const int *m, const int *n,
+				const T *alpha, const T *a, const int *lda, const T *b, const int *ldb,
+				const T *beta, T *c, const int *ldc);
+
+		typedef void (*syrk_t)(const char *uplo, const char *trans, const int *n, const int *k,
+				const T *alpha, const T *a, const int *lda, const T *beta, T *c, const int *ldc);
+
+		typedef void (*trmm_t)(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const T *alpha, const T *a, const int *lda,
+				T *b, const int *ldb);
+
+		typedef void (*trsm_t)(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const T *alpha, const T *a, const int *lda,
+				T *b, const int *ldb);
+	};
+
+
+	struct blas_backend
+	{
+		const char *name;
+
+		blas_fn<float>::asum_t sasum;
+		blas_fn<float>::axpy_t saxpy;
+		blas_fn<float>::dot_t  sdot;
+		blas_fn<float>::nrm2_t snrm2;
+		blas_fn<float>::rot_t  srot;
+
+		blas_fn<float>::gemv_t sgemv;
+		blas_fn<float>::ger_t  sger;
+		blas_fn<float>::symv_t ssymv;
+		blas_fn<float>::trmv_t strmv;
+		blas_fn<float>::trsv_t strsv;
+
+		blas_fn<float>::gemm_t sgemm;
+		blas_fn<float>::symm_t ssymm;
+		blas_fn<float>::syrk_t ssyrk;
+		blas_fn<float>::trmm_t strmm;
+		blas_fn<float>::trsm_t strsm;
+
+		blas_fn<double>::asum_t dasum;
+		blas_fn<double>::axpy_t daxpy;
+		blas_fn<double>::dot_t  ddot;
+		blas_fn<double>::nrm2_t dnrm2;
+		blas_fn<double>::rot_t  drot;
+
+		blas_fn<double>::gemv_t dgemv;
+		blas_fn<double>::ger_t  dger;
+		blas_fn<double>::symv_t dsymv;
+		blas_fn<double>::trmv_t dtrmv;
+		blas_fn<double>::trsv_t dtrsv;
+
+		blas_fn<double>::gemm_t dgemm;
+		blas_fn<double>::symm_t dsymm;
+		blas_fn<double>::syrk_t dsyrk;
+		blas_fn<double>::trmm_t dtrmm;
+		blas_fn<double>::trsm_t dtrsm;
+	};
+
+
+	inline const blas_backend& native_blas_backend()
+	{
+		static const blas_backend b =
+		{
+			"native",
+
+			native::sasum, native::saxpy, native::sdot, native::snrm2, native::srot,
+			native::sgemv, native::sger, native::ssymv, native::strmv, native::strsv,
+			native::sgemm, native::ssymm, native::ssyrk, native::strmm, native::strsm,
+
+			native::dasum, native::daxpy, native::ddot, native::dnrm2, native::drot,
+			native::dgemv, native::dger, native::dsymv, native::dtrmv, native::dtrsv,
+			native::dgemm, native::dsymm, native::dsyrk, native::dtrmm, native::dtrsm
+		};
+		return b;
+	}
+
+#ifndef BCSLIB_USE_NATIVE_BLAS
+
+	inline const blas_backend& extern_blas_backend()
+	{
+		static const blas_backend b =
+		{
+			"extern",
+
+			BCS_SASUM, BCS_SAXPY, BCS_SDOT, BCS_SNRM2, BCS_SROT,
+			BCS_SGEMV, BCS_SGER, BCS_SSYMV, BCS_STRMV, BCS_STRSV,
+			BCS_SGEMM, BCS_SSYMM, BCS_SSYRK, BCS_STRMM, BCS_STRSM,
+
+			BCS_DASUM, BCS_DAXPY, BCS_DDOT, BCS_DNRM2, BCS_DROT,
+			BCS_DGEMV, BCS_DGER, BCS_DSYMV, BCS_DTRMV, BCS_DTRSV,
+			BCS_DGEMM, BCS_DSYMM, BCS_DSYRK, BCS_DTRMM, BCS_DTRSM
+		};
+		return b;
+	}
+
+#endif
+
+	/**
+	 * Returns the built-in backend of the given name ("native" or
+	 * "extern"), or null if there is no such backend in this build
+	 */
+	inline const blas_backend* find_blas_backend(const char *name)
+	{
+		if (std::strcmp(name, "native") == 0) return &native_blas_backend();
+#ifndef BCSLIB_USE_NATIVE_BLAS
+		if (std::strcmp(name, "extern") == 0) return &extern_blas_backend();
+#endif
+		return BCS_NULL;
+	}
+
+	namespace detail
+	{
+		inline const blas_backend& default_blas_backend()
+		{
+			const char *s = std::getenv("BCS_BLAS_BACKEND");
+			const blas_backend *b = s ? find_blas_backend(s) : BCS_NULL;
+			if (b) return *b;
+
+#ifndef BCSLIB_USE_NATIVE_BLAS
+			return extern_blas_backend();
+#else
+			return native_blas_backend();
+#endif
+		}
+
+		inline const blas_backend*& cur_blas_backend()
+		{
+			static const blas_backend *b = &default_blas_backend();
+			return b;
+		}
+	}
+
+	/**
+	 * Returns the backend to which BLAS calls currently go
+	 */
+	inline const blas_backend& get_blas_backend()
+	{
+		return *detail::cur_blas_backend();
+	}
+
+	/**
+	 * Sets the backend to which BLAS calls go (null restores the default).
+	 * The table must stay alive while it is in use.
+	 *
+	 * Note: this should not be called while a BLAS call is in progress.
+	 */
+	inline void set_blas_backend(const blas_backend *b)
+	{
+		detail::cur_blas_backend() = b ? b : &detail::default_blas_backend();
+	}
+
+	/**
+	 * Whether gemm on T currently goes to native_gemm (in which case
+	 * the operands may also be given to native_gemm by packers)
+	 */
+	template<typename T> inline bool gemm_is_native();
+
+	template<>
+	inline bool gemm_is_native<double>()
+	{
+		return get_blas_backend().dgemm == &native::dgemm;
+	}
+
+	template<>
+	inline bool gemm_is_native<float>()
+	{
+		return get_blas_backend().sgemm == &native::sgemm;
+	}
+
+
+	/********************************************
+	 *
+	 *  profiling counters
+	 *
+	 ********************************************/
+
+	enum blas_routine
+	{
+		BLAS_ASUM = 0,
+		BLAS_AXPY,
+		BLAS_DOT,
+		BLAS_NRM2,
+		BLAS_ROT,
+		BLAS_GEMV,
+		BLAS_GER,
+		BLAS_SYMV,
+		BLAS_TRMV,
+		BLAS_TRSV,
+		BLAS_GEMM,
+		BLAS_SYMM,
+		BLAS_SYRK,
+		BLAS_TRMM,
+		BLAS_TRSM,
+		NUM_BLAS_ROUTINES
+	};
+
+	inline const char* blas_routine_name(const blas_routine r)
+	{
+		static const char *names[NUM_BLAS_ROUTINES] =
+		{
+			"asum", "axpy", "dot", "nrm2", "rot",
+			"gemv", "ger", "symv", "trmv", "trsv",
+			"gemm", "symm", "syrk", "trmm", "trsm"
+		};
+		return names[r];
+	}
+
+	struct blas_stats
+	{
+		int64_t calls;			// calls that went to the backend
+		int64_t small_calls;	// calls taken by the runtime-size small kernels
+		int64_t flops;			// estimated floating point operations (backend calls)
+		int64_t bytes;			// estimated bytes moved (backend calls)
+		double secs;			// time spent in the backend
+	};
+
+	namespace detail
+	{
+#ifndef BCSLIB_NO_THREADS
+		typedef std::atomic<int64_t> blas_counter_t;
+
+		BCS_ENSURE_INLINE
+		inline void blas_count(blas_counter_t& c, const int64_t v)
+		{
+			c.fetch_add(v, std::memory_order_relaxed);
+		}
+
+		typedef std::atomic<bool> blas_flag_t;
+
+		BCS_ENSURE_INLINE
+		inline bool blas_flag_get(const blas_flag_t& f)
+		{
+			return f.load(std::memory_order_relaxed);
+		}
+
+		BCS_ENSURE_INLINE
+		inline void blas_flag_set(blas_flag_t& f, const bool v)
+		{
+			f.store(v, std::memory_order_relaxed);
+		}
+#else
+		typedef int64_t blas_counter_t;
+
+		BCS_ENSURE_INLINE
+		inline void blas_count(blas_counter_t& c, const int64_t v)
+		{
+			c += v;
+		}
+
+		typedef bool blas_flag_t;
+
+		BCS_ENSURE_INLINE
+		inline bool blas_flag_get(const blas_flag_t& f)
+		{
+			return f;
+		}
+
+		BCS_ENSURE_INLINE
+		inline void blas_flag_set(blas_flag_t& f, const bool v)
+		{
+			f = v;
+		}
+#endif
+
+		struct blas_counters
+		{
+			blas_counter_t calls;
+			blas_counter_t small_calls;
+			blas_counter_t flops;
+			blas_counter_t bytes;
+			blas_counter_t nsecs;
+		};
+
+		// static members of a class template, such that they are
+		// statically initialized, and defined in headers only
+
+		template<int D>
+		struct blas_profile_state
+		{
+			static blas_flag_t enabled;
+			static blas_counters counters[2][NUM_BLAS_ROUTINES];
+		};
+
+		template<int D> blas_flag_t blas_profile_state<D>::enabled(false);
+		template<int D> blas_counters blas_profile_state<D>::counters[2][NUM_BLAS_ROUTINES];
+
+		typedef blas_profile_state<0> blas_profile;
+
+		template<typename T> struct blas_type_index;
+		template<> struct blas_type_index<float>  { static const int value = 0; };
+		template<> struct blas_type_index<double> { static const int value = 1; };
+
+		// counts a backend call over its scope
+
+		template<typename T>
+		class blas_profile_scope : private noncopyable
+		{
+		public:
+			BCS_ENSURE_INLINE
+			blas_profile_scope(const blas_routine r, const int64_t flops, const int64_t elems)
+			: m_c(BCS_NULL)
+			{
+				if (blas_flag_get(blas_profile::enabled))
+				{
+					m_c = &blas_profile::counters[blas_type_index<T>::value][r];
+					blas_count(m_c->calls, 1);
+					blas_count(m_c->flops, flops);
+					blas_count(m_c->bytes, elems * (int64_t)sizeof(T));
+					m_t0 = std::chrono::steady_clock::now();
+				}
+			}
+
+			BCS_ENSURE_INLINE
+			~blas_profile_scope()
+			{
+				if (m_c)
+				{
+					const std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - m_t0;
+					blas_count(m_c->nsecs, (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+				}
+			}
+
+		private:
+			blas_counters *m_c;
+			std::chrono::steady_clock::time_point m_t0;
+		};
+
+		// counts a call taken by the runtime-size small kernels
+
+		template<typename T>
+		BCS_ENSURE_INLINE
+		inline void note_small_blas_call(const blas_routine r)
+		{
+			if (blas_flag_get(blas_profile::enabled))
+			{
+				blas_count(blas_profile::counters[blas_type_index<T>::value][r].small_calls, 1);
+			}
+		}
+
+		// the estimated numbers of elements moved
+
+		inline int64_t blas_tri_elems(const int n)
+		{
+			return (int64_t)n * (n + 1) / 2;
+		}
+
+		inline int64_t blas_gemv_elems(const char *trans, const int m, const int n)
+		{
+			// a and x are read, and y is read and written
+			const bool tr = (*trans != 'N' && *trans != 'n');
+			return (int64_t)m * n + (tr ? m : n) + 2 * (int64_t)(tr ? n : m);
+		}
+
+		// the order of the triangular / symmetric operand
+		inline int blas_side_order(const char *side, const int m, const int n)
+		{
+			return (*side == 'L' || *side == 'l') ? m : n;
+		}
+	}
+
+	inline bool blas_profiling_enabled()
+	{
+		return detail::blas_flag_get(detail::blas_profile::enabled);
+	}
+
+	/**
+	 * Enables or disables the BLAS profiling counters (disabled by default).
+	 * The counters are kept when profiling is disabled.
+	 */
+	inline void enable_blas_profiling(bool on=true)
+	{
+		detail::blas_flag_set(detail::blas_profile::enabled, on);
+	}
+
+	inline void reset_blas_profile()
+	{
+		for (int t = 0; t < 2; ++t)
+		{
+			for (int r = 0; r < NUM_BLAS_ROUTINES; ++r)
+			{
+				detail::blas_counters& c = detail::blas_profile::counters[t][r];
+				c.calls = 0;
+				c.small_calls = 0;
+				c.flops = 0;
+				c.bytes = 0;
+				c.nsecs = 0;
+			}
+		}
+	}
+
+	template<typename T>
+	inline blas_stats get_blas_stats(const blas_routine r)
+	{
+		const detail::blas_counters& c = detail::blas_profile::counters[detail::blas_type_index<T>::value][r];
+
+		blas_stats s;
+		s.calls = c.calls;
+		s.small_calls = c.small_calls;
+		s.flops = c.flops;
+		s.bytes = c.bytes;
+		s.secs = double(int64_t(c.nsecs)) * 1.0e-9;
+		return s;
+	}
+
+	/**
+	 * Prints the counters of the routines that have been called, one per
+	 * line, ordered by the time spent in the backend
+	 */
+	inline void dump_blas_profile(std::FILE *fp = stdout)
+	{
+		const int nr = 2 * NUM_BLAS_ROUTINES;
+		blas_stats st[nr];
+		int order[nr];
+		int n = 0;
+
+		for (int r = 0; r < NUM_BLAS_ROUTINES; ++r)
+		{
+			st[2 * r] = get_blas_stats<float>((blas_routine)r);
+			st[2 * r + 1] = get_blas_stats<double>((blas_routine)r);
+		}
+
+		for (int i = 0; i < nr; ++i)
+		{
+			if (st[i].calls > 0 || st[i].small_calls > 0)
+			{
+				int j = n++;
+				for (; j > 0 && st[order[j - 1]].secs < st[i].secs; --j) order[j] = order[j - 1];
+				order[j] = i;
+			}
+		}
+
+		std::fprintf(fp, "BLAS profile (backend: %s)\n", get_blas_backend().name);
+		std::fprintf(fp, "%-8s %12s %12s %12s %12s %12s %10s\n",
+				"routine", "calls", "small calls", "MFlop", "MB", "time (ms)", "GFlop/s");
+
+		for (int u = 0; u < n; ++u)
+		{
+			const int i = order[u];
+			const blas_stats& s = st[i];
+
+			char name[8];
+			std::sprintf(name, "%c%s", (i % 2 ? 'd' : 's'), blas_routine_name((blas_routine)(i / 2)));
+
+			std::fprintf(fp, "%-8s %12ld %12ld %12.3f %12.3f %12.3f %10.3f\n", name,
+					(long)s.calls, (long)s.small_calls,
+					double(s.flops) * 1.0e-6, double(s.bytes) * 1.0e-6, s.secs * 1.0e3,
+					s.secs > 0 ? double(s.flops) * 1.0e-9 / s.secs : 0.0);
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  profiled calls to the current backend
+	 *
+	 ********************************************/
+
+	namespace backend
+	{
+		// Level 1
+
+		inline float sasum(const int *n, const float *x, const int *incx)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_ASUM, *n, *n);
+			return get_blas_backend().sasum(n, x, incx);
+		}
+
+		inline void saxpy(const int *n, const float *alpha, const float *x, const int *incx, float *y, const int *incy)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_AXPY, 2 * (int64_t)*n, 3 * (int64_t)*n);
+			get_blas_backend().saxpy(n, alpha, x, incx, y, incy);
+		}
+
+		inline float sdot(const int *n, const float *x, const int *incx, const float *y, const int *incy)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_DOT, 2 * (int64_t)*n, 2 * (int64_t)*n);
+			return get_blas_backend().sdot(n, x, incx, y, incy);
+		}
+
+		inline float snrm2(const int *n, const float *x, const int *incx)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_NRM2, 2 * (int64_t)*n, *n);
+			return get_blas_backend().snrm2(n, x, incx);
+		}
+
+		inline void srot(const int *n, float *x, const int *incx, float *y, const int *incy, const float *c, const float *s)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_ROT, 6 * (int64_t)*n, 4 * (int64_t)*n);
+			get_blas_backend().srot(n, x, incx, y, incy, c, s);
+		}
+
+		inline double dasum(const int *n, const double *x, const int *incx)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_ASUM, *n, *n);
+			return get_blas_backend().dasum(n, x, incx);
+		}
+
+		inline void daxpy(const int *n, const double *alpha, const double *x, const int *incx, double *y, const int *incy)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_AXPY, 2 * (int64_t)*n, 3 * (int64_t)*n);
+			get_blas_backend().daxpy(n, alpha, x, incx, y, incy);
+		}
+
+		inline double ddot(const int *n, const double *x, const int *incx, const double *y, const int *incy)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_DOT, 2 * (int64_t)*n, 2 * (int64_t)*n);
+			return get_blas_backend().ddot(n, x, incx, y, incy);
+		}
+
+		inline double dnrm2(const int *n, const double *x, const int *incx)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_NRM2, 2 * (int64_t)*n, *n);
+			return get_blas_backend().dnrm2(n, x, incx);
+		}
+
+		inline void drot(const int *n, double *x, const int *incx, double *y, const int *incy, const double *c, const double *s)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_ROT, 6 * (int64_t)*n, 4 * (int64_t)*n);
+			get_blas_backend().drot(n, x, incx, y, incy, c, s);
+		}
+
+		// Level 2
+
+		inline void sgemv(const char *trans, const int *m, const int *n, const float *alpha,
+				const float *a, const int *lda, const float *x, const int *incx,
+				const float *beta, float *y, const int *incy)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_GEMV,
+					2 * (int64_t)*m * *n, detail::blas_gemv_elems(trans, *m, *n));
+			get_blas_backend().sgemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy);
+		}
+
+		inline void sger(const int *m, const int *n, const float *alpha, const float *x, const int *incx,
+				const float *y, const int *incy, float *a, const int *lda)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_GER,
+					2 * (int64_t)*m * *n, 2 * (int64_t)*m * *n + *m + *n);
+			get_blas_backend().sger(m, n, alpha, x, incx, y, incy, a, lda);
+		}
+
+		inline void ssymv(const char *uplo, const int *n, const float *alpha, const float *a, const int *lda,
+				const float *x, const int *incx, const float *beta, float *y, const int *incy)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_SYMV,
+					2 * (int64_t)*n * *n, detail::blas_tri_elems(*n) + 3 * (int64_t)*n);
+			get_blas_backend().ssymv(uplo, n, alpha, a, lda, x, incx, beta, y, incy);
+		}
+
+		inline void strmv(const char *uplo, const char *transa, const char *diag, const int *n,
+				const float *a, const int *lda, float *b, const int *incx)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_TRMV,
+					(int64_t)*n * *n, detail::blas_tri_elems(*n) + 2 * (int64_t)*n);
+			get_blas_backend().strmv(uplo, transa, diag, n, a, lda, b, incx);
+		}
+
+		inline void strsv(const char *uplo, const char *trans, const char *diag, const int *n,
+				const float *a, const int *lda, float *x, const int *incx)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_TRSV,
+					(int64_t)*n * *n, detail::blas_tri_elems(*n) + 2 * (int64_t)*n);
+			get_blas_backend().strsv(uplo, trans, diag, n, a, lda, x, incx);
+		}
+
+		inline void dgemv(const char *trans, const int *m, const int *n, const double *alpha,
+				const double *a, const int *lda, const double *x, const int *incx,
+				const double *beta, double *y, const int *incy)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_GEMV,
+					2 * (int64_t)*m * *n, detail::blas_gemv_elems(trans, *m, *n));
+			get_blas_backend().dgemv(trans, m, n, alpha, a, lda, x, incx, beta, y, incy);
+		}
+
+		inline void dger(const int *m, const int *n, const double *alpha, const double *x, const int *incx,
+				const double *y, const int *incy, double *a, const int *lda)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_GER,
+					2 * (int64_t)*m * *n, 2 * (int64_t)*m * *n + *m + *n);
+			get_blas_backend().dger(m, n, alpha, x, incx, y, incy, a, lda);
+		}
+
+		inline void dsymv(const char *uplo, const int *n, const double *alpha, const double *a, const int *lda,
+				const double *x, const int *incx, const double *beta, double *y, const int *incy)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_SYMV,
+					2 * (int64_t)*n * *n, detail::blas_tri_elems(*n) + 3 * (int64_t)*n);
+			get_blas_backend().dsymv(uplo, n, alpha, a, lda, x, incx, beta, y, incy);
+		}
+
+		inline void dtrmv(const char *uplo, const char *transa, const char *diag, const int *n,
+				const double *a, const int *lda, double *b, const int *incx)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_TRMV,
+					(int64_t)*n * *n, detail::blas_tri_elems(*n) + 2 * (int64_t)*n);
+			get_blas_backend().dtrmv(uplo, transa, diag, n, a, lda, b, incx);
+		}
+
+		inline void dtrsv(const char *uplo, const char *trans, const char *diag, const int *n,
+				const double *a, const int *lda, double *x, const int *incx)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_TRSV,
+					(int64_t)*n * *n, detail::blas_tri_elems(*n) + 2 * (int64_t)*n);
+			get_blas_backend().dtrsv(uplo, trans, diag, n, a, lda, x, incx);
+		}
+
+		// Level 3
+
+		inline void sgemm(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+				const float *alpha, const float *a, const int *lda, const float *b, const int *ldb,
+				const float *beta, float *c, const int *ldc)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_GEMM,
+					2 * (int64_t)*m * *n * *k, (int64_t)*k * (*m + *n) + 2 * (int64_t)*m * *n);
+			get_blas_backend().sgemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		}
+
+		inline void ssymm(const char *side, const char *uplo, const int *m, const int *n,
+				const float *alpha, const float *a, const int *lda, const float *b, const int *ldb,
+				const float *beta, float *c, const int *ldc)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<float> ps(BLAS_SYMM,
+					2 * (int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 3 * (int64_t)*m * *n);
+			get_blas_backend().ssymm(side, uplo, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+		}
+
+		inline void ssyrk(const char *uplo, const char *trans, const int *n, const int *k,
+				const float *alpha, const float *a, const int *lda, const float *beta, float *c, const int *ldc)
+		{
+			detail::blas_profile_scope<float> ps(BLAS_SYRK,
+					(int64_t)*n * (*n + 1) * *k, (int64_t)*n * *k + 2 * detail::blas_tri_elems(*n));
+			get_blas_backend().ssyrk(uplo, trans, n, k, alpha, a, lda, beta, c, ldc);
+		}
+
+		inline void strmm(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const float *alpha, const float *a, const int *lda,
+				float *b, const int *ldb)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<float> ps(BLAS_TRMM,
+					(int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 2 * (int64_t)*m * *n);
+			get_blas_backend().strmm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+		}
+
+		inline void strsm(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const float *alpha, const float *a, const int *lda,
+				float *b, const int *ldb)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<float> ps(BLAS_TRSM,
+					(int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 2 * (int64_t)*m * *n);
+			get_blas_backend().strsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+		}
+
+		inline void dgemm(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+				const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+				const double *beta, double *c, const int *ldc)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_GEMM,
+					2 * (int64_t)*m * *n * *k, (int64_t)*k * (*m + *n) + 2 * (int64_t)*m * *n);
+			get_blas_backend().dgemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		}
+
+		inline void dsymm(const char *side, const char *uplo, const int *m, const int *n,
+				const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+				const double *beta, double *c, const int *ldc)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<double> ps(BLAS_SYMM,
+					2 * (int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 3 * (int64_t)*m * *n);
+			get_blas_backend().dsymm(side, uplo, m, n, alpha, a, lda, b, ldb, beta, c, ldc);
+		}
+
+		inline void dsyrk(const char *uplo, const char *trans, const int *n, const int *k,
+				const double *alpha, const double *a, const int *lda, const double *beta, double *c, const int *ldc)
+		{
+			detail::blas_profile_scope<double> ps(BLAS_SYRK,
+					(int64_t)*n * (*n + 1) * *k, (int64_t)*n * *k + 2 * detail::blas_tri_elems(*n));
+			get_blas_backend().dsyrk(uplo, trans, n, k, alpha, a, lda, beta, c, ldc);
+		}
+
+		inline void dtrmm(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const double *alpha, const double *a, const int *lda,
+				double *b, const int *ldb)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<double> ps(BLAS_TRMM,
+					(int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 2 * (int64_t)*m * *n);
+			get_blas_backend().dtrmm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+		}
+
+		inline void dtrsm(const char *side, const char *uplo, const char *transa, const char *diag,
+				const int *m, const int *n, const double *alpha, const double *a, const int *lda,
+				double *b, const int *ldb)
+		{
+			const int ka = detail::blas_side_order(side, *m, *n);
+			detail::blas_profile_scope<double> ps(BLAS_TRSM,
+					(int64_t)ka * *m * *n, detail::blas_tri_elems(ka) + 2 * (int64_t)*m * *n);
+			get_blas_backend().dtrsm(side, uplo, transa, diag, m, n, alpha, a, lda, b, ldb);
+		}
+	}
+
+} }
+
+#endif /* BCSLIB_BLAS_BACKEND_H_ */
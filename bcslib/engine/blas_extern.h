@@ -15,6 +15,56 @@
 
 #include <bcslib/config/config.h>
 
+#ifdef BCSLIB_USE_NATIVE_BLAS
+
+// use the built-in implementation (no external BLAS library is needed)
+
+#include <bcslib/engine/native_blas.h>
+
+// BLAS Level 1
+
+#define BCS_SASUM	::bcs::engine::native::sasum
+#define BCS_SAXPY	::bcs::engine::native::saxpy
+#define BCS_SDOT	::bcs::engine::native::sdot
+#define BCS_SNRM2	::bcs::engine::native::snrm2
+#define BCS_SROT	::bcs::engine::native::srot
+
+#define BCS_DASUM	::bcs::engine::native::dasum
+#define BCS_DAXPY	::bcs::engine::native::daxpy
+#define BCS_DDOT	::bcs::engine::native::ddot
+#define BCS_DNRM2	::bcs::engine::native::dnrm2
+#define BCS_DROT	::bcs::engine::native::drot
+
+// BLAS Level 2
+
+#define BCS_SGEMV	::bcs::engine::native::sgemv
+#define BCS_SGER	::bcs::engine::native::sger
+#define BCS_SSYMV	::bcs::engine::native::ssymv
+#define BCS_STRMV	::bcs::engine::native::strmv
+#define BCS_STRSV	::bcs::engine::native::strsv
+
+#define BCS_DGEMV	::bcs::engine::native::dgemv
+#define BCS_DGER	::bcs::engine::native::dger
+#define BCS_DSYMV	::bcs::engine::native::dsymv
+#define BCS_DTRMV	::bcs::engine::native::dtrmv
+#define BCS_DTRSV	::bcs::engine::native::dtrsv
+
+// BLAS Level 3
+
+#define BCS_SGEMM	::bcs::engine::native::sgemm
+#define BCS_SSYMM	::bcs::engine::native::ssymm
+#define BCS_SSYRK	::bcs::engine::native::ssyrk
+#define BCS_STRMM	::bcs::engine::native::strmm
+#define BCS_STRSM	::bcs::engine::native::strsm
+
+#define BCS_DGEMM	::bcs::engine::native::dgemm
+#define BCS_DSYMM	::bcs::engine::native::dsymm
+#define BCS_DSYRK	::bcs::engine::native::dsyrk
+#define BCS_DTRMM	::bcs::engine::native::dtrmm
+#define BCS_DTRSM	::bcs::engine::native::dtrsm
+
+#else
+
 // function name macros
 
 // BLAS Level 1
@@ -50,11 +100,13 @@
 
 #define BCS_SGEMM	sgemm
 #define BCS_SSYMM	ssymm
+#define BCS_SSYRK	ssyrk
 #define BCS_STRMM 	strmm
 #define BCS_STRSM 	strsm
 
 #define BCS_DGEMM	dgemm
 #define BCS_DSYMM	dsymm
+#define BCS_DSYRK	dsyrk
 #define BCS_DTRMM	dtrmm
 #define BCS_DTRSM	dtrsm
 
@@ -121,6 +173,10 @@ extern "C"
 	           	   const float *alpha, const float *a, const int *lda, const float *b, const int *ldb,
 	           	   const float *beta, float *c, const int *ldc);
 
+	void BCS_SSYRK(const char *uplo, const char *trans, const int *n, const int *k,
+	           	   const float *alpha, const float *a, const int *lda,
+	           	   const float *beta, float *c, const int *ldc);
+
 	void BCS_STRMM(const char *side, const char *uplo, const char *transa, const char *diag,
 	           	   const int *m, const int *n, const float *alpha, const float *a, const int *lda,
 	           	   float *b, const int *ldb);
@@ -138,6 +194,10 @@ extern "C"
 	           	   const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
 	           	   const double *beta, double *c, const int *ldc);
 
+	void BCS_DSYRK(const char *uplo, const char *trans, const int *n, const int *k,
+	           	   const double *alpha, const double *a, const int *lda,
+	           	   const double *beta, double *c, const int *ldc);
+
 	void BCS_DTRMM(const char *side, const char *uplo, const char *transa, const char *diag,
 	           	   const int *m, const int *n, const double *alpha, const double *a, const int *lda,
 	           	   double *b, const int *ldb);
@@ -147,4 +207,6 @@ extern "C"
 	           	   double *b, const int *ldb);
 }
 
-#endif 
+#endif /* BCSLIB_USE_NATIVE_BLAS */
+
+#endif
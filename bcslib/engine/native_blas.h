@@ -0,0 +1,523 @@
+/**
+ * @file native_blas.h
+ *
+ * Built-in implementation of the BLAS routines used by the library
+ *
+ * The functions here follow the (Fortran) interface of the external
+ * BLAS routines declared in blas_extern.h, so that they can be used
+ * as a drop-in replacement when BCSLIB_USE_NATIVE_BLAS is defined.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_NATIVE_BLAS_H_
+#define BCSLIB_NATIVE_BLAS_H_
+
+#include <bcslib/engine/small_blasL2.h>
+#include <bcslib/engine/native_gemm.h>
+#include <cmath>
+
+namespace bcs { namespace engine { namespace native {
+
+	inline bool is_trans(const char t) { return t != 'N' && t != 'n'; }
+	inline bool is_upper(const char t) { return t == 'U' || t == 'u'; }
+	inline bool is_unit(const char t) { return t == 'U' || t == 'u'; }
+	inline bool is_left(const char t) { return t == 'L' || t == 'l'; }
+
+
+	/********************************************
+	 *
+	 *  Level 1
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline T asum(const int n, const T *x, const int incx)
+	{
+		T s(0);
+		for (int i = 0; i < n; ++i) s += std::abs(x[i * incx]);
+		return s;
+	}
+
+	template<typename T>
+	inline void axpy(const int n, const T a, const T *x, const int incx, T *y, const int incy)
+	{
+		for (int i = 0; i < n; ++i) y[i * incy] += a * x[i * incx];
+	}
+
+	template<typename T>
+	inline T dot(const int n, const T *x, const int incx, const T *y, const int incy)
+	{
+		T s(0);
+		for (int i = 0; i < n; ++i) s += x[i * incx] * y[i * incy];
+		return s;
+	}
+
+	template<typename T>
+	inline T nrm2(const int n, const T *x, const int incx)
+	{
+		// accumulate scale & scaled sum of squares to avoid overflow
+
+		T scale(0);
+		T ssq(1);
+
+		for (int i = 0; i < n; ++i)
+		{
+			const T v = x[i * incx];
+			if (v != 0)
+			{
+				const T a = std::abs(v);
+				if (scale < a)
+				{
+					const T r = scale / a;
+					ssq = T(1) + ssq * (r * r);
+					scale = a;
+				}
+				else
+				{
+					const T r = a / scale;
+					ssq += r * r;
+				}
+			}
+		}
+
+		return scale * std::sqrt(ssq);
+	}
+
+	template<typename T>
+	inline void rot(const int n, T *x, const int incx, T *y, const int incy, const T c, const T s)
+	{
+		for (int i = 0; i < n; ++i)
+		{
+			T& xi = x[i * incx];
+			T& yi = y[i * incy];
+
+			const T u = xi;
+			const T v = yi;
+			xi = c * u + s * v;
+			yi = c * v - s * u;
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Level 2
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline void gemv(const char trans, const int m, const int n,
+			const T alpha, const T *a, const int lda, const T *x, const int incx,
+			const T beta, T *y, const int incy)
+	{
+		if (is_trans(trans))
+			small_gemv_rt<T>::eval_t(m, n, alpha, a, lda, x, incx, beta, y, incy);
+		else
+			small_gemv_rt<T>::eval_n(m, n, alpha, a, lda, x, incx, beta, y, incy);
+	}
+
+	template<typename T>
+	inline void ger(const int m, const int n, const T alpha,
+			const T *x, const int incx, const T *y, const int incy, T *a, const int lda)
+	{
+		small_ger_rt<T>::eval(m, n, alpha, x, incx, y, incy, a, lda);
+	}
+
+	template<typename T>
+	inline void symv(const char uplo, const int n,
+			const T alpha, const T *a, const int lda, const T *x, const int incx,
+			const T beta, T *y, const int incy)
+	{
+		const bool up = is_upper(uplo);
+
+		for (int i = 0; i < n; ++i)
+		{
+			T s(0);
+			for (int j = 0; j < n; ++j)
+			{
+				const bool in_tri = up ? (i <= j) : (i >= j);
+				const T aij = in_tri ? a[i + j * lda] : a[j + i * lda];
+				s += aij * x[j * incx];
+			}
+
+			T& yi = y[i * incy];
+			yi = (beta == 0 ? alpha * s : beta * yi + alpha * s);
+		}
+	}
+
+	// x := op(A) * x
+
+	template<typename T>
+	inline void trmv(const char uplo, const char trans, const char diag, const int n,
+			const T *a, const int lda, T *x, const int incx)
+	{
+		const bool tr = is_trans(trans);
+		const bool unit = is_unit(diag);
+
+		// whether op(A) is upper triangular
+		if (is_upper(uplo) != tr)
+		{
+			for (int i = 0; i < n; ++i)
+			{
+				T s = unit ? x[i * incx] : a[i + i * lda] * x[i * incx];
+				for (int j = i + 1; j < n; ++j)
+					s += (tr ? a[j + i * lda] : a[i + j * lda]) * x[j * incx];
+				x[i * incx] = s;
+			}
+		}
+		else
+		{
+			for (int i = n - 1; i >= 0; --i)
+			{
+				T s = unit ? x[i * incx] : a[i + i * lda] * x[i * incx];
+				for (int j = 0; j < i; ++j)
+					s += (tr ? a[j + i * lda] : a[i + j * lda]) * x[j * incx];
+				x[i * incx] = s;
+			}
+		}
+	}
+
+	// solve op(A) * x = b (x overwrites b)
+
+	template<typename T>
+	inline void trsv(const char uplo, const char trans, const char diag, const int n,
+			const T *a, const int lda, T *x, const int incx)
+	{
+		const bool tr = is_trans(trans);
+		const bool unit = is_unit(diag);
+
+		// whether op(A) is upper triangular
+		if (is_upper(uplo) != tr)
+		{
+			for (int i = n - 1; i >= 0; --i)
+			{
+				T s = x[i * incx];
+				for (int j = i + 1; j < n; ++j)
+					s -= (tr ? a[j + i * lda] : a[i + j * lda]) * x[j * incx];
+				x[i * incx] = unit ? s : s / a[i + i * lda];
+			}
+		}
+		else
+		{
+			for (int i = 0; i < n; ++i)
+			{
+				T s = x[i * incx];
+				for (int j = 0; j < i; ++j)
+					s -= (tr ? a[j + i * lda] : a[i + j * lda]) * x[j * incx];
+				x[i * incx] = unit ? s : s / a[i + i * lda];
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Level 3
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline void gemm(const char transa, const char transb,
+			const int m, const int n, const int k,
+			const T alpha, const T *a, const int lda, const T *b, const int ldb,
+			const T beta, T *c, const int ldc)
+	{
+		native_gemm<T>::eval(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+	}
+
+	template<typename T>
+	inline void symm(const char side, const char uplo, const int m, const int n,
+			const T alpha, const T *a, const int lda, const T *b, const int ldb,
+			const T beta, T *c, const int ldc)
+	{
+		// expand the symmetric matrix and use gemm
+
+		const int na = is_left(side) ? m : n;
+		const bool up = is_upper(uplo);
+
+		scoped_block<T> fa(na * na);
+		T *f = fa.ptr_begin();
+
+		for (int j = 0; j < na; ++j)
+		{
+			for (int i = 0; i < na; ++i)
+			{
+				const bool in_tri = up ? (i <= j) : (i >= j);
+				f[i + j * na] = in_tri ? a[i + j * lda] : a[j + i * lda];
+			}
+		}
+
+		if (is_left(side))
+			native_gemm<T>::eval('N', 'N', m, n, m, alpha, f, na, b, ldb, beta, c, ldc);
+		else
+			native_gemm<T>::eval('N', 'N', m, n, n, alpha, b, ldb, f, na, beta, c, ldc);
+	}
+
+	// C := alpha * op(A) * op(A)' + beta * C  (within the uplo triangle)
+
+	template<typename T>
+	inline void syrk(const char uplo, const char trans, const int n, const int k,
+			const T alpha, const T *a, const int lda, const T beta, T *c, const int ldc)
+	{
+		native_syrk<T>::eval(uplo, trans, n, k, alpha, a, lda, beta, c, ldc);
+	}
+
+	// B := alpha * op(A) * B,  or  B := alpha * B * op(A)
+
+	template<typename T>
+	inline void trmm(const char side, const char uplo, const char transa, const char diag,
+			const int m, const int n, const T alpha, const T *a, const int lda,
+			T *b, const int ldb)
+	{
+		if (is_left(side))
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				T *bj = b + j * ldb;
+				trmv(uplo, transa, diag, m, a, lda, bj, 1);
+				if (alpha != 1) for (int i = 0; i < m; ++i) bj[i] *= alpha;
+			}
+		}
+		else
+		{
+			// each row: r := r * op(A)  <=>  r' := op(A)' * r'
+			const char tt = is_trans(transa) ? 'N' : 'T';
+			for (int i = 0; i < m; ++i)
+			{
+				T *bi = b + i;
+				trmv(uplo, tt, diag, n, a, lda, bi, ldb);
+				if (alpha != 1) for (int j = 0; j < n; ++j) bi[j * ldb] *= alpha;
+			}
+		}
+	}
+
+	// solve op(A) * X = alpha * B,  or  X * op(A) = alpha * B  (X overwrites B)
+
+	template<typename T>
+	inline void trsm(const char side, const char uplo, const char transa, const char diag,
+			const int m, const int n, const T alpha, const T *a, const int lda,
+			T *b, const int ldb)
+	{
+		if (is_left(side))
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				T *bj = b + j * ldb;
+				if (alpha != 1) for (int i = 0; i < m; ++i) bj[i] *= alpha;
+				trsv(uplo, transa, diag, m, a, lda, bj, 1);
+			}
+		}
+		else
+		{
+			// each row: x * op(A) = r  <=>  op(A)' * x' = r'
+			const char tt = is_trans(transa) ? 'N' : 'T';
+			for (int i = 0; i < m; ++i)
+			{
+				T *bi = b + i;
+				if (alpha != 1) for (int j = 0; j < n; ++j) bi[j * ldb] *= alpha;
+				trsv(uplo, tt, diag, n, a, lda, bi, ldb);
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  BLAS-compatible interface
+	 *
+	 ********************************************/
+
+	// Level 1
+
+	inline float sasum(const int *n, const float *x, const int *incx)
+	{
+		return asum(*n, x, *incx);
+	}
+
+	inline void saxpy(const int *n, const float *alpha, const float *x, const int *incx, float *y, const int *incy)
+	{
+		axpy(*n, *alpha, x, *incx, y, *incy);
+	}
+
+	inline float sdot(const int *n, const float *x, const int *incx, const float *y, const int *incy)
+	{
+		return dot(*n, x, *incx, y, *incy);
+	}
+
+	inline float snrm2(const int *n, const float *x, const int *incx)
+	{
+		return nrm2(*n, x, *incx);
+	}
+
+	inline void srot(const int *n, float *x, const int *incx, float *y, const int *incy, const float *c, const float *s)
+	{
+		rot(*n, x, *incx, y, *incy, *c, *s);
+	}
+
+	inline double dasum(const int *n, const double *x, const int *incx)
+	{
+		return asum(*n, x, *incx);
+	}
+
+	inline void daxpy(const int *n, const double *alpha, const double *x, const int *incx, double *y, const int *incy)
+	{
+		axpy(*n, *alpha, x, *incx, y, *incy);
+	}
+
+	inline double ddot(const int *n, const double *x, const int *incx, const double *y, const int *incy)
+	{
+		return dot(*n, x, *incx, y, *incy);
+	}
+
+	inline double dnrm2(const int *n, const double *x, const int *incx)
+	{
+		return nrm2(*n, x, *incx);
+	}
+
+	inline void drot(const int *n, double *x, const int *incx, double *y, const int *incy, const double *c, const double *s)
+	{
+		rot(*n, x, *incx, y, *incy, *c, *s);
+	}
+
+	// Level 2
+
+	inline void sgemv(const char *trans, const int *m, const int *n, const float *alpha,
+			const float *a, const int *lda, const float *x, const int *incx,
+			const float *beta, float *y, const int *incy)
+	{
+		gemv(*trans, *m, *n, *alpha, a, *lda, x, *incx, *beta, y, *incy);
+	}
+
+	inline void sger(const int *m, const int *n, const float *alpha, const float *x, const int *incx,
+			const float *y, const int *incy, float *a, const int *lda)
+	{
+		ger(*m, *n, *alpha, x, *incx, y, *incy, a, *lda);
+	}
+
+	inline void ssymv(const char *uplo, const int *n, const float *alpha, const float *a, const int *lda,
+			const float *x, const int *incx, const float *beta, float *y, const int *incy)
+	{
+		symv(*uplo, *n, *alpha, a, *lda, x, *incx, *beta, y, *incy);
+	}
+
+	inline void strmv(const char *uplo, const char *transa, const char *diag, const int *n,
+			const float *a, const int *lda, float *b, const int *incx)
+	{
+		trmv(*uplo, *transa, *diag, *n, a, *lda, b, *incx);
+	}
+
+	inline void strsv(const char *uplo, const char *trans, const char *diag, const int *n,
+			const float *a, const int *lda, float *x, const int *incx)
+	{
+		trsv(*uplo, *trans, *diag, *n, a, *lda, x, *incx);
+	}
+
+	inline void dgemv(const char *trans, const int *m, const int *n, const double *alpha,
+			const double *a, const int *lda, const double *x, const int *incx,
+			const double *beta, double *y, const int *incy)
+	{
+		gemv(*trans, *m, *n, *alpha, a, *lda, x, *incx, *beta, y, *incy);
+	}
+
+	inline void dger(const int *m, const int *n, const double *alpha, const double *x, const int *incx,
+			const double *y, const int *incy, double *a, const int *lda)
+	{
+		ger(*m, *n, *alpha, x, *incx, y, *incy, a, *lda);
+	}
+
+	inline void dsymv(const char *uplo, const int *n, const double *alpha, const double *a, const int *lda,
+			const double *x, const int *incx, const double *beta, double *y, const int *incy)
+	{
+		symv(*uplo, *n, *alpha, a, *lda, x, *incx, *beta, y, *incy);
+	}
+
+	inline void dtrmv(const char *uplo, const char *transa, const char *diag, const int *n,
+			const double *a, const int *lda, double *b, const int *incx)
+	{
+		trmv(*uplo, *transa, *diag, *n, a, *lda, b, *incx);
+	}
+
+	inline void dtrsv(const char *uplo, const char *trans, const char *diag, const int *n,
+			const double *a, const int *lda, double *x, const int *incx)
+	{
+		trsv(*uplo, *trans, *diag, *n, a, *lda, x, *incx);
+	}
+
+	// Level 3
+
+	inline void sgemm(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+			const float *alpha, const float *a, const int *lda, const float *b, const int *ldb,
+			const float *beta, float *c, const int *ldc)
+	{
+		gemm(*transa, *transb, *m, *n, *k, *alpha, a, *lda, b, *ldb, *beta, c, *ldc);
+	}
+
+	inline void ssymm(const char *side, const char *uplo, const int *m, const int *n,
+			const float *alpha, const float *a, const int *lda, const float *b, const int *ldb,
+			const float *beta, float *c, const int *ldc)
+	{
+		symm(*side, *uplo, *m, *n, *alpha, a, *lda, b, *ldb, *beta, c, *ldc);
+	}
+
+	inline void ssyrk(const char *uplo, const char *trans, const int *n, const int *k,
+			const float *alpha, const float *a, const int *lda, const float *beta, float *c, const int *ldc)
+	{
+		syrk(*uplo, *trans, *n, *k, *alpha, a, *lda, *beta, c, *ldc);
+	}
+
+	inline void strmm(const char *side, const char *uplo, const char *transa, const char *diag,
+			const int *m, const int *n, const float *alpha, const float *a, const int *lda,
+			float *b, const int *ldb)
+	{
+		trmm(*side, *uplo, *transa, *diag, *m, *n, *alpha, a, *lda, b, *ldb);
+	}
+
+	inline void strsm(const char *side, const char *uplo, const char *transa, const char *diag,
+			const int *m, const int *n, const float *alpha, const float *a, const int *lda,
+			float *b, const int *ldb)
+	{
+		trsm(*side, *uplo, *transa, *diag, *m, *n, *alpha, a, *lda, b, *ldb);
+	}
+
+	inline void dgemm(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+			const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+			const double *beta, double *c, const int *ldc)
+	{
+		gemm(*transa, *transb, *m, *n, *k, *alpha, a, *lda, b, *ldb, *beta, c, *ldc);
+	}
+
+	inline void dsymm(const char *side, const char *uplo, const int *m, const int *n,
+			const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+			const double *beta, double *c, const int *ldc)
+	{
+		symm(*side, *uplo, *m, *n, *alpha, a, *lda, b, *ldb, *beta, c, *ldc);
+	}
+
+	inline void dsyrk(const char *uplo, const char *trans, const int *n, const int *k,
+			const double *alpha, const double *a, const int *lda, const double *beta, double *c, const int *ldc)
+	{
+		syrk(*uplo, *trans, *n, *k, *alpha, a, *lda, *beta, c, *ldc);
+	}
+
+	inline void dtrmm(const char *side, const char *uplo, const char *transa, const char *diag,
+			const int *m, const int *n, const double *alpha, const double *a, const int *lda,
+			double *b, const int *ldb)
+	{
+		trmm(*side, *uplo, *transa, *diag, *m, *n, *alpha, a, *lda, b, *ldb);
+	}
+
+	inline void dtrsm(const char *side, const char *uplo, const char *transa, const char *diag,
+			const int *m, const int *n, const double *alpha, const double *a, const int *lda,
+			double *b, const int *ldb)
+	{
+		trsm(*side, *uplo, *transa, *diag, *m, *n, *alpha, a, *lda, b, *ldb);
+	}
+
+} } }
+
+#endif /* BCSLIB_NATIVE_BLAS_H_ */
@@ -0,0 +1,850 @@
+/**
+ * @file native_gemm.h
+ *
+ * A built-in cache-blocked implementation of GEMM (and of SYRK)
+ *
+ * Large products are run on the library thread pool (parallel.h).
+ * For each KC x NC panel of B, the threads first pack the panel and
+ * the whole corresponding m x KC panel of A together (such that every
+ * element is packed once), and then compute disjoint 2D tiles of C
+ * from the shared packed panels. The number of threads is chosen such
+ * that each gets at least native_gemm_min_madds() multiply-adds.
+ *
+ * The panels are filled by packers (see gemm_ptr_packer_a/b), so that
+ * an operand that is not stored in memory (e.g. an expression read
+ * column by column) is packed directly, without being materialized
+ * as a whole beforehand.
+ *
+ * native_syrk uses the same packing and micro-kernel, but only visits
+ * the micro-tiles that meet the referenced triangle of C, and splits
+ * the columns of C among threads by the area of the triangle.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_NATIVE_GEMM_H_
+#define BCSLIB_NATIVE_GEMM_H_
+
+#include <bcslib/core/basic_defs.h>
+#include <bcslib/core/block.h>
+#include <bcslib/core/parallel.h>
+#include <cmath>
+
+namespace bcs { namespace engine {
+
+	/********************************************
+	 *
+	 *  Blocking parameters
+	 *
+	 *  MR x NR:  the size of a register block
+	 *            (computed by the micro-kernel)
+	 *
+	 *  KC:  the depth of a packed panel, chosen
+	 *       such that an MR x KC sliver of A and
+	 *       a KC x NR sliver of B stay in L1
+	 *
+	 *  MC:  the height of a packed block of A
+	 *       (MC x KC is meant to reside in L2)
+	 *
+	 *  NC:  the width of a packed panel of B
+	 *       (KC x NC is meant to reside in L3)
+	 *
+	 ********************************************/
+
+	template<typename T> struct native_gemm_params;
+
+	template<>
+	struct native_gemm_params<double>
+	{
+		static const int MR = 8;
+		static const int NR = 4;
+		static const int KC = 256;
+		static const int MC = 96;
+		static const int NC = 2048;
+	};
+
+	template<>
+	struct native_gemm_params<float>
+	{
+		static const int MR = 8;
+		static const int NR = 8;
+		static const int KC = 256;
+		static const int MC = 128;
+		static const int NC = 4096;
+	};
+
+
+	namespace detail
+	{
+		inline int gemm_round_up(const int n, const int b)
+		{
+			return ((n + b - 1) / b) * b;
+		}
+
+		// pack op(A)(0:mc, 0:kc) into micro-panels of MR rows,
+		// each stored as kc consecutive columns of length MR
+		// (the last panel is zero-padded)
+
+		template<typename T, int MR>
+		void gemm_pack_a(const bool ta, const int mc, const int kc,
+				const T* __restrict__ a, const int lda, T* __restrict__ buf)
+		{
+			const int rs = ta ? lda : 1;
+			const int cs = ta ? 1 : lda;
+
+			for (int i0 = 0; i0 < mc; i0 += MR)
+			{
+				const int mr = mc - i0 < MR ? mc - i0 : MR;
+				const T *ap = a + i0 * rs;
+
+				if (mr == MR && rs == 1)
+				{
+					for (int p = 0; p < kc; ++p, ap += cs, buf += MR)
+					{
+						for (int i = 0; i < MR; ++i) buf[i] = ap[i];
+					}
+				}
+				else
+				{
+					for (int p = 0; p < kc; ++p, ap += cs, buf += MR)
+					{
+						int i = 0;
+						for (; i < mr; ++i) buf[i] = ap[i * rs];
+						for (; i < MR; ++i) buf[i] = T(0);
+					}
+				}
+			}
+		}
+
+		// pack op(B)(0:kc, 0:nc) into micro-panels of NR columns,
+		// each stored as kc consecutive rows of length NR
+		// (the last panel is zero-padded)
+
+		template<typename T, int NR>
+		void gemm_pack_b(const bool tb, const int kc, const int nc,
+				const T* __restrict__ b, const int ldb, T* __restrict__ buf)
+		{
+			const int rs = tb ? ldb : 1;
+			const int cs = tb ? 1 : ldb;
+
+			for (int j0 = 0; j0 < nc; j0 += NR)
+			{
+				const int nr = nc - j0 < NR ? nc - j0 : NR;
+				const T *bp = b + j0 * cs;
+
+				if (nr == NR && cs == 1)
+				{
+					for (int p = 0; p < kc; ++p, bp += rs, buf += NR)
+					{
+						for (int j = 0; j < NR; ++j) buf[j] = bp[j];
+					}
+				}
+				else
+				{
+					for (int p = 0; p < kc; ++p, bp += rs, buf += NR)
+					{
+						int j = 0;
+						for (; j < nr; ++j) buf[j] = bp[j * cs];
+						for (; j < NR; ++j) buf[j] = T(0);
+					}
+				}
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  packers
+		 *
+		 *  An A-packer packs op(A)(i0:i0+mc, p0:p0+kc)
+		 *  in the layout of gemm_pack_a, via
+		 *
+		 *    pack(i0, p0, mc, kc, buf);
+		 *
+		 *  and a B-packer packs op(B)(p0:p0+kc, j0:j0+nc)
+		 *  in the layout of gemm_pack_b, via
+		 *
+		 *    pack(p0, j0, kc, nc, buf);
+		 *
+		 *  The pack functions may be called concurrently
+		 *  (on disjoint parts).
+		 *
+		 ********************************************/
+
+		template<typename T, int MR>
+		struct gemm_ptr_packer_a
+		{
+			bool ta; const T *a; int lda;
+
+			gemm_ptr_packer_a(const bool ta_, const T *a_, const int lda_)
+			: ta(ta_), a(a_), lda(lda_) { }
+
+			void pack(const int i0, const int p0, const int mc, const int kc, T *buf) const
+			{
+				gemm_pack_a<T, MR>(ta, mc, kc, ta ? a + (p0 + i0 * lda) : a + (i0 + p0 * lda), lda, buf);
+			}
+		};
+
+		template<typename T, int NR>
+		struct gemm_ptr_packer_b
+		{
+			bool tb; const T *b; int ldb;
+
+			gemm_ptr_packer_b(const bool tb_, const T *b_, const int ldb_)
+			: tb(tb_), b(b_), ldb(ldb_) { }
+
+			void pack(const int p0, const int j0, const int kc, const int nc, T *buf) const
+			{
+				gemm_pack_b<T, NR>(tb, kc, nc, tb ? b + (j0 + p0 * ldb) : b + (p0 + j0 * ldb), ldb, buf);
+			}
+		};
+
+		// packers reading an operand X column by column, through a bank
+		// of column readers, i.e. Bank::reader_type(bank, j).get(i) = X(i, j),
+		// where op(X) = X (Trans = false) or X^T (Trans = true)
+
+		template<typename T, int MR, class Bank, bool Trans>
+		struct gemm_colreader_packer_a
+		{
+			typedef typename Bank::reader_type reader_t;
+			const Bank& bank;
+
+			explicit gemm_colreader_packer_a(const Bank& bk) : bank(bk) { }
+
+			void pack(const int i0, const int p0, const int mc, const int kc, T *buf) const
+			{
+				const int mp = gemm_round_up(mc, MR);
+
+				if (!Trans)
+				{
+					for (int p = 0; p < kc; ++p)
+					{
+						reader_t col(bank, p0 + p);
+						T *b = buf + p * MR;
+						for (int i = 0; i < mc; ++i) b[(i / MR) * MR * kc + (i % MR)] = col.get(i0 + i);
+					}
+				}
+				else
+				{
+					for (int i = 0; i < mc; ++i)
+					{
+						reader_t col(bank, i0 + i);
+						T *b = buf + (i / MR) * MR * kc + (i % MR);
+						for (int p = 0; p < kc; ++p) b[p * MR] = col.get(p0 + p);
+					}
+				}
+
+				for (int i = mc; i < mp; ++i)
+				{
+					T *b = buf + (i / MR) * MR * kc + (i % MR);
+					for (int p = 0; p < kc; ++p) b[p * MR] = T(0);
+				}
+			}
+		};
+
+		template<typename T, int NR, class Bank, bool Trans>
+		struct gemm_colreader_packer_b
+		{
+			typedef typename Bank::reader_type reader_t;
+			const Bank& bank;
+
+			explicit gemm_colreader_packer_b(const Bank& bk) : bank(bk) { }
+
+			void pack(const int p0, const int j0, const int kc, const int nc, T *buf) const
+			{
+				const int np = gemm_round_up(nc, NR);
+
+				if (!Trans)
+				{
+					for (int j = 0; j < nc; ++j)
+					{
+						reader_t col(bank, j0 + j);
+						T *b = buf + (j / NR) * NR * kc + (j % NR);
+						for (int p = 0; p < kc; ++p) b[p * NR] = col.get(p0 + p);
+					}
+				}
+				else
+				{
+					for (int p = 0; p < kc; ++p)
+					{
+						reader_t col(bank, p0 + p);
+						T *b = buf + p * NR;
+						for (int j = 0; j < nc; ++j) b[(j / NR) * NR * kc + (j % NR)] = col.get(j0 + j);
+					}
+				}
+
+				for (int j = nc; j < np; ++j)
+				{
+					T *b = buf + (j / NR) * NR * kc + (j % NR);
+					for (int p = 0; p < kc; ++p) b[p * NR] = T(0);
+				}
+			}
+		};
+
+
+		// ab := (MR x kc panel of A) * (kc x NR panel of B)
+
+		template<typename T, int MR, int NR>
+		struct gemm_micro_kernel
+		{
+			BCS_ENSURE_INLINE
+			static void run(const int kc,
+					const T* __restrict__ a, const T* __restrict__ b, T* __restrict__ ab)
+			{
+				T r[NR][MR] __attribute__(( aligned(32) ));
+				for (int j = 0; j < NR; ++j)
+					for (int i = 0; i < MR; ++i) r[j][i] = T(0);
+
+				for (int p = 0; p < kc; ++p, a += MR, b += NR)
+				{
+					T av[MR];
+					for (int i = 0; i < MR; ++i) av[i] = a[i];
+
+					for (int j = 0; j < NR; ++j)
+					{
+						for (int i = 0; i < MR; ++i) r[j][i] += av[i] * b[j];
+					}
+				}
+
+				for (int j = 0; j < NR; ++j)
+					for (int i = 0; i < MR; ++i) ab[i + j * MR] = r[j][i];
+			}
+		};
+
+
+		// C(0:mc, 0:nc) += alpha * packed(A) * packed(B)
+
+		template<typename T, int MR, int NR>
+		void gemm_macro_kernel(const int mc, const int nc, const int kc, const T alpha,
+				const T* __restrict__ pa, const T* __restrict__ pb,
+				T* __restrict__ c, const int ldc)
+		{
+			T ab[MR * NR] __attribute__(( aligned(32) ));
+
+			for (int j0 = 0; j0 < nc; j0 += NR)
+			{
+				const int nr = nc - j0 < NR ? nc - j0 : NR;
+				const T *pb_j = pb + j0 * kc;
+
+				for (int i0 = 0; i0 < mc; i0 += MR)
+				{
+					const int mr = mc - i0 < MR ? mc - i0 : MR;
+
+					gemm_micro_kernel<T, MR, NR>::run(kc, pa + i0 * kc, pb_j, ab);
+
+					T *c_ij = c + i0 + j0 * ldc;
+					if (mr == MR && nr == NR)
+					{
+						for (int j = 0; j < NR; ++j, c_ij += ldc)
+						{
+							for (int i = 0; i < MR; ++i) c_ij[i] += alpha * ab[i + j * MR];
+						}
+					}
+					else
+					{
+						for (int j = 0; j < nr; ++j, c_ij += ldc)
+						{
+							for (int i = 0; i < mr; ++i) c_ij[i] += alpha * ab[i + j * MR];
+						}
+					}
+				}
+			}
+		}
+
+
+		// as gemm_macro_kernel, but only updates the elements of C in the
+		// upper (or lower) triangle of the whole matrix, where d0 is the
+		// row offset minus the column offset of this block of C
+
+		template<typename T, int MR, int NR>
+		void syrk_macro_kernel(const bool up, const int d0,
+				const int mc, const int nc, const int kc, const T alpha,
+				const T* __restrict__ pa, const T* __restrict__ pb,
+				T* __restrict__ c, const int ldc)
+		{
+			T ab[MR * NR] __attribute__(( aligned(32) ));
+
+			for (int j0 = 0; j0 < nc; j0 += NR)
+			{
+				const int nr = nc - j0 < NR ? nc - j0 : NR;
+				const T *pb_j = pb + j0 * kc;
+
+				for (int i0 = 0; i0 < mc; i0 += MR)
+				{
+					const int mr = mc - i0 < MR ? mc - i0 : MR;
+
+					// the range of (row - column) over the micro-tile
+					const int dmin = d0 + i0 - (j0 + nr - 1);
+					const int dmax = d0 + i0 + (mr - 1) - j0;
+
+					if (up ? dmin > 0 : dmax < 0) continue;
+
+					gemm_micro_kernel<T, MR, NR>::run(kc, pa + i0 * kc, pb_j, ab);
+
+					T *c_ij = c + i0 + j0 * ldc;
+					if (up ? dmax <= 0 : dmin >= 0)
+					{
+						for (int j = 0; j < nr; ++j, c_ij += ldc)
+						{
+							for (int i = 0; i < mr; ++i) c_ij[i] += alpha * ab[i + j * MR];
+						}
+					}
+					else
+					{
+						for (int j = 0; j < nr; ++j, c_ij += ldc)
+						{
+							const int d = d0 + i0 - (j0 + j);
+							for (int i = 0; i < mr; ++i)
+							{
+								if (up ? d + i <= 0 : d + i >= 0) c_ij[i] += alpha * ab[i + j * MR];
+							}
+						}
+					}
+				}
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  parallel steps
+		 *
+		 *  Each step is split into nt parts of items,
+		 *  such that a part is the work of a thread.
+		 *
+		 ********************************************/
+
+		// packs the A panel (as ceil(m / MR) items) and the B panel
+		// (as ceil(nc / NR) items)
+
+		template<typename T, int MR, int NR, class APacker, class BPacker>
+		struct gemm_par_pack
+		{
+			const APacker *apk; const BPacker *bpk;
+			int m; int nc; int kc;
+			int jc; int pc;
+			T *pa; T *pb;
+			int nt;
+
+			void operator() (const index_t k0, const index_t k1) const
+			{
+				const int na = (m + MR - 1) / MR;
+				const int ni = na + (nc + NR - 1) / NR;
+
+				const int i0 = (int)((long)ni * k0 / nt);
+				const int i1 = (int)((long)ni * k1 / nt);
+
+				if (i0 < na)
+				{
+					const int r0 = i0 * MR;
+					const int r1 = (i1 < na ? i1 * MR : m);
+					apk->pack(r0, pc, r1 - r0, kc, pa + r0 * kc);
+				}
+
+				if (i1 > na)
+				{
+					const int c0 = (i0 > na ? i0 - na : 0) * NR;
+					const int c1 = (i1 - na) * NR < nc ? (i1 - na) * NR : nc;
+					bpk->pack(pc, jc + c0, kc, c1 - c0, pb + c0 * kc);
+				}
+			}
+		};
+
+		// computes the tiles of C, with t = ti * ntj + tj for the tile
+		// at rows ti * MC and columns tj * ncw (consecutive tiles share
+		// the same block of packed A)
+
+		template<typename T, int MR, int NR, int MC>
+		struct gemm_par_tiles
+		{
+			int m; int nc; int kc; T alpha;
+			const T *pa; const T *pb;
+			T *c; int ldc;
+			int ncw; int ntj;
+			int nt;
+
+			void operator() (const index_t k0, const index_t k1) const
+			{
+				const int nti = (m + MC - 1) / MC;
+				const int ntiles = nti * ntj;
+
+				const int t0 = (int)((long)ntiles * k0 / nt);
+				const int t1 = (int)((long)ntiles * k1 / nt);
+
+				for (int t = t0; t < t1; ++t)
+				{
+					const int ic = (t / ntj) * MC;
+					const int jr = (t % ntj) * ncw;
+
+					const int mc = m - ic < MC ? m - ic : MC;
+					const int nw = nc - jr < ncw ? nc - jr : ncw;
+
+					gemm_macro_kernel<T, MR, NR>(mc, nw, kc, alpha,
+							pa + ic * kc, pb + jr * kc, c + (ic + jr * ldc), ldc);
+				}
+			}
+		};
+		// computes the columns [cols[t], cols[t+1]) of a SYRK for each t
+
+		template<class Syrk, typename T>
+		struct syrk_par_cols
+		{
+			bool up; bool ta;
+			int n; int k; T alpha;
+			const T *a; int lda;
+			T *c; int ldc;
+			const int *cols;
+
+			void operator() (const index_t t0, const index_t t1) const
+			{
+				for (index_t t = t0; t < t1; ++t)
+				{
+					Syrk::eval_cols(up, ta, n, k, alpha, a, lda, c, ldc, cols[t], cols[t + 1]);
+				}
+			}
+		};
+	}
+
+
+	/**
+	 * The minimum number of multiply-adds for each thread
+	 * of a parallel native_gemm
+	 */
+	inline double native_gemm_min_madds()
+	{
+		return double(get_parallel_grain()) * 32;
+	}
+
+
+	/********************************************
+	 *
+	 *  native_gemm
+	 *
+	 *  C := alpha * op(A) * op(B) + beta * C
+	 *
+	 *  (same semantics as the BLAS routine)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct native_gemm
+	{
+		typedef native_gemm_params<T> params_t;
+
+		static const int MR = params_t::MR;
+		static const int NR = params_t::NR;
+		static const int KC = params_t::KC;
+		static const int MC = params_t::MC;
+		static const int NC = params_t::NC;
+
+		static void eval(const char transa, const char transb,
+				const int m, const int n, const int k,
+				const T alpha, const T *a, const int lda, const T *b, const int ldb,
+				const T beta, T *c, const int ldc)
+		{
+			const bool ta = (transa != 'N' && transa != 'n');
+			const bool tb = (transb != 'N' && transb != 'n');
+
+			eval_packed(m, n, k, alpha,
+					detail::gemm_ptr_packer_a<T, MR>(ta, a, lda),
+					detail::gemm_ptr_packer_b<T, NR>(tb, b, ldb),
+					beta, c, ldc);
+		}
+
+		/**
+		 * C := alpha * op(A) * op(B) + beta * C, with op(A) (m x k)
+		 * and op(B) (k x n) given by packers (see detail::gemm_ptr_packer_a/b)
+		 */
+		template<class APacker, class BPacker>
+		static void eval_packed(const int m, const int n, const int k,
+				const T alpha, const APacker& apk, const BPacker& bpk,
+				const T beta, T *c, const int ldc)
+		{
+			if (m <= 0 || n <= 0) return;
+
+			scale_c(m, n, beta, c, ldc);
+			if (k <= 0 || alpha == 0) return;
+
+			const int nt = num_threads(m, n, k);
+			if (nt > 1)
+			{
+				eval_par(nt, m, n, k, alpha, apk, bpk, c, ldc);
+				return;
+			}
+
+			const int mc_max = m < MC ? detail::gemm_round_up(m, MR) : MC;
+			const int nc_max = n < NC ? detail::gemm_round_up(n, NR) : NC;
+			const int kc_max = k < KC ? k : KC;
+
+			scoped_block<T> abuf(mc_max * kc_max);
+			scoped_block<T> bbuf(kc_max * nc_max);
+
+			T *pa = abuf.ptr_begin();
+			T *pb = bbuf.ptr_begin();
+
+			for (int jc = 0; jc < n; jc += NC)
+			{
+				const int nc = n - jc < NC ? n - jc : NC;
+
+				for (int pc = 0; pc < k; pc += KC)
+				{
+					const int kc = k - pc < KC ? k - pc : KC;
+
+					bpk.pack(pc, jc, kc, nc, pb);
+
+					for (int ic = 0; ic < m; ic += MC)
+					{
+						const int mc = m - ic < MC ? m - ic : MC;
+
+						apk.pack(ic, pc, mc, kc, pa);
+
+						detail::gemm_macro_kernel<T, MR, NR>(mc, nc, kc, alpha, pa, pb,
+								c + (ic + jc * ldc), ldc);
+					}
+				}
+			}
+		}
+
+	private:
+		static int num_threads(const int m, const int n, const int k)
+		{
+#ifndef BCSLIB_NO_THREADS
+			const int nthreads = get_num_threads();
+			if (nthreads <= 1 || thread_pool::in_task()) return 1;
+
+			const double nt = double(m) * double(n) * double(k) / native_gemm_min_madds();
+			return nt < nthreads ? (int)nt : nthreads;
+#else
+			return 1;
+#endif
+		}
+
+		template<class APacker, class BPacker>
+		static void eval_par(const int nt, const int m, const int n, const int k,
+				const T alpha, const APacker& apk, const BPacker& bpk,
+				T *c, const int ldc)
+		{
+			const int nc_max = n < NC ? detail::gemm_round_up(n, NR) : NC;
+			const int kc_max = k < KC ? k : KC;
+
+			scoped_block<T> abuf(detail::gemm_round_up(m, MR) * kc_max);
+			scoped_block<T> bbuf(kc_max * nc_max);
+
+			detail::gemm_par_pack<T, MR, NR, APacker, BPacker> pk;
+			pk.apk = &apk;
+			pk.bpk = &bpk;
+			pk.m = m;
+			pk.pa = abuf.ptr_begin();
+			pk.pb = bbuf.ptr_begin();
+			pk.nt = nt;
+
+			detail::gemm_par_tiles<T, MR, NR, MC> tk;
+			tk.m = m; tk.alpha = alpha;
+			tk.pa = abuf.ptr_begin();
+			tk.pb = bbuf.ptr_begin();
+			tk.ldc = ldc;
+			tk.nt = nt;
+
+			// about four tiles per thread, for balance
+			const int nti = (m + MC - 1) / MC;
+
+			for (int jc = 0; jc < n; jc += NC)
+			{
+				const int nc = n - jc < NC ? n - jc : NC;
+
+				int ntj = (4 * nt + nti - 1) / nti;
+				const int ncw = detail::gemm_round_up((nc + ntj - 1) / ntj, NR);
+				ntj = (nc + ncw - 1) / ncw;
+
+				for (int pc = 0; pc < k; pc += KC)
+				{
+					const int kc = k - pc < KC ? k - pc : KC;
+
+					pk.nc = nc; pk.kc = kc;
+					pk.jc = jc; pk.pc = pc;
+					parallel_for(0, nt, 1, pk);
+
+					tk.nc = nc; tk.kc = kc;
+					tk.c = c + jc * ldc;
+					tk.ncw = ncw; tk.ntj = ntj;
+					parallel_for(0, nt, 1, tk);
+				}
+			}
+		}
+
+		static void scale_c(const int m, const int n, const T beta, T *c, const int ldc)
+		{
+			if (beta == 0)
+			{
+				for (int j = 0; j < n; ++j, c += ldc)
+					for (int i = 0; i < m; ++i) c[i] = T(0);
+			}
+			else if (beta != 1)
+			{
+				for (int j = 0; j < n; ++j, c += ldc)
+					for (int i = 0; i < m; ++i) c[i] *= beta;
+			}
+		}
+	};
+
+
+
+	/********************************************
+	 *
+	 *  native_syrk
+	 *
+	 *  C := alpha * op(A) * op(A)' + beta * C
+	 *
+	 *  with op(A) of size n x k, where only the
+	 *  uplo triangle of C is referenced
+	 *
+	 *  (same semantics as the BLAS routine)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct native_syrk
+	{
+		typedef native_gemm_params<T> params_t;
+
+		static const int MR = params_t::MR;
+		static const int NR = params_t::NR;
+		static const int KC = params_t::KC;
+		static const int MC = params_t::MC;
+		static const int NC = params_t::NC;
+
+		static void eval(const char uplo, const char trans, const int n, const int k,
+				const T alpha, const T *a, const int lda,
+				const T beta, T *c, const int ldc)
+		{
+			if (n <= 0) return;
+
+			const bool up = (uplo == 'U' || uplo == 'u');
+			const bool ta = (trans != 'N' && trans != 'n');
+
+			scale_tri(up, n, beta, c, ldc);
+			if (k <= 0 || alpha == 0) return;
+
+			const int nt = num_threads(n, k);
+			if (nt > 1)
+			{
+				// split the columns, such that the parts of the
+				// triangle have about the same area
+
+				scoped_block<int> cb(nt + 1);
+				int *cols = cb.ptr_begin();
+
+				cols[0] = 0;
+				for (int t = 1; t < nt; ++t)
+				{
+					const double r = double(t) / nt;
+					const double f = up ? std::sqrt(r) : 1.0 - std::sqrt(1.0 - r);
+					const int j = detail::gemm_round_up((int)(f * n), NR);
+					cols[t] = j < cols[t - 1] ? cols[t - 1] : (j > n ? n : j);
+				}
+				cols[nt] = n;
+
+				detail::syrk_par_cols<native_syrk, T> pc;
+				pc.up = up; pc.ta = ta;
+				pc.n = n; pc.k = k; pc.alpha = alpha;
+				pc.a = a; pc.lda = lda;
+				pc.c = c; pc.ldc = ldc;
+				pc.cols = cols;
+
+				parallel_for(0, nt, 1, pc);
+			}
+			else
+			{
+				eval_cols(up, ta, n, k, alpha, a, lda, c, ldc, 0, n);
+			}
+		}
+
+		// C(:, j_beg:j_end) += alpha * op(A) * op(A)(j_beg:j_end, :)'
+		// (within the triangle)
+
+		static void eval_cols(const bool up, const bool ta, const int n, const int k,
+				const T alpha, const T *a, const int lda, T *c, const int ldc,
+				const int j_beg, const int j_end)
+		{
+			if (j_end <= j_beg) return;
+
+			// op(A) as the left operand, and op(A)' as the right one
+			detail::gemm_ptr_packer_a<T, MR> apk(ta, a, lda);
+			detail::gemm_ptr_packer_b<T, NR> bpk(!ta, a, lda);
+
+			const int w = j_end - j_beg;
+			const int mc_max = n < MC ? detail::gemm_round_up(n, MR) : MC;
+			const int nc_max = w < NC ? detail::gemm_round_up(w, NR) : NC;
+			const int kc_max = k < KC ? k : KC;
+
+			scoped_block<T> abuf(mc_max * kc_max);
+			scoped_block<T> bbuf(kc_max * nc_max);
+
+			T *pa = abuf.ptr_begin();
+			T *pb = bbuf.ptr_begin();
+
+			for (int jc = j_beg; jc < j_end; jc += NC)
+			{
+				const int nc = j_end - jc < NC ? j_end - jc : NC;
+
+				// the rows that meet the triangle within these columns
+				const int i_beg = up ? 0 : jc;
+				const int i_end = up ? jc + nc : n;
+
+				for (int pc = 0; pc < k; pc += KC)
+				{
+					const int kc = k - pc < KC ? k - pc : KC;
+
+					bpk.pack(pc, jc, kc, nc, pb);
+
+					for (int ic = i_beg; ic < i_end; ic += MC)
+					{
+						const int mc = i_end - ic < MC ? i_end - ic : MC;
+
+						apk.pack(ic, pc, mc, kc, pa);
+
+						detail::syrk_macro_kernel<T, MR, NR>(up, ic - jc, mc, nc, kc, alpha, pa, pb,
+								c + (ic + jc * ldc), ldc);
+					}
+				}
+			}
+		}
+
+	private:
+		static int num_threads(const int n, const int k)
+		{
+#ifndef BCSLIB_NO_THREADS
+			const int nthreads = get_num_threads();
+			if (nthreads <= 1 || thread_pool::in_task()) return 1;
+
+			const double nt = 0.5 * double(n) * double(n) * double(k) / native_gemm_min_madds();
+			return nt < nthreads ? (int)nt : nthreads;
+#else
+			return 1;
+#endif
+		}
+
+		static void scale_tri(const bool up, const int n, const T beta, T *c, const int ldc)
+		{
+			if (beta == 1) return;
+
+			for (int j = 0; j < n; ++j, c += ldc)
+			{
+				const int i0 = up ? 0 : j;
+				const int i1 = up ? j + 1 : n;
+
+				if (beta == 0)
+					for (int i = i0; i < i1; ++i) c[i] = T(0);
+				else
+					for (int i = i0; i < i1; ++i) c[i] *= beta;
+			}
+		}
+	};
+
+} }
+
+#endif /* BCSLIB_NATIVE_GEMM_H_ */
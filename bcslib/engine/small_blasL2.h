@@ -1052,6 +1052,71 @@ namespace bcs { namespace engine {
 	};
 
 
+	/********************************************
+	 *
+	 *  runtime-size small gemv & ger
+	 *
+	 *  (used when dimensions are not fixed at
+	 *   compile-time but are known to be tiny)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct small_gemv_rt
+	{
+		static void eval_n(const int m, const int n, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ x, const int incx,
+				const T beta, T* __restrict__ y, const int incy)
+		{
+			if (beta == 0)
+			{
+				for (int i = 0; i < m; ++i) y[i * incy] = T(0);
+			}
+			else if (beta != 1)
+			{
+				for (int i = 0; i < m; ++i) y[i * incy] *= beta;
+			}
+
+			for (int j = 0; j < n; ++j, a += lda)
+			{
+				const T xj = alpha * x[j * incx];
+				for (int i = 0; i < m; ++i) y[i * incy] += a[i] * xj;
+			}
+		}
+
+		static void eval_t(const int m, const int n, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ x, const int incx,
+				const T beta, T* __restrict__ y, const int incy)
+		{
+			for (int j = 0; j < n; ++j, a += lda)
+			{
+				T s(0);
+				for (int i = 0; i < m; ++i) s += a[i] * x[i * incx];
+
+				T& yj = y[j * incy];
+				yj = (beta == 0 ? alpha * s : beta * yj + alpha * s);
+			}
+		}
+	};
+
+
+	template<typename T>
+	struct small_ger_rt
+	{
+		static void eval(const int m, const int n, const T alpha,
+				const T* __restrict__ x, const int incx, const T* __restrict__ y, const int incy,
+				T *__restrict__ a, const int lda)
+		{
+			for (int j = 0; j < n; ++j, a += lda)
+			{
+				const T yj = alpha * y[j * incy];
+				for (int i = 0; i < m; ++i) a[i] += x[i * incx] * yj;
+			}
+		}
+	};
+
 
 } }
 
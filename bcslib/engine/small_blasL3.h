@@ -14,6 +14,7 @@
 #define BCSLIB_SMALL_BLASL3_H_
 
 #include "small_blasL2.h"
+#include "small_gemm_simd.h"
 
 namespace bcs { namespace engine {
 
@@ -623,6 +624,22 @@ namespace bcs { namespace engine {
 
 
 
+	template<typename T, int M, int N, int K,
+		bool UseSimd=small_gemm_simd_supported<T, M, N>::value>
+	struct small_gemm_MNK_impl
+	{
+		typedef small_gemm_MNK<T, M, N, K> type;
+	};
+
+#ifdef BCS_HAS_PACKET
+	template<typename T, int M, int N, int K>
+	struct small_gemm_MNK_impl<T, M, N, K, true>
+	{
+		typedef small_gemm_simd_MNK<T, M, N, K> type;
+	};
+#endif
+
+
 	template<typename T, int M, int N, int K>
 	struct small_gemm_ker
 	{
@@ -635,7 +652,7 @@ namespace bcs { namespace engine {
 						small_gemm_M1K<T, M, K>,
 						typename select_type<K == 1,
 							small_gemm_MN1<T, M, N>,
-							small_gemm_MNK<T, M, N, K>
+							typename small_gemm_MNK_impl<T, M, N, K>::type
 						>::type
 					>::type
 				>::type impl_t;
@@ -804,6 +821,108 @@ namespace bcs { namespace engine {
 	};
 
 
+	/********************************************
+	 *
+	 *  runtime-size small gemm
+	 *
+	 *  (used when dimensions are not fixed at
+	 *   compile-time but are known to be tiny)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct small_gemm_rt
+	{
+		static void eval_nn(const int m, const int n, const int k, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				const T beta,
+				T* __restrict__ c, const int ldc)
+		{
+			for (int j = 0; j < n; ++j, b += ldb, c += ldc)
+			{
+				scale_col(m, beta, c);
+
+				const T *a_u = a;
+				for (int u = 0; u < k; ++u, a_u += lda)
+				{
+					const T s = alpha * b[u];
+					for (int i = 0; i < m; ++i) c[i] += a_u[i] * s;
+				}
+			}
+		}
+
+		static void eval_nt(const int m, const int n, const int k, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				const T beta,
+				T* __restrict__ c, const int ldc)
+		{
+			for (int j = 0; j < n; ++j, ++b, c += ldc)
+			{
+				scale_col(m, beta, c);
+
+				const T *a_u = a;
+				for (int u = 0; u < k; ++u, a_u += lda)
+				{
+					const T s = alpha * b[u * ldb];
+					for (int i = 0; i < m; ++i) c[i] += a_u[i] * s;
+				}
+			}
+		}
+
+		static void eval_tn(const int m, const int n, const int k, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				const T beta,
+				T* __restrict__ c, const int ldc)
+		{
+			for (int j = 0; j < n; ++j, b += ldb, c += ldc)
+			{
+				const T *a_i = a;
+				for (int i = 0; i < m; ++i, a_i += lda)
+				{
+					T s(0);
+					for (int u = 0; u < k; ++u) s += a_i[u] * b[u];
+					c[i] = (beta == 0 ? alpha * s : beta * c[i] + alpha * s);
+				}
+			}
+		}
+
+		static void eval_tt(const int m, const int n, const int k, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				const T beta,
+				T* __restrict__ c, const int ldc)
+		{
+			for (int j = 0; j < n; ++j, ++b, c += ldc)
+			{
+				const T *a_i = a;
+				for (int i = 0; i < m; ++i, a_i += lda)
+				{
+					T s(0);
+					for (int u = 0; u < k; ++u) s += a_i[u] * b[u * ldb];
+					c[i] = (beta == 0 ? alpha * s : beta * c[i] + alpha * s);
+				}
+			}
+		}
+
+	private:
+		BCS_ENSURE_INLINE
+		static void scale_col(const int m, const T beta, T* __restrict__ c)
+		{
+			if (beta == 0)
+			{
+				for (int i = 0; i < m; ++i) c[i] = T(0);
+			}
+			else if (beta != 1)
+			{
+				for (int i = 0; i < m; ++i) c[i] *= beta;
+			}
+		}
+	};
+
+
 } }
 
 
@@ -0,0 +1,536 @@
+/**
+ * @file small_blas_batch.h
+ *
+ * Batched products of small fixed-size matrices
+ *
+ * A batch consists of many independent problems of the same
+ * (compile-time) size, given either as strided arrays (the p-th
+ * matrix starts at base + p * stride) or as arrays of pointers.
+ *
+ * Problems are processed in groups of W (the packet width of T):
+ * the W operands are interleaved into structure-of-arrays form
+ * (with in-register W x W transposes), such that each SIMD lane
+ * works on a different problem. When the per-problem kernels
+ * vectorize well by themselves (even M below 8), the problems are
+ * evaluated one by one instead. Either way, the batch is split
+ * among threads with parallel_for.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SMALL_BLAS_BATCH_H_
+#define BCSLIB_SMALL_BLAS_BATCH_H_
+
+#include "small_blasL3.h"
+
+#include <bcslib/core/packet.h>
+#include <bcslib/core/parallel.h>
+
+namespace bcs { namespace engine {
+
+	/********************************************
+	 *
+	 *  batch descriptors
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct strided_batch
+	{
+		T *base;
+		index_t stride;
+
+		strided_batch(T *b, const index_t s) : base(b), stride(s) { }
+
+		BCS_ENSURE_INLINE T* operator[] (const index_t p) const
+		{
+			return base + p * stride;
+		}
+	};
+
+	template<typename T>
+	struct ptr_array_batch
+	{
+		T* const *ptrs;
+
+		explicit ptr_array_batch(T* const *ps) : ptrs(ps) { }
+
+		BCS_ENSURE_INLINE T* operator[] (const index_t p) const
+		{
+			return ptrs[p];
+		}
+	};
+
+
+	namespace detail
+	{
+		/********************************************
+		 *
+		 *  per-problem evaluation
+		 *
+		 ********************************************/
+
+		template<typename T, int M, int N, int K, bool TA, bool TB> struct small_gemm_op;
+
+		template<typename T, int M, int N, int K>
+		struct small_gemm_op<T, M, N, K, false, false>
+		{
+			BCS_ENSURE_INLINE
+			static void eval_b0(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_nn_b0(alpha, a, lda, b, ldb, c, ldc);
+			}
+
+			BCS_ENSURE_INLINE
+			static void eval_b1(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_nn_b1(alpha, a, lda, b, ldb, c, ldc);
+			}
+		};
+
+		template<typename T, int M, int N, int K>
+		struct small_gemm_op<T, M, N, K, false, true>
+		{
+			BCS_ENSURE_INLINE
+			static void eval_b0(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_nt_b0(alpha, a, lda, b, ldb, c, ldc);
+			}
+
+			BCS_ENSURE_INLINE
+			static void eval_b1(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_nt_b1(alpha, a, lda, b, ldb, c, ldc);
+			}
+		};
+
+		template<typename T, int M, int N, int K>
+		struct small_gemm_op<T, M, N, K, true, false>
+		{
+			BCS_ENSURE_INLINE
+			static void eval_b0(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_tn_b0(alpha, a, lda, b, ldb, c, ldc);
+			}
+
+			BCS_ENSURE_INLINE
+			static void eval_b1(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_tn_b1(alpha, a, lda, b, ldb, c, ldc);
+			}
+		};
+
+		template<typename T, int M, int N, int K>
+		struct small_gemm_op<T, M, N, K, true, true>
+		{
+			BCS_ENSURE_INLINE
+			static void eval_b0(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_tt_b0(alpha, a, lda, b, ldb, c, ldc);
+			}
+
+			BCS_ENSURE_INLINE
+			static void eval_b1(const T alpha, const T* a, const int lda, const T* b, const int ldb,
+					T* c, const int ldc)
+			{
+				small_gemm_ker<T, M, N, K>::eval_tt_b1(alpha, a, lda, b, ldb, c, ldc);
+			}
+		};
+
+
+		/********************************************
+		 *
+		 *  interleaved (SoA) evaluation
+		 *
+		 *  The operands of W problems are stored
+		 *  in buffers as buf[e * W + l], where e is
+		 *  the offset of an element within a matrix
+		 *  (in storage order) and l is the problem.
+		 *
+		 ********************************************/
+
+#ifdef BCS_HAS_PACKET
+
+		// interleaves W matrices of size R x C (with leading dimension ld)
+		template<typename T, int R, int C>
+		BCS_ENSURE_INLINE
+		inline void soa_load(const T* const *s, const int ld, T* __restrict__ buf)
+		{
+			if (ld == R)
+			{
+				soa_load_run<T, R * C>(s, 0, buf);
+			}
+			else
+			{
+				for (int j = 0; j < C; ++j)
+					soa_load_run<T, R>(s, j * ld, buf + j * R * soa_block<T>::W);
+			}
+		}
+
+		template<typename T, int R, int C>
+		BCS_ENSURE_INLINE
+		inline void soa_store(const T* __restrict__ buf, T* const *d, const int ld)
+		{
+			if (ld == R)
+			{
+				soa_store_run<T, R * C>(buf, d, 0);
+			}
+			else
+			{
+				for (int j = 0; j < C; ++j)
+					soa_store_run<T, R>(buf + j * R * soa_block<T>::W, d, j * ld);
+			}
+		}
+
+
+		// c := alpha * op(a) * op(b) + beta * c, on interleaved operands
+		// (a and b are in storage order, i.e. K x M and N x K when transposed)
+
+		template<typename T, int M, int N, int K, bool TA, bool TB>
+		struct small_gemm_soa
+		{
+			typedef typename packet_traits<T>::type packet_t;
+			static const int W = soa_block<T>::W;
+
+			BCS_ENSURE_INLINE
+			static void eval(const T alpha, const T beta,
+					const T* __restrict__ a, const T* __restrict__ b, T* __restrict__ c)
+			{
+				const packet_t pa = simd::set1(alpha);
+				const packet_t pb = simd::set1(beta);
+
+				for (int j = 0; j < N; ++j)
+				{
+					packet_t bj[K];
+					for (int u = 0; u < K; ++u) bj[u] = simd::load(b + (TB ? j + u * N : u + j * K) * W);
+
+					for (int i = 0; i < M; ++i)
+					{
+						packet_t s = simd::mul(simd::load(a + (TA ? i * K : i) * W), bj[0]);
+						for (int u = 1; u < K; ++u)
+						{
+							s = simd::add(s, simd::mul(simd::load(a + (TA ? u + i * K : i + u * M) * W), bj[u]));
+						}
+
+						T *cij = c + (i + j * M) * W;
+						s = simd::mul(pa, s);
+						if (beta != 0) s = simd::add(s, simd::mul(pb, simd::load(cij)));
+						simd::store(cij, s);
+					}
+				}
+			}
+		};
+
+#endif
+
+		// processes the leading groups of W problems in [p, p1), and returns
+		// where it stops
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, int W>
+		struct small_gemm_soa_groups;
+
+		template<typename T, int M, int N, int K, bool TA, bool TB>
+		struct small_gemm_soa_groups<T, M, N, K, TA, TB, 1>
+		{
+			template<class BA, class BB, class BC>
+			BCS_ENSURE_INLINE
+			static index_t run(const index_t p, const index_t p1, const T alpha,
+					const BA& a, const int lda, const BB& b, const int ldb,
+					const T beta, const BC& c, const int ldc)
+			{
+				return p;
+			}
+		};
+
+#ifdef BCS_HAS_PACKET
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, int W>
+		struct small_gemm_soa_groups
+		{
+			template<class BA, class BB, class BC>
+			BCS_ENSURE_INLINE
+			static index_t run(index_t p, const index_t p1, const T alpha,
+					const BA& a, const int lda, const BB& b, const int ldb,
+					const T beta, const BC& c, const int ldc)
+			{
+				BCS_ALIGN(32) T bufa[M * K * W];
+				BCS_ALIGN(32) T bufb[K * N * W];
+				BCS_ALIGN(32) T bufc[M * N * W];
+
+				const T *pa[W];
+				const T *pb[W];
+				T *pc[W];
+
+				for (; p + W <= p1; p += W)
+				{
+					for (int l = 0; l < W; ++l)
+					{
+						pa[l] = a[p + l];
+						pb[l] = b[p + l];
+						pc[l] = c[p + l];
+					}
+
+					soa_load<T, (TA ? K : M), (TA ? M : K)>(pa, lda, bufa);
+					soa_load<T, (TB ? N : K), (TB ? K : N)>(pb, ldb, bufb);
+					if (beta != 0) soa_load<T, M, N>(pc, ldc, bufc);
+
+					small_gemm_soa<T, M, N, K, TA, TB>::eval(alpha, beta, bufa, bufb, bufc);
+
+					soa_store<T, M, N>(bufc, pc, ldc);
+				}
+				return p;
+			}
+		};
+
+#endif
+
+
+		// evaluates the problems in [p, p1) one by one (the loops for
+		// beta == 0 and beta != 0 are kept apart, so that each of them
+		// is optimized on its own)
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, class BA, class BB, class BC>
+		inline void small_gemm_each_b0(index_t p, const index_t p1, const T alpha,
+				const BA a, const int lda, const BB b, const int ldb, const BC c, const int ldc)
+		{
+			for (; p < p1; ++p)
+			{
+				small_gemm_op<T, M, N, K, TA, TB>::eval_b0(alpha, a[p], lda, b[p], ldb, c[p], ldc);
+			}
+		}
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, class BA, class BB, class BC>
+		inline void small_gemm_each_b1(index_t p, const index_t p1, const T alpha,
+				const BA a, const int lda, const BB b, const int ldb, const T beta, const BC c, const int ldc)
+		{
+			for (; p < p1; ++p)
+			{
+				T *cp = c[p];
+				if (beta != 1)
+				{
+					for (int j = 0; j < N; ++j) mul_ker<T, M>::eval(beta, cp + ldc * j);
+				}
+				small_gemm_op<T, M, N, K, TA, TB>::eval_b1(alpha, a[p], lda, b[p], ldb, cp, ldc);
+			}
+		}
+
+
+		// the per-problem kernels already vectorize well along columns of
+		// even height below 8, and win over the interleaved path there
+
+		template<typename T, int M>
+		struct small_gemm_batch_width
+		{
+			static const int value = (M % 2 == 1 || M >= 8) ? soa_width<T>::value : 1;
+		};
+
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, class BA, class BB, class BC>
+		struct small_gemm_batch_task
+		{
+			static const int W = small_gemm_batch_width<T, M>::value;
+			typedef small_gemm_soa_groups<T, M, N, K, TA, TB, W> groups_t;
+
+			T alpha;
+			T beta;
+			BA a; int lda;
+			BB b; int ldb;
+			BC c; int ldc;
+
+			small_gemm_batch_task(const T alpha_, const BA& a_, const int lda_,
+					const BB& b_, const int ldb_, const T beta_, const BC& c_, const int ldc_)
+			: alpha(alpha_), beta(beta_), a(a_), lda(lda_), b(b_), ldb(ldb_), c(c_), ldc(ldc_) { }
+
+			// processes the problems in [p0, p1)
+			static void run(const index_t p0, const index_t p1, const T alpha,
+					const BA& a, const int lda, const BB& b, const int ldb,
+					const T beta, const BC& c, const int ldc)
+			{
+				index_t p = groups_t::run(p0, p1, alpha, a, lda, b, ldb, beta, c, ldc);
+
+				if (beta == 0)
+					small_gemm_each_b0<T, M, N, K, TA, TB>(p, p1, alpha, a, lda, b, ldb, c, ldc);
+				else
+					small_gemm_each_b1<T, M, N, K, TA, TB>(p, p1, alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+
+			void operator() (const index_t p0, const index_t p1) const
+			{
+				run(p0, p1, alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+		};
+
+
+		template<class Task>
+		struct small_gemm_group_task
+		{
+			const Task& task;
+			index_t w;
+
+			small_gemm_group_task(const Task& t, const index_t w_) : task(t), w(w_) { }
+
+			void operator() (const index_t g0, const index_t g1) const
+			{
+				task(g0 * w, g1 * w);
+			}
+		};
+
+
+		template<typename T, int M, int N, int K, bool TA, bool TB, class BA, class BB, class BC>
+		inline void small_gemm_batch_run(const index_t nb, const T alpha,
+				const BA& a, const int lda, const BB& b, const int ldb,
+				const T beta, const BC& c, const int ldc)
+		{
+			typedef small_gemm_batch_task<T, M, N, K, TA, TB, BA, BB, BC> task_t;
+			const index_t W = task_t::W;
+
+			// split at group boundaries, with each thread taking at least
+			// one grain of multiply-adds
+
+			const index_t ng = nb / W;
+			index_t grain = get_parallel_grain() / (M * N * K * W);
+			if (grain < 1) grain = 1;
+
+			if (ng >= 2 * grain && use_parallel(nb * (M * N * K)))
+			{
+				task_t task(alpha, a, lda, b, ldb, beta, c, ldc);
+				parallel_for(0, ng, grain, small_gemm_group_task<task_t>(task, W));
+				task(ng * W, nb);
+			}
+			else
+			{
+				task_t::run(0, nb, alpha, a, lda, b, ldb, beta, c, ldc);
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  small_gemm_batch
+	 *
+	 *  C_p := alpha * op(A_p) * op(B_p) + beta * C_p,
+	 *  for p = 0, ..., nb - 1
+	 *
+	 *  (C_p is not read when beta == 0)
+	 *
+	 ********************************************/
+
+	template<typename T, int M, int N, int K>
+	struct small_gemm_batch
+	{
+		// strided batches
+
+		static void eval_nn(const index_t nb, const T alpha,
+				const T* a, const int lda, const index_t stride_a,
+				const T* b, const int ldb, const index_t stride_b,
+				const T beta,
+				T* c, const int ldc, const index_t stride_c)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, false, false>(nb, alpha,
+					strided_batch<const T>(a, stride_a), lda,
+					strided_batch<const T>(b, stride_b), ldb,
+					beta, strided_batch<T>(c, stride_c), ldc);
+		}
+
+		static void eval_nt(const index_t nb, const T alpha,
+				const T* a, const int lda, const index_t stride_a,
+				const T* b, const int ldb, const index_t stride_b,
+				const T beta,
+				T* c, const int ldc, const index_t stride_c)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, false, true>(nb, alpha,
+					strided_batch<const T>(a, stride_a), lda,
+					strided_batch<const T>(b, stride_b), ldb,
+					beta, strided_batch<T>(c, stride_c), ldc);
+		}
+
+		static void eval_tn(const index_t nb, const T alpha,
+				const T* a, const int lda, const index_t stride_a,
+				const T* b, const int ldb, const index_t stride_b,
+				const T beta,
+				T* c, const int ldc, const index_t stride_c)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, true, false>(nb, alpha,
+					strided_batch<const T>(a, stride_a), lda,
+					strided_batch<const T>(b, stride_b), ldb,
+					beta, strided_batch<T>(c, stride_c), ldc);
+		}
+
+		static void eval_tt(const index_t nb, const T alpha,
+				const T* a, const int lda, const index_t stride_a,
+				const T* b, const int ldb, const index_t stride_b,
+				const T beta,
+				T* c, const int ldc, const index_t stride_c)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, true, true>(nb, alpha,
+					strided_batch<const T>(a, stride_a), lda,
+					strided_batch<const T>(b, stride_b), ldb,
+					beta, strided_batch<T>(c, stride_c), ldc);
+		}
+
+		// pointer-array batches
+
+		static void eval_nn(const index_t nb, const T alpha,
+				const T* const *a, const int lda,
+				const T* const *b, const int ldb,
+				const T beta,
+				T* const *c, const int ldc)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, false, false>(nb, alpha,
+					ptr_array_batch<const T>(a), lda,
+					ptr_array_batch<const T>(b), ldb,
+					beta, ptr_array_batch<T>(c), ldc);
+		}
+
+		static void eval_nt(const index_t nb, const T alpha,
+				const T* const *a, const int lda,
+				const T* const *b, const int ldb,
+				const T beta,
+				T* const *c, const int ldc)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, false, true>(nb, alpha,
+					ptr_array_batch<const T>(a), lda,
+					ptr_array_batch<const T>(b), ldb,
+					beta, ptr_array_batch<T>(c), ldc);
+		}
+
+		static void eval_tn(const index_t nb, const T alpha,
+				const T* const *a, const int lda,
+				const T* const *b, const int ldb,
+				const T beta,
+				T* const *c, const int ldc)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, true, false>(nb, alpha,
+					ptr_array_batch<const T>(a), lda,
+					ptr_array_batch<const T>(b), ldb,
+					beta, ptr_array_batch<T>(c), ldc);
+		}
+
+		static void eval_tt(const index_t nb, const T alpha,
+				const T* const *a, const int lda,
+				const T* const *b, const int ldb,
+				const T beta,
+				T* const *c, const int ldc)
+		{
+			detail::small_gemm_batch_run<T, M, N, K, true, true>(nb, alpha,
+					ptr_array_batch<const T>(a), lda,
+					ptr_array_batch<const T>(b), ldb,
+					beta, ptr_array_batch<T>(c), ldc);
+		}
+	};
+
+} }
+
+#endif /* BCSLIB_SMALL_BLAS_BATCH_H_ */
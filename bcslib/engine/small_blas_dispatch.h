@@ -0,0 +1,378 @@
+/**
+ * @file small_blas_dispatch.h
+ *
+ * Dispatch of runtime dimensions to the fixed-size small kernels
+ *
+ * When the dimensions of a tiny product are only known at runtime
+ * and all lie within [1, BCS_SMALL_BLAS_MAX_RTDIM], the product is
+ * dispatched through a jump table (built at the first use) on the
+ * number of rows M to a kernel specialized on it, which loops over
+ * the other dimensions at runtime:
+ *
+ * - gemm keeps M x 4 tiles of C in registers (small_gemm_simd_tile
+ *   where available), running over the inner dimension;
+ * - gemv and ger run fixed-length small_axpy / small_dot over the
+ *   columns of A.
+ *
+ * (Tables over all of (M, N, K) would instantiate D^2 or D^3
+ * kernels for each type and transposition in every translation
+ * unit that uses them, which takes too long to compile.)
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SMALL_BLAS_DISPATCH_H_
+#define BCSLIB_SMALL_BLAS_DISPATCH_H_
+
+#include <bcslib/engine/small_blasL3.h>
+
+// the maximum runtime dimension dispatched to the fixed-size small kernels
+#ifndef BCS_SMALL_BLAS_MAX_RTDIM
+#define BCS_SMALL_BLAS_MAX_RTDIM 8
+#endif
+
+namespace bcs { namespace engine {
+
+	const int SmallBlasMaxRtDim = BCS_SMALL_BLAS_MAX_RTDIM;
+
+	BCS_ENSURE_INLINE
+	inline bool in_small_dispatch_range(const int m, const int n, const int k=1)
+	{
+		return m >= 1 && m <= SmallBlasMaxRtDim &&
+				n >= 1 && n <= SmallBlasMaxRtDim &&
+				k >= 1 && k <= SmallBlasMaxRtDim;
+	}
+
+
+	namespace detail
+	{
+		/********************************************
+		 *
+		 *  gemm tiles
+		 *
+		 ********************************************/
+
+		// generic (scalar) tile, with the same interface as small_gemm_simd_tile
+
+		template<typename T, int M, int N>
+		struct small_gemm_scalar_tile
+		{
+			template<bool Acc>
+			BCS_ENSURE_INLINE
+			static void run(const int k, const T alpha,
+					const T* __restrict__ a, const int lda,
+					const T* __restrict__ b, const int bu, const int bj,
+					T* __restrict__ c, const int ldc)
+			{
+				T acc[M * N];
+
+				for (int j = 0; j < N; ++j)
+				{
+					const T bv = b[j * bj];
+					for (int i = 0; i < M; ++i) acc[i + j * M] = a[i] * bv;
+				}
+
+				for (int u = 1; u < k; ++u)
+				{
+					const T *au = a + u * lda;
+					for (int j = 0; j < N; ++j)
+					{
+						const T bv = b[u * bu + j * bj];
+						for (int i = 0; i < M; ++i) acc[i + j * M] += au[i] * bv;
+					}
+				}
+
+				for (int j = 0; j < N; ++j)
+				{
+					T *cj = c + j * ldc;
+					for (int i = 0; i < M; ++i)
+						cj[i] = Acc ? cj[i] + alpha * acc[i + j * M] : alpha * acc[i + j * M];
+				}
+			}
+		};
+
+		template<typename T, int M, int N, bool UseSimd=small_gemm_simd_supported<T, M, N>::value>
+		struct small_gemm_tile_of
+		{
+			typedef small_gemm_scalar_tile<T, M, N> type;
+		};
+
+#ifdef BCS_HAS_PACKET
+		template<typename T, int M, int N>
+		struct small_gemm_tile_of<T, M, N, true>
+		{
+			typedef small_gemm_simd_tile<T, M, N> type;
+		};
+#endif
+
+
+		/********************************************
+		 *
+		 *  kernels specialized on M
+		 *
+		 ********************************************/
+
+		template<typename T, int M, bool TA, bool TB>
+		struct small_gemm_m
+		{
+			static const int NB = 4;
+
+			static void eval(const int n, const int k, const T alpha,
+					const T *a, const int lda, const T *b, const int ldb,
+					const T beta, T *c, const int ldc)
+			{
+				T at[TA ? M * SmallBlasMaxRtDim : 1];
+				if (TA)
+				{
+					for (int i = 0; i < M; ++i)
+						for (int u = 0; u < k; ++u) at[i + u * M] = a[u + i * lda];
+					a = at;
+				}
+
+				const int la = TA ? M : lda;
+				const int bu = TB ? ldb : 1;
+				const int bj = TB ? 1 : ldb;
+
+				if (beta == 0)
+				{
+					run<false>(n, k, alpha, a, la, b, bu, bj, c, ldc);
+				}
+				else
+				{
+					if (beta != 1)
+					{
+						for (int j = 0; j < n; ++j) mul_ker<T, M>::eval(beta, c + ldc * j);
+					}
+					run<true>(n, k, alpha, a, la, b, bu, bj, c, ldc);
+				}
+			}
+
+		private:
+			template<bool Acc>
+			BCS_ENSURE_INLINE
+			static void run(const int n, const int k, const T alpha,
+					const T *a, const int la, const T *b, const int bu, const int bj,
+					T *c, const int ldc)
+			{
+				typedef typename small_gemm_tile_of<T, M, NB>::type tile_t;
+				typedef typename small_gemm_tile_of<T, M, 1>::type tile1_t;
+
+				int j = 0;
+				for (; j + NB <= n; j += NB)
+				{
+					tile_t::template run<Acc>(k, alpha, a, la, b + j * bj, bu, bj, c + j * ldc, ldc);
+				}
+				for (; j < n; ++j)
+				{
+					tile1_t::template run<Acc>(k, alpha, a, la, b + j * bj, bu, bj, c + j * ldc, ldc);
+				}
+			}
+		};
+
+
+		template<typename T, int M, bool Trans>
+		struct small_gemv_m;
+
+		// y := alpha * A * x + beta * y, with A: M x n
+
+		template<typename T, int M>
+		struct small_gemv_m<T, M, false>
+		{
+			static void eval(const int n, const T alpha, const T *a, const int lda,
+					const T *x, const int incx, const T beta, T *y, const int incy)
+			{
+				if (beta == 0)
+				{
+					for (int i = 0; i < M; ++i) y[i * incy] = T(0);
+				}
+				else if (beta != 1)
+				{
+					for (int i = 0; i < M; ++i) y[i * incy] *= beta;
+				}
+
+				for (int j = 0; j < n; ++j)
+				{
+					small_axpy<T, M>::eval(alpha * x[j * incx], a + j * lda, 1, y, incy);
+				}
+			}
+		};
+
+		// y := alpha * A' * x + beta * y, with A: M x n
+
+		template<typename T, int M>
+		struct small_gemv_m<T, M, true>
+		{
+			static void eval(const int n, const T alpha, const T *a, const int lda,
+					const T *x, const int incx, const T beta, T *y, const int incy)
+			{
+				for (int j = 0; j < n; ++j)
+				{
+					const T s = small_dot<T, M>::eval(a + j * lda, 1, x, incx);
+
+					T& yj = y[j * incy];
+					yj = (beta == 0 ? alpha * s : beta * yj + alpha * s);
+				}
+			}
+		};
+
+		// A += alpha * x * y', with A: M x n
+
+		template<typename T, int M>
+		struct small_ger_m
+		{
+			static void eval(const int n, const T alpha, const T *x, const int incx,
+					const T *y, const int incy, T *a, const int lda)
+			{
+				for (int j = 0; j < n; ++j)
+				{
+					small_axpy<T, M>::eval(alpha * y[j * incy], x, incx, a + j * lda, 1);
+				}
+			}
+		};
+
+
+		/********************************************
+		 *
+		 *  tables (entry m - 1 for M = m)
+		 *
+		 ********************************************/
+
+		template<class Policy, int M>
+		struct small_table_fill
+		{
+			static void run(typename Policy::fn_t *tab)
+			{
+				tab[M - 1] = Policy::template entry<M>::get();
+				small_table_fill<Policy, M - 1>::run(tab);
+			}
+		};
+
+		template<class Policy>
+		struct small_table_fill<Policy, 0>
+		{
+			static void run(typename Policy::fn_t *) { }
+		};
+
+		template<class Policy>
+		struct small_table
+		{
+			typename Policy::fn_t fns[SmallBlasMaxRtDim];
+
+			small_table()
+			{
+				small_table_fill<Policy, SmallBlasMaxRtDim>::run(fns);
+			}
+
+			static typename Policy::fn_t get(const int m)
+			{
+				static small_table tab;
+				return tab.fns[m - 1];
+			}
+		};
+
+
+		template<typename T, bool TA, bool TB>
+		struct small_gemm_policy
+		{
+			typedef void (*fn_t)(const int n, const int k, const T alpha,
+					const T *a, const int lda, const T *b, const int ldb,
+					const T beta, T *c, const int ldc);
+
+			template<int M>
+			struct entry
+			{
+				static fn_t get() { return &small_gemm_m<T, M, TA, TB>::eval; }
+			};
+		};
+
+		template<typename T, bool Trans>
+		struct small_gemv_policy
+		{
+			typedef void (*fn_t)(const int n, const T alpha, const T *a, const int lda,
+					const T *x, const int incx, const T beta, T *y, const int incy);
+
+			template<int M>
+			struct entry
+			{
+				static fn_t get() { return &small_gemv_m<T, M, Trans>::eval; }
+			};
+		};
+
+		template<typename T>
+		struct small_ger_policy
+		{
+			typedef void (*fn_t)(const int n, const T alpha, const T *x, const int incx,
+					const T *y, const int incy, T *a, const int lda);
+
+			template<int M>
+			struct entry
+			{
+				static fn_t get() { return &small_ger_m<T, M>::eval; }
+			};
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  dispatchers
+	 *
+	 *  (the dimensions must satisfy
+	 *   in_small_dispatch_range)
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct small_gemm_dispatch
+	{
+		static void eval(const bool ta, const bool tb, const int m, const int n, const int k,
+				const T alpha, const T *a, const int lda, const T *b, const int ldb,
+				const T beta, T *c, const int ldc)
+		{
+			using detail::small_table;
+			using detail::small_gemm_policy;
+
+			typename small_gemm_policy<T, false, false>::fn_t f = ta ?
+					(tb ? small_table<small_gemm_policy<T, true, true> >::get(m) :
+						  small_table<small_gemm_policy<T, true, false> >::get(m)) :
+					(tb ? small_table<small_gemm_policy<T, false, true> >::get(m) :
+						  small_table<small_gemm_policy<T, false, false> >::get(m));
+
+			f(n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		}
+	};
+
+	template<typename T>
+	struct small_gemv_dispatch
+	{
+		static void eval(const bool trans, const int m, const int n,
+				const T alpha, const T *a, const int lda, const T *x, const int incx,
+				const T beta, T *y, const int incy)
+		{
+			using detail::small_table;
+			using detail::small_gemv_policy;
+
+			typename small_gemv_policy<T, false>::fn_t f = trans ?
+					small_table<small_gemv_policy<T, true> >::get(m) :
+					small_table<small_gemv_policy<T, false> >::get(m);
+
+			f(n, alpha, a, lda, x, incx, beta, y, incy);
+		}
+	};
+
+	template<typename T>
+	struct small_ger_dispatch
+	{
+		static void eval(const int m, const int n,
+				const T alpha, const T *x, const int incx, const T *y, const int incy,
+				T *a, const int lda)
+		{
+			detail::small_table<detail::small_ger_policy<T> >::get(m)(n, alpha, x, incx, y, incy, a, lda);
+		}
+	};
+
+} }
+
+#endif
@@ -0,0 +1,432 @@
+/**
+ * @file small_gemm_simd.h
+ *
+ * Register-blocked SIMD micro-kernels for small matrix products
+ *
+ * For M in {2, 3, 4, 8} and N <= 8, the whole M x N tile of C
+ * is kept in registers (as N column registers) while the K
+ * columns of op(A) and rows of op(B) are streamed through once:
+ *
+ *   c_j += a_u * b(u, j),   for u = 0, ..., K-1
+ *
+ * C is only touched when the tile is written back.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SMALL_GEMM_SIMD_H_
+#define BCSLIB_SMALL_GEMM_SIMD_H_
+
+#include <bcslib/core/packet.h>
+
+namespace bcs { namespace engine {
+
+	template<typename T, int M>
+	struct small_simd_col
+	{
+		static const bool supported = false;
+	};
+
+	template<typename T, int M, int N>
+	struct small_gemm_simd_supported
+	{
+		static const bool value = small_simd_col<T, M>::supported && N <= 8;
+	};
+
+
+#ifdef BCS_HAS_PACKET
+
+	/********************************************
+	 *
+	 *  column registers
+	 *
+	 *  small_simd_col<T, M> holds a column of
+	 *  M elements (loaded from / stored to
+	 *  contiguous, possibly unaligned memory)
+	 *
+	 ********************************************/
+
+	// double
+
+	template<>
+	struct small_simd_col<double, 2>
+	{
+		static const bool supported = true;
+		__m128d v;
+
+		BCS_ENSURE_INLINE void load(const double *p) { v = _mm_loadu_pd(p); }
+		BCS_ENSURE_INLINE void store(double *p) const { _mm_storeu_pd(p, v); }
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const double s)
+		{
+			v = _mm_mul_pd(a.v, _mm_set1_pd(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const double s)
+		{
+			v = _mm_add_pd(v, _mm_mul_pd(a.v, _mm_set1_pd(s)));
+		}
+	};
+
+	template<>
+	struct small_simd_col<double, 3>
+	{
+		static const bool supported = true;
+		__m128d v0;
+		__m128d v1;  // only the lower lane is used
+
+		BCS_ENSURE_INLINE void load(const double *p)
+		{
+			v0 = _mm_loadu_pd(p);
+			v1 = _mm_load_sd(p + 2);
+		}
+
+		BCS_ENSURE_INLINE void store(double *p) const
+		{
+			_mm_storeu_pd(p, v0);
+			_mm_store_sd(p + 2, v1);
+		}
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const double s)
+		{
+			const __m128d ps = _mm_set1_pd(s);
+			v0 = _mm_mul_pd(a.v0, ps);
+			v1 = _mm_mul_sd(a.v1, ps);
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const double s)
+		{
+			const __m128d ps = _mm_set1_pd(s);
+			v0 = _mm_add_pd(v0, _mm_mul_pd(a.v0, ps));
+			v1 = _mm_add_sd(v1, _mm_mul_sd(a.v1, ps));
+		}
+	};
+
+	// float
+
+	template<>
+	struct small_simd_col<float, 2>
+	{
+		static const bool supported = true;
+		__m128 v;  // only the lower two lanes are used
+
+		BCS_ENSURE_INLINE void load(const float *p)
+		{
+			v = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+		}
+
+		BCS_ENSURE_INLINE void store(float *p) const
+		{
+			_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+		}
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const float s)
+		{
+			v = _mm_mul_ps(a.v, _mm_set1_ps(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const float s)
+		{
+			v = _mm_add_ps(v, _mm_mul_ps(a.v, _mm_set1_ps(s)));
+		}
+	};
+
+	template<>
+	struct small_simd_col<float, 3>
+	{
+		static const bool supported = true;
+		__m128 v;  // only the lower three lanes are used
+
+		BCS_ENSURE_INLINE void load(const float *p)
+		{
+			__m128 lo = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+			v = _mm_movelh_ps(lo, _mm_load_ss(p + 2));
+		}
+
+		BCS_ENSURE_INLINE void store(float *p) const
+		{
+			_mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+			_mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+		}
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const float s)
+		{
+			v = _mm_mul_ps(a.v, _mm_set1_ps(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const float s)
+		{
+			v = _mm_add_ps(v, _mm_mul_ps(a.v, _mm_set1_ps(s)));
+		}
+	};
+
+	template<>
+	struct small_simd_col<float, 4>
+	{
+		static const bool supported = true;
+		__m128 v;
+
+		BCS_ENSURE_INLINE void load(const float *p) { v = _mm_loadu_ps(p); }
+		BCS_ENSURE_INLINE void store(float *p) const { _mm_storeu_ps(p, v); }
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const float s)
+		{
+			v = _mm_mul_ps(a.v, _mm_set1_ps(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const float s)
+		{
+			v = _mm_add_ps(v, _mm_mul_ps(a.v, _mm_set1_ps(s)));
+		}
+	};
+
+
+	// a column made of two halves
+
+	template<typename T, int M>
+	struct small_simd_col_pair
+	{
+		static const bool supported = true;
+		small_simd_col<T, M/2> lo;
+		small_simd_col<T, M/2> hi;
+
+		BCS_ENSURE_INLINE void load(const T *p)
+		{
+			lo.load(p);
+			hi.load(p + M/2);
+		}
+
+		BCS_ENSURE_INLINE void store(T *p) const
+		{
+			lo.store(p);
+			hi.store(p + M/2);
+		}
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col_pair& a, const T s)
+		{
+			lo.mul(a.lo, s);
+			hi.mul(a.hi, s);
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col_pair& a, const T s)
+		{
+			lo.madd(a.lo, s);
+			hi.madd(a.hi, s);
+		}
+	};
+
+
+#ifdef BCS_HAS_PACKET_AVX
+
+	template<>
+	struct small_simd_col<double, 4>
+	{
+		static const bool supported = true;
+		__m256d v;
+
+		BCS_ENSURE_INLINE void load(const double *p) { v = _mm256_loadu_pd(p); }
+		BCS_ENSURE_INLINE void store(double *p) const { _mm256_storeu_pd(p, v); }
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const double s)
+		{
+			v = _mm256_mul_pd(a.v, _mm256_set1_pd(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const double s)
+		{
+			v = _mm256_add_pd(v, _mm256_mul_pd(a.v, _mm256_set1_pd(s)));
+		}
+	};
+
+	template<>
+	struct small_simd_col<float, 8>
+	{
+		static const bool supported = true;
+		__m256 v;
+
+		BCS_ENSURE_INLINE void load(const float *p) { v = _mm256_loadu_ps(p); }
+		BCS_ENSURE_INLINE void store(float *p) const { _mm256_storeu_ps(p, v); }
+
+		BCS_ENSURE_INLINE void mul(const small_simd_col& a, const float s)
+		{
+			v = _mm256_mul_ps(a.v, _mm256_set1_ps(s));
+		}
+
+		BCS_ENSURE_INLINE void madd(const small_simd_col& a, const float s)
+		{
+			v = _mm256_add_ps(v, _mm256_mul_ps(a.v, _mm256_set1_ps(s)));
+		}
+	};
+
+#else
+
+	template<>
+	struct small_simd_col<double, 4> : public small_simd_col_pair<double, 4> { };
+
+	template<>
+	struct small_simd_col<float, 8> : public small_simd_col_pair<float, 8> { };
+
+#endif
+
+	template<>
+	struct small_simd_col<double, 8> : public small_simd_col_pair<double, 8> { };
+
+
+	/********************************************
+	 *
+	 *  micro-kernel
+	 *
+	 ********************************************/
+
+	template<typename T, int M, int N>
+	struct small_gemm_simd_tile
+	{
+		typedef small_simd_col<T, M> col_t;
+
+		// c := alpha * A * op(B) (+ c if Acc), where A is M x k (k >= 1)
+		// with leading dimension lda, and op(B)(u, j) = b[u * bu + j * bj]
+
+		template<bool Acc>
+		BCS_ENSURE_INLINE
+		static void run(const int k, const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int bu, const int bj,
+				T* __restrict__ c, const int ldc)
+		{
+			col_t acc[N];
+			col_t au;
+
+			au.load(a);
+			for (int j = 0; j < N; ++j) acc[j].mul(au, b[j * bj]);
+
+			for (int u = 1; u < k; ++u)
+			{
+				au.load(a + u * lda);
+				for (int j = 0; j < N; ++j) acc[j].madd(au, b[u * bu + j * bj]);
+			}
+
+			for (int j = 0; j < N; ++j)
+			{
+				T *cj = c + j * ldc;
+				col_t r;
+
+				if (Acc)
+				{
+					r.load(cj);
+					r.madd(acc[j], alpha);
+				}
+				else
+				{
+					r.mul(acc[j], alpha);
+				}
+				r.store(cj);
+			}
+		}
+
+		// at[i + u * M] := a[u + i * lda]
+		BCS_ENSURE_INLINE
+		static void transpose_a(const int k, const T* __restrict__ a, const int lda, T* __restrict__ at)
+		{
+			for (int i = 0; i < M; ++i)
+			{
+				for (int u = 0; u < k; ++u) at[i + u * M] = a[u + i * lda];
+			}
+		}
+	};
+
+
+	template<typename T, int M, int N, int K>
+	struct small_gemm_simd_MNK  // (M x K) * (K x N), with C held in registers
+	{
+		typedef small_gemm_simd_tile<T, M, N> ker_t;
+
+		BCS_ENSURE_INLINE
+		static void eval_nn_b0(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			ker_t::template run<false>(K, alpha, a, lda, b, 1, ldb, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_nn_b1(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			ker_t::template run<true>(K, alpha, a, lda, b, 1, ldb, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_nt_b0(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			ker_t::template run<false>(K, alpha, a, lda, b, ldb, 1, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_nt_b1(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			ker_t::template run<true>(K, alpha, a, lda, b, ldb, 1, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_tn_b0(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			T at[M * K];
+			ker_t::transpose_a(K, a, lda, at);
+			ker_t::template run<false>(K, alpha, at, M, b, 1, ldb, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_tn_b1(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			T at[M * K];
+			ker_t::transpose_a(K, a, lda, at);
+			ker_t::template run<true>(K, alpha, at, M, b, 1, ldb, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_tt_b0(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			T at[M * K];
+			ker_t::transpose_a(K, a, lda, at);
+			ker_t::template run<false>(K, alpha, at, M, b, ldb, 1, c, ldc);
+		}
+
+		BCS_ENSURE_INLINE
+		static void eval_tt_b1(const T alpha,
+				const T* __restrict__ a, const int lda,
+				const T* __restrict__ b, const int ldb,
+				T* __restrict__ c, const int ldc)
+		{
+			T at[M * K];
+			ker_t::transpose_a(K, a, lda, at);
+			ker_t::template run<true>(K, alpha, at, M, b, ldb, 1, c, ldc);
+		}
+	};
+
+#endif
+
+} }
+
+#endif
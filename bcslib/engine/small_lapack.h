@@ -0,0 +1,599 @@
+/**
+ * @file small_lapack.h
+ *
+ * Factorizations and solvers for small fixed-size matrices
+ *
+ * The routines follow the LAPACK conventions (column-major storage
+ * with a leading dimension, and an info code that is zero on success),
+ * except that pivot indices are zero-based. All loops have compile-time
+ * bounds, and the per-column steps of the pivoted factorizations are
+ * unrolled with templates, such that the whole factorization is
+ * straight-line code (row interchanges are done with selects).
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SMALL_LAPACK_H_
+#define BCSLIB_SMALL_LAPACK_H_
+
+#include "small_blasL3.h"
+#include <cmath>
+
+namespace bcs { namespace engine {
+
+	namespace detail
+	{
+		/********************************************
+		 *
+		 *  substitution steps
+		 *
+		 *  (unrolled at compile time, such that every
+		 *   inner loop has a constant trip count)
+		 *
+		 ********************************************/
+
+		// x := inv(L) * x, on column J
+
+		template<typename T, int N, bool Unit, int J>
+		struct small_trsv_ln_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x)
+			{
+				const T *aj = a + J * lda;
+				if (!Unit) x[J] *= r[J];
+
+				const T xj = x[J];
+				for (int i = J + 1; i < N; ++i) x[i] -= aj[i] * xj;
+
+				small_trsv_ln_step<T, N, Unit, J + 1>::run(a, lda, r, x);
+			}
+		};
+
+		template<typename T, int N, bool Unit>
+		struct small_trsv_ln_step<T, N, Unit, N>
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x) { }
+		};
+
+		// x := inv(L') * x, on row J
+
+		template<typename T, int N, bool Unit, int J>
+		struct small_trsv_lt_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x)
+			{
+				const T *aj = a + J * lda;
+
+				T s = x[J];
+				for (int i = J + 1; i < N; ++i) s -= aj[i] * x[i];
+				x[J] = Unit ? s : s * r[J];
+
+				small_trsv_lt_step<T, N, Unit, J - 1>::run(a, lda, r, x);
+			}
+		};
+
+		template<typename T, int N, bool Unit>
+		struct small_trsv_lt_step<T, N, Unit, -1>
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x) { }
+		};
+
+		// x := inv(U) * x, on column J
+
+		template<typename T, int N, bool Unit, int J>
+		struct small_trsv_un_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x)
+			{
+				const T *aj = a + J * lda;
+				if (!Unit) x[J] *= r[J];
+
+				const T xj = x[J];
+				for (int i = 0; i < J; ++i) x[i] -= aj[i] * xj;
+
+				small_trsv_un_step<T, N, Unit, J - 1>::run(a, lda, r, x);
+			}
+		};
+
+		template<typename T, int N, bool Unit>
+		struct small_trsv_un_step<T, N, Unit, -1>
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x) { }
+		};
+
+		// x := inv(U') * x, on row J
+
+		template<typename T, int N, bool Unit, int J>
+		struct small_trsv_ut_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x)
+			{
+				const T *aj = a + J * lda;
+
+				T s = x[J];
+				for (int i = 0; i < J; ++i) s -= aj[i] * x[i];
+				x[J] = Unit ? s : s * r[J];
+
+				small_trsv_ut_step<T, N, Unit, J + 1>::run(a, lda, r, x);
+			}
+		};
+
+		template<typename T, int N, bool Unit>
+		struct small_trsv_ut_step<T, N, Unit, N>
+		{
+			BCS_ENSURE_INLINE
+			static void run(const T* __restrict__ a, const int lda, const T* __restrict__ r, T* __restrict__ x) { }
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  small triangular solve
+	 *
+	 ********************************************/
+
+	template<typename T, int N>
+	struct small_trsv
+	{
+		// the reciprocals of the diagonal are computed up front, such that
+		// the divisions are off the dependency chain of the substitution
+		// (they are all ones, and unused, for a unit diagonal)
+
+		template<bool Unit>
+		BCS_ENSURE_INLINE
+		static void diag_recip(const T* __restrict__ a, const int lda, T* __restrict__ r)
+		{
+			for (int j = 0; j < N; ++j) r[j] = Unit ? T(1) : T(1) / a[j + j * lda];
+		}
+
+		// x := inv(L) * x
+
+		template<bool Unit>
+		BCS_ENSURE_INLINE
+		static void eval_ln(const T* __restrict__ a, const int lda, T* __restrict__ x)
+		{
+			T r[N];
+			diag_recip<Unit>(a, lda, r);
+			detail::small_trsv_ln_step<T, N, Unit, 0>::run(a, lda, r, x);
+		}
+
+		// x := inv(L') * x
+
+		template<bool Unit>
+		BCS_ENSURE_INLINE
+		static void eval_lt(const T* __restrict__ a, const int lda, T* __restrict__ x)
+		{
+			T r[N];
+			diag_recip<Unit>(a, lda, r);
+			detail::small_trsv_lt_step<T, N, Unit, N - 1>::run(a, lda, r, x);
+		}
+
+		// x := inv(U) * x
+
+		template<bool Unit>
+		BCS_ENSURE_INLINE
+		static void eval_un(const T* __restrict__ a, const int lda, T* __restrict__ x)
+		{
+			T r[N];
+			diag_recip<Unit>(a, lda, r);
+			detail::small_trsv_un_step<T, N, Unit, N - 1>::run(a, lda, r, x);
+		}
+
+		// x := inv(U') * x
+
+		template<bool Unit>
+		BCS_ENSURE_INLINE
+		static void eval_ut(const T* __restrict__ a, const int lda, T* __restrict__ x)
+		{
+			T r[N];
+			diag_recip<Unit>(a, lda, r);
+			detail::small_trsv_ut_step<T, N, Unit, 0>::run(a, lda, r, x);
+		}
+
+		// with the same flags as BLAS trsv
+
+		inline
+		static void eval(const char uplo, const char trans, const char diag,
+				const T* __restrict__ a, const int lda, T* __restrict__ x)
+		{
+			const bool lower = (uplo == 'L' || uplo == 'l');
+			const bool tr = (trans != 'N' && trans != 'n');
+
+			if (diag == 'U' || diag == 'u')
+			{
+				if (lower)
+				{
+					if (tr) eval_lt<true>(a, lda, x); else eval_ln<true>(a, lda, x);
+				}
+				else
+				{
+					if (tr) eval_ut<true>(a, lda, x); else eval_un<true>(a, lda, x);
+				}
+			}
+			else
+			{
+				if (lower)
+				{
+					if (tr) eval_lt<false>(a, lda, x); else eval_ln<false>(a, lda, x);
+				}
+				else
+				{
+					if (tr) eval_ut<false>(a, lda, x); else eval_un<false>(a, lda, x);
+				}
+			}
+		}
+	};
+
+
+	namespace detail
+	{
+		/********************************************
+		 *
+		 *  factorization kernels
+		 *
+		 *  (the column steps are unrolled at compile
+		 *   time, as for the substitutions)
+		 *
+		 ********************************************/
+
+		// one column step of the lower Cholesky factorization, on column J
+		// (in place, only the lower part is used)
+
+		template<typename T, int N, int J>
+		struct small_chol_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ l, const int ldl, int& info)
+			{
+				T *lj = l + J * ldl;
+
+				// left-looking: column J is updated with the finished columns
+				for (int k = 0; k < J; ++k)
+				{
+					const T *lk = l + k * ldl;
+					const T v = lk[J];
+					for (int i = J; i < N; ++i) lj[i] -= lk[i] * v;
+				}
+
+				const T d = lj[J];
+				if (!(d > T(0)) && info == 0) info = J + 1;
+
+				lj[J] = std::sqrt(d);
+				const T r = T(1) / lj[J];
+				for (int i = J + 1; i < N; ++i) lj[i] *= r;
+
+				small_chol_step<T, N, J + 1>::run(l, ldl, info);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_chol_step<T, N, N>
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ l, const int ldl, int& info) { }
+		};
+
+
+		template<typename T, int N>
+		struct small_chol_ker
+		{
+			// lower Cholesky factor, in which the factorization runs to the end
+			// without branching (the factor is garbage if a non-positive pivot
+			// was met)
+
+			BCS_ENSURE_INLINE
+			static int factor(T* __restrict__ l, const int ldl)
+			{
+				int info = 0;
+				small_chol_step<T, N, 0>::run(l, ldl, info);
+				return info;
+			}
+		};
+
+
+		// one column step of LU with partial pivoting, on column J
+
+		template<typename T, int N, int J>
+		struct small_lu_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ f, const int ldf, int* __restrict__ ipiv, int& info)
+			{
+				T *fj = f + J * ldf;
+
+				int p = J;
+				T vmax = std::fabs(fj[J]);
+				for (int i = J + 1; i < N; ++i)
+				{
+					const T v = std::fabs(fj[i]);
+					if (v > vmax) { vmax = v; p = i; }
+				}
+				ipiv[J] = p;
+
+				// row interchange, with selects over the candidate rows
+				for (int i = J + 1; i < N; ++i)
+				{
+					const bool s = (i == p);
+					for (int k = 0; k < N; ++k)
+					{
+						const T u = f[J + k * ldf];
+						const T v = f[i + k * ldf];
+						f[J + k * ldf] = s ? v : u;
+						f[i + k * ldf] = s ? u : v;
+					}
+				}
+
+				// an exactly zero pivot comes with an all-zero column below it
+				const bool zp = (fj[J] == T(0));
+				if (zp && info == 0) info = J + 1;
+
+				const T r = zp ? T(0) : T(1) / fj[J];
+				for (int i = J + 1; i < N; ++i) fj[i] *= r;
+
+				for (int k = J + 1; k < N; ++k)
+				{
+					T *fk = f + k * ldf;
+					const T v = fk[J];
+					for (int i = J + 1; i < N; ++i) fk[i] -= fj[i] * v;
+				}
+
+				small_lu_step<T, N, J + 1>::run(f, ldf, ipiv, info);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_lu_step<T, N, N>
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ f, const int ldf, int* __restrict__ ipiv, int& info) { }
+		};
+
+
+		template<typename T, int N>
+		struct small_lu_ker
+		{
+			// LU with partial pivoting (in place), in which the factorization
+			// runs to the end even when an exactly zero pivot is met
+
+			BCS_ENSURE_INLINE
+			static int factor(T* __restrict__ f, const int ldf, int* __restrict__ ipiv)
+			{
+				int info = 0;
+				small_lu_step<T, N, 0>::run(f, ldf, ipiv, info);
+				return info;
+			}
+
+			// x := inv(A) * x, given the factors
+			BCS_ENSURE_INLINE
+			static void solve(const T* __restrict__ f, const int ldf, const int* __restrict__ ipiv,
+					T* __restrict__ x)
+			{
+				for (int j = 0; j < N; ++j)
+				{
+					const int p = ipiv[j];
+					for (int i = j + 1; i < N; ++i)
+					{
+						const T u = x[j];
+						const T v = x[i];
+						x[j] = (i == p) ? v : u;
+						x[i] = (i == p) ? u : v;
+					}
+				}
+
+				small_trsv<T, N>::template eval_ln<true>(f, ldf, x);
+				small_trsv<T, N>::template eval_un<false>(f, ldf, x);
+			}
+		};
+
+
+		// one column step of the in-place Gauss-Jordan inversion with partial
+		// pivoting, on column J
+
+		template<typename T, int N, int J>
+		struct small_gj_step
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ b, const int ldb, int* __restrict__ ipiv, int& info)
+			{
+				T *bj = b + J * ldb;
+
+				int p = J;
+				T vmax = std::fabs(bj[J]);
+				for (int i = J + 1; i < N; ++i)
+				{
+					const T v = std::fabs(bj[i]);
+					if (v > vmax) { vmax = v; p = i; }
+				}
+				ipiv[J] = p;
+
+				for (int i = J + 1; i < N; ++i)
+				{
+					const bool s = (i == p);
+					for (int k = 0; k < N; ++k)
+					{
+						const T u = b[J + k * ldb];
+						const T v = b[i + k * ldb];
+						b[J + k * ldb] = s ? v : u;
+						b[i + k * ldb] = s ? u : v;
+					}
+				}
+
+				if (bj[J] == T(0) && info == 0) info = J + 1;
+
+				// row J := row J / pivot, with the pivot entry replaced by 1
+				const T r = T(1) / bj[J];
+				bj[J] = T(1);
+				for (int k = 0; k < N; ++k) b[J + k * ldb] *= r;
+
+				// row i -= b(i, J) * row J, with b(i, J) replaced by 0
+				for (int i = 0; i < N; ++i)
+				{
+					if (i != J)
+					{
+						const T v = bj[i];
+						bj[i] = T(0);
+						for (int k = 0; k < N; ++k) b[i + k * ldb] -= b[J + k * ldb] * v;
+					}
+				}
+
+				small_gj_step<T, N, J + 1>::run(b, ldb, ipiv, info);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_gj_step<T, N, N>
+		{
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ b, const int ldb, int* __restrict__ ipiv, int& info) { }
+		};
+	}
+
+
+	/********************************************
+	 *
+	 *  Cholesky factorization and solve
+	 *
+	 ********************************************/
+
+	// A = L * L', with L written to the lower part of a (the strictly
+	// upper part is neither used nor touched)
+	//
+	// returns 0 on success, or j + 1 if the leading minor of order j + 1
+	// is not positive definite (in which case the contents of the lower
+	// part are undefined)
+
+	template<typename T, int N>
+	struct small_potrf
+	{
+		BCS_ENSURE_INLINE
+		static int eval(T* __restrict__ a, const int lda)
+		{
+			return detail::small_chol_ker<T, N>::factor(a, lda);
+		}
+	};
+
+	// B := inv(L * L') * B, given the factor L from small_potrf
+
+	template<typename T, int N>
+	struct small_potrs
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const T* __restrict__ l, const int ldl, T* __restrict__ b)
+		{
+			small_trsv<T, N>::template eval_ln<false>(l, ldl, b);
+			small_trsv<T, N>::template eval_lt<false>(l, ldl, b);
+		}
+
+		inline
+		static void eval(const T* __restrict__ l, const int ldl,
+				T* __restrict__ b, const int ldb, const int nrhs)
+		{
+			for (int j = 0; j < nrhs; ++j) eval(l, ldl, b + j * ldb);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  LU factorization and solve
+	 *
+	 ********************************************/
+
+	// P * A = L * U, with L (unit lower) and U written to a, and the row
+	// interchanged with row j recorded in ipiv[j] (zero-based)
+	//
+	// returns 0 on success, or j + 1 if U(j, j) is exactly zero (the
+	// factorization is completed, but U is singular)
+
+	template<typename T, int N>
+	struct small_getrf
+	{
+		BCS_ENSURE_INLINE
+		static int eval(T* __restrict__ a, const int lda, int* __restrict__ ipiv)
+		{
+			return detail::small_lu_ker<T, N>::factor(a, lda, ipiv);
+		}
+	};
+
+	// B := inv(A) * B, given the factors from small_getrf
+
+	template<typename T, int N>
+	struct small_getrs
+	{
+		BCS_ENSURE_INLINE
+		static void eval(const T* __restrict__ lu, const int lda, const int* __restrict__ ipiv,
+				T* __restrict__ b)
+		{
+			detail::small_lu_ker<T, N>::solve(lu, lda, ipiv, b);
+		}
+
+		inline
+		static void eval(const T* __restrict__ lu, const int lda, const int* __restrict__ ipiv,
+				T* __restrict__ b, const int ldb, const int nrhs)
+		{
+			for (int j = 0; j < nrhs; ++j) eval(lu, lda, ipiv, b + j * ldb);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  inverse
+	 *
+	 ********************************************/
+
+	// B := inv(A), through Gauss-Jordan elimination with partial pivoting
+	// (in place on b)
+	//
+	// returns 0 on success, or j + 1 if A is found singular at the j-th
+	// step (in which case the contents of b are undefined)
+
+	template<typename T, int N>
+	struct small_inv
+	{
+		inline
+		static int eval(const T* __restrict__ a, const int lda, T* __restrict__ b, const int ldb)
+		{
+			for (int j = 0; j < N; ++j)
+				for (int i = 0; i < N; ++i) b[i + j * ldb] = a[i + j * lda];
+
+			int ipiv[N];
+			int info = 0;
+			detail::small_gj_step<T, N, 0>::run(b, ldb, ipiv, info);
+
+			// undo the row interchanges on the columns, in reverse order
+			for (int j = N - 1; j >= 0; --j)
+			{
+				const int p = ipiv[j];
+				for (int k = j + 1; k < N; ++k)
+				{
+					const bool s = (k == p);
+					for (int i = 0; i < N; ++i)
+					{
+						const T u = b[i + j * ldb];
+						const T v = b[i + k * ldb];
+						b[i + j * ldb] = s ? v : u;
+						b[i + k * ldb] = s ? u : v;
+					}
+				}
+			}
+
+			return info;
+		}
+	};
+
+} }
+
+#endif /* BCSLIB_SMALL_LAPACK_H_ */
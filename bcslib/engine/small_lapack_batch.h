@@ -0,0 +1,582 @@
+/**
+ * @file small_lapack_batch.h
+ *
+ * Batched factorizations and solvers for small fixed-size matrices
+ *
+ * The batches are given in the same forms as for small_gemm_batch
+ * (strided arrays or arrays of pointers), and each problem reports
+ * its own info code (see small_lapack.h) in info[p].
+ *
+ * The Cholesky-based routines work on groups of W (the packet width
+ * of T) interleaved problems, with each SIMD lane factoring and solving
+ * a different one. A group that contains a matrix which is not positive
+ * definite is redone problem by problem from the original matrices,
+ * so as to report the info code of each. The LU-based routines, whose
+ * pivoting differs from problem to problem, evaluate the problems one
+ * by one.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_SMALL_LAPACK_BATCH_H_
+#define BCSLIB_SMALL_LAPACK_BATCH_H_
+
+#include "small_lapack.h"
+#include "small_blas_batch.h"
+
+namespace bcs { namespace engine {
+
+	namespace detail
+	{
+		/********************************************
+		 *
+		 *  per-problem evaluation
+		 *
+		 ********************************************/
+
+		// factors A_p = L_p * L_p', and then solves for the N x NRHS matrix B_p
+		// (NRHS == 0 for the factorization alone)
+
+		template<typename T, int N, int NRHS>
+		inline int small_posv_one(T* __restrict__ a, const int lda, T* __restrict__ b, const int ldb)
+		{
+			const int r = small_potrf<T, N>::eval(a, lda);
+			if (r == 0 && NRHS > 0) small_potrs<T, N>::eval(a, lda, b, ldb, NRHS);
+			return r;
+		}
+
+		template<typename T, int N, int NRHS, class BA, class BB>
+		inline void small_posv_each(index_t p, const index_t p1,
+				const BA& a, const int lda, const BB& b, const int ldb, int *info)
+		{
+			for (; p < p1; ++p)
+			{
+				info[p] = small_posv_one<T, N, NRHS>(a[p], lda, b[p], ldb);
+			}
+		}
+
+		template<typename T, int N, int NRHS, class BA, class BB>
+		inline void small_gesv_each(index_t p, const index_t p1,
+				const BA& a, const int lda, const BB& b, const int ldb, int *info)
+		{
+			int ipiv[N];
+
+			for (; p < p1; ++p)
+			{
+				T *ap = a[p];
+				const int r = small_getrf<T, N>::eval(ap, lda, ipiv);
+				if (r == 0) small_getrs<T, N>::eval(ap, lda, ipiv, b[p], ldb, NRHS);
+				info[p] = r;
+			}
+		}
+
+		template<typename T, int N, class BA, class BB>
+		inline void small_inv_each(index_t p, const index_t p1,
+				const BA& a, const int lda, const BB& b, const int ldb, int *info)
+		{
+			for (; p < p1; ++p)
+			{
+				info[p] = small_inv<T, N>::eval(a[p], lda, b[p], ldb);
+			}
+		}
+
+
+		/********************************************
+		 *
+		 *  interleaved Cholesky
+		 *
+		 ********************************************/
+
+#ifdef BCS_HAS_PACKET
+
+		// one column step of the interleaved Cholesky factorization, on
+		// column J (left-looking, as small_chol_step), which loads the column
+		// from a and stores its factor back (a plain loop over the columns
+		// would be turned into variable-length copies through memory)
+
+		template<typename T, int N, int J>
+		struct small_chol_soa_step
+		{
+			typedef typename packet_traits<T>::type packet_t;
+			static const int W = soa_block<T>::W;
+
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ a, packet_t* __restrict__ l, packet_t* __restrict__ r)
+			{
+				for (int i = J; i < N; ++i) l[i + J * N] = simd::load(a + (i + J * N) * W);
+
+				for (int k = 0; k < J; ++k)
+				{
+					const packet_t v = l[J + k * N];
+					for (int i = J; i < N; ++i)
+					{
+						l[i + J * N] = simd::sub(l[i + J * N], simd::mul(l[i + k * N], v));
+					}
+				}
+
+				const packet_t d = simd::sqrt(l[J + J * N]);
+				l[J + J * N] = d;
+				r[J] = simd::div(simd::set1(T(1)), d);
+
+				for (int i = J + 1; i < N; ++i) l[i + J * N] = simd::mul(l[i + J * N], r[J]);
+
+				for (int i = J; i < N; ++i) simd::store(a + (i + J * N) * W, l[i + J * N]);
+
+				small_chol_soa_step<T, N, J + 1>::run(a, l, r);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_chol_soa_step<T, N, N>
+		{
+			typedef typename packet_traits<T>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static void run(T* __restrict__ a, packet_t* __restrict__ l, packet_t* __restrict__ r) { }
+		};
+
+		// forward substitution with the interleaved factor, on column J
+
+		template<typename T, int N, int J>
+		struct small_fsub_soa_step
+		{
+			typedef typename packet_traits<T>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static void run(const packet_t* __restrict__ l, const packet_t* __restrict__ r,
+					packet_t* __restrict__ x)
+			{
+				x[J] = simd::mul(x[J], r[J]);
+				for (int i = J + 1; i < N; ++i) x[i] = simd::sub(x[i], simd::mul(l[i + J * N], x[J]));
+
+				small_fsub_soa_step<T, N, J + 1>::run(l, r, x);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_fsub_soa_step<T, N, N>
+		{
+			typedef typename packet_traits<T>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static void run(const packet_t* __restrict__ l, const packet_t* __restrict__ r,
+					packet_t* __restrict__ x) { }
+		};
+
+		// backward substitution with the transposed interleaved factor, on row J
+
+		template<typename T, int N, int J>
+		struct small_bsub_soa_step
+		{
+			typedef typename packet_traits<T>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static void run(const packet_t* __restrict__ l, const packet_t* __restrict__ r,
+					packet_t* __restrict__ x)
+			{
+				packet_t s = x[J];
+				for (int i = J + 1; i < N; ++i) s = simd::sub(s, simd::mul(l[i + J * N], x[i]));
+				x[J] = simd::mul(s, r[J]);
+
+				small_bsub_soa_step<T, N, J - 1>::run(l, r, x);
+			}
+		};
+
+		template<typename T, int N>
+		struct small_bsub_soa_step<T, N, -1>
+		{
+			typedef typename packet_traits<T>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static void run(const packet_t* __restrict__ l, const packet_t* __restrict__ r,
+					packet_t* __restrict__ x) { }
+		};
+
+
+		// factors W interleaved N x N matrices in a (lower part), and
+		// overwrites W interleaved N x NRHS matrices in b with the solutions
+
+		template<typename T, int N, int NRHS>
+		struct small_posv_soa
+		{
+			typedef typename packet_traits<T>::type packet_t;
+			static const int W = soa_block<T>::W;
+
+			BCS_ENSURE_INLINE
+			static void eval(T* __restrict__ a, T* __restrict__ b)
+			{
+				packet_t l[N * N];
+				packet_t r[N];
+
+				small_chol_soa_step<T, N, 0>::run(a, l, r);
+
+				for (int c = 0; c < NRHS; ++c)
+				{
+					T *bc = b + c * N * W;
+
+					packet_t x[N];
+					for (int i = 0; i < N; ++i) x[i] = simd::load(bc + i * W);
+
+					small_fsub_soa_step<T, N, 0>::run(l, r, x);
+					small_bsub_soa_step<T, N, N - 1>::run(l, r, x);
+
+					for (int i = 0; i < N; ++i) simd::store(bc + i * W, x[i]);
+				}
+			}
+
+			// whether all the W matrices are positive definite, judged from
+			// their factors (sqrt yields NaN or zero on the diagonal otherwise)
+			BCS_ENSURE_INLINE
+			static bool all_pd(const T* __restrict__ a)
+			{
+				bool ok = true;
+				for (int j = 0; j < N; ++j)
+				{
+					const T *d = a + (j + j * N) * W;
+					for (int l = 0; l < W; ++l) ok &= (d[l] > T(0));
+				}
+				return ok;
+			}
+		};
+
+#endif
+
+		// processes the leading groups of W problems in [p, p1), and returns
+		// where it stops
+
+		template<typename T, int N, int NRHS, int W>
+		struct small_posv_soa_groups;
+
+		template<typename T, int N, int NRHS>
+		struct small_posv_soa_groups<T, N, NRHS, 1>
+		{
+			template<class BA, class BB>
+			BCS_ENSURE_INLINE
+			static index_t run(const index_t p, const index_t p1,
+					const BA& a, const int lda, const BB& b, const int ldb, int *info)
+			{
+				return p;
+			}
+		};
+
+#ifdef BCS_HAS_PACKET
+
+		template<typename T, int N, int NRHS, int W>
+		struct small_posv_soa_groups
+		{
+			template<class BA, class BB>
+			BCS_ENSURE_INLINE
+			static index_t run(index_t p, const index_t p1,
+					const BA& a, const int lda, const BB& b, const int ldb, int *info)
+			{
+				BCS_ALIGN(32) T bufa[N * N * W];
+				BCS_ALIGN(32) T bufb[N * (NRHS > 0 ? NRHS : 1) * W];
+
+				T *pa[W];
+				T *pb[W];
+
+				const index_t pe = p + ((p1 - p) / W) * W;
+
+				for (; p < pe; p += W)
+				{
+					for (int l = 0; l < W; ++l) pa[l] = a[p + l];
+					soa_load<T, N, N>(pa, lda, bufa);
+
+					if (NRHS > 0)
+					{
+						for (int l = 0; l < W; ++l) pb[l] = b[p + l];
+						soa_load<T, N, NRHS>(pb, ldb, bufb);
+					}
+
+					small_posv_soa<T, N, NRHS>::eval(bufa, bufb);
+
+					if (small_posv_soa<T, N, NRHS>::all_pd(bufa))
+					{
+						soa_store<T, N, N>(bufa, pa, lda);
+						if (NRHS > 0) soa_store<T, N, NRHS>(bufb, pb, ldb);
+						for (int l = 0; l < W; ++l) info[p + l] = 0;
+					}
+					else
+					{
+						for (int l = 0; l < W; ++l)
+							info[p + l] = small_posv_one<T, N, NRHS>(pa[l], lda, b[p + l], ldb);
+					}
+				}
+				return p;
+			}
+		};
+
+#endif
+
+
+		/********************************************
+		 *
+		 *  batch tasks
+		 *
+		 ********************************************/
+
+		template<typename T>
+		struct small_posv_batch_width
+		{
+#ifdef BCS_HAS_PACKET
+			static const int value = soa_width<T>::value;
+#else
+			static const int value = 1;
+#endif
+		};
+
+		template<typename T, int N, int NRHS, class BA, class BB>
+		struct small_posv_batch_task
+		{
+			static const int W = small_posv_batch_width<T>::value;
+			typedef small_posv_soa_groups<T, N, NRHS, W> groups_t;
+
+			BA a; int lda;
+			BB b; int ldb;
+			int *info;
+
+			small_posv_batch_task(const BA& a_, const int lda_, const BB& b_, const int ldb_, int *info_)
+			: a(a_), lda(lda_), b(b_), ldb(ldb_), info(info_) { }
+
+			// processes the problems in [p0, p1)
+			static void run(const index_t p0, const index_t p1,
+					const BA& a, const int lda, const BB& b, const int ldb, int *info)
+			{
+				index_t p = groups_t::run(p0, p1, a, lda, b, ldb, info);
+				small_posv_each<T, N, NRHS>(p, p1, a, lda, b, ldb, info);
+			}
+
+			void operator() (const index_t p0, const index_t p1) const
+			{
+				run(p0, p1, a, lda, b, ldb, info);
+			}
+		};
+
+		template<typename T, int N, int NRHS, class BA, class BB>
+		struct small_gesv_batch_task
+		{
+			static const int W = 1;
+
+			BA a; int lda;
+			BB b; int ldb;
+			int *info;
+
+			small_gesv_batch_task(const BA& a_, const int lda_, const BB& b_, const int ldb_, int *info_)
+			: a(a_), lda(lda_), b(b_), ldb(ldb_), info(info_) { }
+
+			static void run(const index_t p0, const index_t p1,
+					const BA& a, const int lda, const BB& b, const int ldb, int *info)
+			{
+				small_gesv_each<T, N, NRHS>(p0, p1, a, lda, b, ldb, info);
+			}
+
+			void operator() (const index_t p0, const index_t p1) const
+			{
+				run(p0, p1, a, lda, b, ldb, info);
+			}
+		};
+
+		template<typename T, int N, class BA, class BB>
+		struct small_inv_batch_task
+		{
+			static const int W = 1;
+
+			BA a; int lda;
+			BB b; int ldb;
+			int *info;
+
+			small_inv_batch_task(const BA& a_, const int lda_, const BB& b_, const int ldb_, int *info_)
+			: a(a_), lda(lda_), b(b_), ldb(ldb_), info(info_) { }
+
+			static void run(const index_t p0, const index_t p1,
+					const BA& a, const int lda, const BB& b, const int ldb, int *info)
+			{
+				small_inv_each<T, N>(p0, p1, a, lda, b, ldb, info);
+			}
+
+			void operator() (const index_t p0, const index_t p1) const
+			{
+				run(p0, p1, a, lda, b, ldb, info);
+			}
+		};
+
+
+		// splits the batch at group boundaries among threads, with each
+		// thread taking at least one grain of N^3 operations per problem
+
+		template<class Task, int N, class BA, class BB>
+		inline void small_lapack_batch_run(const index_t nb,
+				const BA& a, const int lda, const BB& b, const int ldb, int *info)
+		{
+			const index_t W = Task::W;
+			const index_t ng = nb / W;
+			index_t grain = get_parallel_grain() / (N * N * N * W);
+			if (grain < 1) grain = 1;
+
+			if (ng >= 2 * grain && use_parallel(nb * (N * N * N)))
+			{
+				Task task(a, lda, b, ldb, info);
+				parallel_for(0, ng, grain, small_gemm_group_task<Task>(task, W));
+				task(ng * W, nb);
+			}
+			else
+			{
+				Task::run(0, nb, a, lda, b, ldb, info);
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  small_potrf_batch
+	 *
+	 *  A_p = L_p * L_p', for p = 0, ..., nb - 1
+	 *
+	 ********************************************/
+
+	template<typename T, int N>
+	struct small_potrf_batch
+	{
+		static void eval(const index_t nb,
+				T* a, const int lda, const index_t stride_a, int *info)
+		{
+			typedef strided_batch<T> ba_t;
+			typedef detail::small_posv_batch_task<T, N, 0, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a, stride_a), lda, ba_t(0, 0), 0, info);
+		}
+
+		static void eval(const index_t nb,
+				T* const *a, const int lda, int *info)
+		{
+			typedef ptr_array_batch<T> ba_t;
+			typedef detail::small_posv_batch_task<T, N, 0, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a), lda, ba_t(a), 0, info);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  small_posv_batch
+	 *
+	 *  A_p * X_p = B_p, with A_p symmetric positive
+	 *  definite, for p = 0, ..., nb - 1
+	 *
+	 *  (A_p is overwritten by its Cholesky factor,
+	 *   and B_p (N x NRHS) by the solution X_p)
+	 *
+	 ********************************************/
+
+	template<typename T, int N, int NRHS=1>
+	struct small_posv_batch
+	{
+		static void eval(const index_t nb,
+				T* a, const int lda, const index_t stride_a,
+				T* b, const int ldb, const index_t stride_b, int *info)
+		{
+			typedef strided_batch<T> ba_t;
+			typedef detail::small_posv_batch_task<T, N, NRHS, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a, stride_a), lda, ba_t(b, stride_b), ldb, info);
+		}
+
+		static void eval(const index_t nb,
+				T* const *a, const int lda,
+				T* const *b, const int ldb, int *info)
+		{
+			typedef ptr_array_batch<T> ba_t;
+			typedef detail::small_posv_batch_task<T, N, NRHS, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a), lda, ba_t(b), ldb, info);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  small_gesv_batch
+	 *
+	 *  A_p * X_p = B_p, for p = 0, ..., nb - 1
+	 *
+	 *  (A_p is overwritten by its LU factors, and
+	 *   B_p (N x NRHS) by the solution X_p)
+	 *
+	 ********************************************/
+
+	template<typename T, int N, int NRHS=1>
+	struct small_gesv_batch
+	{
+		static void eval(const index_t nb,
+				T* a, const int lda, const index_t stride_a,
+				T* b, const int ldb, const index_t stride_b, int *info)
+		{
+			typedef strided_batch<T> ba_t;
+			typedef detail::small_gesv_batch_task<T, N, NRHS, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a, stride_a), lda, ba_t(b, stride_b), ldb, info);
+		}
+
+		static void eval(const index_t nb,
+				T* const *a, const int lda,
+				T* const *b, const int ldb, int *info)
+		{
+			typedef ptr_array_batch<T> ba_t;
+			typedef detail::small_gesv_batch_task<T, N, NRHS, ba_t, ba_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a), lda, ba_t(b), ldb, info);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  small_inv_batch
+	 *
+	 *  B_p := inv(A_p), for p = 0, ..., nb - 1
+	 *
+	 ********************************************/
+
+	template<typename T, int N>
+	struct small_inv_batch
+	{
+		static void eval(const index_t nb,
+				const T* a, const int lda, const index_t stride_a,
+				T* b, const int ldb, const index_t stride_b, int *info)
+		{
+			typedef strided_batch<const T> ba_t;
+			typedef strided_batch<T> bb_t;
+			typedef detail::small_inv_batch_task<T, N, ba_t, bb_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a, stride_a), lda, bb_t(b, stride_b), ldb, info);
+		}
+
+		static void eval(const index_t nb,
+				const T* const *a, const int lda,
+				T* const *b, const int ldb, int *info)
+		{
+			typedef ptr_array_batch<const T> ba_t;
+			typedef ptr_array_batch<T> bb_t;
+			typedef detail::small_inv_batch_task<T, N, ba_t, bb_t> task_t;
+
+			detail::small_lapack_batch_run<task_t, N>(nb,
+					ba_t(a), lda, bb_t(b), ldb, info);
+		}
+	};
+
+} }
+
+#endif /* BCSLIB_SMALL_LAPACK_BATCH_H_ */
@@ -17,6 +17,8 @@
 
 #include <bcslib/linalg/matrix_blas.h>
 #include <bcslib/linalg/matrix_prod.h>
+#include <bcslib/linalg/matrix_factor.h>
+#include <bcslib/linalg/matrix_gram.h>
 
 
 #endif /* LINALG_H_ */
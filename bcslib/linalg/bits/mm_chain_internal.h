@@ -0,0 +1,450 @@
+/**
+ * @file mm_chain_internal.h
+ *
+ * Internal implementation of the evaluation of matrix product chains
+ *
+ * A tree of nested mm_expr, such as mm(mm(A, B), v), is seen as
+ * a chain of factors F_0 * F_1 * ... * F_{L-1}. Instead of
+ * following the nesting written by the user, it is evaluated
+ * in the order that minimizes the number of multiply-adds, which
+ * is solved by the standard dynamic programming over the chain
+ * dimensions. The costs only depend on the dimensions, so the
+ * plan is folded to constants when they are fixed at compile time.
+ *
+ * The alpha factors of all nested products are combined and
+ * applied to the outermost product. The intermediate results are
+ * held in dense matrices drawn from the scratch arena.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_MM_CHAIN_INTERNAL_H_
+#define BCSLIB_MM_CHAIN_INTERNAL_H_
+
+#include <bcslib/linalg/mm_evaluators.h>
+
+namespace bcs
+{
+	template<class LArg, class RArg> class mm_expr;
+
+namespace detail
+{
+	/**
+	 * Chains longer than this are evaluated following the
+	 * nesting (each nested chain is still reordered on its own)
+	 */
+	const int MaxMMChainLength = 6;
+
+
+	/********************************************
+	 *
+	 *  Chain structure
+	 *
+	 ********************************************/
+
+	template<class E>
+	struct mm_chain_length
+	{
+		static const int value = 1;
+	};
+
+	template<class LArg, class RArg>
+	struct mm_chain_length<mm_expr<LArg, RArg> >
+	{
+		static const int value = mm_chain_length<LArg>::value + mm_chain_length<RArg>::value;
+	};
+
+
+	template<class E, int I> struct mm_chain_factor;
+
+	template<class LArg, class RArg, int I, bool InLeft> struct mm_chain_factor_sel;
+
+	template<class E, int I>
+	struct mm_chain_factor
+	{
+		typedef E type;
+
+		BCS_ENSURE_INLINE
+		static const E& get(const E& e)
+		{
+			return e;
+		}
+	};
+
+	template<class LArg, class RArg, int I>
+	struct mm_chain_factor<mm_expr<LArg, RArg>, I>
+	: public mm_chain_factor_sel<LArg, RArg, I, (I < mm_chain_length<LArg>::value)>
+	{
+	};
+
+	template<class LArg, class RArg, int I>
+	struct mm_chain_factor_sel<LArg, RArg, I, true>
+	{
+		typedef mm_chain_factor<LArg, I> sel_t;
+		typedef typename sel_t::type type;
+
+		BCS_ENSURE_INLINE
+		static const type& get(const mm_expr<LArg, RArg>& e)
+		{
+			return sel_t::get(e.left_arg());
+		}
+	};
+
+	template<class LArg, class RArg, int I>
+	struct mm_chain_factor_sel<LArg, RArg, I, false>
+	{
+		typedef mm_chain_factor<RArg, I - mm_chain_length<LArg>::value> sel_t;
+		typedef typename sel_t::type type;
+
+		BCS_ENSURE_INLINE
+		static const type& get(const mm_expr<LArg, RArg>& e)
+		{
+			return sel_t::get(e.right_arg());
+		}
+	};
+
+
+	template<class E>
+	struct mm_chain_alpha
+	{
+		typedef typename matrix_traits<E>::value_type T;
+
+		BCS_ENSURE_INLINE
+		static T get(const E& )
+		{
+			return T(1);
+		}
+	};
+
+	template<class LArg, class RArg>
+	struct mm_chain_alpha<mm_expr<LArg, RArg> >
+	{
+		typedef typename matrix_traits<LArg>::value_type T;
+
+		BCS_ENSURE_INLINE
+		static T get(const mm_expr<LArg, RArg>& e)
+		{
+			return e.alpha() *
+					mm_chain_alpha<LArg>::get(e.left_arg()) *
+					mm_chain_alpha<RArg>::get(e.right_arg());
+		}
+	};
+
+
+	// dims[i] = nrows(F_i), dims[L] = ncolumns(F_{L-1})
+
+	template<class E, int I, int L>
+	struct mm_chain_dims
+	{
+		BCS_ENSURE_INLINE
+		static void fill(const E& e, index_t *dims)
+		{
+			dims[I] = mm_chain_factor<E, I>::get(e).nrows();
+			mm_chain_dims<E, I + 1, L>::fill(e, dims);
+		}
+	};
+
+	template<class E, int L>
+	struct mm_chain_dims<E, L, L>
+	{
+		BCS_ENSURE_INLINE
+		static void fill(const E& e, index_t *dims)
+		{
+			dims[L] = mm_chain_factor<E, L - 1>::get(e).ncolumns();
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  Ordering
+	 *
+	 ********************************************/
+
+	template<int L>
+	struct mm_chain_plan
+	{
+		index_t dims[L + 1];
+		int split[L][L + 1];	// [i, j) is computed as [i, split) * [split, j)
+
+		BCS_ENSURE_INLINE
+		void solve()
+		{
+			double cost[L][L + 1];
+			for (int i = 0; i < L; ++i) cost[i][i + 1] = 0;
+
+			for (int len = 2; len <= L; ++len)
+			{
+				for (int i = 0; i + len <= L; ++i)
+				{
+					const int j = i + len;
+					const double mn = double(dims[i]) * double(dims[j]);
+
+					int s_best = j - 1;
+					double c_best = cost[i][j - 1] + mn * double(dims[j - 1]);
+
+					for (int s = j - 2; s > i; --s)
+					{
+						const double c = cost[i][s] + cost[s][j] + mn * double(dims[s]);
+						if (c < c_best)
+						{
+							c_best = c;
+							s_best = s;
+						}
+					}
+
+					cost[i][j] = c_best;
+					split[i][j] = s_best;
+				}
+			}
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  Operands
+	 *
+	 ********************************************/
+
+	/**
+	 * mm_evaluator does not accept a sym_mat_proxy together with
+	 * a transpose_expr or another sym_mat_proxy. The reordering
+	 * may put two such factors side by side, in which case the
+	 * right one is taken as a general matrix.
+	 */
+	template<class LF, class RF>
+	struct mm_chain_conflict
+	{
+		typedef typename mm_left_tag<LF>::type ltag;
+		typedef typename mm_right_tag<RF>::type rtag;
+
+		static const bool value =
+				(is_same<ltag, mm_smat_tag>::value &&
+						(is_same<rtag, mm_tmat_tag>::value || is_same<rtag, mm_smat_tag>::value)) ||
+				(is_same<ltag, mm_tmat_tag>::value && is_same<rtag, mm_smat_tag>::value);
+	};
+
+	template<class F>
+	struct mm_chain_general
+	{
+		typedef F type;
+
+		BCS_ENSURE_INLINE
+		static const F& get(const F& f)
+		{
+			return f;
+		}
+	};
+
+	template<class Mat>
+	struct mm_chain_general<sym_mat_proxy<Mat> >
+	{
+		typedef Mat type;
+
+		BCS_ENSURE_INLINE
+		static const Mat& get(const sym_mat_proxy<Mat>& f)
+		{
+			return f.get();
+		}
+	};
+
+
+	template<class E, int I, int J> struct mm_chain_eval;
+
+	// Kind: 0 - a factor as it is, 1 - a factor as a general matrix, 2 - a sub-chain
+
+	template<class E, int I, int J, int Kind> class mm_chain_operand;
+
+	template<class E, int I, int J>
+	class mm_chain_operand<E, I, J, 0> : private noncopyable
+	{
+	public:
+		typedef typename mm_chain_factor<E, I>::type type;
+
+		template<int L>
+		BCS_ENSURE_INLINE
+		mm_chain_operand(const E& e, const mm_chain_plan<L>& )
+		: m_arg(mm_chain_factor<E, I>::get(e))
+		{
+		}
+
+		BCS_ENSURE_INLINE
+		const type& get() const
+		{
+			return m_arg;
+		}
+
+	private:
+		const type& m_arg;
+	};
+
+	template<class E, int I, int J>
+	class mm_chain_operand<E, I, J, 1> : private noncopyable
+	{
+		typedef typename mm_chain_factor<E, I>::type factor_t;
+		typedef mm_chain_general<factor_t> general_t;
+		typedef typename general_t::type arg_t;
+		typedef matrix_capture<arg_t, is_dense_mat<arg_t>::value> capture_t;
+
+	public:
+		typedef typename capture_t::captured_type type;
+
+		template<int L>
+		BCS_ENSURE_INLINE
+		mm_chain_operand(const E& e, const mm_chain_plan<L>& )
+		: m_cap(general_t::get(mm_chain_factor<E, I>::get(e)))
+		{
+		}
+
+		BCS_ENSURE_INLINE
+		const type& get() const
+		{
+			return m_cap.get();
+		}
+
+	private:
+		capture_t m_cap;
+	};
+
+	template<class E, int I, int J>
+	class mm_chain_operand<E, I, J, 2> : private noncopyable
+	{
+		typedef typename matrix_traits<E>::value_type T;
+		typedef typename mm_chain_factor<E, I>::type first_t;
+		typedef typename mm_chain_factor<E, J - 1>::type last_t;
+
+	public:
+		typedef dense_matrix<T, ct_rows<first_t>::value, ct_cols<last_t>::value,
+				scratch_allocator<T> > type;
+
+		template<int L>
+		BCS_ENSURE_INLINE
+		mm_chain_operand(const E& e, const mm_chain_plan<L>& plan)
+		: m_mat(plan.dims[I], plan.dims[J])
+		{
+			mm_chain_eval<E, I, J>::eval(T(1), e, plan, T(0), m_mat);
+		}
+
+		BCS_ENSURE_INLINE
+		const type& get() const
+		{
+			return m_mat;
+		}
+
+	private:
+		type m_mat;
+	};
+
+
+	/********************************************
+	 *
+	 *  Evaluation
+	 *
+	 ********************************************/
+
+	template<class E, int I, int J, int S>
+	struct mm_chain_split
+	{
+		typedef typename matrix_traits<E>::value_type T;
+
+		static const int lkind = S - I > 1 ? 2 : 0;
+		static const int rkind = J - S > 1 ? 2 :
+				(S - I == 1 && mm_chain_conflict<
+						typename mm_chain_factor<E, I>::type,
+						typename mm_chain_factor<E, S>::type>::value ? 1 : 0);
+
+		template<int L, class DMat>
+		static void eval(const int s, const T& alpha, const E& e, const mm_chain_plan<L>& plan,
+				const T& beta, DMat& dst)
+		{
+			if (s == S)
+			{
+				typedef mm_chain_operand<E, I, S, lkind> left_t;
+				typedef mm_chain_operand<E, S, J, rkind> right_t;
+
+				left_t left(e, plan);
+				right_t right(e, plan);
+
+				mm_evaluator<typename left_t::type, typename right_t::type>::eval(
+						alpha, left.get(), right.get(), beta, dst);
+			}
+			else
+			{
+				mm_chain_split<E, I, J, S + 1>::eval(s, alpha, e, plan, beta, dst);
+			}
+		}
+	};
+
+	template<class E, int I, int J>
+	struct mm_chain_split<E, I, J, J>
+	{
+		typedef typename matrix_traits<E>::value_type T;
+
+		template<int L, class DMat>
+		BCS_ENSURE_INLINE
+		static void eval(const int, const T&, const E&, const mm_chain_plan<L>&, const T&, DMat&)
+		{
+		}
+	};
+
+	template<class E, int I, int J>
+	struct mm_chain_eval
+	{
+		typedef typename matrix_traits<E>::value_type T;
+
+		template<int L, class DMat>
+		BCS_ENSURE_INLINE
+		static void eval(const T& alpha, const E& e, const mm_chain_plan<L>& plan,
+				const T& beta, DMat& dst)
+		{
+			mm_chain_split<E, I, J, I + 1>::eval(plan.split[I][J], alpha, e, plan, beta, dst);
+		}
+	};
+
+
+	template<class LArg, class RArg>
+	struct mm_chain_evaluator
+	{
+		typedef typename matrix_traits<LArg>::value_type T;
+		typedef mm_expr<LArg, RArg> chain_t;
+		static const int L = mm_chain_length<chain_t>::value;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE static void eval(
+				const T& alpha, const LArg& larg, const RArg& rarg,
+				const T& beta, IDenseMatrix<DMat, T>& dst)
+		{
+			const chain_t e(larg, rarg, alpha);
+
+			mm_chain_plan<L> plan;
+			mm_chain_dims<chain_t, 0, L>::fill(e, plan.dims);
+			plan.solve();
+
+			mm_chain_eval<chain_t, 0, L>::eval(
+					mm_chain_alpha<chain_t>::get(e), e, plan, beta, dst.derived());
+		}
+	};
+
+
+	/**
+	 * The evaluator of mm_expr<LArg, RArg>: products of two
+	 * factors go to mm_evaluator directly, chains are reordered
+	 */
+	template<class LArg, class RArg>
+	struct mm_product_evaluator
+	{
+		static const int len = mm_chain_length<LArg>::value + mm_chain_length<RArg>::value;
+
+		typedef typename select_type<(len > 2 && len <= MaxMMChainLength),
+				mm_chain_evaluator<LArg, RArg>,
+				mm_evaluator<LArg, RArg> >::type type;
+	};
+
+} }
+
+#endif /* MM_CHAIN_INTERNAL_H_ */
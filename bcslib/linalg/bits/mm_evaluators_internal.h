@@ -14,6 +14,7 @@
 #define BCSLIB_MM_EVALUATORS_INTERNAL_H_
 
 #include <bcslib/linalg/linalg_base.h>
+#include <bcslib/linalg/matrix_blas.h>
 #include <bcslib/matrix/matrix_capture.h>
 
 namespace bcs { namespace detail {
@@ -26,6 +27,302 @@ namespace bcs { namespace detail {
 
 	template<class LArg, class RArg, typename LTag, typename RTag> struct mm_evaluator_intern;
 
+
+	/********************************************
+	 *
+	 *  Operand capture
+	 *
+	 ********************************************/
+
+	// a vector operand viewed as a dense row (1 x n, with a stride):
+	// it is not copied when its elements are evenly spaced in memory
+	// (e.g. a row of a matrix, or the transpose of such a row)
+
+	template<class Arg, bool IsDense=is_dense_mat<Arg>::value>
+	class mm_row_view : private noncopyable
+	{
+	public:
+		typedef typename matrix_traits<Arg>::value_type value_type;
+		typedef cref_matrix_ex<value_type, 1, ct_size<Arg>::value> captured_type;
+
+		BCS_ENSURE_INLINE
+		explicit mm_row_view(const Arg& a)
+		: m_row(a.ptr_data(), 1, a.nelems(), ct_is_row<Arg>::value ? a.lead_dim() : 1) { }
+
+		BCS_ENSURE_INLINE
+		const captured_type& get() const
+		{
+			return m_row;
+		}
+
+	private:
+		captured_type m_row;
+	};
+
+	template<class Arg>
+	class mm_row_view<Arg, false> : private noncopyable
+	{
+	public:
+		typedef typename matrix_traits<Arg>::value_type value_type;
+		typedef cref_matrix_ex<value_type, 1, ct_size<Arg>::value> captured_type;
+
+		BCS_ENSURE_INLINE
+		explicit mm_row_view(const Arg& a)
+		: m_cap(a), m_row(m_cap.get().ptr_data(), 1, a.nelems(), 1) { }
+
+		BCS_ENSURE_INLINE
+		const captured_type& get() const
+		{
+			return m_row;
+		}
+
+	private:
+		matrix_capture<Arg, false> m_cap;
+		captured_type m_row;
+	};
+
+	template<class Grid>
+	class mm_grid_row_view : private noncopyable
+	{
+	public:
+		typedef typename matrix_traits<Grid>::value_type value_type;
+		typedef cref_matrix_ex<value_type, 1, ct_size<Grid>::value> captured_type;
+
+		BCS_ENSURE_INLINE
+		explicit mm_grid_row_view(const Grid& a)
+		: m_row(a.ptr_data(), 1, a.nelems(), ct_is_row<Grid>::value ? a.lead_dim() : a.inner_step()) { }
+
+		BCS_ENSURE_INLINE
+		const captured_type& get() const
+		{
+			return m_row;
+		}
+
+	private:
+		captured_type m_row;
+	};
+
+	template<typename T, int CTRows, int CTCols>
+	class mm_row_view<cref_grid2d<T, CTRows, CTCols>, false>
+	: public mm_grid_row_view<cref_grid2d<T, CTRows, CTCols> >
+	{
+	public:
+		BCS_ENSURE_INLINE
+		explicit mm_row_view(const cref_grid2d<T, CTRows, CTCols>& a)
+		: mm_grid_row_view<cref_grid2d<T, CTRows, CTCols> >(a) { }
+	};
+
+	template<typename T, int CTRows, int CTCols>
+	class mm_row_view<ref_grid2d<T, CTRows, CTCols>, false>
+	: public mm_grid_row_view<ref_grid2d<T, CTRows, CTCols> >
+	{
+	public:
+		BCS_ENSURE_INLINE
+		explicit mm_row_view(const ref_grid2d<T, CTRows, CTCols>& a)
+		: mm_grid_row_view<ref_grid2d<T, CTRows, CTCols> >(a) { }
+	};
+
+	// a dense column y viewed as a row (for computing y' = x' * op(A)')
+
+	template<class DMat>
+	BCS_ENSURE_INLINE
+	inline ref_matrix_ex<typename matrix_traits<DMat>::value_type, 1, ct_rows<DMat>::value>
+	mm_col_as_row(IDenseMatrix<DMat, typename matrix_traits<DMat>::value_type>& y)
+	{
+		typedef ref_matrix_ex<typename matrix_traits<DMat>::value_type, 1, ct_rows<DMat>::value> row_t;
+		return row_t(y.ptr_data(), 1, y.nrows(), 1);
+	}
+
+
+	/********************************************
+	 *
+	 *  General matrix products
+	 *
+	 *  When an operand is not dense (e.g. an
+	 *  element-wise expression) and gemm goes to
+	 *  native_gemm, it is packed into the gemm
+	 *  panels directly from its column readers,
+	 *  instead of being copied to a temporary as a
+	 *  whole beforehand.
+	 *
+	 ********************************************/
+
+	template<bool TA, bool TB> struct mm_gemm_call;
+
+	template<> struct mm_gemm_call<false, false>
+	{
+		template<typename T, class MatA, class MatB, class DMat>
+		BCS_ENSURE_INLINE static void run(const T& alpha, const MatA& a, const MatB& b, const T& beta, DMat& dst)
+		{
+			blas::gemm_nn(alpha, a, b, beta, dst);
+		}
+	};
+
+	template<> struct mm_gemm_call<false, true>
+	{
+		template<typename T, class MatA, class MatB, class DMat>
+		BCS_ENSURE_INLINE static void run(const T& alpha, const MatA& a, const MatB& b, const T& beta, DMat& dst)
+		{
+			blas::gemm_nt(alpha, a, b, beta, dst);
+		}
+	};
+
+	template<> struct mm_gemm_call<true, false>
+	{
+		template<typename T, class MatA, class MatB, class DMat>
+		BCS_ENSURE_INLINE static void run(const T& alpha, const MatA& a, const MatB& b, const T& beta, DMat& dst)
+		{
+			blas::gemm_tn(alpha, a, b, beta, dst);
+		}
+	};
+
+	template<> struct mm_gemm_call<true, true>
+	{
+		template<typename T, class MatA, class MatB, class DMat>
+		BCS_ENSURE_INLINE static void run(const T& alpha, const MatA& a, const MatB& b, const T& beta, DMat& dst)
+		{
+			blas::gemm_tt(alpha, a, b, beta, dst);
+		}
+	};
+
+
+	// the packers of an operand of native_gemm
+
+	template<class Mat, bool Trans, bool IsDense=is_dense_mat<Mat>::value>
+	class mm_gemm_packers;
+
+	template<class Mat, bool Trans>
+	class mm_gemm_packers<Mat, Trans, true> : private noncopyable
+	{
+		typedef typename matrix_traits<Mat>::value_type T;
+		typedef engine::native_gemm<T> gemm_t;
+
+	public:
+		typedef engine::detail::gemm_ptr_packer_a<T, gemm_t::MR> a_packer;
+		typedef engine::detail::gemm_ptr_packer_b<T, gemm_t::NR> b_packer;
+
+		BCS_ENSURE_INLINE
+		explicit mm_gemm_packers(const Mat& a) : m_mat(a) { }
+
+		BCS_ENSURE_INLINE
+		a_packer as_a() const { return a_packer(Trans, m_mat.ptr_data(), (int)m_mat.lead_dim()); }
+
+		BCS_ENSURE_INLINE
+		b_packer as_b() const { return b_packer(Trans, m_mat.ptr_data(), (int)m_mat.lead_dim()); }
+
+	private:
+		const Mat& m_mat;
+	};
+
+	template<class Mat, bool Trans>
+	class mm_gemm_packers<Mat, Trans, false> : private noncopyable
+	{
+		typedef typename matrix_traits<Mat>::value_type T;
+		typedef engine::native_gemm<T> gemm_t;
+		typedef typename colwise_reader_bank<Mat>::type bank_t;
+
+	public:
+		typedef engine::detail::gemm_colreader_packer_a<T, gemm_t::MR, bank_t, Trans> a_packer;
+		typedef engine::detail::gemm_colreader_packer_b<T, gemm_t::NR, bank_t, Trans> b_packer;
+
+		BCS_ENSURE_INLINE
+		explicit mm_gemm_packers(const Mat& a) : m_bank(a) { }
+
+		BCS_ENSURE_INLINE
+		a_packer as_a() const { return a_packer(m_bank); }
+
+		BCS_ENSURE_INLINE
+		b_packer as_b() const { return b_packer(m_bank); }
+
+	private:
+		bank_t m_bank;
+	};
+
+
+	// dst = alpha * op(A) * op(B) + beta * dst, with op(X) = X or X' (by TA and TB)
+
+	template<class MatA, bool TA, class MatB, bool TB,
+		bool AllDense=(is_dense_mat<MatA>::value && is_dense_mat<MatB>::value)>
+	struct mm_gemm;
+
+	template<class MatA, bool TA, class MatB, bool TB>
+	struct mm_gemm<MatA, TA, MatB, TB, true>
+	{
+		typedef typename matrix_traits<MatA>::value_type T;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE static void eval(
+				const T& alpha, const MatA& a, const MatB& b,
+				const T& beta, IDenseMatrix<DMat, T>& dst)
+		{
+			mm_gemm_call<TA, TB>::run(alpha, a, b, beta, dst);
+		}
+	};
+
+	template<class MatA, bool TA, class MatB, bool TB>
+	struct mm_gemm<MatA, TA, MatB, TB, false>
+	{
+		typedef typename matrix_traits<MatA>::value_type T;
+
+		static const int ctm = TA ? ct_cols<MatA>::value : ct_rows<MatA>::value;
+		static const int ctn = TB ? ct_rows<MatB>::value : ct_cols<MatB>::value;
+		static const int ctk = TA ? ct_rows<MatA>::value : ct_cols<MatA>::value;
+
+		template<class DMat>
+		static void eval(
+				const T& alpha, const MatA& a, const MatB& b,
+				const T& beta, IDenseMatrix<DMat, T>& dst)
+		{
+			const int m = (int)(TA ? a.ncolumns() : a.nrows());
+			const int n = (int)(TB ? b.nrows() : b.ncolumns());
+			const int k = (int)(TA ? a.nrows() : a.ncolumns());
+
+			if (!engine::use_small_blas<ctm, ctn, ctk>::value &&
+				!engine::in_small_dispatch_range(m, n, k) &&
+				!engine::use_small_blas_rt(m, n, k) &&
+				engine::gemm_is_native<T>())
+			{
+				check_arg(dst.nrows() == m && dst.ncolumns() == n,
+						"The size of dst is invalid (for mm)");
+
+				mm_gemm_packers<MatA, TA> pka(a);
+				mm_gemm_packers<MatB, TB> pkb(b);
+
+				// the packers read the operands while C is being written,
+				// and the operands may refer to dst (e.g. D = mm(D + E, B)),
+				// hence the product is formed in a scratch matrix
+
+				dense_matrix<T, DynamicDim, DynamicDim, scratch_allocator<T> > c(m, n);
+				if (beta != T(0)) copy(dst.derived(), c);
+
+				{
+					engine::detail::blas_profile_scope<T> ps(engine::BLAS_GEMM,
+							2 * (int64_t)m * n * k, (int64_t)k * (m + n) + 2 * (int64_t)m * n);
+
+					engine::native_gemm<T>::eval_packed(m, n, k, alpha, pka.as_a(), pkb.as_b(),
+							beta, c.ptr_data(), m);
+				}
+
+				copy(c, dst.derived());
+			}
+			else
+			{
+				matrix_capture<MatA, is_dense_mat<MatA>::value> left(a);
+				matrix_capture<MatB, is_dense_mat<MatB>::value> right(b);
+
+				mm_gemm_call<TA, TB>::run(alpha, left.get(), right.get(), beta, dst);
+			}
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  Evaluators
+	 *
+	 ********************************************/
+
+
 	template<class LArg, class RArg>
 	struct mm_evaluator_intern<LArg, RArg, mm_mat_tag, mm_col_tag>
 	{
@@ -37,9 +334,18 @@ namespace bcs { namespace detail {
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
 			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
-			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
 
-			blas::gemv_n(alpha, left.get(), right.get(), beta, dst);
+			if (is_dense_mat<RArg>::value)
+			{
+				matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
+				blas::gemv_n(alpha, left.get(), right.get(), beta, dst);
+			}
+			else  // as dst' = rarg' * op(A)', with rarg' viewed in place when possible
+			{
+				mm_row_view<RArg> right(rarg);
+				ref_matrix_ex<T, 1, ct_rows<DMat>::value> y = mm_col_as_row(dst);
+				blas::gevm_t(alpha, right.get(), left.get(), beta, y);
+			}
 		}
 	};
 
@@ -54,9 +360,18 @@ namespace bcs { namespace detail {
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
 			matrix_capture<typename LArg::arg_type, is_dense_mat<typename LArg::arg_type>::value> left(larg.arg());
-			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
 
-			blas::gemv_t(alpha, left.get(), right.get(), beta, dst);
+			if (is_dense_mat<RArg>::value)
+			{
+				matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
+				blas::gemv_t(alpha, left.get(), right.get(), beta, dst);
+			}
+			else  // as dst' = rarg' * op(A)', with rarg' viewed in place when possible
+			{
+				mm_row_view<RArg> right(rarg);
+				ref_matrix_ex<T, 1, ct_rows<DMat>::value> y = mm_col_as_row(dst);
+				blas::gevm_n(alpha, right.get(), left.get(), beta, y);
+			}
 		}
 	};
 
@@ -71,9 +386,18 @@ namespace bcs { namespace detail {
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
 			matrix_capture<typename LArg::mat_type, is_dense_mat<typename LArg::mat_type>::value> left(larg.get());
-			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
 
-			blas::symv(alpha, left.get(), right.get(), beta, dst);
+			if (is_dense_mat<RArg>::value)
+			{
+				matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
+				blas::symv(alpha, left.get(), right.get(), beta, dst);
+			}
+			else  // as dst' = rarg' * op(A)', with rarg' viewed in place when possible
+			{
+				mm_row_view<RArg> right(rarg);
+				ref_matrix_ex<T, 1, ct_rows<DMat>::value> y = mm_col_as_row(dst);
+				blas::syvm(alpha, right.get(), left.get(), beta, y);
+			}
 		}
 	};
 
@@ -88,13 +412,21 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
+			mm_row_view<LArg> left(larg);
 			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
 
 			blas::gevm_n(alpha, left.get(), right.get(), beta, dst);
 		}
 	};
 
+	// a row times a column (e.g. x' * A * y once reduced), taken as a 1 x 1 row-matrix product
+
+	template<class LArg, class RArg>
+	struct mm_evaluator_intern<LArg, RArg, mm_row_tag, mm_col_tag>
+	: public mm_evaluator_intern<LArg, RArg, mm_row_tag, mm_mat_tag>
+	{
+	};
+
 	template<class LArg, class RArg>
 	struct mm_evaluator_intern<LArg, RArg, mm_row_tag, mm_tmat_tag>
 	{
@@ -105,7 +437,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
+			mm_row_view<LArg> left(larg);
 			matrix_capture<typename RArg::arg_type, is_dense_mat<typename RArg::arg_type>::value> right(rarg.arg());
 
 			blas::gevm_t(alpha, left.get(), right.get(), beta, dst);
@@ -122,7 +454,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
+			mm_row_view<LArg> left(larg);
 			matrix_capture<typename RArg::mat_type, is_dense_mat<typename RArg::mat_type>::value> right(rarg.get());
 
 			blas::syvm(alpha, left.get(), right.get(), beta, dst);
@@ -142,10 +474,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
-			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
-
-			blas::gemm_nn(alpha, left.get(), right.get(), beta, dst);
+			mm_gemm<LArg, false, RArg, false>::eval(alpha, larg, rarg, beta, dst);
 		}
 	};
 
@@ -159,10 +488,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<LArg, is_dense_mat<LArg>::value> left(larg);
-			matrix_capture<typename RArg::arg_type, is_dense_mat<typename RArg::arg_type>::value> right(rarg.arg());
-
-			blas::gemm_nt(alpha, left.get(), right.get(), beta, dst);
+			mm_gemm<LArg, false, typename RArg::arg_type, true>::eval(alpha, larg, rarg.arg(), beta, dst);
 		}
 	};
 
@@ -194,10 +520,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<typename LArg::arg_type, is_dense_mat<typename LArg::arg_type>::value> left(larg.arg());
-			matrix_capture<RArg, is_dense_mat<RArg>::value> right(rarg);
-
-			blas::gemm_tn(alpha, left.get(), right.get(), beta, dst);
+			mm_gemm<typename LArg::arg_type, true, RArg, false>::eval(alpha, larg.arg(), rarg, beta, dst);
 		}
 	};
 
@@ -211,10 +534,7 @@ namespace bcs { namespace detail {
 				const T& alpha, const LArg& larg, const RArg& rarg,
 				const T& beta, IDenseMatrix<DMat, T>& dst)
 		{
-			matrix_capture<typename LArg::arg_type, is_dense_mat<typename LArg::arg_type>::value> left(larg.arg());
-			matrix_capture<typename RArg::arg_type, is_dense_mat<typename RArg::arg_type>::value> right(rarg.arg());
-
-			blas::gemm_tt(alpha, left.get(), right.get(), beta, dst);
+			mm_gemm<typename LArg::arg_type, true, typename RArg::arg_type, true>::eval(alpha, larg.arg(), rarg.arg(), beta, dst);
 		}
 	};
 
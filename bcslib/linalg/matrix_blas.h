@@ -362,6 +362,39 @@ namespace bcs { namespace blas {
 				beta, c.ptr_data(), (int)c.lead_dim());
 	}
 
+	// syrk (only the uplo triangle of c is updated)
+
+	template<typename T, class MatA, class MatC>
+	inline typename enable_ty<is_floating_point<T>::value, void>::type
+	syrk_n(const T alpha, const IDenseMatrix<MatA, T>& a,
+			const T beta, IDenseMatrix<MatC, T>& c, const char uplo = 'L')
+	{
+		check_arg(c.nrows() == a.nrows() && c.ncolumns() == a.nrows(), "The size of c is invalid for syrk_n");
+
+		typedef engine::syrk<T,
+				binary_ctdim<ct_rows<MatA>::value, ct_rows<MatC>::value>::value,
+				ct_cols<MatA>::value> impl_t;
+
+		impl_t::eval(uplo, 'N', (int)a.nrows(), (int)a.ncolumns(),
+				alpha, a.ptr_data(), (int)a.lead_dim(),
+				beta, c.ptr_data(), (int)c.lead_dim());
+	}
+
+	template<typename T, class MatA, class MatC>
+	inline typename enable_ty<is_floating_point<T>::value, void>::type
+	syrk_t(const T alpha, const IDenseMatrix<MatA, T>& a,
+			const T beta, IDenseMatrix<MatC, T>& c, const char uplo = 'L')
+	{
+		check_arg(c.nrows() == a.ncolumns() && c.ncolumns() == a.ncolumns(), "The size of c is invalid for syrk_t");
+
+		typedef engine::syrk<T,
+				binary_ctdim<ct_cols<MatA>::value, ct_rows<MatC>::value>::value,
+				ct_rows<MatA>::value> impl_t;
+
+		impl_t::eval(uplo, 'T', (int)a.ncolumns(), (int)a.nrows(),
+				alpha, a.ptr_data(), (int)a.lead_dim(),
+				beta, c.ptr_data(), (int)c.lead_dim());
+	}
 
 } }
 
@@ -0,0 +1,115 @@
+/**
+ * @file matrix_factor.h
+ *
+ * Factorizations and solvers for small fixed-size matrices
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_MATRIX_FACTOR_H_
+#define BCSLIB_MATRIX_FACTOR_H_
+
+#include <bcslib/matrix/dense_matrix.h>
+#include <bcslib/engine/blas.h>
+#include <bcslib/engine/small_lapack.h>
+
+namespace bcs
+{
+
+	/********************************************
+	 *
+	 *  Cholesky factorization
+	 *
+	 ********************************************/
+
+	// L := the lower factor with A = L * L'
+	// (returns false if A is not positive definite)
+
+	template<typename T, int N>
+	inline typename enable_ty<engine::use_small_blas<N, N>::value, bool>::type
+	chol(const dense_matrix<T, N, N>& a, dense_matrix<T, N, N>& l)
+	{
+		l = a;
+		T *pl = l.ptr_data();
+
+		if (engine::small_potrf<T, N>::eval(pl, N) != 0) return false;
+
+		for (int j = 1; j < N; ++j)
+			for (int i = 0; i < j; ++i) pl[i + j * N] = T(0);
+		return true;
+	}
+
+	// X := inv(A) * B, with A symmetric positive definite
+	// (returns false if A is not positive definite)
+
+	template<typename T, int N, int K>
+	inline typename enable_ty<engine::use_small_blas<N, N>::value, bool>::type
+	chol_solve(const dense_matrix<T, N, N>& a, const dense_matrix<T, N, K>& b, dense_matrix<T, N, K>& x)
+	{
+		dense_matrix<T, N, N> l(a);
+		if (engine::small_potrf<T, N>::eval(l.ptr_data(), N) != 0) return false;
+
+		x = b;
+		engine::small_potrs<T, N>::eval(l.ptr_data(), N, x.ptr_data(), N, (int)x.ncolumns());
+		return true;
+	}
+
+
+	/********************************************
+	 *
+	 *  LU factorization
+	 *
+	 ********************************************/
+
+	// P * A = L * U, with the unit lower L and U stored in f, and the
+	// row interchanged with row j in ipiv[j]
+	// (returns false if A is singular)
+
+	template<typename T, int N>
+	inline typename enable_ty<engine::use_small_blas<N, N>::value, bool>::type
+	lu(const dense_matrix<T, N, N>& a, dense_matrix<T, N, N>& f, int (&ipiv)[N])
+	{
+		f = a;
+		return engine::small_getrf<T, N>::eval(f.ptr_data(), N, ipiv) == 0;
+	}
+
+	// X := inv(A) * B
+	// (returns false if A is singular)
+
+	template<typename T, int N, int K>
+	inline typename enable_ty<engine::use_small_blas<N, N>::value, bool>::type
+	lu_solve(const dense_matrix<T, N, N>& a, const dense_matrix<T, N, K>& b, dense_matrix<T, N, K>& x)
+	{
+		dense_matrix<T, N, N> f(a);
+		int ipiv[N];
+		if (engine::small_getrf<T, N>::eval(f.ptr_data(), N, ipiv) != 0) return false;
+
+		x = b;
+		engine::small_getrs<T, N>::eval(f.ptr_data(), N, ipiv, x.ptr_data(), N, (int)x.ncolumns());
+		return true;
+	}
+
+
+	/********************************************
+	 *
+	 *  inverse
+	 *
+	 ********************************************/
+
+	// R := inv(A)
+	// (returns false if A is singular)
+
+	template<typename T, int N>
+	inline typename enable_ty<engine::use_small_blas<N, N>::value, bool>::type
+	inv(const dense_matrix<T, N, N>& a, dense_matrix<T, N, N>& r)
+	{
+		return engine::small_inv<T, N>::eval(a.ptr_data(), N, r.ptr_data(), N) == 0;
+	}
+
+}
+
+#endif /* BCSLIB_MATRIX_FACTOR_H_ */
@@ -0,0 +1,232 @@
+/**
+ * @file matrix_gram.h
+ *
+ * Gram matrices and pairwise squared distances between columns
+ *
+ * The Gram matrix X' * X is computed on one triangle by syrk and then
+ * mirrored. The pairwise squared distances
+ *
+ *   D(i, j) = ||x_i||^2 + ||y_j||^2 - 2 * x_i' * y_j
+ *
+ * are computed tile by tile: the product for a tile is followed by the
+ * addition of the (precomputed) squared norms while the tile is still
+ * in cache. pairwise_sqdist_tiles hands over the tiles one at a time,
+ * for distance matrices that are too large to be held in memory.
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_MATRIX_GRAM_H_
+#define BCSLIB_MATRIX_GRAM_H_
+
+#include <bcslib/matrix/dense_matrix.h>
+#include <bcslib/matrix/matrix_par_reduc.h>
+#include <bcslib/linalg/matrix_blas.h>
+
+// the (maximum) number of rows and columns of a tile of distances
+
+#ifndef BCS_SQDIST_TILE_SIZE
+#define BCS_SQDIST_TILE_SIZE 256
+#endif
+
+namespace bcs
+{
+
+	namespace detail
+	{
+		// A(i, j) := A(j, i) for i > j
+
+		template<typename T, class Mat>
+		inline void mirror_upper(IDenseMatrix<Mat, T>& a)
+		{
+			const index_t n = a.ncolumns();
+			const index_t lda = a.lead_dim();
+			T *pa = a.ptr_data();
+
+			for (index_t j = 0; j < n; ++j)
+			{
+				for (index_t i = j + 1; i < n; ++i) pa[i + j * lda] = pa[j + i * lda];
+			}
+		}
+
+		// D := the squared distances between the columns x(:, i0:i0+m)
+		// and y(:, j0:j0+n), with D of size m x n, and nx and ny the
+		// squared norms of the columns of x and y
+
+		template<typename T, class MatX, class MatY, class MatD>
+		void pairwise_sqdist_tile(const IDenseMatrix<MatX, T>& x, const IDenseMatrix<MatY, T>& y,
+				const T *nx, const T *ny, const index_t i0, const index_t j0, IDenseMatrix<MatD, T>& d)
+		{
+			const index_t dim = x.nrows();
+			const index_t m = d.nrows();
+			const index_t n = d.ncolumns();
+
+			cref_matrix_ex<T> xs(x.ptr_data() + i0 * x.lead_dim(), dim, m, x.lead_dim());
+			cref_matrix_ex<T> ys(y.ptr_data() + j0 * y.lead_dim(), dim, n, y.lead_dim());
+
+			blas::gemm_tn(T(-2), xs, ys, T(0), d);
+
+			const index_t ldd = d.lead_dim();
+			for (index_t j = 0; j < n; ++j)
+			{
+				T *dj = d.ptr_data() + j * ldd;
+				const T nyj = ny[j0 + j];
+
+				for (index_t i = 0; i < m; ++i)
+				{
+					// clamp the (tiny) negative values caused by round-off
+					const T v = dj[i] + nx[i0 + i] + nyj;
+					dj[i] = v > T(0) ? v : T(0);
+				}
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  Gram matrix
+	 *
+	 ********************************************/
+
+	// G := X' * X
+
+	template<typename T, class MatX, class MatG>
+	inline void gram(const IDenseMatrix<MatX, T>& x, IDenseMatrix<MatG, T>& g)
+	{
+		const index_t n = x.ncolumns();
+		check_arg(g.nrows() == n && g.ncolumns() == n, "The size of g is invalid for gram");
+
+		blas::syrk_t(T(1), x, T(0), g, 'U');
+		detail::mirror_upper(g);
+	}
+
+	template<typename T, class MatX>
+	inline dense_matrix<T> gram(const IDenseMatrix<MatX, T>& x)
+	{
+		dense_matrix<T> g(x.ncolumns(), x.ncolumns());
+		gram(x, g);
+		return g;
+	}
+
+
+	/********************************************
+	 *
+	 *  Pairwise squared distances
+	 *
+	 ********************************************/
+
+	// D(i, j) := ||x_i - y_j||^2, for the columns x_i of X and y_j of Y
+
+	template<typename T, class MatX, class MatY, class MatD>
+	void pairwise_sqdist(const IDenseMatrix<MatX, T>& x, const IDenseMatrix<MatY, T>& y,
+			IDenseMatrix<MatD, T>& d)
+	{
+		check_arg(x.nrows() == y.nrows(), "x and y should have the same number of rows for pairwise_sqdist");
+		check_arg(d.nrows() == x.ncolumns() && d.ncolumns() == y.ncolumns(),
+				"The size of d is invalid for pairwise_sqdist");
+
+		const index_t m = x.ncolumns();
+		const index_t n = y.ncolumns();
+		const index_t ts = BCS_SQDIST_TILE_SIZE;
+		const index_t ldd = d.lead_dim();
+
+		dense_row<T> nx = sqL2norm(colwise(x));
+		dense_row<T> ny = sqL2norm(colwise(y));
+
+		for (index_t j0 = 0; j0 < n; j0 += ts)
+		{
+			const index_t nb = n - j0 < ts ? n - j0 : ts;
+
+			for (index_t i0 = 0; i0 < m; i0 += ts)
+			{
+				const index_t mb = m - i0 < ts ? m - i0 : ts;
+
+				ref_matrix_ex<T> dt(d.ptr_data() + (i0 + j0 * ldd), mb, nb, ldd);
+				detail::pairwise_sqdist_tile(x, y, nx.ptr_data(), ny.ptr_data(), i0, j0, dt);
+			}
+		}
+	}
+
+	template<typename T, class MatX, class MatY>
+	inline dense_matrix<T> pairwise_sqdist(const IDenseMatrix<MatX, T>& x, const IDenseMatrix<MatY, T>& y)
+	{
+		dense_matrix<T> d(x.ncolumns(), y.ncolumns());
+		pairwise_sqdist(x, y, d);
+		return d;
+	}
+
+	// D(i, j) := ||x_i - x_j||^2 (the product is done by syrk on one
+	// triangle, and the diagonal is exactly zero)
+
+	template<typename T, class MatX>
+	dense_matrix<T> pairwise_sqdist(const IDenseMatrix<MatX, T>& x)
+	{
+		const index_t n = x.ncolumns();
+		dense_matrix<T> d(n, n);
+
+		blas::syrk_t(T(-2), x, T(0), d, 'U');
+
+		dense_row<T> nx = sqL2norm(colwise(x));
+		for (index_t j = 0; j < n; ++j)
+		{
+			T *dj = d.ptr_data() + j * n;
+			for (index_t i = 0; i < j; ++i)
+			{
+				const T v = dj[i] + nx[i] + nx[j];
+				dj[i] = v > T(0) ? v : T(0);
+			}
+			dj[j] = T(0);
+		}
+
+		detail::mirror_upper(d);
+		return d;
+	}
+
+	/**
+	 * Computes the squared distances between the columns of X and Y
+	 * tile by tile, and calls fun(i0, j0, tile) for each tile, where
+	 * tile (of at most tile_rows x tile_cols) holds D(i0:, j0:).
+	 *
+	 * Only one tile is held in memory at a time (it is overwritten
+	 * by the next one after fun returns).
+	 */
+	template<typename T, class MatX, class MatY, class Fun>
+	void pairwise_sqdist_tiles(const IDenseMatrix<MatX, T>& x, const IDenseMatrix<MatY, T>& y,
+			const index_t tile_rows, const index_t tile_cols, Fun fun)
+	{
+		check_arg(x.nrows() == y.nrows(), "x and y should have the same number of rows for pairwise_sqdist_tiles");
+		check_arg(tile_rows > 0 && tile_cols > 0, "The tile size should be positive for pairwise_sqdist_tiles");
+
+		const index_t m = x.ncolumns();
+		const index_t n = y.ncolumns();
+
+		dense_row<T> nx = sqL2norm(colwise(x));
+		dense_row<T> ny = sqL2norm(colwise(y));
+
+		const index_t tm = m < tile_rows ? m : tile_rows;
+		const index_t tn = n < tile_cols ? n : tile_cols;
+		dense_matrix<T> buf(tm, tn);
+
+		for (index_t j0 = 0; j0 < n; j0 += tile_cols)
+		{
+			const index_t nb = n - j0 < tile_cols ? n - j0 : tile_cols;
+
+			for (index_t i0 = 0; i0 < m; i0 += tile_rows)
+			{
+				const index_t mb = m - i0 < tile_rows ? m - i0 : tile_rows;
+
+				ref_matrix_ex<T> dt(buf.ptr_data(), mb, nb, tm);
+				detail::pairwise_sqdist_tile(x, y, nx.ptr_data(), ny.ptr_data(), i0, j0, dt);
+				fun(i0, j0, dt);
+			}
+		}
+	}
+
+}
+
+#endif /* BCSLIB_MATRIX_GRAM_H_ */
@@ -14,6 +14,7 @@
 #define BCSLIB_MATRIX_PROD_H_
 
 #include <bcslib/linalg/mm_evaluators.h>
+#include <bcslib/linalg/bits/mm_chain_internal.h>
 
 namespace bcs
 {
@@ -134,8 +135,217 @@ namespace bcs
 		BCS_ENSURE_INLINE
 		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
 		{
-			mm_evaluator<LArg, RArg>::eval(
-					expr.alpha(), expr.left_arg(), expr.right_arg(), T(0), dst);
+			typedef typename detail::mm_product_evaluator<LArg, RArg>::type impl_t;
+
+			impl_t::eval(expr.alpha(), expr.left_arg(), expr.right_arg(), T(0), dst);
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  Fused additive forms
+	 *
+	 *  For alpha * A * B + beta * C (and the
+	 *  forms with minus), C is first written to
+	 *  the destination, and then the product is
+	 *  added there by a single gemm/gemv call with
+	 *  beta, without a temporary for the product.
+	 *
+	 *  The destination may be C. If it may
+	 *  overlap A or B (or either of them is not
+	 *  a dense matrix), the result is formed in
+	 *  a temporary and then copied to it.
+	 *
+	 ********************************************/
+
+	namespace detail
+	{
+		// an addend coef * arg
+
+		template<class Expr>
+		struct mm_addend
+		{
+			typedef Expr arg_type;
+			typedef typename matrix_traits<Expr>::value_type T;
+
+			BCS_ENSURE_INLINE
+			static const arg_type& arg(const Expr& e) { return e; }
+
+			BCS_ENSURE_INLINE
+			static T coef(const Expr& ) { return T(1); }
+		};
+
+		template<typename T, class Arg>
+		struct mm_addend<unary_ewise_expr<times_scalar<T>, Arg> >
+		{
+			typedef Arg arg_type;
+
+			BCS_ENSURE_INLINE
+			static const arg_type& arg(const unary_ewise_expr<times_scalar<T>, Arg>& e) { return e.arg; }
+
+			BCS_ENSURE_INLINE
+			static T coef(const unary_ewise_expr<times_scalar<T>, Arg>& e) { return e.fun.scalar_arg; }
+		};
+
+		template<typename T, class Arg>
+		struct mm_addend<unary_ewise_expr<unary_negate<T>, Arg> >
+		{
+			typedef Arg arg_type;
+
+			BCS_ENSURE_INLINE
+			static const arg_type& arg(const unary_ewise_expr<unary_negate<T>, Arg>& e) { return e.arg; }
+
+			BCS_ENSURE_INLINE
+			static T coef(const unary_ewise_expr<unary_negate<T>, Arg>& ) { return T(-1); }
+		};
+
+
+		// whether a product operand is known not to overlap the destination
+
+		template<class Arg, bool IsDense=is_dense_mat<Arg>::value>
+		struct mm_disjoint_operand
+		{
+			template<typename T, class DMat>
+			BCS_ENSURE_INLINE
+			static bool test(const Arg&, const IDenseMatrix<DMat, T>&)
+			{
+				return false;  // it may refer to the destination
+			}
+		};
+
+		template<class Arg>
+		struct mm_disjoint_operand<Arg, true>
+		{
+			template<typename T, class DMat>
+			inline static bool test(const Arg& a, const IDenseMatrix<DMat, T>& dst)
+			{
+				if (is_empty(a) || is_empty(dst)) return true;
+
+				const T *a0 = a.ptr_data();
+				const T *a1 = a0 + (a.ncolumns() - 1) * a.lead_dim() + a.nrows();
+				const T *d0 = dst.ptr_data();
+				const T *d1 = d0 + (dst.ncolumns() - 1) * dst.lead_dim() + dst.nrows();
+
+				return a1 <= d0 || d1 <= a0;
+			}
+		};
+
+
+		// dst <- s * prod + t * c
+
+		template<typename T, class LArg, class RArg, class CExpr, class DMat>
+		BCS_ENSURE_INLINE
+		inline void mm_fused_eval(const T s, const mm_expr<LArg, RArg>& prod,
+				const T t, const CExpr& c, IDenseMatrix<DMat, T>& dst)
+		{
+			typedef mm_addend<CExpr> addend_t;
+			typedef typename addend_t::arg_type carg_t;
+			typedef typename mm_product_evaluator<LArg, RArg>::type impl_t;
+
+			const T beta = t * addend_t::coef(c);
+			const carg_t& carg = addend_t::arg(c);
+
+			if (mm_disjoint_operand<LArg>::test(prod.left_arg(), dst) &&
+				mm_disjoint_operand<RArg>::test(prod.right_arg(), dst))
+			{
+				if (beta != T(0) &&
+					static_cast<const void*>(&carg) != static_cast<const void*>(&(dst.derived())))
+				{
+					evaluate_to(carg, dst.derived());
+				}
+
+				impl_t::eval(s * prod.alpha(), prod.left_arg(), prod.right_arg(), beta, dst);
+			}
+			else
+			{
+				// writing c to dst first would clobber an operand
+
+				dense_matrix<T> tmp(prod.nrows(), prod.ncolumns());
+				if (beta != T(0)) evaluate_to(carg, tmp);
+
+				impl_t::eval(s * prod.alpha(), prod.left_arg(), prod.right_arg(), beta, tmp);
+				evaluate_to(tmp, dst.derived());
+			}
+		}
+	}
+
+
+	template<typename T, class LArg, class RArg, class CExpr>
+	struct expr_evaluator<binary_ewise_expr<binary_plus<T>, mm_expr<LArg, RArg>, CExpr> >
+	{
+		typedef binary_ewise_expr<binary_plus<T>, mm_expr<LArg, RArg>, CExpr> expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(1), expr.left_arg, T(1), expr.right_arg, dst);
+		}
+	};
+
+	template<typename T, class CExpr, class LArg, class RArg>
+	struct expr_evaluator<binary_ewise_expr<binary_plus<T>, CExpr, mm_expr<LArg, RArg> > >
+	{
+		typedef binary_ewise_expr<binary_plus<T>, CExpr, mm_expr<LArg, RArg> > expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(1), expr.right_arg, T(1), expr.left_arg, dst);
+		}
+	};
+
+	template<typename T, class LArg1, class RArg1, class LArg2, class RArg2>
+	struct expr_evaluator<binary_ewise_expr<binary_plus<T>, mm_expr<LArg1, RArg1>, mm_expr<LArg2, RArg2> > >
+	{
+		typedef binary_ewise_expr<binary_plus<T>, mm_expr<LArg1, RArg1>, mm_expr<LArg2, RArg2> > expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(1), expr.right_arg, T(1), expr.left_arg, dst);
+		}
+	};
+
+	template<typename T, class LArg, class RArg, class CExpr>
+	struct expr_evaluator<binary_ewise_expr<binary_minus<T>, mm_expr<LArg, RArg>, CExpr> >
+	{
+		typedef binary_ewise_expr<binary_minus<T>, mm_expr<LArg, RArg>, CExpr> expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(1), expr.left_arg, T(-1), expr.right_arg, dst);
+		}
+	};
+
+	template<typename T, class CExpr, class LArg, class RArg>
+	struct expr_evaluator<binary_ewise_expr<binary_minus<T>, CExpr, mm_expr<LArg, RArg> > >
+	{
+		typedef binary_ewise_expr<binary_minus<T>, CExpr, mm_expr<LArg, RArg> > expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(-1), expr.right_arg, T(1), expr.left_arg, dst);
+		}
+	};
+
+	template<typename T, class LArg1, class RArg1, class LArg2, class RArg2>
+	struct expr_evaluator<binary_ewise_expr<binary_minus<T>, mm_expr<LArg1, RArg1>, mm_expr<LArg2, RArg2> > >
+	{
+		typedef binary_ewise_expr<binary_minus<T>, mm_expr<LArg1, RArg1>, mm_expr<LArg2, RArg2> > expr_type;
+
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static void evaluate(const expr_type& expr, IDenseMatrix<DMat, T>& dst)
+		{
+			detail::mm_fused_eval(T(-1), expr.right_arg, T(1), expr.left_arg, dst);
 		}
 	};
 
@@ -178,8 +388,21 @@ namespace bcs
 	{
 		typedef typename matrix_traits<LArg>::value_type T;
 
-		mm_evaluator<LArg, RArg>::eval(
-				expr.alpha(), expr.left_arg(), expr.right_arg(), T(1), lhs);
+		typedef typename detail::mm_product_evaluator<LArg, RArg>::type impl_t;
+
+		impl_t::eval(expr.alpha(), expr.left_arg(), expr.right_arg(), T(1), lhs);
+	}
+
+	template<class DMat, class LArg, class RArg>
+	BCS_ENSURE_INLINE
+	inline void operator -= (
+			IDenseMatrix<DMat, typename matrix_traits<LArg>::value_type>& lhs,
+			const mm_expr<LArg, RArg>& expr)
+	{
+		typedef typename matrix_traits<LArg>::value_type T;
+		typedef typename detail::mm_product_evaluator<LArg, RArg>::type impl_t;
+
+		impl_t::eval(-expr.alpha(), expr.left_arg(), expr.right_arg(), T(1), lhs);
 	}
 
 
@@ -14,6 +14,7 @@
 #define BCSLIB_ARITHMETIC_FUNCTORS_H_
 
 #include <bcslib/core/functional.h>
+#include <bcslib/core/packet.h>
 #include <bcslib/math/scalar_math.h>
 #include <algorithm>
 
@@ -24,44 +25,76 @@ namespace bcs
 	struct binary_plus
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return x + y;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::add(x, y);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct binary_minus
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return x - y;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::sub(x, y);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct binary_times
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return x * y;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::mul(x, y);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct binary_divides
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return x / y;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::div(x, y);
+		}
+#endif
 	};
 
 
@@ -69,6 +102,7 @@ namespace bcs
 	struct plus_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE plus_scalar(const T& s) : scalar_arg(s) { }
@@ -77,12 +111,20 @@ namespace bcs
 		{
 			return x + scalar_arg;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::add(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 	template<typename T>
 	struct minus_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE minus_scalar(const T& s) : scalar_arg(s) { }
@@ -91,12 +133,20 @@ namespace bcs
 		{
 			return x - scalar_arg;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::sub(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 	template<typename T>
 	struct rminus_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE rminus_scalar(const T& s) : scalar_arg(s) { }
@@ -105,12 +155,20 @@ namespace bcs
 		{
 			return scalar_arg - x;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::sub(simd::set1(scalar_arg), x);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct times_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE times_scalar(const T& s) : scalar_arg(s) { }
@@ -119,12 +177,20 @@ namespace bcs
 		{
 			return x * scalar_arg;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::mul(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 	template<typename T>
 	struct divides_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE divides_scalar(const T& s) : scalar_arg(s) { }
@@ -133,12 +199,20 @@ namespace bcs
 		{
 			return x / scalar_arg;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::div(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 	template<typename T>
 	struct rdivides_scalar
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 		T scalar_arg;
 
 		BCS_ENSURE_INLINE rdivides_scalar(const T& s) : scalar_arg(s) { }
@@ -147,6 +221,13 @@ namespace bcs
 		{
 			return scalar_arg / x;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::div(simd::set1(scalar_arg), x);
+		}
+#endif
 	};
 
 
@@ -155,55 +236,95 @@ namespace bcs
 	struct unary_negate
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x) const
 		{
 			return -x;
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::neg(x);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct unary_rcp
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x) const
 		{
 			return bcs::math::rcp(x);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::div(simd::set1(T(1)), x);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct unary_abs
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x) const
 		{
 			return bcs::math::abs(x);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::abs(x);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct unary_sqr
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x) const
 		{
 			return bcs::math::sqr(x);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::mul(x, x);
+		}
+#endif
 	};
 
 	template<typename T>
 	struct unary_cube
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x) const
 		{
 			return bcs::math::cube(x);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::mul(simd::mul(x, x), x);
+		}
+#endif
 	};
 
 
@@ -211,11 +332,19 @@ namespace bcs
 	struct binary_min
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return std::min(x, y);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::min(x, y);
+		}
+#endif
 	};
 
 
@@ -223,6 +352,7 @@ namespace bcs
 	struct unary_min
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		T scalar_arg;
 
@@ -232,6 +362,13 @@ namespace bcs
 		{
 			return std::min(x, scalar_arg);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::min(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 
@@ -239,11 +376,19 @@ namespace bcs
 	struct binary_max
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE T operator() (const T& x, const T& y) const
 		{
 			return std::max(x, y);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x, const packet_type& y) const
+		{
+			return simd::max(x, y);
+		}
+#endif
 	};
 
 
@@ -251,6 +396,7 @@ namespace bcs
 	struct unary_max
 	{
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		T scalar_arg;
 
@@ -260,6 +406,13 @@ namespace bcs
 		{
 			return std::max(x, scalar_arg);
 		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type operator() (const packet_type& x) const
+		{
+			return simd::max(x, simd::set1(scalar_arg));
+		}
+#endif
 	};
 
 
@@ -286,6 +439,28 @@ namespace bcs
 	BCS_DECLARE_EWISE_FUNCTOR( unary_min, 1 )
 	BCS_DECLARE_EWISE_FUNCTOR( unary_max, 1 )
 
+#ifdef BCS_HAS_PACKET
+	BCS_DECLARE_PACKET_FUNCTOR( binary_plus )
+	BCS_DECLARE_PACKET_FUNCTOR( binary_minus )
+	BCS_DECLARE_PACKET_FUNCTOR( binary_times )
+	BCS_DECLARE_PACKET_FUNCTOR( binary_divides )
+	BCS_DECLARE_PACKET_FUNCTOR( plus_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( minus_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( rminus_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( times_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( divides_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( rdivides_scalar )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_negate )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_rcp )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_abs )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_sqr )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_cube )
+	BCS_DECLARE_PACKET_FUNCTOR( binary_min )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_min )
+	BCS_DECLARE_PACKET_FUNCTOR( binary_max )
+	BCS_DECLARE_PACKET_FUNCTOR( unary_max )
+#endif
+
 }
 
 #endif /* EWISE_FUNCTORS_H_ */
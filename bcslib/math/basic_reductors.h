@@ -14,6 +14,7 @@
 #define BCSLIB_REDUCTORS_H_
 
 #include <bcslib/core/basic_defs.h>
+#include <bcslib/core/packet.h>
 #include <bcslib/utils/arg_check.h>
 
 #include <bcslib/math/scalar_math.h>
@@ -34,6 +35,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -49,6 +51,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return x; }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::add(a, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -58,6 +71,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { throw invalid_operation("Attempted to get the mean of an empty array."); }
@@ -73,6 +87,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t n) const { return a / static_cast<T>(n); }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return x; }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::add(a, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -82,6 +107,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { throw invalid_operation("Attempted to get the minimum of an empty array."); }
@@ -97,6 +123,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return x; }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::min(a, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::min(a, a2); }
+#endif
 	};
 
 
@@ -106,6 +143,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { throw invalid_operation("Attempted to get the maximum of an empty array."); }
@@ -121,6 +159,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return x; }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::max(a, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::max(a, a2); }
+#endif
 	};
 
 
@@ -136,6 +185,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -151,6 +201,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return simd::abs(x); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::add(a, simd::abs(x)); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 	template<typename T>
@@ -159,6 +220,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -174,6 +236,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return simd::mul(x, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::add(a, simd::mul(x, x)); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -183,6 +256,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -198,6 +272,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return math::sqrt(a); }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return simd::mul(x, x); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::add(a, simd::mul(x, x)); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -207,6 +292,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -222,6 +308,214 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x) const { return simd::abs(x); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x) const { return simd::max(a, simd::abs(x)); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::max(a, a2); }
+#endif
+	};
+
+
+	/**
+	 * The state of a streaming variance: the number of elements n,
+	 * their mean, and the sum of squared deviations m2 from the mean.
+	 */
+	template<typename T>
+	struct welford_accum
+	{
+		T n;
+		T mean;
+		T m2;
+
+		BCS_ENSURE_INLINE
+		welford_accum() { }
+
+		BCS_ENSURE_INLINE
+		welford_accum(const T& n_, const T& mean_, const T& m2_)
+		: n(n_), mean(mean_), m2(m2_) { }
+	};
+
+
+	/**
+	 * The (unbiased) variance, i.e. the sum of squared deviations
+	 * divided by n - 1. The elements are accumulated by Welford's
+	 * update, and partial results (e.g. of different threads) are
+	 * combined by the pairwise update of Chan et al, so that the
+	 * squares of large means never cancel each other.
+	 */
+	template<typename T>
+	struct var_reductor
+	{
+		typedef T argument_type;
+		typedef welford_accum<T> accum_type;
+		typedef T result_type;
+
+		BCS_ENSURE_INLINE
+		T empty_result() const { throw invalid_operation("Attempted to get the variance of an empty array."); }
+
+		BCS_ENSURE_INLINE
+		accum_type init(const T& x) const { return accum_type(T(1), x, T(0)); }
+
+		BCS_ENSURE_INLINE
+		accum_type add(const accum_type& a, const T& x) const
+		{
+			const T n = a.n + T(1);
+			const T d = x - a.mean;
+			const T mu = a.mean + d / n;
+			return accum_type(n, mu, a.m2 + d * (x - mu));
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type combine(const accum_type& a, const accum_type& a2) const
+		{
+			const T n = a.n + a2.n;
+			const T d = a2.mean - a.mean;
+			return accum_type(n, a.mean + d * (a2.n / n), a.m2 + a2.m2 + d * d * (a.n * a2.n / n));
+		}
+
+		BCS_ENSURE_INLINE
+		T get(const accum_type& a, const index_t) const { return a.n > T(1) ? a.m2 / (a.n - T(1)) : T(0); }
+	};
+
+
+	/********************************************
+	 *
+	 *  Arg reductors
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct indexed_value
+	{
+		T value;
+		index_t index;
+
+		BCS_ENSURE_INLINE
+		indexed_value() { }
+
+		BCS_ENSURE_INLINE
+		indexed_value(const T& v, const index_t i) : value(v), index(i) { }
+	};
+
+	// the current extreme, its index, and the number of elements seen
+
+	template<typename T>
+	struct indexed_accum
+	{
+		T value;
+		index_t index;
+		index_t count;
+
+		BCS_ENSURE_INLINE
+		indexed_accum() { }
+
+		BCS_ENSURE_INLINE
+		indexed_accum(const T& v, const index_t i, const index_t c)
+		: value(v), index(i), count(c) { }
+	};
+
+
+	/**
+	 * The minimum and the index of its first occurrence.
+	 *
+	 * An element is indexed by its position in the sequence, so the
+	 * elements must be added in order, and combine(a, a2) requires
+	 * those of a2 to follow those of a. Hence this is not declared
+	 * associative. The input should not contain NaN.
+	 */
+	template<typename T>
+	struct argmin_reductor
+	{
+		typedef T argument_type;
+		typedef indexed_accum<T> accum_type;
+		typedef indexed_value<T> result_type;
+		typedef typename packet_traits<T>::type packet_type;
+
+		BCS_ENSURE_INLINE
+		result_type empty_result() const { throw invalid_operation("Attempted to get the argmin of an empty array."); }
+
+		BCS_ENSURE_INLINE
+		bool better(const T& x, const T& y) const { return x < y; }
+
+		BCS_ENSURE_INLINE
+		accum_type init(const T& x) const { return accum_type(x, 0, 1); }
+
+		BCS_ENSURE_INLINE
+		accum_type add(const accum_type& a, const T& x) const
+		{
+			return better(x, a.value) ?
+					accum_type(x, a.count, a.count + 1) :
+					accum_type(a.value, a.index, a.count + 1);
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type combine(const accum_type& a, const accum_type& a2) const
+		{
+			return better(a2.value, a.value) ?
+					accum_type(a2.value, a.count + a2.index, a.count + a2.count) :
+					accum_type(a.value, a.index, a.count + a2.count);
+		}
+
+		BCS_ENSURE_INLINE
+		result_type get(const accum_type& a, const index_t) const { return result_type(a.value, a.index); }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type better(const packet_type& x, const packet_type& y) const { return simd::lt(x, y); }
+#endif
+	};
+
+
+	/**
+	 * The maximum and the index of its first occurrence
+	 * (see argmin_reductor).
+	 */
+	template<typename T>
+	struct argmax_reductor
+	{
+		typedef T argument_type;
+		typedef indexed_accum<T> accum_type;
+		typedef indexed_value<T> result_type;
+		typedef typename packet_traits<T>::type packet_type;
+
+		BCS_ENSURE_INLINE
+		result_type empty_result() const { throw invalid_operation("Attempted to get the argmax of an empty array."); }
+
+		BCS_ENSURE_INLINE
+		bool better(const T& x, const T& y) const { return x > y; }
+
+		BCS_ENSURE_INLINE
+		accum_type init(const T& x) const { return accum_type(x, 0, 1); }
+
+		BCS_ENSURE_INLINE
+		accum_type add(const accum_type& a, const T& x) const
+		{
+			return better(x, a.value) ?
+					accum_type(x, a.count, a.count + 1) :
+					accum_type(a.value, a.index, a.count + 1);
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type combine(const accum_type& a, const accum_type& a2) const
+		{
+			return better(a2.value, a.value) ?
+					accum_type(a2.value, a.count + a2.index, a.count + a2.count) :
+					accum_type(a.value, a.index, a.count + a2.count);
+		}
+
+		BCS_ENSURE_INLINE
+		result_type get(const accum_type& a, const index_t) const { return result_type(a.value, a.index); }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type better(const packet_type& x, const packet_type& y) const { return simd::gt(x, y); }
+#endif
 	};
 
 
@@ -237,6 +531,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -252,6 +547,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x, const packet_type& y) const { return simd::mul(x, y); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x, const packet_type& y) const { return simd::add(a, simd::mul(x, y)); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -261,6 +567,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -276,6 +583,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x, const packet_type& y) const { return simd::abs(simd::sub(x, y)); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x, const packet_type& y) const { return simd::add(a, simd::abs(simd::sub(x, y))); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 	template<typename T>
@@ -284,6 +602,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -299,6 +618,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x, const packet_type& y) const { return simd::mul(simd::sub(x, y), simd::sub(x, y)); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x, const packet_type& y) const { return simd::add(a, simd::mul(simd::sub(x, y), simd::sub(x, y))); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -308,6 +638,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -323,6 +654,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return math::sqrt(a); }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x, const packet_type& y) const { return simd::mul(simd::sub(x, y), simd::sub(x, y)); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x, const packet_type& y) const { return simd::add(a, simd::mul(simd::sub(x, y), simd::sub(x, y))); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::add(a, a2); }
+#endif
 	};
 
 
@@ -332,6 +674,7 @@ namespace bcs
 		typedef T argument_type;
 		typedef T accum_type;
 		typedef T result_type;
+		typedef typename packet_traits<T>::type packet_type;
 
 		BCS_ENSURE_INLINE
 		T empty_result() const { return 0; }
@@ -347,6 +690,17 @@ namespace bcs
 
 		BCS_ENSURE_INLINE
 		T get(const T& a, const index_t) const { return a; }
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE
+		packet_type init(const packet_type& x, const packet_type& y) const { return simd::abs(simd::sub(x, y)); }
+
+		BCS_ENSURE_INLINE
+		packet_type add(const packet_type& a, const packet_type& x, const packet_type& y) const { return simd::max(a, simd::abs(simd::sub(x, y))); }
+
+		BCS_ENSURE_INLINE
+		packet_type combine(const packet_type& a, const packet_type& a2) const { return simd::max(a, a2); }
+#endif
 	};
 
 
@@ -361,6 +715,9 @@ namespace bcs
 	BCS_DECLARE_REDUCTOR( sqL2norm_reductor, 1 )
 	BCS_DECLARE_REDUCTOR( L2norm_reductor, 1 )
 	BCS_DECLARE_REDUCTOR( Linfnorm_reductor, 1 )
+	BCS_DECLARE_REDUCTOR( var_reductor, 1 )
+	BCS_DECLARE_REDUCTOR( argmin_reductor, 1 )
+	BCS_DECLARE_REDUCTOR( argmax_reductor, 1 )
 
 	BCS_DECLARE_REDUCTOR( dot_reductor, 2 )
 
@@ -369,6 +726,40 @@ namespace bcs
 	BCS_DECLARE_REDUCTOR( L2diffnorm_reductor, 2 )
 	BCS_DECLARE_REDUCTOR( Linfdiffnorm_reductor, 2 )
 
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( sum_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( mean_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( min_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( max_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( L1norm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( sqL2norm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( L2norm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( Linfnorm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( var_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( dot_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( L1diffnorm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( sqL2diffnorm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( L2diffnorm_reductor )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( Linfdiffnorm_reductor )
+
+	BCS_DECLARE_ARG_REDUCTOR( argmin_reductor )
+	BCS_DECLARE_ARG_REDUCTOR( argmax_reductor )
+
+#ifdef BCS_HAS_PACKET
+	BCS_DECLARE_PACKET_FUNCTOR( sum_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( mean_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( min_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( max_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( L1norm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( sqL2norm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( L2norm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( Linfnorm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( dot_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( L1diffnorm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( sqL2diffnorm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( L2diffnorm_reductor )
+	BCS_DECLARE_PACKET_FUNCTOR( Linfdiffnorm_reductor )
+#endif
+
 }
 
 #endif /* REDUCTION_FUNCTORS_H_ */
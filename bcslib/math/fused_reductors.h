@@ -0,0 +1,222 @@
+/**
+ * @file fused_reductors.h
+ *
+ * The fusion of several reductors into one
+ *
+ * A fused reductor accumulates the states of all its components
+ * at once, such that several statistics (e.g. the mean, variance,
+ * minimum and maximum) are obtained from a single pass over the
+ * data. It is itself a reductor, and thus works with reduce,
+ * colwise_reduce and rowwise_reduce.
+ *
+ * fuse(r1, r2, ...) fuses up to four unary reductors. The results
+ * (and accumulators) are nested fused_value pairs, e.g. (v1, (v2, v3))
+ * for three reductors, of which the k-th is fused_get<k>(v).
+ *
+ * @author Dahua Lin
+ */
+
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#ifndef BCSLIB_FUSED_REDUCTORS_H_
+#define BCSLIB_FUSED_REDUCTORS_H_
+
+#include <bcslib/core/basic_defs.h>
+#include <bcslib/core/functional.h>
+#include <bcslib/core/type_traits.h>
+
+namespace bcs
+{
+
+	/********************************************
+	 *
+	 *  fused values
+	 *
+	 ********************************************/
+
+	template<typename A, typename B>
+	struct fused_value
+	{
+		A first;
+		B second;
+
+		BCS_ENSURE_INLINE
+		fused_value() { }
+
+		BCS_ENSURE_INLINE
+		fused_value(const A& a, const B& b) : first(a), second(b) { }
+	};
+
+
+	// the type of the k-th element of a (nested) fused value
+
+	template<typename V, int K>
+	struct fused_element
+	{
+		typedef V type;
+	};
+
+	template<typename A, typename B>
+	struct fused_element<fused_value<A, B>, 0>
+	{
+		typedef A type;
+	};
+
+	template<typename A, typename B, int K>
+	struct fused_element<fused_value<A, B>, K>
+	{
+		typedef typename fused_element<B, K - 1>::type type;
+	};
+
+
+	namespace detail
+	{
+		template<int K>
+		struct fused_getter
+		{
+			template<typename A, typename B>
+			BCS_ENSURE_INLINE
+			static const typename fused_element<fused_value<A, B>, K>::type&
+			get(const fused_value<A, B>& v)
+			{
+				return fused_getter<K - 1>::get(v.second);
+			}
+		};
+
+		template<>
+		struct fused_getter<0>
+		{
+			template<typename A, typename B>
+			BCS_ENSURE_INLINE
+			static const A& get(const fused_value<A, B>& v)
+			{
+				return v.first;
+			}
+
+			// the last element
+			template<typename V>
+			BCS_ENSURE_INLINE
+			static const V& get(const V& v)
+			{
+				return v;
+			}
+		};
+	}
+
+	template<int K, typename A, typename B>
+	BCS_ENSURE_INLINE
+	inline const typename fused_element<fused_value<A, B>, K>::type&
+	fused_get(const fused_value<A, B>& v)
+	{
+		return detail::fused_getter<K>::get(v);
+	}
+
+
+	/********************************************
+	 *
+	 *  fused reductor
+	 *
+	 ********************************************/
+
+	template<class R1, class R2>
+	struct fused_reductor
+	{
+#ifdef BCS_USE_STATIC_ASSERT
+		static_assert(is_reductor<R1, 1>::value && is_reductor<R2, 1>::value,
+				"R1 and R2 must be unary reductors");
+		static_assert(is_same<typename R1::argument_type, typename R2::argument_type>::value,
+				"R1 and R2 must have the same argument type");
+#endif
+
+		typedef typename R1::argument_type argument_type;
+		typedef fused_value<typename R1::accum_type, typename R2::accum_type> accum_type;
+		typedef fused_value<typename R1::result_type, typename R2::result_type> result_type;
+
+		R1 r1;
+		R2 r2;
+
+		BCS_ENSURE_INLINE
+		fused_reductor() { }
+
+		BCS_ENSURE_INLINE
+		fused_reductor(const R1& a, const R2& b) : r1(a), r2(b) { }
+
+		BCS_ENSURE_INLINE
+		result_type empty_result() const
+		{
+			return result_type(r1.empty_result(), r2.empty_result());
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type init(const argument_type& x) const
+		{
+			return accum_type(r1.init(x), r2.init(x));
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type add(const accum_type& a, const argument_type& x) const
+		{
+			return accum_type(r1.add(a.first, x), r2.add(a.second, x));
+		}
+
+		BCS_ENSURE_INLINE
+		accum_type combine(const accum_type& a, const accum_type& a2) const
+		{
+			return accum_type(r1.combine(a.first, a2.first), r2.combine(a.second, a2.second));
+		}
+
+		BCS_ENSURE_INLINE
+		result_type get(const accum_type& a, const index_t n) const
+		{
+			return result_type(r1.get(a.first, n), r2.get(a.second, n));
+		}
+	};
+
+	template<class R1, class R2>
+	struct is_reductor<fused_reductor<R1, R2>, 1>
+	{
+		static const bool value = true;
+	};
+
+	template<class R1, class R2>
+	struct num_arguments<fused_reductor<R1, R2> >
+	{
+		static const int value = 1;
+	};
+
+	template<class R1, class R2>
+	struct is_associative_reductor<fused_reductor<R1, R2> >
+	{
+		static const bool value =
+				is_associative_reductor<R1>::value && is_associative_reductor<R2>::value;
+	};
+
+
+	template<class R1, class R2>
+	BCS_ENSURE_INLINE
+	inline fused_reductor<R1, R2> fuse(const R1& r1, const R2& r2)
+	{
+		return fused_reductor<R1, R2>(r1, r2);
+	}
+
+	template<class R1, class R2, class R3>
+	BCS_ENSURE_INLINE
+	inline fused_reductor<R1, fused_reductor<R2, R3> >
+	fuse(const R1& r1, const R2& r2, const R3& r3)
+	{
+		return fuse(r1, fuse(r2, r3));
+	}
+
+	template<class R1, class R2, class R3, class R4>
+	BCS_ENSURE_INLINE
+	inline fused_reductor<R1, fused_reductor<R2, fused_reductor<R3, R4> > >
+	fuse(const R1& r1, const R2& r2, const R3& r3, const R4& r4)
+	{
+		return fuse(r1, fuse(r2, r3, r4));
+	}
+
+}
+
+#endif /* BCSLIB_FUSED_REDUCTORS_H_ */
@@ -17,15 +17,17 @@
 #include <bcslib/matrix/bits/offset_helper.h>
 
 #include <bcslib/core/block.h>
+#include <bcslib/core/scratch_pool.h>
 
 #include <algorithm>
+#include <utility>
 
 namespace bcs { namespace detail {
 
 
-	template<typename T, int CTRows, int CTCols> class dense_matrix_internal;
+	template<typename T, int CTRows, int CTCols, class Allocator> class dense_matrix_internal;
 
-	template<typename T, int CTRows, int CTCols>
+	template<typename T, int CTRows, int CTCols, class Allocator>
 	class dense_matrix_internal
 	{
 	public:
@@ -65,8 +67,8 @@ namespace bcs { namespace detail {
 	};
 
 
-	template<typename T, int CTRows>
-	class dense_matrix_internal<T, CTRows, DynamicDim>
+	template<typename T, int CTRows, class Allocator>
+	class dense_matrix_internal<T, CTRows, DynamicDim, Allocator>
 	{
 	public:
 		BCS_ENSURE_INLINE
@@ -78,6 +80,25 @@ namespace bcs { namespace detail {
 				"Invalid construction of dense_matrix (m != CTRows)") )
 		, m_ncols(n) { }
 
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(const dense_matrix_internal& s)
+		: m_blk(s.m_blk), m_ncols(s.m_ncols) { }
+
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(dense_matrix_internal&& s) BCS_NOEXCEPT
+		: m_blk(std::move(s.m_blk)), m_ncols(s.m_ncols)
+		{
+			s.m_ncols = 0;
+		}
+
+		inline dense_matrix_internal& operator = (dense_matrix_internal&& s) BCS_NOEXCEPT
+		{
+			m_blk = std::move(s.m_blk);
+			m_ncols = s.m_ncols;
+			s.m_ncols = 0;
+			return *this;
+		}
+
 		inline void swap(dense_matrix_internal& s)
 		{
 			m_blk.swap(s.m_blk);
@@ -107,13 +128,13 @@ namespace bcs { namespace detail {
 		}
 
 	private:
-		block<T, aligned_allocator<T> > m_blk;
+		block<T, Allocator> m_blk;
 		index_t m_ncols;
 	};
 
 
-	template<typename T, int CTCols>
-	class dense_matrix_internal<T, DynamicDim, CTCols>
+	template<typename T, int CTCols, class Allocator>
+	class dense_matrix_internal<T, DynamicDim, CTCols, Allocator>
 	{
 	public:
 		BCS_ENSURE_INLINE
@@ -125,6 +146,25 @@ namespace bcs { namespace detail {
 				"Invalid construction of dense_matrix (n != CTCols)") )
 		, m_nrows(m) { }
 
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(const dense_matrix_internal& s)
+		: m_blk(s.m_blk), m_nrows(s.m_nrows) { }
+
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(dense_matrix_internal&& s) BCS_NOEXCEPT
+		: m_blk(std::move(s.m_blk)), m_nrows(s.m_nrows)
+		{
+			s.m_nrows = 0;
+		}
+
+		inline dense_matrix_internal& operator = (dense_matrix_internal&& s) BCS_NOEXCEPT
+		{
+			m_blk = std::move(s.m_blk);
+			m_nrows = s.m_nrows;
+			s.m_nrows = 0;
+			return *this;
+		}
+
 		inline void swap(dense_matrix_internal& s)
 		{
 			m_blk.swap(s.m_blk);
@@ -154,13 +194,13 @@ namespace bcs { namespace detail {
 		}
 
 	private:
-		block<T, aligned_allocator<T> > m_blk;
+		block<T, Allocator> m_blk;
 		index_t m_nrows;
 	};
 
 
-	template<typename T>
-	class dense_matrix_internal<T, DynamicDim, DynamicDim>
+	template<typename T, class Allocator>
+	class dense_matrix_internal<T, DynamicDim, DynamicDim, Allocator>
 	{
 	public:
 		BCS_ENSURE_INLINE
@@ -170,6 +210,28 @@ namespace bcs { namespace detail {
 		dense_matrix_internal(index_t m, index_t n)
 		: m_blk(m * n), m_nrows(m), m_ncols(n) { }
 
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(const dense_matrix_internal& s)
+		: m_blk(s.m_blk), m_nrows(s.m_nrows), m_ncols(s.m_ncols) { }
+
+		BCS_ENSURE_INLINE
+		dense_matrix_internal(dense_matrix_internal&& s) BCS_NOEXCEPT
+		: m_blk(std::move(s.m_blk)), m_nrows(s.m_nrows), m_ncols(s.m_ncols)
+		{
+			s.m_nrows = 0;
+			s.m_ncols = 0;
+		}
+
+		inline dense_matrix_internal& operator = (dense_matrix_internal&& s) BCS_NOEXCEPT
+		{
+			m_blk = std::move(s.m_blk);
+			m_nrows = s.m_nrows;
+			m_ncols = s.m_ncols;
+			s.m_nrows = 0;
+			s.m_ncols = 0;
+			return *this;
+		}
+
 		inline void swap(dense_matrix_internal& s)
 		{
 			m_blk.swap(s.m_blk);
@@ -199,7 +261,7 @@ namespace bcs { namespace detail {
 		}
 
 	private:
-		block<T, aligned_allocator<T> > m_blk;
+		block<T, Allocator> m_blk;
 		index_t m_nrows;
 		index_t m_ncols;
 	};
@@ -15,14 +15,150 @@
 
 #include <bcslib/matrix/ewise_matrix_expr.h>
 #include <bcslib/matrix/vector_operations.h>
+#include <bcslib/core/parallel.h>
 
 namespace bcs { namespace detail {
 
 
+	/********************************************
+	 *
+	 *  Transfer of a vector
+	 *
+	 *  Packets are used when both sides support
+	 *  them and the vector is not too short to
+	 *  benefit (short static vectors are better
+	 *  handled by the fully unrolled transfer_vec)
+	 *
+	 ********************************************/
+
+	template<typename T, int CTLen, class SVec, class DVec>
+	struct ewise_use_packets
+	{
+		static const bool value =
+				SVec::has_packet_access && DVec::has_packet_access &&
+				(CTLen == DynamicDim || CTLen >= 4 * packet_traits<T>::width);
+	};
+
+	template<typename T, int CTLen, class SVec, class DVec,
+		bool UsePackets=ewise_use_packets<T, CTLen, SVec, DVec>::value>
+	struct ewise_transfer
+	{
+		BCS_ENSURE_INLINE
+		static void run(const index_t len, const SVec& in, DVec& out, const T *)
+		{
+			transfer_vec<CTLen, SVec, DVec>::run(len, in, out);
+		}
+
+		BCS_ENSURE_INLINE
+		static void run_range(const index_t i0, const index_t i1, const SVec& in, DVec& out, const T *)
+		{
+			for (index_t i = i0; i < i1; ++i) out.set(i, in.get(i));
+		}
+	};
+
+	template<typename T, int CTLen, class SVec, class DVec>
+	struct ewise_transfer<T, CTLen, SVec, DVec, true>
+	{
+		BCS_ENSURE_INLINE
+		static void run(const index_t len, const SVec& in, DVec& out, const T *pdst)
+		{
+			index_t head = packet_head(pdst);
+
+			if (head >= 0)
+			{
+				if (head > len) head = len;
+				transfer_vec_packets<T, SVec, DVec>::run(0, len, head, in, out);
+			}
+			else
+			{
+				transfer_vec<CTLen, SVec, DVec>::run(len, in, out);
+			}
+		}
+
+		BCS_ENSURE_INLINE
+		static void run_range(const index_t i0, const index_t i1, const SVec& in, DVec& out, const T *pdst)
+		{
+			index_t head = packet_head(pdst + i0);
+
+			if (head >= 0)
+			{
+				head = (head < i1 - i0 ? i0 + head : i1);
+				transfer_vec_packets<T, SVec, DVec>::run(i0, i1, head, in, out);
+			}
+			else
+			{
+				for (index_t i = i0; i < i1; ++i) out.set(i, in.get(i));
+			}
+		}
+	};
+
+
+	/********************************************
+	 *
+	 *  Parallel tasks
+	 *
+	 *  Readers and accessors are shared by all
+	 *  threads (they are not modified by get/set),
+	 *  while each thread works on a disjoint range
+	 *  of elements or columns.
+	 *
+	 ********************************************/
+
+	template<typename T, int CTLen, class SVec, class DVec>
+	struct ewise_vector_task
+	{
+		const SVec& in;
+		DVec& out;
+		const T *pdst;
+
+		ewise_vector_task(const SVec& in_, DVec& out_, const T *pdst_)
+		: in(in_), out(out_), pdst(pdst_) { }
+
+		void operator() (const index_t i0, const index_t i1) const
+		{
+			ewise_transfer<T, CTLen, SVec, DVec>::run_range(i0, i1, in, out, pdst);
+		}
+	};
+
+	template<class Expr, class DMat, int CTRows>
+	struct ewise_columns_task
+	{
+		typedef typename colwise_reader_bank<Expr>::type in_bank_t;
+		typedef typename colwise_accessor_bank<DMat>::type out_bank_t;
+		typedef typename in_bank_t::reader_type in_t;
+		typedef typename out_bank_t::accessor_type out_t;
+
+		typedef typename matrix_traits<DMat>::value_type T;
+
+		const in_bank_t& in_bank;
+		out_bank_t& out_bank;
+		DMat& dst;
+		index_t m;
+
+		ewise_columns_task(const in_bank_t& ib, out_bank_t& ob, DMat& d, index_t m_)
+		: in_bank(ib), out_bank(ob), dst(d), m(m_) { }
+
+		void operator() (const index_t j0, const index_t j1) const
+		{
+			for (index_t j = j0; j < j1; ++j)
+			{
+				in_t in(in_bank, j);
+				out_t out(out_bank, j);
+				ewise_transfer<T, CTRows, in_t, out_t>::run(m, in, out, col_ptr(dst, j));
+			}
+		}
+	};
+
+
 	/********************************************
 	 *
 	 *  Evaluation
 	 *
+	 *  Large evaluations (with dynamic sizes) are
+	 *  run in parallel, over element ranges for
+	 *  the single-vector way or over column ranges
+	 *  otherwise.
+	 *
 	 ********************************************/
 
 	template<class Expr, class DMat, int CTSize>
@@ -32,32 +168,44 @@ namespace bcs { namespace detail {
 		typedef typename vec_reader<Expr>::type in_t;
 		typedef typename vec_accessor<DMat>::type out_t;
 
+		typedef typename matrix_traits<DMat>::value_type T;
+
 		in_t in(src);
 		out_t out(dst);
-		transfer_vec<CTSize, in_t, out_t>::run(src.nelems(), in, out);
+
+		const index_t len = src.nelems();
+
+		if (CTSize == DynamicDim && use_parallel(len))
+		{
+			parallel_for(0, len, get_parallel_grain(),
+					ewise_vector_task<T, CTSize, in_t, out_t>(in, out, dst.ptr_data()));
+		}
+		else
+		{
+			ewise_transfer<T, CTSize, in_t, out_t>::run(len, in, out, dst.ptr_data());
+		}
 	}
 
 	template<class Expr, class DMat, int CTRows>
 	inline void ewise_evaluate_by_columns(const Expr& src, DMat& dst)
 	{
-		typedef typename colwise_reader_bank<Expr>::type in_bank_t;
-		typedef typename colwise_accessor_bank<DMat>::type out_bank_t;
-		typedef typename in_bank_t::reader_type in_t;
-		typedef typename out_bank_t::accessor_type out_t;
+		typedef ewise_columns_task<Expr, DMat, CTRows> task_t;
 
-		typedef typename matrix_traits<DMat>::value_type T;
-
-		in_bank_t in_bank(src);
-		out_bank_t out_bank(dst);
+		typename task_t::in_bank_t in_bank(src);
+		typename task_t::out_bank_t out_bank(dst);
 
 		const index_t m = src.nrows();
 		const index_t n = src.ncolumns();
 
-		for (index_t j = 0; j < n; ++j)
+		task_t task(in_bank, out_bank, dst, m);
+
+		if (use_parallel(m * n))
+		{
+			parallel_for(0, n, parallel_column_grain(m), task);
+		}
+		else
 		{
-			in_t in(in_bank, j);
-			out_t out(out_bank, j);
-			transfer_vec<CTRows, in_t, out_t>::run(m, in, out);
+			task(0, n);
 		}
 	}
 
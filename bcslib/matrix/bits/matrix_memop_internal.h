@@ -249,7 +249,7 @@ namespace bcs { namespace detail {
 			}
 			else
 			{
-				fill_elems(a.nelems(), a.ptr_data(), v);
+				bcs::fill_elems(a.nelems(), a.ptr_data(), v);
 			}
 		}
 	};
@@ -282,13 +282,13 @@ namespace bcs { namespace detail {
 
 				if (n == 1)
 				{
-					fill_elems(m, a.ptr_data(), v);
+					bcs::fill_elems(m, a.ptr_data(), v);
 				}
 				else
 				{
 					for (index_t j = 0; j < n; ++j)
 					{
-						fill_elems(m, col_ptr(a, j), v);
+						bcs::fill_elems(m, col_ptr(a, j), v);
 					}
 				}
 			}
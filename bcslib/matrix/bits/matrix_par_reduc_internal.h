@@ -14,17 +14,462 @@
 #define BCSLIB_MATRIX_PAR_REDUC_INTERNAL_H_
 
 #include <bcslib/matrix/vector_operations.h>
+#include <bcslib/core/parallel.h>
+#include <bcslib/core/block.h>
+#include <bcslib/math/basic_reductors.h>
+
+#include <algorithm>
+#include <limits>
 
 namespace bcs { namespace detail {
 
 
+	/********************************************
+	 *
+	 *  Colwise reduction of short columns
+	 *
+	 *  When the columns are short (at most
+	 *  ColwiseReducShortRows), W columns of a
+	 *  dense matrix are interleaved by W x W
+	 *  in-register transposes, such that each
+	 *  lane of a packet accumulates a different
+	 *  column. The rows are visited in order, so
+	 *  the results are the same as those of
+	 *  accumulating the columns one by one.
+	 *
+	 *  The number of rows is a compile-time
+	 *  constant when ct_rows is fixed. Fixed
+	 *  heights below W are left to the generic
+	 *  way, whose (fully unrolled) per-column
+	 *  loops are as fast for them.
+	 *
+	 ********************************************/
+
+	const index_t ColwiseReducShortRows = 16;
+
+	template<class Reductor, class Arg>
+	struct use_short_colwise_reduc
+	{
+		static const int M = ct_rows<Arg>::value;
+
+		static const bool value =
+#ifdef BCS_HAS_PACKET
+				has_packet_op<Reductor>::value &&
+				is_dense_mat<Arg>::value &&
+				is_same<typename Reductor::accum_type, typename matrix_traits<Arg>::value_type>::value &&
+				(M == DynamicDim || (M >= soa_width<typename Reductor::accum_type>::value &&
+						M <= ColwiseReducShortRows));
+#else
+				false;
+#endif
+	};
+
+	template<class Reductor, class LArg, class RArg>
+	struct use_short_colwise_reduc2
+	{
+		static const int M = binary_ct_rows<LArg, RArg>::value;
+
+		static const bool value =
+#ifdef BCS_HAS_PACKET
+				has_packet_op<Reductor>::value &&
+				is_dense_mat<LArg>::value && is_dense_mat<RArg>::value &&
+				is_same<typename Reductor::accum_type, typename matrix_traits<LArg>::value_type>::value &&
+				is_same<typename Reductor::accum_type, typename matrix_traits<RArg>::value_type>::value &&
+				(M == DynamicDim || (M >= soa_width<typename Reductor::accum_type>::value &&
+						M <= ColwiseReducShortRows));
+#else
+				false;
+#endif
+	};
+
+
+	// reduces the columns in [j, j1) in groups of W, and returns the
+	// first column that remains (the generic way is used when it
+	// does not apply)
+
+	template<class Reductor, class Arg, bool Use>
+	struct short_colwise_reduc
+	{
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static index_t run(const Reductor&, const Arg&, const index_t j, const index_t, DMat&)
+		{
+			return j;
+		}
+	};
+
+	template<class Reductor, class LArg, class RArg, bool Use>
+	struct short_colwise_reduc2
+	{
+		template<class DMat>
+		BCS_ENSURE_INLINE
+		static index_t run(const Reductor&, const LArg&, const RArg&, const index_t j, const index_t, DMat&)
+		{
+			return j;
+		}
+	};
+
+#ifdef BCS_HAS_PACKET
+
+	// accumulates the column s + l * ld (of length m) into the l-th
+	// lane of the returned packet, for l in [0, W). The rows are
+	// transposed W at a time, so the rows in [m, r), with r being m
+	// rounded up to a multiple of W, are read (but not used) as well.
+
+	template<class Reductor, int M>
+	BCS_ENSURE_INLINE
+	inline typename packet_traits<typename Reductor::accum_type>::type
+	accum_soa_columns(const Reductor& reduc, const index_t m_,
+			const typename Reductor::accum_type *s, const index_t ld)
+	{
+		typedef typename Reductor::accum_type T;
+		typedef typename packet_traits<T>::type packet_t;
+
+		const int W = soa_block<T>::W;
+		const index_t m = M > 0 ? M : m_;
+
+		packet_t p[W];
+		soa_block<T>::load_packets(s, ld, p);
+
+		packet_t a = reduc.init(p[0]);
+		const int k0 = m < W ? (int)m : W;
+		for (int k = 1; k < k0; ++k) a = reduc.add(a, p[k]);
+
+		for (index_t e = W; e < m; e += W)
+		{
+			soa_block<T>::load_packets(s + e, ld, p);
+
+			const int ke = m - e < W ? (int)(m - e) : W;
+			for (int k = 0; k < ke; ++k) a = reduc.add(a, p[k]);
+		}
+		return a;
+	}
+
+	template<class Reductor, int M>
+	BCS_ENSURE_INLINE
+	inline typename packet_traits<typename Reductor::accum_type>::type
+	accum_soa_columns2(const Reductor& reduc, const index_t m_,
+			const typename Reductor::accum_type *sa, const index_t lda,
+			const typename Reductor::accum_type *sb, const index_t ldb)
+	{
+		typedef typename Reductor::accum_type T;
+		typedef typename packet_traits<T>::type packet_t;
+
+		const int W = soa_block<T>::W;
+		const index_t m = M > 0 ? M : m_;
+
+		packet_t pa[W];
+		packet_t pb[W];
+		soa_block<T>::load_packets(sa, lda, pa);
+		soa_block<T>::load_packets(sb, ldb, pb);
+
+		packet_t a = reduc.init(pa[0], pb[0]);
+		const int k0 = m < W ? (int)m : W;
+		for (int k = 1; k < k0; ++k) a = reduc.add(a, pa[k], pb[k]);
+
+		for (index_t e = W; e < m; e += W)
+		{
+			soa_block<T>::load_packets(sa + e, lda, pa);
+			soa_block<T>::load_packets(sb + e, ldb, pb);
+
+			const int ke = m - e < W ? (int)(m - e) : W;
+			for (int k = 0; k < ke; ++k) a = reduc.add(a, pa[k], pb[k]);
+		}
+		return a;
+	}
+
+	// whether W columns starting at j can be transposed as above, without
+	// reading beyond the last element of a (which is at (n-1)*lda + m-1)
+
+	template<typename T>
+	BCS_ENSURE_INLINE
+	inline bool can_soa_columns(const index_t m, const index_t lda, const index_t j, const index_t n)
+	{
+		const int W = soa_block<T>::W;
+		const index_t r = (m + (W - 1)) / W * W;
+
+		return j + W < n && r <= lda + m;
+	}
+
+	template<class Reductor, class Arg>
+	struct short_colwise_reduc<Reductor, Arg, true>
+	{
+		typedef typename Reductor::accum_type T;
+
+		static const int M = ct_rows<Arg>::value;
+		static const int W = soa_block<T>::W;
+
+		template<class DMat>
+		static index_t run(const Reductor& reduc, const Arg& a, index_t j, const index_t j1, DMat& dst)
+		{
+			const index_t m = a.nrows();
+			if (m < 2 || m > ColwiseReducShortRows) return j;
+
+			const T *pa = a.ptr_data();
+			const index_t lda = a.lead_dim();
+			const index_t n = a.ncolumns();
+
+			BCS_ALIGN(32) T r[W];
+
+			for (; j + W <= j1 && can_soa_columns<T>(m, lda, j, n); j += W)
+			{
+				simd::store(r, accum_soa_columns<Reductor, M>(reduc, m, pa + j * lda, lda));
+				for (int l = 0; l < W; ++l) dst(0, j + l) = reduc.get(r[l], m);
+			}
+			return j;
+		}
+	};
+
+	template<class Reductor, class LArg, class RArg>
+	struct short_colwise_reduc2<Reductor, LArg, RArg, true>
+	{
+		typedef typename Reductor::accum_type T;
+
+		static const int M = binary_ct_rows<LArg, RArg>::value;
+		static const int W = soa_block<T>::W;
+
+		template<class DMat>
+		static index_t run(const Reductor& reduc, const LArg& a, const RArg& b,
+				index_t j, const index_t j1, DMat& dst)
+		{
+			const index_t m = a.nrows();
+			if (m < 2 || m > ColwiseReducShortRows) return j;
+
+			const T *pa = a.ptr_data();
+			const T *pb = b.ptr_data();
+			const index_t lda = a.lead_dim();
+			const index_t ldb = b.lead_dim();
+			const index_t n = a.ncolumns();
+
+			BCS_ALIGN(32) T r[W];
+
+			for (; j + W <= j1 &&
+					can_soa_columns<T>(m, lda, j, n) &&
+					can_soa_columns<T>(m, ldb, j, n); j += W)
+			{
+				simd::store(r, accum_soa_columns2<Reductor, M>(reduc, m,
+						pa + j * lda, lda, pb + j * ldb, ldb));
+				for (int l = 0; l < W; ++l) dst(0, j + l) = reduc.get(r[l], m);
+			}
+			return j;
+		}
+	};
+
+#endif
+
+
+	/********************************************
+	 *
+	 *  Arg reduction kernels
+	 *
+	 *  For arg reductors (argmin / argmax) on
+	 *  dense matrices, the current extremes and
+	 *  their indices are kept in two packets, and
+	 *  updated by compare-and-blend. The indices
+	 *  are represented by values of type T, and
+	 *  are thus exact up to 2^digits.
+	 *
+	 *  Ties are resolved in favor of the smaller
+	 *  index, so the results are the same as
+	 *  those of the scalar reductor.
+	 *
+	 ********************************************/
+
+	template<class Reductor, class Arg>
+	struct use_arg_reduc_kernel
+	{
+		static const bool value =
+#ifdef BCS_HAS_PACKET
+				is_arg_reductor<Reductor>::value &&
+				is_dense_mat<Arg>::value &&
+				is_same<typename Reductor::argument_type, typename matrix_traits<Arg>::value_type>::value;
+#else
+				false;
+#endif
+	};
+
+	template<typename T>
+	BCS_ENSURE_INLINE
+	inline index_t arg_index_bound()
+	{
+		return index_t(1) << std::numeric_limits<T>::digits;
+	}
+
+#ifdef BCS_HAS_PACKET
+
+	// (v, i) := (v2, i2) in the lanes where v2 is better than v, which
+	// is to be used only if the elements of (v2, i2) come later
+
+	template<class Reductor, typename Packet>
+	BCS_ENSURE_INLINE
+	inline void arg_blend(const Reductor& reduc, Packet& v, Packet& i, const Packet& v2, const Packet& i2)
+	{
+		const Packet b = reduc.better(v2, v);
+		v = simd::select(b, v2, v);
+		i = simd::select(b, i2, i);
+	}
+
+	// the extreme of a[0:m) and the first index where it occurs. Long
+	// vectors are split into four consecutive parts scanned together
+	// (for independent dependency chains), whose results are then
+	// combined in order.
+
+	template<class Reductor>
+	inline typename Reductor::result_type
+	arg_reduce_vec(const Reductor& reduc, const index_t m, const typename Reductor::argument_type *a)
+	{
+		typedef typename Reductor::argument_type T;
+		typedef typename packet_traits<T>::type packet_t;
+		const int W = packet_traits<T>::width;
+
+		T v = a[0];
+		index_t k = 0;
+		index_t i = 1;
+
+		if (m >= 4 * W && m <= arg_index_bound<T>())
+		{
+			const index_t L = m / (4 * W) * W;
+
+			BCS_ALIGN(32) T bv[W];
+			BCS_ALIGN(32) T bi[W];
+			for (int l = 0; l < W; ++l) bi[l] = T(l);
+			const packet_t lanes = simd::load(bi);
+			const packet_t step = simd::set1(T(W));
+
+			packet_t pv[4], pi[4], ci[4];
+			for (int q = 0; q < 4; ++q)
+			{
+				pv[q] = simd::loadu(a + q * L);
+				pi[q] = ci[q] = simd::add(lanes, simd::set1(T(q * L)));
+			}
+
+			for (i = W; i < L; i += W)
+			{
+				for (int q = 0; q < 4; ++q)
+				{
+					ci[q] = simd::add(ci[q], step);
+					arg_blend(reduc, pv[q], pi[q], simd::loadu(a + q * L + i), ci[q]);
+				}
+			}
+
+			for (i = 4 * L; i + W <= m; i += W)
+			{
+				arg_blend(reduc, pv[3], pi[3], simd::loadu(a + i), simd::add(lanes, simd::set1(T(i))));
+			}
+
+			for (int q = 1; q < 4; ++q) arg_blend(reduc, pv[0], pi[0], pv[q], pi[q]);
+
+			simd::store(bv, pv[0]);
+			simd::store(bi, pi[0]);
+
+			// the lanes are not in the order of indices
+
+			v = bv[0];
+			k = index_t(bi[0]);
+			for (int l = 1; l < W; ++l)
+			{
+				const index_t kl = index_t(bi[l]);
+				if (reduc.better(bv[l], v) || (!reduc.better(v, bv[l]) && kl < k))
+				{
+					v = bv[l];
+					k = kl;
+				}
+			}
+		}
+
+		for (; i < m; ++i)
+		{
+			if (reduc.better(a[i], v))
+			{
+				v = a[i];
+				k = i;
+			}
+		}
+
+		return typename Reductor::result_type(v, k);
+	}
+
+
+	// reduces (p[0:K), ix[0:K)) into (p[0], ix[0]) pairwise, such that
+	// the dependency chains are log2(K) long (K is a power of 2)
+
+	template<int K>
+	struct arg_tournament
+	{
+		template<class Reductor, typename Packet>
+		BCS_ENSURE_INLINE
+		static void run(const Reductor& reduc, Packet *p, Packet *ix)
+		{
+			arg_tournament<K / 2>::run(reduc, p, ix);
+			arg_tournament<K / 2>::run(reduc, p + K / 2, ix + K / 2);
+			arg_blend(reduc, p[0], ix[0], p[K / 2], ix[K / 2]);
+		}
+	};
+
+	template<>
+	struct arg_tournament<1>
+	{
+		template<class Reductor, typename Packet>
+		BCS_ENSURE_INLINE
+		static void run(const Reductor&, Packet *, Packet *) { }
+	};
+
+
+	// the extremes (and their indices) of the columns s + l * ld (of
+	// length m >= W), for l in [0, W), which are transposed W rows at
+	// a time (see accum_soa_columns). When W
+	// does not divide m, the last block overlaps the one before (the
+	// rows visited twice are never strictly better the second time),
+	// so no rows beyond m are read.
+
+	template<class Reductor, int M>
+	BCS_ENSURE_INLINE
+	inline void arg_soa_columns(const Reductor& reduc, const index_t m_,
+			const typename Reductor::argument_type *s, const index_t ld,
+			typename Reductor::argument_type *rv, typename Reductor::argument_type *ri)
+	{
+		typedef typename Reductor::argument_type T;
+		typedef typename packet_traits<T>::type packet_t;
+
+		const int W = soa_block<T>::W;
+		const index_t m = M > 0 ? M : m_;
+
+		packet_t p[W];
+		packet_t ix[W];
+
+		for (int k = 0; k < W; ++k) ix[k] = simd::set1(T(k));
+		soa_block<T>::load_packets(s, ld, p);
+		arg_tournament<W>::run(reduc, p, ix);
+
+		packet_t v = p[0];
+		packet_t vi = ix[0];
+
+		for (index_t e = W; e < m; e += W)
+		{
+			const index_t e1 = e + W <= m ? e : m - W;
+
+			for (int k = 0; k < W; ++k) ix[k] = simd::set1(T(k));
+			soa_block<T>::load_packets(s + e1, ld, p);
+			arg_tournament<W>::run(reduc, p, ix);
+
+			arg_blend(reduc, v, vi, p[0], simd::add(ix[0], simd::set1(T(e1))));
+		}
+
+		simd::store(rv, v);
+		simd::store(ri, vi);
+	}
+
+#endif
+
+
 	/********************************************
 	 *
 	 *  Evaluation
 	 *
 	 ********************************************/
 
-	template<class Reductor, class Arg, class DMat>
+	template<class Reductor, class Arg, class DMat,
+		bool UseArgKernel=use_arg_reduc_kernel<Reductor, Arg>::value>
 	struct unary_colwise_reduction_evaluator
 	{
 		typedef typename Reductor::result_type result_type;
@@ -33,16 +478,23 @@ namespace bcs { namespace detail {
 		typedef typename colwise_reader_bank<Arg>::type bank_t;
 		typedef typename bank_t::reader_type reader_t;
 
-		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		typedef short_colwise_reduc<Reductor, Arg,
+				use_short_colwise_reduc<Reductor, Arg>::value> short_reduc_t;
+
+		struct task
 		{
-			index_t m = arg.nrows();
-			index_t n = arg.ncolumns();
+			const Reductor& reduc;
+			const Arg& arg;
+			const bank_t& bank;
+			DMat& dst;
+			index_t m;
 
-			if (m > 0)
-			{
-				bank_t bank(arg);
+			task(const Reductor& r, const Arg& a, const bank_t& b, DMat& d, index_t m_)
+			: reduc(r), arg(a), bank(b), dst(d), m(m_) { }
 
-				for (index_t j = 0; j < n; ++j)
+			void operator() (const index_t j0, const index_t j1) const
+			{
+				for (index_t j = short_reduc_t::run(reduc, arg, j0, j1, dst); j < j1; ++j)
 				{
 					reader_t in(bank, j);
 					accum_t s = accum_vec<Reductor,
@@ -51,6 +503,23 @@ namespace bcs { namespace detail {
 					dst(0, j) = reduc.get(s, m);
 				}
 			}
+		};
+
+		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		{
+			index_t m = arg.nrows();
+			index_t n = arg.ncolumns();
+
+			if (m > 0)
+			{
+				bank_t bank(arg);
+				task tsk(reduc, arg, bank, dst, m);
+
+				if (use_parallel(m * n))
+					parallel_for(0, n, parallel_column_grain(m), tsk);
+				else
+					tsk(0, n);
+			}
 			else
 			{
 				fill(dst, reduc.empty_result());
@@ -70,17 +539,26 @@ namespace bcs { namespace detail {
 		typedef typename left_bank_t::reader_type left_reader_t;
 		typedef typename right_bank_t::reader_type right_reader_t;
 
-		static void run(Reductor reduc, const LArg& larg, const RArg& rarg, DMat& dst)
+		typedef short_colwise_reduc2<Reductor, LArg, RArg,
+				use_short_colwise_reduc2<Reductor, LArg, RArg>::value> short_reduc_t;
+
+		struct task
 		{
-			index_t m = larg.nrows();
-			index_t n = larg.ncolumns();
+			const Reductor& reduc;
+			const LArg& larg;
+			const RArg& rarg;
+			const left_bank_t& left_bank;
+			const right_bank_t& right_bank;
+			DMat& dst;
+			index_t m;
 
-			if (m > 0)
-			{
-				left_bank_t left_bank(larg);
-				right_bank_t right_bank(rarg);
+			task(const Reductor& r, const LArg& la, const RArg& ra,
+					const left_bank_t& lb, const right_bank_t& rb, DMat& d, index_t m_)
+			: reduc(r), larg(la), rarg(ra), left_bank(lb), right_bank(rb), dst(d), m(m_) { }
 
-				for (index_t j = 0; j < n; ++j)
+			void operator() (const index_t j0, const index_t j1) const
+			{
+				for (index_t j = short_reduc_t::run(reduc, larg, rarg, j0, j1, dst); j < j1; ++j)
 				{
 					left_reader_t left_in(left_bank, j);
 					right_reader_t right_in(right_bank, j);
@@ -93,6 +571,24 @@ namespace bcs { namespace detail {
 					dst(0, j) = reduc.get(s, m);
 				}
 			}
+		};
+
+		static void run(Reductor reduc, const LArg& larg, const RArg& rarg, DMat& dst)
+		{
+			index_t m = larg.nrows();
+			index_t n = larg.ncolumns();
+
+			if (m > 0)
+			{
+				left_bank_t left_bank(larg);
+				right_bank_t right_bank(rarg);
+				task tsk(reduc, larg, rarg, left_bank, right_bank, dst, m);
+
+				if (use_parallel(m * n))
+					parallel_for(0, n, parallel_column_grain(m), tsk);
+				else
+					tsk(0, n);
+			}
 			else
 			{
 				fill(dst, reduc.empty_result());
@@ -104,104 +600,679 @@ namespace bcs { namespace detail {
 
 
 
-	template<class Reductor, class Arg, class DMat>
-	struct unary_rowwise_reduction_evaluator
+	/********************************************
+	 *
+	 *  Rowwise accumulation
+	 *
+	 *  The rows are processed in blocks, whose
+	 *  accumulators are kept in a private buffer
+	 *  (small enough to stay in L1) while all the
+	 *  columns are swept. The inner loops run down
+	 *  the rows of a column, packet by packet when
+	 *  both the reductor and the readers support
+	 *  packets.
+	 *
+	 *  Large inputs are split among threads by row
+	 *  blocks. When there are too few rows for
+	 *  that, the columns of associative reductors
+	 *  are split instead, and the partial results
+	 *  are combined in the order of the parts.
+	 *
+	 *  Streamed operands (see streamed_colreaders)
+	 *  are evaluated again on each sweep over the
+	 *  columns, so they are swept only once, with
+	 *  a single block of all rows.
+	 *
+	 ********************************************/
+
+#ifndef BCS_ROWWISE_REDUC_BLOCK_BYTES
+#define BCS_ROWWISE_REDUC_BLOCK_BYTES 8192
+#endif
+
+	// the minimum number of rows of a part when split by rows
+	const index_t RowwiseReducMinPartRows = 64;
+
+	template<class Reductor>
+	struct rowwise_reduc_block
+	{
+		static const index_t value = BCS_ROWWISE_REDUC_BLOCK_BYTES / sizeof(typename Reductor::accum_type);
+	};
+
+
+	// acc[0:len) := init / add (column j, rows i0:i0+len)
+
+	template<class Reductor, class Arg,
+		bool UsePacket=use_packet_accum<Reductor, typename colwise_reader_bank<Arg>::type::reader_type>::value>
+	struct rowwise_accum_source
 	{
-		typedef typename Reductor::result_type result_t;
 		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<Arg>::type bank_t;
+		typedef typename bank_t::reader_type reader_t;
 
-#ifdef BCS_USE_STATIC_ASSERT
-		static_assert(bcs::is_same<result_t, accum_t>::value,
-				"rowwise reduction is only supported when accum_type and result_type are identical.");
-#endif
+		static const bool is_streamed = has_streamed_columns<Arg>::value;
+
+		const bank_t& bank;
+
+		explicit rowwise_accum_source(const bank_t& b) : bank(b) { }
+
+		void init(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			reader_t in(bank, j);
+			for (index_t i = 0; i < len; ++i) acc[i] = reduc.init(in.get(i0 + i));
+		}
+
+		void add(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			reader_t in(bank, j);
+			for (index_t i = 0; i < len; ++i) acc[i] = reduc.add(acc[i], in.get(i0 + i));
+		}
+	};
+
+	template<class Reductor, class LArg, class RArg,
+		bool UsePacket=use_packet_accum2<Reductor,
+			typename colwise_reader_bank<LArg>::type::reader_type,
+			typename colwise_reader_bank<RArg>::type::reader_type>::value>
+	struct rowwise_accum_source2
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<LArg>::type left_bank_t;
+		typedef typename colwise_reader_bank<RArg>::type right_bank_t;
+		typedef typename left_bank_t::reader_type left_reader_t;
+		typedef typename right_bank_t::reader_type right_reader_t;
 
+		static const bool is_streamed =
+				has_streamed_columns<LArg>::value || has_streamed_columns<RArg>::value;
+
+		const left_bank_t& left_bank;
+		const right_bank_t& right_bank;
+
+		rowwise_accum_source2(const left_bank_t& lb, const right_bank_t& rb)
+		: left_bank(lb), right_bank(rb) { }
+
+		void init(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			left_reader_t left_in(left_bank, j);
+			right_reader_t right_in(right_bank, j);
+			for (index_t i = 0; i < len; ++i)
+				acc[i] = reduc.init(left_in.get(i0 + i), right_in.get(i0 + i));
+		}
+
+		void add(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			left_reader_t left_in(left_bank, j);
+			right_reader_t right_in(right_bank, j);
+			for (index_t i = 0; i < len; ++i)
+				acc[i] = reduc.add(acc[i], left_in.get(i0 + i), right_in.get(i0 + i));
+		}
+	};
+
+#ifdef BCS_HAS_PACKET
+
+	template<class Reductor, class Arg>
+	struct rowwise_accum_source<Reductor, Arg, true>
+	{
+		typedef typename Reductor::accum_type accum_t;
 		typedef typename colwise_reader_bank<Arg>::type bank_t;
 		typedef typename bank_t::reader_type reader_t;
 
-		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		static const bool is_streamed = has_streamed_columns<Arg>::value;
+
+		const bank_t& bank;
+
+		explicit rowwise_accum_source(const bank_t& b) : bank(b) { }
+
+		void init(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
 		{
-			index_t m = arg.nrows();
-			index_t n = arg.ncolumns();
+			const index_t W = packet_traits<accum_t>::width;
+			reader_t in(bank, j);
+
+			index_t i = 0;
+			for (; i + W <= len; i += W)
+				simd::storeu(acc + i, reduc.init(in.get_packet(i0 + i)));
+			for (; i < len; ++i) acc[i] = reduc.init(in.get(i0 + i));
+		}
+
+		void add(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			const index_t W = packet_traits<accum_t>::width;
+			reader_t in(bank, j);
 
-			if (n > 0)
+			index_t i = 0;
+			for (; i + W <= len; i += W)
+				simd::storeu(acc + i, reduc.add(simd::loadu(acc + i), in.get_packet(i0 + i)));
+			for (; i < len; ++i) acc[i] = reduc.add(acc[i], in.get(i0 + i));
+		}
+	};
+
+	template<class Reductor, class LArg, class RArg>
+	struct rowwise_accum_source2<Reductor, LArg, RArg, true>
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<LArg>::type left_bank_t;
+		typedef typename colwise_reader_bank<RArg>::type right_bank_t;
+		typedef typename left_bank_t::reader_type left_reader_t;
+		typedef typename right_bank_t::reader_type right_reader_t;
+
+		static const bool is_streamed =
+				has_streamed_columns<LArg>::value || has_streamed_columns<RArg>::value;
+
+		const left_bank_t& left_bank;
+		const right_bank_t& right_bank;
+
+		rowwise_accum_source2(const left_bank_t& lb, const right_bank_t& rb)
+		: left_bank(lb), right_bank(rb) { }
+
+		void init(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			const index_t W = packet_traits<accum_t>::width;
+			left_reader_t left_in(left_bank, j);
+			right_reader_t right_in(right_bank, j);
+
+			index_t i = 0;
+			for (; i + W <= len; i += W)
+				simd::storeu(acc + i, reduc.init(left_in.get_packet(i0 + i), right_in.get_packet(i0 + i)));
+			for (; i < len; ++i)
+				acc[i] = reduc.init(left_in.get(i0 + i), right_in.get(i0 + i));
+		}
+
+		void add(const Reductor& reduc, const index_t j, const index_t i0, const index_t len,
+				accum_t* __restrict__ acc) const
+		{
+			const index_t W = packet_traits<accum_t>::width;
+			left_reader_t left_in(left_bank, j);
+			right_reader_t right_in(right_bank, j);
+
+			index_t i = 0;
+			for (; i + W <= len; i += W)
+				simd::storeu(acc + i, reduc.add(simd::loadu(acc + i),
+						left_in.get_packet(i0 + i), right_in.get_packet(i0 + i)));
+			for (; i < len; ++i)
+				acc[i] = reduc.add(acc[i], left_in.get(i0 + i), right_in.get(i0 + i));
+		}
+	};
+
+#endif
+
+
+	template<class Reductor, class Source, class DMat>
+	struct rowwise_reduction_engine
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename vec_accessor<DMat>::type out_t;
+
+		static const index_t RB = rowwise_reduc_block<Reductor>::value;
+
+		// acc[0:len) := the accumulation of rows [i0, i0 + len) over
+		// the columns [j0, j1), in blocks of at most RB rows
+		// (or in a single block for a streamed source)
+
+		static void accum_rows(const Reductor& reduc, const Source& src,
+				const index_t i0, const index_t len, const index_t j0, const index_t j1, accum_t *acc)
+		{
+			const index_t rb = Source::is_streamed ? len : RB;
+
+			for (index_t b = 0; b < len; b += rb)
 			{
-				bank_t bank(arg);
-				typename vec_accessor<DMat>::type out(dst);
+				const index_t bl = len - b < rb ? len - b : rb;
 
-				reader_t in0(bank, 0);
-				for (index_t i = 0; i < m; ++i)
-					out.set(i, reduc.init(in0.get(i)));
+				src.init(reduc, j0, i0 + b, bl, acc + b);
+				for (index_t j = j0 + 1; j < j1; ++j) src.add(reduc, j, i0 + b, bl, acc + b);
+			}
+		}
 
-				for (index_t j = 1; j < n; ++j)
+		// processes the row blocks [b0, b1), each of rb rows
+		struct row_task
+		{
+			const Reductor& reduc;
+			const Source& src;
+			out_t& out;
+			index_t m; index_t n; index_t rb;
+
+			row_task(const Reductor& r, const Source& s, out_t& o, index_t m_, index_t n_, index_t rb_)
+			: reduc(r), src(s), out(o), m(m_), n(n_), rb(rb_) { }
+
+			void operator() (const index_t b0, const index_t b1) const
+			{
+				scoped_block<accum_t> buf(rb);
+				accum_t *acc = buf.ptr_begin();
+
+				for (index_t b = b0; b < b1; ++b)
 				{
-					reader_t in(bank, j);
-					for (index_t i = 0; i < m; ++i)
-						out.set(i, reduc.add(out.get(i), in.get(i)));
+					const index_t i0 = b * rb;
+					const index_t len = m - i0 < rb ? m - i0 : rb;
+
+					accum_rows(reduc, src, i0, len, 0, n, acc);
+					for (index_t i = 0; i < len; ++i) out.set(i0 + i, reduc.get(acc[i], n));
+				}
+			}
+		};
+
+		// accumulates all rows over the columns of the parts [t0, t1)
+		struct col_task
+		{
+			const Reductor& reduc;
+			const Source& src;
+			accum_t *parts;
+			index_t m; index_t n; index_t np;
+
+			col_task(const Reductor& r, const Source& s, accum_t *p, index_t m_, index_t n_, index_t np_)
+			: reduc(r), src(s), parts(p), m(m_), n(n_), np(np_) { }
+
+			void operator() (const index_t t0, const index_t t1) const
+			{
+				for (index_t t = t0; t < t1; ++t)
+				{
+					accum_rows(reduc, src, 0, m, n * t / np, n * (t + 1) / np, parts + t * m);
 				}
+			}
+		};
+
+		static void run(const Reductor& reduc, const Source& src, const index_t m, const index_t n, DMat& dst)
+		{
+			if (n == 0)
+			{
+				fill(dst.derived(), reduc.empty_result());
+				return;
+			}
+
+			out_t out(dst);
+			const index_t nt = use_parallel(m * n) ? get_num_threads() : 1;
+
+			if (nt > 1 && !Source::is_streamed && m >= 2 * RowwiseReducMinPartRows)
+			{
+				// split by row blocks (about four per thread)
+
+				const index_t W = packet_traits<accum_t>::width;
+				index_t rb = (m + 4 * nt - 1) / (4 * nt);
+				if (rb < RowwiseReducMinPartRows) rb = RowwiseReducMinPartRows;
+				if (rb > RB) rb = RB;
+				rb = ((rb + W - 1) / W) * W;
+
+				row_task tsk(reduc, src, out, m, n, rb);
+				parallel_for(0, (m + rb - 1) / rb, 1, tsk);
+			}
+			else if (nt > 1 && use_multi_accum<Reductor>::value && n >= 2 * nt)
+			{
+				// split by columns, and combine the parts
+
+				scoped_block<accum_t> pbuf(m * nt);
+				accum_t *parts = pbuf.ptr_begin();
+
+				col_task tsk(reduc, src, parts, m, n, nt);
+				parallel_for(0, nt, 1, tsk);
 
 				for (index_t i = 0; i < m; ++i)
-					out.set(i, reduc.get(out.get(i), n));
+				{
+					accum_t a = parts[i];
+					for (index_t t = 1; t < nt; ++t) a = reduc.combine(a, parts[t * m + i]);
+					out.set(i, reduc.get(a, n));
+				}
 			}
 			else
 			{
-				fill(dst.derived(), reduc.empty_result());
+				const index_t rb_max = Source::is_streamed ? m : RB;
+				const index_t rb = m < rb_max ? m : rb_max;
+				row_task tsk(reduc, src, out, m, n, rb);
+				if (rb > 0) tsk(0, (m + rb - 1) / rb);
 			}
 		}
 	};
 
 
-	template<class Reductor, class LArg, class RArg, class DMat>
-	struct binary_rowwise_reduction_evaluator
+	template<class Reductor, class Arg, class DMat,
+		bool UseArgKernel=use_arg_reduc_kernel<Reductor, Arg>::value>
+	struct unary_rowwise_reduction_evaluator
 	{
-		typedef typename Reductor::result_type result_t;
-		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<Arg>::type bank_t;
+		typedef rowwise_accum_source<Reductor, Arg> source_t;
+
+		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		{
+			bank_t bank(arg);
+			source_t src(bank);
+
+			rowwise_reduction_engine<Reductor, source_t, DMat>::run(
+					reduc, src, arg.nrows(), arg.ncolumns(), dst);
+		}
+	};
 
-#ifdef BCS_USE_STATIC_ASSERT
-		static_assert(bcs::is_same<result_t, accum_t>::value,
-				"rowwise reduction is only supported when accum_type and result_type are identical.");
-#endif
 
+	template<class Reductor, class LArg, class RArg, class DMat>
+	struct binary_rowwise_reduction_evaluator
+	{
 		typedef typename colwise_reader_bank<LArg>::type left_bank_t;
-		typedef typename left_bank_t::reader_type left_reader_t;
 		typedef typename colwise_reader_bank<RArg>::type right_bank_t;
-		typedef typename right_bank_t::reader_type right_reader_t;
+		typedef rowwise_accum_source2<Reductor, LArg, RArg> source_t;
 
 		static void run(Reductor reduc, const LArg& larg, const RArg& rarg, DMat& dst)
 		{
-			index_t m = larg.nrows();
-			index_t n = larg.ncolumns();
+			left_bank_t left_bank(larg);
+			right_bank_t right_bank(rarg);
+			source_t src(left_bank, right_bank);
 
-			if (n > 0)
-			{
-				left_bank_t left_bank(larg);
-				right_bank_t right_bank(rarg);
-				typename vec_accessor<DMat>::type out(dst);
+			rowwise_reduction_engine<Reductor, source_t, DMat>::run(
+					reduc, src, larg.nrows(), larg.ncolumns(), dst);
+		}
+	};
 
-				left_reader_t left_in0(left_bank, 0);
-				right_reader_t right_in0(right_bank, 0);
 
-				for (index_t i = 0; i < m; ++i)
-					out.set(i, reduc.init(left_in0.get(i), right_in0.get(i)));
+	/********************************************
+	 *
+	 *  Evaluation of arg reductions
+	 *
+	 *  Colwise: the columns are transposed W at
+	 *  a time, such that each lane handles a
+	 *  column (unlike accumulation, this also
+	 *  pays off for long columns, as the lanes
+	 *  need no merging). The remaining columns
+	 *  are scanned by W lanes each.
+	 *
+	 *  Rowwise: the extremes of a block of rows
+	 *  are kept in two buffers, updated a packet
+	 *  at a time while sweeping the columns.
+	 *
+	 ********************************************/
+
+#ifdef BCS_HAS_PACKET
+
+	template<class Reductor, class Arg, class DMat>
+	struct unary_colwise_reduction_evaluator<Reductor, Arg, DMat, true>
+	{
+		typedef typename Reductor::argument_type T;
+		typedef typename Reductor::result_type result_type;
+
+		static const int M = ct_rows<Arg>::value;
+		static const int W = soa_block<T>::W;
+
+		struct task
+		{
+			const Reductor& reduc;
+			const Arg& arg;
+			DMat& dst;
+
+			task(const Reductor& r, const Arg& a, DMat& d)
+			: reduc(r), arg(a), dst(d) { }
+
+			void operator() (index_t j, const index_t j1) const
+			{
+				const index_t m = arg.nrows();
+				const index_t lda = arg.lead_dim();
+				const T *pa = arg.ptr_data();
 
-				for (index_t j = 1; j < n; ++j)
+				if (m >= W && m <= arg_index_bound<T>())
 				{
-					left_reader_t left_in(left_bank, j);
-					right_reader_t right_in(right_bank, j);
+					BCS_ALIGN(32) T rv[W];
+					BCS_ALIGN(32) T ri[W];
 
-					for (index_t i = 0; i < m; ++i)
-						out.set(i, reduc.add(out.get(i), left_in.get(i), right_in.get(i)));
+					for (; j + W <= j1; j += W)
+					{
+						arg_soa_columns<Reductor, M>(reduc, m, pa + j * lda, lda, rv, ri);
+						for (int l = 0; l < W; ++l) dst(0, j + l) = result_type(rv[l], index_t(ri[l]));
+					}
 				}
 
-				for (index_t i = 0; i < m; ++i)
-					out.set(i, reduc.get(out.get(i), n));
+				for (; j < j1; ++j) dst(0, j) = arg_reduce_vec(reduc, m, pa + j * lda);
+			}
+		};
+
+		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		{
+			index_t m = arg.nrows();
+			index_t n = arg.ncolumns();
+
+			if (m > 0)
+			{
+				task tsk(reduc, arg, dst);
+
+				if (use_parallel(m * n))
+					parallel_for(0, n, parallel_column_grain(m), tsk);
+				else
+					tsk(0, n);
 			}
 			else
 			{
-				fill(dst.derived(), reduc.empty_result());
+				fill(dst, reduc.empty_result());
+			}
+		}
+	};
+
+
+	template<class Reductor, class Arg, class DMat>
+	struct unary_rowwise_reduction_evaluator<Reductor, Arg, DMat, true>
+	{
+		typedef typename Reductor::argument_type T;
+		typedef typename Reductor::result_type result_type;
+		typedef typename packet_traits<T>::type packet_t;
+		typedef typename vec_accessor<DMat>::type out_t;
+
+		static const index_t RB = BCS_ROWWISE_REDUC_BLOCK_BYTES / (2 * sizeof(T));
+
+		// processes the row blocks [b0, b1), each of rb rows
+		struct task
+		{
+			const Reductor& reduc;
+			const Arg& arg;
+			out_t& out;
+			index_t rb;
+
+			task(const Reductor& r, const Arg& a, out_t& o, index_t rb_)
+			: reduc(r), arg(a), out(o), rb(rb_) { }
+
+			void operator() (const index_t b0, const index_t b1) const
+			{
+				const index_t W = packet_traits<T>::width;
+				const index_t m = arg.nrows();
+				const index_t n = arg.ncolumns();
+				const index_t lda = arg.lead_dim();
+
+				scoped_block<T> vbuf(rb);
+				scoped_block<T> ibuf(rb);
+				T* __restrict__ bv = vbuf.ptr_begin();
+				T* __restrict__ bi = ibuf.ptr_begin();
+
+				for (index_t b = b0; b < b1; ++b)
+				{
+					const index_t i0 = b * rb;
+					const index_t len = m - i0 < rb ? m - i0 : rb;
+					const T *pa = arg.ptr_data() + i0;
+
+					for (index_t i = 0; i < len; ++i)
+					{
+						bv[i] = pa[i];
+						bi[i] = T(0);
+					}
+
+					for (index_t j = 1; j < n; ++j)
+					{
+						const T *a = pa + j * lda;
+						const packet_t cj = simd::set1(T(j));
+
+						index_t i = 0;
+						for (; i + W <= len; i += W)
+						{
+							const packet_t x = simd::loadu(a + i);
+							const packet_t v = simd::loadu(bv + i);
+							const packet_t c = reduc.better(x, v);
+							simd::storeu(bv + i, simd::select(c, x, v));
+							simd::storeu(bi + i, simd::select(c, cj, simd::loadu(bi + i)));
+						}
+						for (; i < len; ++i)
+						{
+							if (reduc.better(a[i], bv[i]))
+							{
+								bv[i] = a[i];
+								bi[i] = T(j);
+							}
+						}
+					}
+
+					for (index_t i = 0; i < len; ++i)
+						out.set(i0 + i, result_type(bv[i], index_t(bi[i])));
+				}
+			}
+		};
+
+		static void run(Reductor reduc, const Arg& arg, DMat& dst)
+		{
+			const index_t m = arg.nrows();
+			const index_t n = arg.ncolumns();
+
+			if (n == 0)
+			{
+				fill(dst, reduc.empty_result());
+				return;
+			}
+
+			if (n > arg_index_bound<T>())
+			{
+				unary_rowwise_reduction_evaluator<Reductor, Arg, DMat, false>::run(reduc, arg, dst);
+				return;
 			}
+
+			out_t out(dst);
+			const index_t nt = use_parallel(m * n) ? get_num_threads() : 1;
+			const index_t W = packet_traits<T>::width;
+
+			index_t rb = m < RB ? m : RB;
+			if (nt > 1 && m >= 2 * RowwiseReducMinPartRows)
+			{
+				// split by row blocks (about four per thread)
+
+				rb = (m + 4 * nt - 1) / (4 * nt);
+				if (rb < RowwiseReducMinPartRows) rb = RowwiseReducMinPartRows;
+				if (rb > RB) rb = RB;
+				rb = ((rb + W - 1) / W) * W;
+
+				task tsk(reduc, arg, out, rb);
+				parallel_for(0, (m + rb - 1) / rb, 1, tsk);
+			}
+			else if (rb > 0)
+			{
+				task tsk(reduc, arg, out, rb);
+				tsk(0, (m + rb - 1) / rb);
+			}
+		}
+	};
+
+#endif
+
+
+
+	/********************************************
+	 *
+	 *  Colwise top-k selection
+	 *
+	 *  The k best elements seen so far are kept
+	 *  in a heap, whose root is the worst of them,
+	 *  so each further element costs a single
+	 *  comparison unless it enters the heap.
+	 *  "Better" is defined by an arg reductor.
+	 *
+	 ********************************************/
+
+	template<class Reductor>
+	struct indexed_value_precedes
+	{
+		typedef typename Reductor::argument_type T;
+		const Reductor& reduc;
+
+		explicit indexed_value_precedes(const Reductor& r) : reduc(r) { }
+
+		BCS_ENSURE_INLINE
+		bool operator() (const indexed_value<T>& x, const indexed_value<T>& y) const
+		{
+			return reduc.better(x.value, y.value) ||
+					(!reduc.better(y.value, x.value) && x.index < y.index);
 		}
 	};
 
+	template<class Reductor, class Arg>
+	struct colwise_top_k_evaluator
+	{
+		typedef typename Reductor::argument_type T;
+		typedef indexed_value<T> entry_t;
+
+		typedef typename colwise_reader_bank<Arg>::type bank_t;
+		typedef typename bank_t::reader_type reader_t;
+
+		struct task
+		{
+			const Reductor& reduc;
+			const bank_t& bank;
+			dense_matrix<T>& values;
+			dense_matrix<index_t>& indices;
+			index_t m; index_t k;
+
+			task(const Reductor& r, const bank_t& b, dense_matrix<T>& vs, dense_matrix<index_t>& is,
+					index_t m_, index_t k_)
+			: reduc(r), bank(b), values(vs), indices(is), m(m_), k(k_) { }
+
+			void operator() (const index_t j0, const index_t j1) const
+			{
+				indexed_value_precedes<Reductor> pred(reduc);
+
+				scoped_block<entry_t> hbuf(k);
+				entry_t *h = hbuf.ptr_begin();
+
+				for (index_t j = j0; j < j1; ++j)
+				{
+					reader_t in(bank, j);
+
+					for (index_t i = 0; i < k; ++i) h[i] = entry_t(in.get(i), i);
+					std::make_heap(h, h + k, pred);
+
+					for (index_t i = k; i < m; ++i)
+					{
+						const T x = in.get(i);
+						if (reduc.better(x, h[0].value))
+						{
+							std::pop_heap(h, h + k, pred);
+							h[k-1] = entry_t(x, i);
+							std::push_heap(h, h + k, pred);
+						}
+					}
+
+					std::sort_heap(h, h + k, pred);
+
+					for (index_t i = 0; i < k; ++i)
+					{
+						values(i, j) = h[i].value;
+						indices(i, j) = h[i].index;
+					}
+				}
+			}
+		};
+
+		static void run(const Reductor& reduc, const Arg& arg, const index_t k,
+				dense_matrix<T>& values, dense_matrix<index_t>& indices)
+		{
+			const index_t m = arg.nrows();
+			const index_t n = arg.ncolumns();
+
+			check_arg(k >= 0 && k <= m, "top_k: k must be in [0, nrows].");
+
+			values.resize(k, n);
+			indices.resize(k, n);
+
+			if (k > 0 && n > 0)
+			{
+				bank_t bank(arg);
+				task tsk(reduc, bank, values, indices, m, k);
+
+				if (use_parallel(m * n))
+					parallel_for(0, n, parallel_column_grain(m), tsk);
+				else
+					tsk(0, n);
+			}
+		}
+	};
 
 
 } }
@@ -14,6 +14,28 @@
 #define MATRIX_REDUCTION_INTERNAL_H_
 
 #include <bcslib/matrix/vector_operations.h>
+#include <bcslib/core/parallel.h>
+#include <bcslib/core/block.h>
+
+#include <algorithm>
+
+namespace bcs
+{
+	/**
+	 * The number of elements in each part of a partitioned
+	 * full reduction
+	 *
+	 * Note: full reductions of at least ParallelReducBound elements
+	 * (with associative reductors) are split into parts of about
+	 * ParallelReducChunk elements, whose partial results are combined
+	 * with a fixed pairwise tree. The partition only depends on the
+	 * shape of the operands, so that the result is the same for any
+	 * number of threads (including BCSLIB_NO_THREADS).
+	 */
+	const index_t ParallelReducChunk = 65536;
+
+	const index_t ParallelReducBound = 4 * ParallelReducChunk;
+}
 
 namespace bcs { namespace detail {
 
@@ -119,6 +141,345 @@ namespace bcs { namespace detail {
 	}
 
 
+	/********************************************
+	 *
+	 *  partitioned full reduction
+	 *
+	 ********************************************/
+
+	// a reader of the sub-vector that starts at a given offset
+
+	template<class Vec, typename T>
+	class offset_vec_reader
+	: public IVecReader<offset_vec_reader<Vec, T>, T>
+	, private noncopyable
+	{
+	public:
+		typedef T value_type;
+		typedef typename packet_traits<value_type>::type packet_type;
+		static const bool has_packet_access = Vec::has_packet_access;
+
+		BCS_ENSURE_INLINE
+		offset_vec_reader(const Vec& vec, const index_t offset)
+		: m_vec(vec), m_offset(offset) { }
+
+		BCS_ENSURE_INLINE value_type get(const index_t i) const
+		{
+			return m_vec.get(m_offset + i);
+		}
+
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+		{
+			return m_vec.get_packet(m_offset + i);
+		}
+#endif
+
+	private:
+		const Vec& m_vec;
+		const index_t m_offset;
+	};
+
+
+	// partial results, each on its own cache line
+
+	template<typename A>
+	struct padded_accum
+	{
+		BCS_ALIGN(64) A value;
+	};
+
+
+	// parts of consecutive elements (as a single vector)
+
+	template<class Reductor, class Expr>
+	struct linear_reduc_parts
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename vec_reader<Expr>::type in_t;
+		typedef offset_vec_reader<in_t, typename matrix_traits<Expr>::value_type> part_in_t;
+
+		const Reductor& reduc;
+		in_t in;
+		const index_t len;
+
+		linear_reduc_parts(const Reductor& r, const Expr& a)
+		: reduc(r), in(a), len(a.nelems()) { }
+
+		index_t nparts() const
+		{
+			return (len + ParallelReducChunk - 1) / ParallelReducChunk;
+		}
+
+		accum_t operator() (const index_t k) const
+		{
+			const index_t i = k * ParallelReducChunk;
+			part_in_t pin(in, i);
+			return accum_vec<Reductor, DynamicDim, part_in_t>::run(reduc,
+					std::min(len - i, ParallelReducChunk), pin);
+		}
+	};
+
+	template<class Reductor, class LExpr, class RExpr>
+	struct linear_reduc_parts2
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename vec_reader<LExpr>::type left_in_t;
+		typedef typename vec_reader<RExpr>::type right_in_t;
+		typedef offset_vec_reader<left_in_t, typename matrix_traits<LExpr>::value_type> left_part_in_t;
+		typedef offset_vec_reader<right_in_t, typename matrix_traits<RExpr>::value_type> right_part_in_t;
+
+		const Reductor& reduc;
+		left_in_t in1;
+		right_in_t in2;
+		const index_t len;
+
+		linear_reduc_parts2(const Reductor& r, const LExpr& a, const RExpr& b)
+		: reduc(r), in1(a), in2(b), len(a.nelems()) { }
+
+		index_t nparts() const
+		{
+			return (len + ParallelReducChunk - 1) / ParallelReducChunk;
+		}
+
+		accum_t operator() (const index_t k) const
+		{
+			const index_t i = k * ParallelReducChunk;
+			left_part_in_t pin1(in1, i);
+			right_part_in_t pin2(in2, i);
+			return accum_vec2<Reductor, DynamicDim, left_part_in_t, right_part_in_t>::run(reduc,
+					std::min(len - i, ParallelReducChunk), pin1, pin2);
+		}
+	};
+
+
+	// parts of whole columns, or of row blocks of long columns
+	// (columns that are streamed or cached are never split, as each
+	//  reader would evaluate the entire column)
+
+	template<class Reductor, class Expr>
+	struct colwise_reduc_parts
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<Expr>::type bank_t;
+		typedef typename bank_t::reader_type in_t;
+		typedef offset_vec_reader<in_t, typename matrix_traits<Expr>::value_type> part_in_t;
+
+		static const bool can_split_columns = is_dense_mat<Expr>::value;
+
+		const Reductor& reduc;
+		bank_t bank;
+		const index_t m;
+		const index_t n;
+		index_t rb;  // the number of parts per column
+		index_t gc;  // the number of columns per part
+
+		colwise_reduc_parts(const Reductor& r, const Expr& a)
+		: reduc(r), bank(a), m(a.nrows()), n(a.ncolumns())
+		{
+			if (can_split_columns && m > ParallelReducChunk)
+			{
+				rb = (m + ParallelReducChunk - 1) / ParallelReducChunk;
+				gc = 1;
+			}
+			else
+			{
+				rb = 1;
+				gc = m < ParallelReducChunk ? ParallelReducChunk / m : 1;
+			}
+		}
+
+		index_t nparts() const
+		{
+			return rb > 1 ? n * rb : (n + gc - 1) / gc;
+		}
+
+		accum_t operator() (const index_t k) const
+		{
+			if (rb > 1)
+			{
+				const index_t i = (k % rb) * ParallelReducChunk;
+				in_t in(bank, k / rb);
+				part_in_t pin(in, i);
+				return accum_vec<Reductor, DynamicDim, part_in_t>::run(reduc,
+						std::min(m - i, ParallelReducChunk), pin);
+			}
+			else
+			{
+				const index_t j0 = k * gc;
+				const index_t j1 = std::min(j0 + gc, n);
+
+				in_t in0(bank, j0);
+				accum_t s = accum_vec<Reductor, ct_rows<Expr>::value, in_t>::run(reduc, m, in0);
+
+				for (index_t j = j0 + 1; j < j1; ++j)
+				{
+					in_t in(bank, j);
+					s = reduc.combine(s, accum_vec<Reductor, ct_rows<Expr>::value, in_t>::run(reduc, m, in));
+				}
+				return s;
+			}
+		}
+	};
+
+	template<class Reductor, class LExpr, class RExpr>
+	struct colwise_reduc_parts2
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef typename colwise_reader_bank<LExpr>::type left_bank_t;
+		typedef typename colwise_reader_bank<RExpr>::type right_bank_t;
+		typedef typename left_bank_t::reader_type left_in_t;
+		typedef typename right_bank_t::reader_type right_in_t;
+		typedef offset_vec_reader<left_in_t, typename matrix_traits<LExpr>::value_type> left_part_in_t;
+		typedef offset_vec_reader<right_in_t, typename matrix_traits<RExpr>::value_type> right_part_in_t;
+
+		static const int ct_m = binary_ct_rows<LExpr, RExpr>::value;
+		static const bool can_split_columns = is_dense_mat<LExpr>::value && is_dense_mat<RExpr>::value;
+
+		const Reductor& reduc;
+		left_bank_t bank_a;
+		right_bank_t bank_b;
+		const index_t m;
+		const index_t n;
+		index_t rb;  // the number of parts per column
+		index_t gc;  // the number of columns per part
+
+		colwise_reduc_parts2(const Reductor& r, const LExpr& a, const RExpr& b)
+		: reduc(r), bank_a(a), bank_b(b), m(a.nrows()), n(a.ncolumns())
+		{
+			if (can_split_columns && m > ParallelReducChunk)
+			{
+				rb = (m + ParallelReducChunk - 1) / ParallelReducChunk;
+				gc = 1;
+			}
+			else
+			{
+				rb = 1;
+				gc = m < ParallelReducChunk ? ParallelReducChunk / m : 1;
+			}
+		}
+
+		index_t nparts() const
+		{
+			return rb > 1 ? n * rb : (n + gc - 1) / gc;
+		}
+
+		accum_t operator() (const index_t k) const
+		{
+			if (rb > 1)
+			{
+				const index_t i = (k % rb) * ParallelReducChunk;
+				left_in_t in_a(bank_a, k / rb);
+				right_in_t in_b(bank_b, k / rb);
+				left_part_in_t pin_a(in_a, i);
+				right_part_in_t pin_b(in_b, i);
+				return accum_vec2<Reductor, DynamicDim, left_part_in_t, right_part_in_t>::run(reduc,
+						std::min(m - i, ParallelReducChunk), pin_a, pin_b);
+			}
+			else
+			{
+				const index_t j0 = k * gc;
+				const index_t j1 = std::min(j0 + gc, n);
+
+				left_in_t in_a0(bank_a, j0);
+				right_in_t in_b0(bank_b, j0);
+				accum_t s = accum_vec2<Reductor, ct_m, left_in_t, right_in_t>::run(reduc, m, in_a0, in_b0);
+
+				for (index_t j = j0 + 1; j < j1; ++j)
+				{
+					left_in_t in_a(bank_a, j);
+					right_in_t in_b(bank_b, j);
+					s = reduc.combine(s,
+							accum_vec2<Reductor, ct_m, left_in_t, right_in_t>::run(reduc, m, in_a, in_b));
+				}
+				return s;
+			}
+		}
+	};
+
+
+	template<class Parts, typename Slot>
+	struct reduc_parts_task
+	{
+		const Parts& parts;
+		Slot *partials;
+
+		reduc_parts_task(const Parts& p, Slot *s)
+		: parts(p), partials(s) { }
+
+		void operator() (const index_t k0, const index_t k1) const
+		{
+			for (index_t k = k0; k < k1; ++k) partials[k].value = parts(k);
+		}
+	};
+
+
+	// evaluates the parts (in parallel if worthwhile), and combines
+	// their results with a fixed pairwise tree (which keeps the order
+	// of parts, and does not depend on the number of threads)
+
+	template<class Reductor, class Parts>
+	inline typename Reductor::result_type
+	partitioned_full_reduce(const Reductor& reduc, const Parts& parts, const index_t len)
+	{
+		typedef typename Reductor::accum_type accum_t;
+		typedef padded_accum<accum_t> slot_t;
+
+		const index_t np = parts.nparts();
+		scoped_block<slot_t> buf(np, aligned_allocator<slot_t>(64));
+		slot_t *p = buf.ptr_begin();
+
+		reduc_parts_task<Parts, slot_t> tsk(parts, p);
+
+		if (use_parallel(len))
+			parallel_for(0, np, std::max(get_parallel_grain() / ParallelReducChunk, index_t(1)), tsk);
+		else
+			tsk(0, np);
+
+		for (index_t s = 1; s < np; s <<= 1)
+		{
+			for (index_t k = 0; k + s < np; k += (s << 1))
+			{
+				p[k].value = reduc.combine(p[k].value, p[k + s].value);
+			}
+		}
+
+		return reduc.get(p[0].value, len);
+	}
+
+	template<class Reductor, class Expr>
+	inline typename Reductor::result_type
+	partitioned_full_reduce(Reductor reduc, const Expr& a, bool by_columns)
+	{
+		if (by_columns)
+		{
+			colwise_reduc_parts<Reductor, Expr> parts(reduc, a);
+			return partitioned_full_reduce(reduc, parts, a.nelems());
+		}
+		else
+		{
+			linear_reduc_parts<Reductor, Expr> parts(reduc, a);
+			return partitioned_full_reduce(reduc, parts, a.nelems());
+		}
+	}
+
+	template<class Reductor, class LExpr, class RExpr>
+	inline typename Reductor::result_type
+	partitioned_full_reduce(Reductor reduc, const LExpr& a, const RExpr& b, bool by_columns)
+	{
+		if (by_columns)
+		{
+			colwise_reduc_parts2<Reductor, LExpr, RExpr> parts(reduc, a, b);
+			return partitioned_full_reduce(reduc, parts, a.nelems());
+		}
+		else
+		{
+			linear_reduc_parts2<Reductor, LExpr, RExpr> parts(reduc, a, b);
+			return partitioned_full_reduce(reduc, parts, a.nelems());
+		}
+	}
+
+
 	// Unary
 
 	template<typename Reductor, class Expr>
@@ -146,7 +507,11 @@ namespace bcs { namespace detail {
 
 			if (!is_empty(A))
 			{
-				if (prefer_by_columns_way)
+				if (use_multi_accum<Reductor>::value && A.nelems() >= ParallelReducBound)
+				{
+					return partitioned_full_reduce(reduc, A, prefer_by_columns_way);
+				}
+				else if (prefer_by_columns_way)
 				{
 					return full_reduce_by_columns(reduc, A);
 				}
@@ -190,7 +555,11 @@ namespace bcs { namespace detail {
 
 			if (!is_empty(A))
 			{
-				if (prefer_by_columns_way)
+				if (use_multi_accum<Reductor>::value && A.nelems() >= ParallelReducBound)
+				{
+					return partitioned_full_reduce(reduc, A, B, prefer_by_columns_way);
+				}
+				else if (prefer_by_columns_way)
 				{
 					return full_reduce_by_columns(reduc, A, B);
 				}
@@ -3,6 +3,11 @@
  *
  * Internal implementation of matrix transposition
  *
+ * A matrix is recursively split along its longer dimension
+ * until each part fits in a tile (which stays in L1 cache),
+ * and each tile is then transposed block by block with
+ * an in-register micro-kernel.
+ *
  * @author Dahua Lin
  */
 
@@ -14,27 +19,547 @@
 #define BCSLIB_MATRIX_TRANSPOSE_INTERNAL_H_
 
 #include <bcslib/core/basic_defs.h>
+#include <bcslib/core/packet.h>
+#include <bcslib/core/parallel.h>
 
 namespace bcs { namespace detail {
 
-	// TODO: replace this with a faster algorithm
+	const index_t TransposeTileDim = 32;
+
+
+	/********************************************
+	 *
+	 *  micro-kernels
+	 *
+	 *  run:     d (K x K) <- s^T (K x K)
+	 *
+	 *  swap:    a (K x K) <- b^T, b <- a^T
+	 *
+	 *  inplace: a (K x K) <- a^T
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct transpose_kernel
+	{
+		static const index_t size = 4;
+
+		BCS_ENSURE_INLINE
+		static void run(const T *__restrict__ s, const index_t ls, T *__restrict__ d, const index_t ld)
+		{
+			for (index_t j = 0; j < size; ++j)
+				for (index_t i = 0; i < size; ++i) d[j + i * ld] = s[i + j * ls];
+		}
+
+		BCS_ENSURE_INLINE
+		static void swap(T *a, const index_t la, T *b, const index_t lb)
+		{
+			for (index_t j = 0; j < size; ++j)
+			{
+				for (index_t i = 0; i < size; ++i)
+				{
+					T t = a[i + j * la];
+					a[i + j * la] = b[j + i * lb];
+					b[j + i * lb] = t;
+				}
+			}
+		}
+
+		BCS_ENSURE_INLINE
+		static void inplace(T *a, const index_t la)
+		{
+			for (index_t j = 1; j < size; ++j)
+			{
+				for (index_t i = 0; i < j; ++i)
+				{
+					T t = a[i + j * la];
+					a[i + j * la] = a[j + i * la];
+					a[j + i * la] = t;
+				}
+			}
+		}
+	};
+
+
+#ifdef BCS_HAS_PACKET
+
+#ifdef BCS_HAS_PACKET_AVX
+
+	template<>
+	struct transpose_kernel<double>
+	{
+		static const index_t size = 4;
+
+		BCS_ENSURE_INLINE
+		static void trans(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3)
+		{
+			__m256d t0 = _mm256_unpacklo_pd(r0, r1);
+			__m256d t1 = _mm256_unpackhi_pd(r0, r1);
+			__m256d t2 = _mm256_unpacklo_pd(r2, r3);
+			__m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+			r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+			r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+			r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+			r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+
+		BCS_ENSURE_INLINE
+		static void run(const double *s, const index_t ls, double *d, const index_t ld)
+		{
+			__m256d r0 = _mm256_loadu_pd(s);
+			__m256d r1 = _mm256_loadu_pd(s + ls);
+			__m256d r2 = _mm256_loadu_pd(s + 2 * ls);
+			__m256d r3 = _mm256_loadu_pd(s + 3 * ls);
+
+			trans(r0, r1, r2, r3);
+
+			_mm256_storeu_pd(d, r0);
+			_mm256_storeu_pd(d + ld, r1);
+			_mm256_storeu_pd(d + 2 * ld, r2);
+			_mm256_storeu_pd(d + 3 * ld, r3);
+		}
+
+		// all elements are loaded before any is stored
+		BCS_ENSURE_INLINE
+		static void inplace(double *a, const index_t la)
+		{
+			run(a, la, a, la);
+		}
+
+		BCS_ENSURE_INLINE
+		static void swap(double *a, const index_t la, double *b, const index_t lb)
+		{
+			__m256d a0 = _mm256_loadu_pd(a);
+			__m256d a1 = _mm256_loadu_pd(a + la);
+			__m256d a2 = _mm256_loadu_pd(a + 2 * la);
+			__m256d a3 = _mm256_loadu_pd(a + 3 * la);
+
+			__m256d b0 = _mm256_loadu_pd(b);
+			__m256d b1 = _mm256_loadu_pd(b + lb);
+			__m256d b2 = _mm256_loadu_pd(b + 2 * lb);
+			__m256d b3 = _mm256_loadu_pd(b + 3 * lb);
+
+			trans(a0, a1, a2, a3);
+			trans(b0, b1, b2, b3);
+
+			_mm256_storeu_pd(a, b0);
+			_mm256_storeu_pd(a + la, b1);
+			_mm256_storeu_pd(a + 2 * la, b2);
+			_mm256_storeu_pd(a + 3 * la, b3);
+
+			_mm256_storeu_pd(b, a0);
+			_mm256_storeu_pd(b + lb, a1);
+			_mm256_storeu_pd(b + 2 * lb, a2);
+			_mm256_storeu_pd(b + 3 * lb, a3);
+		}
+	};
+
+
+	template<>
+	struct transpose_kernel<float>
+	{
+		static const index_t size = 8;
+
+		BCS_ENSURE_INLINE
+		static void trans(__m256 *r)
+		{
+			__m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+			__m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+			__m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+			__m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+			__m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+			__m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+			__m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+			__m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+			__m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+			__m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+			__m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+			__m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+			__m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+			__m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+			__m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+			__m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+			r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+			r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+			r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+			r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+			r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+			r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+			r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+			r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+		}
+
+		BCS_ENSURE_INLINE
+		static void run(const float *s, const index_t ls, float *d, const index_t ld)
+		{
+			__m256 r[8];
+			for (int k = 0; k < 8; ++k) r[k] = _mm256_loadu_ps(s + k * ls);
+			trans(r);
+			for (int k = 0; k < 8; ++k) _mm256_storeu_ps(d + k * ld, r[k]);
+		}
+
+		// all elements are loaded before any is stored
+		BCS_ENSURE_INLINE
+		static void inplace(float *a, const index_t la)
+		{
+			run(a, la, a, la);
+		}
+
+		BCS_ENSURE_INLINE
+		static void swap(float *a, const index_t la, float *b, const index_t lb)
+		{
+			__m256 ra[8];
+			__m256 rb[8];
+			for (int k = 0; k < 8; ++k) ra[k] = _mm256_loadu_ps(a + k * la);
+			for (int k = 0; k < 8; ++k) rb[k] = _mm256_loadu_ps(b + k * lb);
+			trans(ra);
+			trans(rb);
+			for (int k = 0; k < 8; ++k) _mm256_storeu_ps(a + k * la, rb[k]);
+			for (int k = 0; k < 8; ++k) _mm256_storeu_ps(b + k * lb, ra[k]);
+		}
+	};
+
+#else
+
+	template<>
+	struct transpose_kernel<double>
+	{
+		static const index_t size = 4;
+
+		// the 4 x 4 block is handled as four 2 x 2 sub-blocks, each
+		// transposed in registers, and the off-diagonal sub-blocks are
+		// exchanged at store time
+
+		struct block
+		{
+			__m128d r00, r10, r01, r11, r02, r12, r03, r13;  // r<c><k>: rows [2c, 2c+2) of column k
+		};
+
+		BCS_ENSURE_INLINE
+		static void trans(__m128d& x, __m128d& y)
+		{
+			__m128d t = _mm_unpacklo_pd(x, y);
+			y = _mm_unpackhi_pd(x, y);
+			x = t;
+		}
+
+		BCS_ENSURE_INLINE
+		static void load(const double *s, const index_t ls, block& b)
+		{
+			b.r00 = _mm_loadu_pd(s);
+			b.r10 = _mm_loadu_pd(s + 2);
+			b.r01 = _mm_loadu_pd(s + ls);
+			b.r11 = _mm_loadu_pd(s + ls + 2);
+			b.r02 = _mm_loadu_pd(s + 2 * ls);
+			b.r12 = _mm_loadu_pd(s + 2 * ls + 2);
+			b.r03 = _mm_loadu_pd(s + 3 * ls);
+			b.r13 = _mm_loadu_pd(s + 3 * ls + 2);
+
+			trans(b.r00, b.r01);
+			trans(b.r10, b.r11);
+			trans(b.r02, b.r03);
+			trans(b.r12, b.r13);
+		}
+
+		BCS_ENSURE_INLINE
+		static void store(const block& b, double *d, const index_t ld)
+		{
+			_mm_storeu_pd(d, b.r00);
+			_mm_storeu_pd(d + 2, b.r02);
+			_mm_storeu_pd(d + ld, b.r01);
+			_mm_storeu_pd(d + ld + 2, b.r03);
+			_mm_storeu_pd(d + 2 * ld, b.r10);
+			_mm_storeu_pd(d + 2 * ld + 2, b.r12);
+			_mm_storeu_pd(d + 3 * ld, b.r11);
+			_mm_storeu_pd(d + 3 * ld + 2, b.r13);
+		}
+
+		BCS_ENSURE_INLINE
+		static void run(const double *s, const index_t ls, double *d, const index_t ld)
+		{
+			block b;
+			load(s, ls, b);
+			store(b, d, ld);
+		}
+
+		// all elements are loaded before any is stored
+		BCS_ENSURE_INLINE
+		static void inplace(double *a, const index_t la)
+		{
+			run(a, la, a, la);
+		}
+
+		BCS_ENSURE_INLINE
+		static void swap(double *a, const index_t la, double *b, const index_t lb)
+		{
+			block ba, bb;
+			load(a, la, ba);
+			load(b, lb, bb);
+			store(bb, a, la);
+			store(ba, b, lb);
+		}
+	};
+
+
+	template<>
+	struct transpose_kernel<float>
+	{
+		static const index_t size = 4;
+
+		BCS_ENSURE_INLINE
+		static void run(const float *s, const index_t ls, float *d, const index_t ld)
+		{
+			__m128 r0 = _mm_loadu_ps(s);
+			__m128 r1 = _mm_loadu_ps(s + ls);
+			__m128 r2 = _mm_loadu_ps(s + 2 * ls);
+			__m128 r3 = _mm_loadu_ps(s + 3 * ls);
+
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+			_mm_storeu_ps(d, r0);
+			_mm_storeu_ps(d + ld, r1);
+			_mm_storeu_ps(d + 2 * ld, r2);
+			_mm_storeu_ps(d + 3 * ld, r3);
+		}
+
+		// all elements are loaded before any is stored
+		BCS_ENSURE_INLINE
+		static void inplace(float *a, const index_t la)
+		{
+			run(a, la, a, la);
+		}
+
+		BCS_ENSURE_INLINE
+		static void swap(float *a, const index_t la, float *b, const index_t lb)
+		{
+			__m128 a0 = _mm_loadu_ps(a);
+			__m128 a1 = _mm_loadu_ps(a + la);
+			__m128 a2 = _mm_loadu_ps(a + 2 * la);
+			__m128 a3 = _mm_loadu_ps(a + 3 * la);
+
+			__m128 b0 = _mm_loadu_ps(b);
+			__m128 b1 = _mm_loadu_ps(b + lb);
+			__m128 b2 = _mm_loadu_ps(b + 2 * lb);
+			__m128 b3 = _mm_loadu_ps(b + 3 * lb);
+
+			_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+			_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+			_mm_storeu_ps(a, b0);
+			_mm_storeu_ps(a + la, b1);
+			_mm_storeu_ps(a + 2 * la, b2);
+			_mm_storeu_ps(a + 3 * la, b3);
+
+			_mm_storeu_ps(b, a0);
+			_mm_storeu_ps(b + lb, a1);
+			_mm_storeu_ps(b + 2 * lb, a2);
+			_mm_storeu_ps(b + 3 * lb, a3);
+		}
+	};
+
+#endif
+
+#endif
+
+
+	/********************************************
+	 *
+	 *  tiles
+	 *
+	 ********************************************/
+
+	// d (n x m) <- s^T (s is m x n)
+	template<typename T>
+	inline void transpose_tile(const index_t m, const index_t n,
+			const T *s, const index_t ls, T *d, const index_t ld)
+	{
+		typedef transpose_kernel<T> kernel_t;
+		const index_t K = kernel_t::size;
+
+		const index_t mf = m - m % K;
+		const index_t nf = n - n % K;
+
+		for (index_t j = 0; j < nf; j += K)
+		{
+			for (index_t i = 0; i < mf; i += K)
+				kernel_t::run(s + i + j * ls, ls, d + j + i * ld, ld);
+		}
+
+		for (index_t j = 0; j < n; ++j)
+		{
+			for (index_t i = (j < nf ? mf : 0); i < m; ++i)
+				d[j + i * ld] = s[i + j * ls];
+		}
+	}
+
+	// exchanges a (m x n) and b^T (b is n x m)
+	template<typename T>
+	inline void transpose_swap_tiles(const index_t m, const index_t n,
+			T *a, T *b, const index_t ld)
+	{
+		typedef transpose_kernel<T> kernel_t;
+		const index_t K = kernel_t::size;
+
+		const index_t mf = m - m % K;
+		const index_t nf = n - n % K;
+
+		for (index_t j = 0; j < nf; j += K)
+		{
+			for (index_t i = 0; i < mf; i += K)
+				kernel_t::swap(a + i + j * ld, ld, b + j + i * ld, ld);
+		}
+
+		for (index_t j = 0; j < n; ++j)
+		{
+			for (index_t i = (j < nf ? mf : 0); i < m; ++i)
+			{
+				T t = a[i + j * ld];
+				a[i + j * ld] = b[j + i * ld];
+				b[j + i * ld] = t;
+			}
+		}
+	}
+
+	// transposes a square tile (n x n) in place
+	template<typename T>
+	inline void transpose_diag_tile(const index_t n, T *a, const index_t ld)
+	{
+		typedef transpose_kernel<T> kernel_t;
+		const index_t K = kernel_t::size;
+
+		const index_t nf = n - n % K;
+
+		for (index_t j = 0; j < nf; j += K)
+		{
+			kernel_t::inplace(a + j + j * ld, ld);
+
+			for (index_t i = j + K; i < nf; i += K)
+				kernel_t::swap(a + i + j * ld, ld, a + j + i * ld, ld);
+		}
+
+		for (index_t i = nf; i < n; ++i)
+		{
+			for (index_t j = 0; j < i; ++j)
+			{
+				T t = a[i + j * ld];
+				a[i + j * ld] = a[j + i * ld];
+				a[j + i * ld] = t;
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  recursive transposition
+	 *
+	 ********************************************/
+
+	template<typename T>
+	inline index_t transpose_split(const index_t len)
+	{
+		const index_t K = transpose_kernel<T>::size;
+		index_t h = len / 2;
+		return h - h % K + (h % K ? K : 0);
+	}
+
+	// d (n x m) <- s^T (s is m x n)
+	template<typename T>
+	void transpose_rec(const index_t m, const index_t n,
+			const T *s, const index_t ls, T *d, const index_t ld)
+	{
+		if (m <= TransposeTileDim && n <= TransposeTileDim)
+		{
+			transpose_tile(m, n, s, ls, d, ld);
+		}
+		else if (m >= n)
+		{
+			const index_t h = transpose_split<T>(m);
+			transpose_rec(h, n, s, ls, d, ld);
+			transpose_rec(m - h, n, s + h, ls, d + h * ld, ld);
+		}
+		else
+		{
+			const index_t h = transpose_split<T>(n);
+			transpose_rec(m, h, s, ls, d, ld);
+			transpose_rec(m, n - h, s + h * ls, ls, d + h, ld);
+		}
+	}
+
+	// transposes a square matrix (n x n) in place
+	template<typename T>
+	void transpose_inplace(const index_t n, T *a, const index_t ld)
+	{
+		const index_t B = TransposeTileDim;
+
+		for (index_t j = 0; j < n; j += B)
+		{
+			const index_t nj = (n - j < B ? n - j : B);
+			transpose_diag_tile(nj, a + j + j * ld, ld);
+
+			for (index_t i = j + B; i < n; i += B)
+			{
+				const index_t mi = (n - i < B ? n - i : B);
+				transpose_swap_tiles(mi, nj, a + i + j * ld, a + j + i * ld, ld);
+			}
+		}
+	}
+
+
+	/********************************************
+	 *
+	 *  evaluation
+	 *
+	 ********************************************/
+
+	template<typename T>
+	struct transpose_task
+	{
+		// transposes the columns of src in [j0, j1)
+
+		index_t m;
+		const T *src;
+		index_t src_ldim;
+		T *dst;
+		index_t dst_ldim;
+
+		transpose_task(index_t m_, const T *s, index_t sld, T *d, index_t dld)
+		: m(m_), src(s), src_ldim(sld), dst(d), dst_ldim(dld) { }
+
+		void operator() (const index_t j0, const index_t j1) const
+		{
+			transpose_rec(m, j1 - j0, src + j0 * src_ldim, src_ldim, dst + j0, dst_ldim);
+		}
+	};
+
+
 	template<typename T, int CTRows, int CTCols>
 	struct matrix_transposer
 	{
 		// m x n --> n x m
 		static void run(const index_t m, const index_t n,
-				const T* __restrict__ src, const index_t src_ldim,
-				T* __restrict__ dst, const index_t dst_ldim)
+				const T* src, const index_t src_ldim,
+				T* dst, const index_t dst_ldim)
 		{
-			if (m > n)
+			if (src == dst && m == n && src_ldim == dst_ldim)
+			{
+				transpose_inplace(m, dst, dst_ldim);
+				return;
+			}
+
+			transpose_task<T> task(m, src, src_ldim, dst, dst_ldim);
+
+			if ((CTRows == DynamicDim || CTCols == DynamicDim) && use_parallel(m * n))
 			{
-				for (index_t j = 0; j < n; ++j)
-					unpack_vector(m, src + j * src_ldim, dst + j, dst_ldim);
+				const index_t g = parallel_column_grain(m);
+				parallel_for(0, n, g > TransposeTileDim ? g : TransposeTileDim, task);
 			}
 			else
 			{
-				for (index_t i = 0; i < m; ++i)
-					pack_vector(n, src + i, src_ldim, dst + i * dst_ldim);
+				task(0, n);
 			}
 		}
 	};
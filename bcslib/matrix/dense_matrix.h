@@ -24,8 +24,8 @@ namespace bcs
 	 *
 	 ********************************************/
 
-	template<typename T, int CTRows, int CTCols>
-	struct matrix_traits<dense_matrix<T, CTRows, CTCols> >
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	struct matrix_traits<dense_matrix<T, CTRows, CTCols, Allocator> >
 	{
 		static const int num_dimensions = 2;
 		static const int compile_time_num_rows = CTRows;
@@ -38,27 +38,27 @@ namespace bcs
 		typedef index_t index_type;
 	};
 
-	template<typename T, int CTRows, int CTCols>
-	struct has_continuous_layout<dense_matrix<T, CTRows, CTCols> >
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	struct has_continuous_layout<dense_matrix<T, CTRows, CTCols, Allocator> >
 	{
 		static const bool value = true;
 	};
 
-	template<typename T, int CTRows, int CTCols>
-	struct is_always_aligned<dense_matrix<T, CTRows, CTCols> >
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	struct is_always_aligned<dense_matrix<T, CTRows, CTCols, Allocator> >
 	{
 		static const bool value = true;
 	};
 
-	template<typename T, int CTRows, int CTCols>
-	struct is_linear_accessible<dense_matrix<T, CTRows, CTCols> >
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	struct is_linear_accessible<dense_matrix<T, CTRows, CTCols, Allocator> >
 	{
 		static const bool value = true;
 	};
 
 
-	template<typename T, int CTRows, int CTCols>
-	class dense_matrix : public IDenseMatrix<dense_matrix<T, CTRows, CTCols>, T>
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	class dense_matrix : public IDenseMatrix<dense_matrix<T, CTRows, CTCols, Allocator>, T>
 	{
 	public:
 		BCS_MAT_TRAITS_DEFS(T)
@@ -91,6 +91,11 @@ namespace bcs
 		{
 		}
 
+		BCS_ENSURE_INLINE dense_matrix(dense_matrix&& s) BCS_NOEXCEPT
+		: m_internal(std::move(s.m_internal))
+		{
+		}
+
 		template<class Other>
 		BCS_ENSURE_INLINE dense_matrix(const IMatrixView<Other, T>& r)
 		: m_internal(r.nrows(), r.ncolumns())
@@ -120,6 +125,15 @@ namespace bcs
 			return *this;
 		}
 
+		BCS_ENSURE_INLINE dense_matrix& operator = (dense_matrix&& r) BCS_NOEXCEPT
+		{
+			if (this != &r)
+			{
+				m_internal = std::move(r.m_internal);
+			}
+			return *this;
+		}
+
 		template<class Other>
 		BCS_ENSURE_INLINE dense_matrix& operator = (const IMatrixView<Other, T>& r)
 		{
@@ -201,13 +215,13 @@ namespace bcs
 		}
 
 	private:
-		detail::dense_matrix_internal<T, CTRows, CTCols> m_internal;
+		detail::dense_matrix_internal<T, CTRows, CTCols, Allocator> m_internal;
 	};
 
 
-	template<typename T, int CTRows, int CTCols>
+	template<typename T, int CTRows, int CTCols, class Allocator>
 	BCS_ENSURE_INLINE
-	inline void swap(dense_matrix<T, CTRows, CTCols>& a, dense_matrix<T, CTRows, CTCols>& b)
+	inline void swap(dense_matrix<T, CTRows, CTCols, Allocator>& a, dense_matrix<T, CTRows, CTCols, Allocator>& b)
 	{
 		a.swap(b);
 	}
@@ -237,6 +251,10 @@ namespace bcs
 
 		BCS_ENSURE_INLINE dense_col(const dense_col& s) : base_mat_t(s) { }
 
+		BCS_ENSURE_INLINE dense_col(base_mat_t&& s) BCS_NOEXCEPT : base_mat_t(std::move(s)) { }
+
+		BCS_ENSURE_INLINE dense_col(dense_col&& s) BCS_NOEXCEPT : base_mat_t(std::move(s)) { }
+
 		template<class Other>
 		BCS_ENSURE_INLINE dense_col(const IMatrixView<Other, T>& r) : base_mat_t(r) { }
 
@@ -250,6 +268,24 @@ namespace bcs
 			return *this;
 		}
 
+		BCS_ENSURE_INLINE dense_col& operator = (const dense_col& r)
+		{
+			base_mat_t::operator = (r);
+			return *this;
+		}
+
+		BCS_ENSURE_INLINE dense_col& operator = (base_mat_t&& r) BCS_NOEXCEPT
+		{
+			base_mat_t::operator = (std::move(r));
+			return *this;
+		}
+
+		BCS_ENSURE_INLINE dense_col& operator = (dense_col&& r) BCS_NOEXCEPT
+		{
+			base_mat_t::operator = (std::move(r));
+			return *this;
+		}
+
 		template<class Other>
 		BCS_ENSURE_INLINE dense_col& operator = (const IMatrixView<Other, T>& r)
 		{
@@ -284,6 +320,10 @@ namespace bcs
 
 		BCS_ENSURE_INLINE dense_row(const dense_row& s) : base_mat_t(s) { }
 
+		BCS_ENSURE_INLINE dense_row(base_mat_t&& s) BCS_NOEXCEPT : base_mat_t(std::move(s)) { }
+
+		BCS_ENSURE_INLINE dense_row(dense_row&& s) BCS_NOEXCEPT : base_mat_t(std::move(s)) { }
+
 		template<class Expr>
 		BCS_ENSURE_INLINE dense_row(const IMatrixXpr<Expr, T>& r) : base_mat_t(r) { }
 
@@ -294,6 +334,24 @@ namespace bcs
 			return *this;
 		}
 
+		BCS_ENSURE_INLINE dense_row& operator = (const dense_row& r)
+		{
+			base_mat_t::operator = (r);
+			return *this;
+		}
+
+		BCS_ENSURE_INLINE dense_row& operator = (base_mat_t&& r) BCS_NOEXCEPT
+		{
+			base_mat_t::operator = (std::move(r));
+			return *this;
+		}
+
+		BCS_ENSURE_INLINE dense_row& operator = (dense_row&& r) BCS_NOEXCEPT
+		{
+			base_mat_t::operator = (std::move(r));
+			return *this;
+		}
+
 		template<class Other>
 		BCS_ENSURE_INLINE dense_row& operator = (const IMatrixView<Other, T>& r)
 		{
@@ -310,10 +368,10 @@ namespace bcs
 	};
 
 
-	template<typename T, int CTRows, int CTCols>
-	struct expr_evaluator<dense_matrix<T, CTRows, CTCols> >
+	template<typename T, int CTRows, int CTCols, class Allocator>
+	struct expr_evaluator<dense_matrix<T, CTRows, CTCols, Allocator> >
 	{
-		typedef dense_matrix<T, CTRows, CTCols> expr_type;
+		typedef dense_matrix<T, CTRows, CTCols, Allocator> expr_type;
 
 		template<class DMat>
 		BCS_ENSURE_INLINE
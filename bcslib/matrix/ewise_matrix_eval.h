@@ -32,6 +32,14 @@ namespace bcs
 	public:
 		typedef unary_ewise_expr<Fun, Arg> expr_type;
 		typedef typename Fun::result_type value_type;
+		typedef typename packet_traits<value_type>::type packet_type;
+
+	private:
+		typedef typename vec_reader<Arg>::type arg_reader_t;
+
+	public:
+		static const bool has_packet_access =
+				has_packet_op<Fun>::value && arg_reader_t::has_packet_access;
 
 		BCS_ENSURE_INLINE
 		explicit unary_ewise_linear_reader(const expr_type& expr)
@@ -45,9 +53,15 @@ namespace bcs
 			return fun(arg_reader.get(i));
 		}
 
+		BCS_ENSURE_INLINE
+		packet_type get_packet(const index_t i) const
+		{
+			return fun(arg_reader.get_packet(i));
+		}
+
 	private:
 		Fun fun;
-		typename vec_reader<Arg>::type arg_reader;
+		arg_reader_t arg_reader;
 	};
 
 
@@ -59,6 +73,15 @@ namespace bcs
 	public:
 		typedef binary_ewise_expr<Fun, LArg, RArg> expr_type;
 		typedef typename Fun::result_type value_type;
+		typedef typename packet_traits<value_type>::type packet_type;
+
+	private:
+		typedef typename vec_reader<LArg>::type left_reader_t;
+		typedef typename vec_reader<RArg>::type right_reader_t;
+
+	public:
+		static const bool has_packet_access = has_packet_op<Fun>::value &&
+				left_reader_t::has_packet_access && right_reader_t::has_packet_access;
 
 		BCS_ENSURE_INLINE
 		explicit binary_ewise_linear_reader(const expr_type& expr)
@@ -74,10 +97,16 @@ namespace bcs
 			return fun(left_in.get(i), right_in.get(i));
 		}
 
+		BCS_ENSURE_INLINE
+		packet_type get_packet(const index_t i) const
+		{
+			return fun(left_in.get_packet(i), right_in.get_packet(i));
+		}
+
 	private:
 		Fun fun;
-		typename vec_reader<LArg>::type left_in;
-		typename vec_reader<RArg>::type right_in;
+		left_reader_t left_in;
+		right_reader_t right_in;
 	};
 
 
@@ -105,6 +134,10 @@ namespace bcs
 		class reader_type : public IVecReader<reader_type, value_type>, private noncopyable
 		{
 		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access =
+					has_packet_op<Fun>::value && arg_col_reader_t::has_packet_access;
+
 			BCS_ENSURE_INLINE
 			reader_type(const unary_ewise_colreaders& host, const index_t j)
 			: m_fun(host.m_fun), m_in(host.m_arg_banks, j)
@@ -117,6 +150,12 @@ namespace bcs
 				return m_fun(m_in.get(i));
 			}
 
+			BCS_ENSURE_INLINE
+			packet_type get_packet(const index_t i) const
+			{
+				return m_fun(m_in.get_packet(i));
+			}
+
 		private:
 			const Fun& m_fun;
 			arg_col_reader_t m_in;
@@ -157,6 +196,10 @@ namespace bcs
 		class reader_type : public IVecReader<reader_type, value_type>, private noncopyable
 		{
 		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = has_packet_op<Fun>::value &&
+					left_arg_col_reader_t::has_packet_access && right_arg_col_reader_t::has_packet_access;
+
 			BCS_ENSURE_INLINE
 			reader_type(const binary_ewise_colreaders& host, const index_t j)
 			: m_fun(host.m_fun)
@@ -171,6 +214,12 @@ namespace bcs
 				return m_fun(m_left_in.get(i), m_right_in.get(i));
 			}
 
+			BCS_ENSURE_INLINE
+			packet_type get_packet(const index_t i) const
+			{
+				return m_fun(m_left_in.get_packet(i), m_right_in.get_packet(i));
+			}
+
 		private:
 			const Fun& m_fun;
 			left_arg_col_reader_t m_left_in;
@@ -231,6 +280,18 @@ namespace bcs
 		typedef binary_ewise_colreaders<Fun, LArg, RArg> type;
 	};
 
+	template<typename Fun, class Arg>
+	struct has_streamed_columns<unary_ewise_expr<Fun, Arg> >
+	{
+		static const bool value = has_streamed_columns<Arg>::value;
+	};
+
+	template<typename Fun, class LArg, class RArg>
+	struct has_streamed_columns<binary_ewise_expr<Fun, LArg, RArg> >
+	{
+		static const bool value = has_streamed_columns<LArg>::value || has_streamed_columns<RArg>::value;
+	};
+
 
 
 	/********************************************
@@ -45,7 +45,8 @@ namespace bcs
 	{
 	public:
 		typedef typename matrix_traits<Expr>::value_type value_type;
-		typedef dense_matrix<value_type, ct_rows<Expr>::value, ct_cols<Expr>::value> captured_type;
+		typedef dense_matrix<value_type, ct_rows<Expr>::value, ct_cols<Expr>::value,
+				scratch_allocator<value_type> > captured_type;
 
 		BCS_ENSURE_INLINE
 		explicit matrix_capture(const Expr& expr)
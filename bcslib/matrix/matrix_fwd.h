@@ -49,7 +49,11 @@ namespace bcs
 
 	// forward declaration of some important types
 
-	template<typename T, int CTRows=DynamicDim, int CTCols=DynamicDim> class dense_matrix; // guranteed to be aligned
+	template<typename T> class aligned_allocator;
+	template<typename T> class scratch_allocator;
+
+	template<typename T, int CTRows=DynamicDim, int CTCols=DynamicDim,
+		class Allocator=aligned_allocator<T> > class dense_matrix; // guranteed to be aligned
 	template<typename T, int CTRows=DynamicDim> class dense_col;
 	template<typename T, int CTCols=DynamicDim> class dense_row;
 
@@ -91,6 +95,8 @@ namespace bcs
 	template<class Expr> struct colwise_reader_bank;	// dispatch Expr --> column-wise reader bank
 	template<class Expr> struct colwise_accessor_bank; 	// dispatch Expr --> column-wise accessor bank
 
+	template<class Expr> struct block_evaluator;		// evaluation of column panels (for streaming)
+
 
 	// forward declaration of useful memory operations
 
@@ -18,6 +18,7 @@
 
 #include <bcslib/matrix/bits/matrix_par_reduc_internal.h>
 #include <bcslib/math/basic_reductors.h>
+#include <bcslib/math/fused_reductors.h>
 
 
 namespace bcs
@@ -446,6 +447,25 @@ namespace bcs
 	}
 
 
+	// var
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_colwise_reduction_expr<var_reductor<T>, Mat>
+	var(const_colwise_proxy<Mat, T> proxy)
+	{
+		return colwise_reduce(var_reductor<T>(), proxy.ref());
+	}
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_rowwise_reduction_expr<var_reductor<T>, Mat>
+	var(const_rowwise_proxy<Mat, T> proxy)
+	{
+		return rowwise_reduce(var_reductor<T>(), proxy.ref());
+	}
+
+
 	// min
 
 	template<typename T, class Mat>
@@ -483,6 +503,42 @@ namespace bcs
 		return rowwise_reduce(max_reductor<T>(), proxy.ref());
 	}
 
+	// argmin
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_colwise_reduction_expr<argmin_reductor<T>, Mat>
+	argmin(const_colwise_proxy<Mat, T> proxy)
+	{
+		return colwise_reduce(argmin_reductor<T>(), proxy.ref());
+	}
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_rowwise_reduction_expr<argmin_reductor<T>, Mat>
+	argmin(const_rowwise_proxy<Mat, T> proxy)
+	{
+		return rowwise_reduce(argmin_reductor<T>(), proxy.ref());
+	}
+
+	// argmax
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_colwise_reduction_expr<argmax_reductor<T>, Mat>
+	argmax(const_colwise_proxy<Mat, T> proxy)
+	{
+		return colwise_reduce(argmax_reductor<T>(), proxy.ref());
+	}
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	unary_rowwise_reduction_expr<argmax_reductor<T>, Mat>
+	argmax(const_rowwise_proxy<Mat, T> proxy)
+	{
+		return rowwise_reduce(argmax_reductor<T>(), proxy.ref());
+	}
+
 	// L1norm
 
 	template<typename T, class Mat>
@@ -650,6 +706,39 @@ namespace bcs
 		return rowwise_reduce(Linfdiffnorm_reductor<T>(), lproxy.ref(), rproxy.ref());
 	}
 
+
+
+	/********************************************
+	 *
+	 *  Colwise top-k selection
+	 *
+	 ********************************************/
+
+	/**
+	 * The k largest values of each column, in descending order,
+	 * together with their row indices (equal values are ordered
+	 * by index). values and indices are resized to k x n.
+	 */
+	template<typename T, class Mat>
+	void top_k(const_colwise_proxy<Mat, T> proxy, const index_t k,
+			dense_matrix<T>& values, dense_matrix<index_t>& indices)
+	{
+		detail::colwise_top_k_evaluator<argmax_reductor<T>, Mat>::run(
+				argmax_reductor<T>(), proxy.ref(), k, values, indices);
+	}
+
+	/**
+	 * The k smallest values of each column, in ascending order,
+	 * together with their row indices (see top_k).
+	 */
+	template<typename T, class Mat>
+	void bottom_k(const_colwise_proxy<Mat, T> proxy, const index_t k,
+			dense_matrix<T>& values, dense_matrix<index_t>& indices)
+	{
+		detail::colwise_top_k_evaluator<argmin_reductor<T>, Mat>::run(
+				argmin_reductor<T>(), proxy.ref(), k, values, indices);
+	}
+
 }
 
 
@@ -15,6 +15,7 @@
 
 #include <bcslib/matrix/bits/matrix_reduction_internal.h>
 #include <bcslib/math/basic_reductors.h>
+#include <bcslib/math/fused_reductors.h>
 
 namespace bcs
 {
@@ -79,6 +80,13 @@ namespace bcs
 		return reduce(mean_reductor<T>(), A);
 	}
 
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	T var(const IMatrixXpr<Mat, T>& A)
+	{
+		return reduce(var_reductor<T>(), A);
+	}
+
 	template<typename T, class Mat>
 	BCS_ENSURE_INLINE
 	T min_val(const IMatrixXpr<Mat, T>& A)
@@ -93,6 +101,22 @@ namespace bcs
 		return reduce(max_reductor<T>(), A);
 	}
 
+	// the index is that of column-major order
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	indexed_value<T> argmin(const IMatrixXpr<Mat, T>& A)
+	{
+		return reduce(argmin_reductor<T>(), A);
+	}
+
+	template<typename T, class Mat>
+	BCS_ENSURE_INLINE
+	indexed_value<T> argmax(const IMatrixXpr<Mat, T>& A)
+	{
+		return reduce(argmax_reductor<T>(), A);
+	}
+
 	template<typename T, class Mat>
 	BCS_ENSURE_INLINE
 	T L1norm(const IMatrixXpr<Mat, T>& A)
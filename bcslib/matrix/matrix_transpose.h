@@ -132,6 +132,26 @@ namespace bcs
 
 
 
+	template<class Mat>
+	struct block_evaluator<transpose_expr<Mat> >
+	{
+		typedef typename matrix_traits<Mat>::value_type value_type;
+
+		static const bool supported = true;
+
+		// columns [j0, j0 + nc) of the transpose are rows [j0, j0 + nc) of the argument
+		static void evaluate(const transpose_expr<Mat>& expr,
+				const index_t j0, const index_t nc, value_type *dst, const index_t ldim)
+		{
+			const Mat& src = expr.arg();
+
+			detail::transpose_rec(nc, src.ncolumns(),
+					src.ptr_data() + j0, src.lead_dim(), dst, ldim);
+		}
+	};
+
+
+
 	/********************************************
 	 *
 	 *  dispatching
@@ -347,6 +347,8 @@ namespace bcs
 				"Either CTRows or CTCols must equal 1");
 #endif
 	public:
+		static const bool has_packet_access = false;
+
 		BCS_ENSURE_INLINE
 		grid2d_linear_reader(const ref_grid2d<T, CTRows, CTCols>& mat)
 		: m_data(mat.ptr_data())
@@ -400,6 +402,8 @@ namespace bcs
 		class reader_type
 		{
 		public:
+			static const bool has_packet_access = false;
+
 			BCS_ENSURE_INLINE
 			reader_type(const grid2d_colreaders& host, const index_t j)
 			: m_col(host.m_data + j * host.m_leaddim), m_step(host.m_step)
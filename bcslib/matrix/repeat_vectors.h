@@ -228,6 +228,9 @@ namespace bcs
 		struct reader_type
 		: public IVecReader<reader_type, value_type>, private noncopyable
 		{
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = vec_reader<Arg>::type::has_packet_access;
+
 			BCS_ENSURE_INLINE
 			reader_type(const repcols_colreaders& host, const index_t)
 			: m_in(host.m_in)
@@ -239,6 +242,11 @@ namespace bcs
 				return m_in.get(i);
 			}
 
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+			{
+				return m_in.get_packet(i);
+			}
+
 		private:
 			const typename vec_reader<Arg>::type& m_in;
 		};
@@ -269,6 +277,9 @@ namespace bcs
 		struct reader_type
 		: public IVecReader<reader_type, value_type>, private noncopyable
 		{
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = packet_traits<value_type>::supported;
+
 			BCS_ENSURE_INLINE
 			reader_type(const reprows_colreaders& host, const index_t j)
 			: m_val(host.m_in.get(j))
@@ -280,6 +291,13 @@ namespace bcs
 				return m_val;
 			}
 
+#ifdef BCS_HAS_PACKET
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t) const
+			{
+				return simd::set1(m_val);
+			}
+#endif
+
 		private:
 			value_type m_val;
 		};
@@ -16,16 +16,33 @@
 #define BCSLIB_VECTOR_ACCESSORS_H_
 
 #include <bcslib/matrix/dense_matrix.h>
+#include <bcslib/core/packet.h>
+#include <bcslib/core/parallel.h>
+#include <vector>
+#include <memory>
 
 namespace bcs
 {
 
+	/**
+	 * A vector reader may additionally support packet access
+	 * (see core/packet.h), in which case it sets has_packet_access
+	 * to true and provides
+	 *
+	 *   packet_type get_packet(i) const;    // reads i, ..., i + width - 1
+	 *
+	 * A vector accessor with packet access further provides
+	 *
+	 *   void set_packet(i, pkt);   // address of element i must be packet-aligned
+	 */
 	template<class Derived, typename T>
 	class IVecReader
 	{
 	public:
 		BCS_CRTP_REF
 
+		static const bool has_packet_access = false;
+
 		BCS_ENSURE_INLINE T get(const index_t i) const
 		{
 			return derived().get(i);
@@ -80,6 +97,8 @@ namespace bcs
 
 	public:
 		typedef typename matrix_traits<Mat>::value_type value_type;
+		typedef typename packet_traits<value_type>::type packet_type;
+		static const bool has_packet_access = packet_traits<value_type>::supported;
 
 		BCS_ENSURE_INLINE
 		explicit continuous_vector_reader(const Mat& mat)
@@ -90,6 +109,13 @@ namespace bcs
 			return m_data[i];
 		}
 
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+		{
+			return simd::loadu(m_data + i);
+		}
+#endif
+
 	private:
 		const value_type *m_data;
 	};
@@ -107,6 +133,8 @@ namespace bcs
 
 	public:
 		typedef typename matrix_traits<Mat>::value_type value_type;
+		typedef typename packet_traits<value_type>::type packet_type;
+		static const bool has_packet_access = packet_traits<value_type>::supported;
 
 		BCS_ENSURE_INLINE
 		explicit continuous_vector_accessor(Mat& mat)
@@ -122,6 +150,18 @@ namespace bcs
 			m_data[i] = v;
 		}
 
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+		{
+			return simd::loadu(m_data + i);
+		}
+
+		BCS_ENSURE_INLINE void set_packet(const index_t i, const packet_type& v)
+		{
+			simd::store(m_data + i, v);
+		}
+#endif
+
 	private:
 		value_type *m_data;
 	};
@@ -196,7 +236,10 @@ namespace bcs
 
 	public:
 		typedef typename matrix_traits<Mat>::value_type value_type;
-		typedef dense_matrix<value_type, ct_rows<Mat>::value, ct_cols<Mat>::value> cache_t;
+		typedef dense_matrix<value_type, ct_rows<Mat>::value, ct_cols<Mat>::value,
+				scratch_allocator<value_type> > cache_t;
+		typedef typename packet_traits<value_type>::type packet_type;
+		static const bool has_packet_access = packet_traits<value_type>::supported;
 
 		BCS_ENSURE_INLINE
 		explicit cache_linear_reader(const Mat& mat)
@@ -207,6 +250,13 @@ namespace bcs
 			return m_cache[i];
 		}
 
+#ifdef BCS_HAS_PACKET
+		BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+		{
+			return simd::loadu(m_cache.ptr_data() + i);
+		}
+#endif
+
 	private:
 		cache_t m_cache;
 	};
@@ -239,6 +289,9 @@ namespace bcs
 		class reader_type : public IVecReader<reader_type, value_type>, private noncopyable
 		{
 		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = packet_traits<value_type>::supported;
+
 			BCS_ENSURE_INLINE
 			reader_type(const dense_colreaders& host, const index_t j)
 			: m_data(col_ptr(host.m_mat, j))
@@ -251,6 +304,13 @@ namespace bcs
 				return m_data[i];
 			}
 
+#ifdef BCS_HAS_PACKET
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+			{
+				return simd::loadu(m_data + i);
+			}
+#endif
+
 		private:
 			const value_type* m_data;
 		};
@@ -281,6 +341,9 @@ namespace bcs
 		class accessor_type : public IVecReader<accessor_type, value_type>, private noncopyable
 		{
 		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = packet_traits<value_type>::supported;
+
 			BCS_ENSURE_INLINE
 			accessor_type(dense_colaccessors& host, const index_t j)
 			: m_data(col_ptr(host.m_mat, j))
@@ -299,6 +362,18 @@ namespace bcs
 				m_data[i] = v;
 			}
 
+#ifdef BCS_HAS_PACKET
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+			{
+				return simd::loadu(m_data + i);
+			}
+
+			BCS_ENSURE_INLINE void set_packet(const index_t i, const packet_type& v)
+			{
+				simd::store(m_data + i, v);
+			}
+#endif
+
 		private:
 			value_type *m_data;
 		};
@@ -319,7 +394,8 @@ namespace bcs
 
 	public:
 		typedef typename matrix_traits<Mat>::value_type value_type;
-		typedef dense_matrix<value_type, ct_rows<Mat>::value, ct_cols<Mat>::value> cache_t;
+		typedef dense_matrix<value_type, ct_rows<Mat>::value, ct_cols<Mat>::value,
+				scratch_allocator<value_type> > cache_t;
 
 		BCS_ENSURE_INLINE
 		explicit cache_colreaders(const Mat& a) : m_cache(a) { }
@@ -328,6 +404,9 @@ namespace bcs
 		class reader_type : public IVecReader<reader_type, value_type>, private noncopyable
 		{
 		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = packet_traits<value_type>::supported;
+
 			BCS_ENSURE_INLINE
 			reader_type(const cache_colreaders& host, const index_t j)
 			: m_data(col_ptr(host.m_cache, j))
@@ -339,6 +418,13 @@ namespace bcs
 				return m_data[i];
 			}
 
+#ifdef BCS_HAS_PACKET
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+			{
+				return simd::loadu(m_data + i);
+			}
+#endif
+
 		private:
 			const value_type* m_data;
 		};
@@ -348,6 +434,164 @@ namespace bcs
 	};
 
 
+	/********************************************
+	 *
+	 *  streamed colwise readers
+	 *
+	 *  Instead of caching the whole expression,
+	 *  it evaluates a panel of columns at a time
+	 *  into a scratch buffer (sized to stay in L2),
+	 *  which is re-filled when a column outside
+	 *  the current panel is requested.
+	 *
+	 *  Each thread has its own scratch panel,
+	 *  so the bank can be shared by parallel tasks
+	 *  (each working on a range of columns).
+	 *
+	 *  Note: a reader holds a pointer into the
+	 *  panel of its thread, which is overwritten
+	 *  when the same thread then requests a column
+	 *  outside that panel (through any reader of
+	 *  the same bank). Hence, a reader should only
+	 *  be used until the thread reads a column
+	 *  that is more than a panel away.
+	 *
+	 ********************************************/
+
+	/**
+	 * block_evaluator<Expr> evaluates a panel of columns of an
+	 * expression. An expression that can do this efficiently
+	 * specializes it as
+	 *
+	 *   static const bool supported = true;
+	 *
+	 *   // evaluates columns [j0, j0 + nc) into dst (with leading dim ldim)
+	 *   static void evaluate(const Expr& expr, index_t j0, index_t nc, T* dst, index_t ldim);
+	 *
+	 * and is then read column-wise by streamed_colreaders.
+	 */
+	template<class Expr>
+	struct block_evaluator
+	{
+		static const bool supported = false;
+	};
+
+	const index_t StreamPanelBytes = 256 * 1024;
+	const index_t StreamMinPanelColumns = 4;
+
+	template<class Mat>
+	class streamed_colreaders
+	: public IVecReaderBank<streamed_colreaders<Mat>, typename matrix_traits<Mat>::value_type>
+	, private noncopyable
+	{
+#ifdef BCS_USE_STATIC_ASSERT
+		static_assert(block_evaluator<Mat>::supported, "Mat must support block evaluation.");
+#endif
+
+	public:
+		typedef typename matrix_traits<Mat>::value_type value_type;
+
+		explicit streamed_colreaders(const Mat& a)
+		: m_mat(a), m_nrows(a.nrows()), m_ncols(a.ncolumns())
+		, m_panel_cols(panel_columns(a.nrows(), a.ncolumns()))
+		, m_panels((size_t)get_num_threads())
+		{
+		}
+
+	public:
+		class reader_type : public IVecReader<reader_type, value_type>, private noncopyable
+		{
+		public:
+			typedef typename packet_traits<value_type>::type packet_type;
+			static const bool has_packet_access = packet_traits<value_type>::supported;
+
+			BCS_ENSURE_INLINE
+			reader_type(const streamed_colreaders& host, const index_t j)
+			: m_data(host.column(j))
+			{
+			}
+
+			BCS_ENSURE_INLINE value_type get(const index_t i) const
+			{
+				return m_data[i];
+			}
+
+#ifdef BCS_HAS_PACKET
+			BCS_ENSURE_INLINE packet_type get_packet(const index_t i) const
+			{
+				return simd::loadu(m_data + i);
+			}
+#endif
+
+		private:
+			const value_type* m_data;
+		};
+
+	private:
+		struct panel
+		{
+			index_t j0;
+			index_t nc;
+			dense_matrix<value_type> buf;
+
+			panel() : j0(0), nc(0) { }
+		};
+
+		static index_t panel_columns(const index_t m, const index_t n)
+		{
+			const index_t colbytes = m * (index_t)sizeof(value_type);
+			index_t p = colbytes > 0 ? StreamPanelBytes / colbytes : n;
+			if (p < StreamMinPanelColumns) p = StreamMinPanelColumns;
+			return p < n ? p : n;
+		}
+
+		// the panel of the calling thread
+		panel& thread_panel() const
+		{
+			const size_t t = (size_t)current_thread_index();
+			if (t < m_panels.size()) return m_panels[t];
+
+			// a worker of another pool (e.g. one created by the user)
+			// may have an index beyond get_num_threads()
+
+#ifndef BCSLIB_NO_THREADS
+			std::lock_guard<std::mutex> lk(m_extra_mutex);
+#endif
+			const size_t k = t - m_panels.size();
+			if (k >= m_extra_panels.size()) m_extra_panels.resize(k + 1);
+			if (!m_extra_panels[k]) m_extra_panels[k].reset(new panel());
+			return *m_extra_panels[k];
+		}
+
+		const value_type* column(const index_t j) const
+		{
+			panel& pn = thread_panel();
+
+			if (j < pn.j0 || j >= pn.j0 + pn.nc)
+			{
+				if (pn.buf.nelems() == 0) pn.buf.resize(m_nrows, m_panel_cols);
+
+				pn.j0 = j;
+				pn.nc = (m_ncols - j < m_panel_cols ? m_ncols - j : m_panel_cols);
+				block_evaluator<Mat>::evaluate(m_mat, j, pn.nc, pn.buf.ptr_data(), m_nrows);
+			}
+
+			return pn.buf.ptr_data() + (j - pn.j0) * m_nrows;
+		}
+
+	private:
+		const Mat& m_mat;
+		index_t m_nrows;
+		index_t m_ncols;
+		index_t m_panel_cols;
+		mutable std::vector<panel> m_panels;  // never resized (read without locking)
+		mutable std::vector<std::unique_ptr<panel> > m_extra_panels;
+#ifndef BCSLIB_NO_THREADS
+		mutable std::mutex m_extra_mutex;
+#endif
+	};
+
+
 	/********************************************
 	 *
 	 *  cost model and dispatcher
@@ -378,6 +622,11 @@ namespace bcs
 	const int CachedByColumnAccessCost = CachedAccessCost + DenseByColumnAccessCost;
 	const int CachedByShortColumnAccessCost = CachedAccessCost + DenseByShortColumnAccessCost;
 
+	// streaming evaluates into a buffer that stays in cache
+	const int StreamedAccessCost = 1000;
+	const int StreamedByColumnAccessCost = StreamedAccessCost + DenseByColumnAccessCost;
+	const int StreamedByShortColumnAccessCost = StreamedAccessCost + DenseByShortColumnAccessCost;
+
 	const int ShortColumnBound = 2;
 
 
@@ -403,7 +652,9 @@ namespace bcs
 			static const int value =
 					(is_dense_mat<Expr>::value ?
 							DenseByColumnAccessCost :
-							CachedByColumnAccessCost);
+							(block_evaluator<Expr>::supported ?
+									StreamedByColumnAccessCost :
+									CachedByColumnAccessCost) );
 		};
 
 
@@ -413,7 +664,9 @@ namespace bcs
 			static const int value =
 					(is_dense_mat<Expr>::value ?
 							DenseByShortColumnAccessCost :
-							CachedByShortColumnAccessCost );
+							(block_evaluator<Expr>::supported ?
+									StreamedByShortColumnAccessCost :
+									CachedByShortColumnAccessCost) );
 		};
 	}
 
@@ -466,11 +719,25 @@ namespace bcs
 	{
 		typedef typename select_type<is_dense_mat<Expr>::value,
 					dense_colreaders<Expr>,
-					cache_colreaders<Expr>
+					typename select_type<block_evaluator<Expr>::supported,
+						streamed_colreaders<Expr>,
+						cache_colreaders<Expr>
+					>::type
 				>::type type;
 	};
 
 
+	/**
+	 * Whether the column readers of Expr involve streamed columns,
+	 * whose panels are evaluated again on each sweep over the columns
+	 */
+	template<class Expr>
+	struct has_streamed_columns
+	{
+		static const bool value = !is_dense_mat<Expr>::value && block_evaluator<Expr>::supported;
+	};
+
+
 	template<class Expr>
 	struct colwise_accessor_bank
 	{
@@ -67,12 +67,286 @@ namespace bcs
 	};
 
 
+	/********************************************
+	 *
+	 *  packet transfer
+	 *
+	 *  Transfers the elements in [begin, end).
+	 *  The leading elements before the first
+	 *  packet-aligned destination address (at
+	 *  index head) and the remaining elements after the last
+	 *  full packet are moved one by one, while
+	 *  the rest are moved packet by packet.
+	 *
+	 ********************************************/
+
+	template<typename T, class SVec, class DVec>
+	struct transfer_vec_packets
+	{
+		BCS_ENSURE_INLINE
+		static void run(const index_t begin, const index_t end, const index_t head, const SVec& in, DVec& out)
+		{
+			const index_t W = packet_traits<T>::width;
+			const index_t pend = head + ((end - head) / W) * W;
+			const index_t pend2 = head + ((end - head) / (2 * W)) * (2 * W);
+
+			index_t i = begin;
+			for (; i < head; ++i) out.set(i, in.get(i));
+			for (; i < pend2; i += 2 * W)
+			{
+				out.set_packet(i, in.get_packet(i));
+				out.set_packet(i + W, in.get_packet(i + W));
+			}
+			for (; i < pend; i += W) out.set_packet(i, in.get_packet(i));
+			for (; i < end; ++i) out.set(i, in.get(i));
+		}
+	};
+
+
 	/********************************************
 	 *
 	 *  accumulation
 	 *
+	 *  For associative reductors, long vectors are
+	 *  accumulated with four independent accumulators
+	 *  (each being a packet when both the reductor
+	 *  and the reader support packets), which are
+	 *  combined at the end.
+	 *
+	 *  With BCSLIB_DETERMINISTIC_REDUCTION defined,
+	 *  elements are always accumulated one by one
+	 *  from left to right, such that the results are
+	 *  bit-reproducible across builds.
+	 *
 	 ********************************************/
 
+	const int MultiAccumBound = 16;
+
+	namespace detail
+	{
+		template<class Reductor>
+		struct use_multi_accum
+		{
+#ifdef BCSLIB_DETERMINISTIC_REDUCTION
+			static const bool value = false;
+#else
+			static const bool value = is_associative_reductor<Reductor>::value;
+#endif
+		};
+
+		template<class Reductor, class Vec>
+		struct use_packet_accum
+		{
+			static const bool value = has_packet_op<Reductor>::value && Vec::has_packet_access;
+		};
+
+		template<class Reductor, class Vec1, class Vec2>
+		struct use_packet_accum2
+		{
+			static const bool value = has_packet_op<Reductor>::value &&
+					Vec1::has_packet_access && Vec2::has_packet_access;
+		};
+
+
+		// scalar lanes (requires len >= 4)
+
+		template<class Reductor, class Vec, bool UsePacket>
+		struct multi_accum_vec
+		{
+			typedef typename Reductor::accum_type accum_t;
+
+			BCS_ENSURE_INLINE
+			static accum_t run(const Reductor& reduc, const index_t len, const Vec& in)
+			{
+				accum_t a0 = reduc.init(in.get(0));
+				accum_t a1 = reduc.init(in.get(1));
+				accum_t a2 = reduc.init(in.get(2));
+				accum_t a3 = reduc.init(in.get(3));
+
+				index_t i = 4;
+				for (; i + 4 <= len; i += 4)
+				{
+					a0 = reduc.add(a0, in.get(i));
+					a1 = reduc.add(a1, in.get(i+1));
+					a2 = reduc.add(a2, in.get(i+2));
+					a3 = reduc.add(a3, in.get(i+3));
+				}
+				for (; i < len; ++i) a0 = reduc.add(a0, in.get(i));
+
+				return reduc.combine(reduc.combine(a0, a1), reduc.combine(a2, a3));
+			}
+		};
+
+		template<class Reductor, class Vec1, class Vec2, bool UsePacket>
+		struct multi_accum_vec2
+		{
+			typedef typename Reductor::accum_type accum_t;
+
+			BCS_ENSURE_INLINE
+			static accum_t run(const Reductor& reduc, const index_t len, const Vec1& in1, const Vec2& in2)
+			{
+				accum_t a0 = reduc.init(in1.get(0), in2.get(0));
+				accum_t a1 = reduc.init(in1.get(1), in2.get(1));
+				accum_t a2 = reduc.init(in1.get(2), in2.get(2));
+				accum_t a3 = reduc.init(in1.get(3), in2.get(3));
+
+				index_t i = 4;
+				for (; i + 4 <= len; i += 4)
+				{
+					a0 = reduc.add(a0, in1.get(i), in2.get(i));
+					a1 = reduc.add(a1, in1.get(i+1), in2.get(i+1));
+					a2 = reduc.add(a2, in1.get(i+2), in2.get(i+2));
+					a3 = reduc.add(a3, in1.get(i+3), in2.get(i+3));
+				}
+				for (; i < len; ++i) a0 = reduc.add(a0, in1.get(i), in2.get(i));
+
+				return reduc.combine(reduc.combine(a0, a1), reduc.combine(a2, a3));
+			}
+		};
+
+
+#ifdef BCS_HAS_PACKET
+
+		// packet lanes (requires len >= 4 * width)
+
+		template<class Reductor, typename T>
+		BCS_ENSURE_INLINE
+		inline T fold_packet(const Reductor& reduc, const typename packet_traits<T>::type& p)
+		{
+			const int W = packet_traits<T>::width;
+
+			T buf[W];
+			simd::storeu(buf, p);
+
+			T a = buf[0];
+			for (int k = 1; k < W; ++k) a = reduc.combine(a, buf[k]);
+			return a;
+		}
+
+		template<class Reductor, class Vec>
+		struct multi_accum_vec<Reductor, Vec, true>
+		{
+			typedef typename Reductor::accum_type accum_t;
+			typedef typename packet_traits<accum_t>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static accum_t run(const Reductor& reduc, const index_t len, const Vec& in)
+			{
+				const index_t W = packet_traits<accum_t>::width;
+
+				packet_t a0 = reduc.init(in.get_packet(0));
+				packet_t a1 = reduc.init(in.get_packet(W));
+				packet_t a2 = reduc.init(in.get_packet(2 * W));
+				packet_t a3 = reduc.init(in.get_packet(3 * W));
+
+				index_t i = 4 * W;
+				for (; i + 4 * W <= len; i += 4 * W)
+				{
+					a0 = reduc.add(a0, in.get_packet(i));
+					a1 = reduc.add(a1, in.get_packet(i + W));
+					a2 = reduc.add(a2, in.get_packet(i + 2 * W));
+					a3 = reduc.add(a3, in.get_packet(i + 3 * W));
+				}
+				for (; i + W <= len; i += W) a0 = reduc.add(a0, in.get_packet(i));
+
+				a0 = reduc.combine(reduc.combine(a0, a1), reduc.combine(a2, a3));
+				accum_t a = fold_packet<Reductor, accum_t>(reduc, a0);
+
+				for (; i < len; ++i) a = reduc.add(a, in.get(i));
+				return a;
+			}
+		};
+
+		template<class Reductor, class Vec1, class Vec2>
+		struct multi_accum_vec2<Reductor, Vec1, Vec2, true>
+		{
+			typedef typename Reductor::accum_type accum_t;
+			typedef typename packet_traits<accum_t>::type packet_t;
+
+			BCS_ENSURE_INLINE
+			static accum_t run(const Reductor& reduc, const index_t len, const Vec1& in1, const Vec2& in2)
+			{
+				const index_t W = packet_traits<accum_t>::width;
+
+				packet_t a0 = reduc.init(in1.get_packet(0), in2.get_packet(0));
+				packet_t a1 = reduc.init(in1.get_packet(W), in2.get_packet(W));
+				packet_t a2 = reduc.init(in1.get_packet(2 * W), in2.get_packet(2 * W));
+				packet_t a3 = reduc.init(in1.get_packet(3 * W), in2.get_packet(3 * W));
+
+				index_t i = 4 * W;
+				for (; i + 4 * W <= len; i += 4 * W)
+				{
+					a0 = reduc.add(a0, in1.get_packet(i), in2.get_packet(i));
+					a1 = reduc.add(a1, in1.get_packet(i + W), in2.get_packet(i + W));
+					a2 = reduc.add(a2, in1.get_packet(i + 2 * W), in2.get_packet(i + 2 * W));
+					a3 = reduc.add(a3, in1.get_packet(i + 3 * W), in2.get_packet(i + 3 * W));
+				}
+				for (; i + W <= len; i += W) a0 = reduc.add(a0, in1.get_packet(i), in2.get_packet(i));
+
+				a0 = reduc.combine(reduc.combine(a0, a1), reduc.combine(a2, a3));
+				accum_t a = fold_packet<Reductor, accum_t>(reduc, a0);
+
+				for (; i < len; ++i) a = reduc.add(a, in1.get(i), in2.get(i));
+				return a;
+			}
+		};
+
+#endif
+
+
+		template<class Reductor, class Vec>
+		BCS_ENSURE_INLINE
+		inline typename Reductor::accum_type
+		seq_accum_vec(const Reductor& reduc, const index_t len, const Vec& in)
+		{
+			typename Reductor::accum_type a = reduc.init(in.get(0));
+			for (index_t i = 1; i < len; ++i) a = reduc.add(a, in.get(i));
+			return a;
+		}
+
+		template<class Reductor, class Vec1, class Vec2>
+		BCS_ENSURE_INLINE
+		inline typename Reductor::accum_type
+		seq_accum_vec2(const Reductor& reduc, const index_t len, const Vec1& in1, const Vec2& in2)
+		{
+			typename Reductor::accum_type a = reduc.init(in1.get(0), in2.get(0));
+			for (index_t i = 1; i < len; ++i) a = reduc.add(a, in1.get(i), in2.get(i));
+			return a;
+		}
+
+
+		template<class Reductor, class Vec>
+		BCS_ENSURE_INLINE
+		inline typename Reductor::accum_type
+		accum_vec_long(const Reductor& reduc, const index_t len, const Vec& in)
+		{
+			const bool use_pkt = use_packet_accum<Reductor, Vec>::value;
+			const index_t min_len = use_pkt ?
+					4 * packet_traits<typename Reductor::accum_type>::width : MultiAccumBound;
+
+			if (use_multi_accum<Reductor>::value && len >= min_len)
+				return multi_accum_vec<Reductor, Vec, use_pkt>::run(reduc, len, in);
+			else
+				return seq_accum_vec(reduc, len, in);
+		}
+
+		template<class Reductor, class Vec1, class Vec2>
+		BCS_ENSURE_INLINE
+		inline typename Reductor::accum_type
+		accum_vec2_long(const Reductor& reduc, const index_t len, const Vec1& in1, const Vec2& in2)
+		{
+			const bool use_pkt = use_packet_accum2<Reductor, Vec1, Vec2>::value;
+			const index_t min_len = use_pkt ?
+					4 * packet_traits<typename Reductor::accum_type>::width : MultiAccumBound;
+
+			if (use_multi_accum<Reductor>::value && len >= min_len)
+				return multi_accum_vec2<Reductor, Vec1, Vec2, use_pkt>::run(reduc, len, in1, in2);
+			else
+				return seq_accum_vec2(reduc, len, in1, in2);
+		}
+	}
+
+
 	template<class Reductor, int N, class Vec>
 	struct accum_vec
 	{
@@ -86,9 +360,7 @@ namespace bcs
 		BCS_ENSURE_INLINE
 		static accum_t run(const Reductor& reduc, const index_t, const Vec& in)
 		{
-			accum_t a = reduc.init(in.get(0));
-			for (index_t i = 1; i < N; ++i) a = reduc.add(a, in.get(i));
-			return a;
+			return detail::accum_vec_long(reduc, N, in);
 		}
 	};
 
@@ -104,9 +376,7 @@ namespace bcs
 		BCS_ENSURE_INLINE
 		static accum_t run(const Reductor& reduc, const index_t len, const Vec& in)
 		{
-			accum_t a = reduc.init(in.get(0));
-			for (index_t i = 1; i < len; ++i) a = reduc.add(a, in.get(i));
-			return a;
+			return detail::accum_vec_long(reduc, len, in);
 		}
 	};
 
@@ -160,10 +430,7 @@ namespace bcs
 		static accum_t run(const Reductor& reduc, const index_t,
 				const Vec1& in1, const Vec2& in2)
 		{
-			accum_t a = reduc.init(in1.get(0), in2.get(0));
-			for (index_t i = 1; i < N; ++i)
-				a = reduc.add(a, in1.get(i), in2.get(i));
-			return a;
+			return detail::accum_vec2_long(reduc, N, in1, in2);
 		}
 	};
 
@@ -180,10 +447,7 @@ namespace bcs
 		static accum_t run(const Reductor& reduc, const index_t len,
 				const Vec1& in1, const Vec2& in2)
 		{
-			accum_t a = reduc.init(in1.get(0), in2.get(0));
-			for (index_t i = 1; i < len; ++i)
-				a = reduc.add(a, in1.get(i), in2.get(i));
-			return a;
+			return detail::accum_vec2_long(reduc, len, in1, in2);
 		}
 	};
 
@@ -25,7 +25,7 @@ namespace bcs
 	{
 	public:
 		memory_allocation_monitor()
-		: m_pending_bytes(0)
+		: m_pending_bytes(0), m_num_requests(0)
 		{
 		}
 
@@ -48,6 +48,11 @@ namespace bcs
 			return m_pending_bytes;
 		}
 
+		size_t num_requests() const
+		{
+			return m_num_requests;
+		}
+
 		bool verify(void *p, size_t nbytes) const
 		{
 			char *pc = static_cast<char*>(p);
@@ -61,6 +66,7 @@ namespace bcs
 
 			m_ptrmap.insert(make_pair(p, nbytes));
 			m_pending_bytes += nbytes;
+			++ m_num_requests;
 
 			return p;
 		}
@@ -92,6 +98,7 @@ namespace bcs
 
 	private:
 		size_t m_pending_bytes;
+		size_t m_num_requests;
 
 		typedef std::map<char*, size_t> map_type;
 		map_type m_ptrmap;
@@ -301,6 +301,21 @@ struct RowwiseSumPerCol : public RowwiseReducTaskBase
 };
 
 
+struct RowwiseSumTransMatrix : public RowwiseReducTaskBase
+{
+	dense_matrix<double> z;
+
+	RowwiseSumTransMatrix(index_t m, index_t n) : RowwiseReducTaskBase(m, n), z(n, m)
+	{
+		index_t len = m * n;
+		for (index_t i = 0; i < len; ++i) z[i] = double(std::rand()) / RAND_MAX;
+	}
+
+	void run()
+	{
+		res = sum(rowwise(x + z.trans()));
+	}
+};
 
 
 
@@ -369,6 +384,9 @@ int main(int argc, char *argv[])
 	RowwiseSumPerCol rowwise_sum_percol(1000, 1000);
 	run(rowwise_sum_percol, "rowwise-sum-percol", 500);
 
+	RowwiseSumTransMatrix rowwise_sum_trans(200000, 32);
+	run(rowwise_sum_trans, "rowwise-sum-trans-matrix", 20);
+
 	std::printf("\n");
 }
 
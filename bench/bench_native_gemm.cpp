@@ -0,0 +1,85 @@
+/**
+ * @file bench_native_gemm.cpp
+ *
+ * Benchmark of the built-in cache-blocked GEMM
+ *
+ * @author Dahua Lin
+ */
+
+
+#include "bench_tools.h"
+#include <bcslib/matrix.h>
+#include <bcslib/engine/native_gemm.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace bcs;
+
+template<typename T> struct type_nam;
+
+template<> struct type_nam<float>  { static const char *get() { return "single"; } };
+template<> struct type_nam<double> { static const char *get() { return "double"; } };
+
+
+template<typename T>
+struct NativeMM
+{
+	typedef T value_type;
+
+	NativeMM(int n_) : n(n_), a(n_, n_), b(n_, n_), c(n_, n_)
+	{
+		for (int i = 0; i < n * n; ++i) a[i] = T(std::rand()) / T(RAND_MAX);
+		for (int i = 0; i < n * n; ++i) b[i] = T(std::rand()) / T(RAND_MAX);
+	}
+
+	void run()
+	{
+		engine::native_gemm<T>::eval('N', 'N', n, n, n,
+				T(1), a.ptr_data(), n, b.ptr_data(), n,
+				T(0), c.ptr_data(), n);
+	}
+
+	double size() const
+	{
+		return 2.0 * double(n) * double(n) * double(n);
+	}
+
+	int n;
+	dense_matrix<T> a;
+	dense_matrix<T> b;
+	dense_matrix<T> c;
+};
+
+
+template<typename T>
+void run_on_size(int n)
+{
+	NativeMM<T> tsk(n);
+
+	long ntimes = long(4.0e9 / tsk.size()) + 1;
+
+	timer tm(true);
+	for (long i = 0; i < ntimes; ++i) tsk.run();
+	double e = tm.elapsed_secs();
+
+	std::printf("%s, %d, %.4f, %.4f\n",
+			type_nam<T>::get(), n, tsk.size() * double(ntimes) * 1.0e-9 / e, e * 1.0e3 / double(ntimes));
+}
+
+
+template<typename T>
+void run_all()
+{
+	const int sizes[] = {64, 128, 256, 512, 1024, 2048};
+	for (int i = 0; i < 6; ++i) run_on_size<T>(sizes[i]);
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::printf("type, N, GFlops, per-run (ms)\n");
+	run_all<float>();
+	run_all<double>();
+}
+
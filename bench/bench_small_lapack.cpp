@@ -0,0 +1,191 @@
+/**
+ * @file bench_small_lapack.cpp
+ *
+ * Benchmark of small fixed-size factorizations and solvers
+ *
+ * @author Dahua Lin
+ */
+
+
+#include "bench_tools.h"
+#include <bcslib/matrix.h>
+#include <bcslib/engine/small_lapack_batch.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace bcs;
+
+template<typename T> struct type_nam;
+
+template<> struct type_nam<float>  { static const char *get() { return "single"; } };
+template<> struct type_nam<double> { static const char *get() { return "double"; } };
+
+
+// a batch of NB symmetric positive definite systems A_p * x_p = b_p,
+// restored from the originals before every run
+
+template<typename T, int N_>
+struct SystemBatch
+{
+	typedef T value_type;
+	static const int N = N_;
+	static const index_t NB = 4096;
+
+	SystemBatch() : a0(N * N, NB), b0(N, NB), a(N * N, NB), b(N, NB), info((size_t)NB)
+	{
+		std::vector<T> m(N * N);
+		for (index_t p = 0; p < NB; ++p)
+		{
+			for (int i = 0; i < N * N; ++i) m[i] = T(std::rand()) / T(RAND_MAX);
+
+			T *ap = a0.ptr_data() + p * N * N;
+			for (int j = 0; j < N; ++j)
+			{
+				for (int i = 0; i < N; ++i)
+				{
+					T s = (i == j ? T(N) : T(0));
+					for (int u = 0; u < N; ++u) s += m[i + u * N] * m[j + u * N];
+					ap[i + j * N] = s;
+				}
+			}
+		}
+		for (index_t i = 0; i < b0.nelems(); ++i) b0[i] = T(std::rand()) / T(RAND_MAX);
+	}
+
+	void restore()
+	{
+		copy_elems(a0.size(), a0.ptr_data(), a.ptr_data());
+		copy_elems(b0.size(), b0.ptr_data(), b.ptr_data());
+	}
+
+	int size() const
+	{
+		return (int)NB;
+	}
+
+	dense_matrix<T> a0;
+	dense_matrix<T> b0;
+	dense_matrix<T> a;
+	dense_matrix<T> b;
+	std::vector<int> info;
+};
+
+
+// potrf + potrs, problem by problem
+template<typename T, int N>
+struct CholSolveEach : public SystemBatch<T, N>
+{
+	typedef SystemBatch<T, N> base;
+
+	void run()
+	{
+		this->restore();
+		T *a = this->a.ptr_data();
+		T *b = this->b.ptr_data();
+
+		for (index_t p = 0; p < base::NB; ++p)
+		{
+			T *ap = a + p * N * N;
+			if (engine::small_potrf<T, N>::eval(ap, N) == 0)
+				engine::small_potrs<T, N>::eval(ap, N, b + p * N);
+		}
+	}
+};
+
+// small_posv_batch
+template<typename T, int N>
+struct CholSolveBatch : public SystemBatch<T, N>
+{
+	typedef SystemBatch<T, N> base;
+
+	void run()
+	{
+		this->restore();
+		engine::small_posv_batch<T, N>::eval(base::NB,
+				this->a.ptr_data(), N, N * N, this->b.ptr_data(), N, N, &(this->info[0]));
+	}
+};
+
+// small_gesv_batch
+template<typename T, int N>
+struct LUSolveBatch : public SystemBatch<T, N>
+{
+	typedef SystemBatch<T, N> base;
+
+	void run()
+	{
+		this->restore();
+		engine::small_gesv_batch<T, N>::eval(base::NB,
+				this->a.ptr_data(), N, N * N, this->b.ptr_data(), N, N, &(this->info[0]));
+	}
+};
+
+// small_inv_batch
+template<typename T, int N>
+struct InvBatch : public SystemBatch<T, N>
+{
+	typedef SystemBatch<T, N> base;
+
+	InvBatch() : r(N * N, base::NB) { }
+
+	void run()
+	{
+		this->restore();
+		engine::small_inv_batch<T, N>::eval(base::NB,
+				this->a.ptr_data(), N, N * N, r.ptr_data(), N, N * N, &(this->info[0]));
+	}
+
+	dense_matrix<T> r;
+};
+
+
+template<class Task>
+void run(const char *name, Task& tsk)
+{
+	const int N = Task::N;
+	const long ntimes = 20000000L / (long(N * N * N) * Task::NB) + 1;
+
+	bench_stats bst = run_benchmark(tsk, 10, ntimes);
+
+	std::printf("%s, %s, %d, %.4f, %.4f\n",
+			type_nam<typename Task::value_type>::get(),
+			name, N, bst.MPS(), bst.elapsed_secs * 1.0e3);
+}
+
+
+template<typename T, int N>
+void run_on_size()
+{
+	CholSolveEach<T, N> t1;
+	CholSolveBatch<T, N> t2;
+	LUSolveBatch<T, N> t3;
+	InvBatch<T, N> t4;
+
+	run("chol-each", t1);
+	run("posv-batch", t2);
+	run("gesv-batch", t3);
+	run("inv-batch", t4);
+}
+
+
+template<typename T>
+void run_all()
+{
+	run_on_size<T, 2>();
+	run_on_size<T, 3>();
+	run_on_size<T, 4>();
+	run_on_size<T, 6>();
+	run_on_size<T, 8>();
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::printf("type, method, N, M systems/sec, elapsed (ms)\n");
+
+	run_all<float>();
+	run_all<double>();
+}
+
@@ -10,9 +10,11 @@
 #include "bench_tools.h"
 #include <bcslib/matrix.h>
 #include <bcslib/engine/small_blasL3.h>
+#include <bcslib/engine/small_blas_batch.h>
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 using namespace bcs;
 
@@ -55,6 +57,42 @@ struct SmallMM
 };
 
 
+template<typename T, int M_, int N_, int K_>
+struct BatchedSmallMM
+{
+	typedef T value_type;
+	static const int M = M_;
+	static const int N = N_;
+	static const int K = K_;
+
+	static const index_t NB = 4096;
+
+	BatchedSmallMM() : a(M * K, NB), b(K * N, NB), c(M * N, NB)
+	{
+		for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(std::rand()) / T(RAND_MAX);
+		for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(std::rand()) / T(RAND_MAX);
+	}
+
+	void run()
+	{
+		engine::small_gemm_batch<T, M, N, K>::eval_nn(NB, T(1),
+				a.ptr_data(), M, M * K,
+				b.ptr_data(), K, K * N,
+				T(0),
+				c.ptr_data(), M, M * N);
+	}
+
+	int size() const
+	{
+		return M * N * K * 2 * (int)NB;
+	}
+
+	dense_matrix<T> a;
+	dense_matrix<T> b;
+	dense_matrix<T> c;
+};
+
+
 template<class Task>
 void run(Task& tsk, long ntimes)
 {
@@ -144,11 +182,46 @@ void run_all()
 
 
 
+template<typename T, int M>
+void run_batched_on_size()
+{
+	BatchedSmallMM<T, M, M, M> t;
+	run(t, calc_times(M, M, M) / BatchedSmallMM<T, M, M, M>::NB + 1);
+}
+
+
+template<typename T>
+void run_all_batched()
+{
+	run_batched_on_size<T, 2>();
+	run_batched_on_size<T, 3>();
+	run_batched_on_size<T, 4>();
+	run_batched_on_size<T, 5>();
+	run_batched_on_size<T, 6>();
+	run_batched_on_size<T, 8>();
+}
+
+
+// usage: bench_small_mm [batch]
+//
+// with "batch", it measures small_gemm_batch over
+// batches of square matrices instead
+
 int main(int argc, char *argv[])
 {
+	const bool batched = (argc > 1 && std::strcmp(argv[1], "batch") == 0);
+
 	std::printf("type, M, N, K, GFlops, elapsed (ms)\n");
-	run_all<float>();
-	run_all<double>();
+	if (batched)
+	{
+		run_all_batched<float>();
+		run_all_batched<double>();
+	}
+	else
+	{
+		run_all<float>();
+		run_all<double>();
+	}
 }
 
 
@@ -10,6 +10,9 @@
 #include <bcslib/core.h>
 #include <bcslib/utils/monitored_allocator.h>
 
+#include <utility>
+#include <vector>
+
 using namespace bcs;
 
 
@@ -243,6 +246,106 @@ TEST( Blocks, ScopedBlockMemOp )
 }
 
 
+TEST( Blocks, BlockMove )
+{
+	ASSERT_FALSE( global_memory_allocation_monitor.has_pending() );
+
+	const index_t N = 5;
+	const int src[N] = {1, 3, 4, 5, 2};
+
+	{
+		blk_t B1(N, src);
+		const int *p1 = B1.ptr_begin();
+		const size_t nr = global_memory_allocation_monitor.num_requests();
+
+		CHECK_MEM_PENDING(1);
+
+		// move construction
+
+		blk_t B2(std::move(B1));
+		ASSERT_EQ(N, B2.nelems());
+		ASSERT_TRUE( B2.ptr_begin() == p1 );
+		ASSERT_EQ(0, B1.nelems());
+		ASSERT_EQ(BCS_NULL, B1.ptr_begin());
+		EXPECT_TRUE( elems_equal(N, B2.ptr_begin(), src) );
+
+		CHECK_MEM_PENDING(1);
+
+		// move assignment
+
+		blk_t B3(3, 7);
+		CHECK_MEM_PENDING(2);
+
+		B3 = std::move(B2);
+		ASSERT_EQ(N, B3.nelems());
+		ASSERT_TRUE( B3.ptr_begin() == p1 );
+		ASSERT_EQ(0, B2.nelems());
+		ASSERT_EQ(BCS_NULL, B2.ptr_begin());
+
+		CHECK_MEM_PENDING(1);
+
+		// a moved-from block remains usable
+
+		B1.resize(4);
+		ASSERT_EQ(4, B1.nelems());
+		CHECK_MEM_PENDING(2);
+
+		ASSERT_EQ(nr + 2, global_memory_allocation_monitor.num_requests());
+
+		// growing a vector of blocks moves them
+
+		std::vector<blk_t> vec;
+		for (int i = 0; i < 20; ++i) vec.push_back(blk_t(N, i));
+
+		CHECK_MEM_PENDING(22);
+		ASSERT_EQ(nr + 22, global_memory_allocation_monitor.num_requests());
+
+		for (int i = 0; i < 20; ++i)
+		{
+			ASSERT_EQ(N, vec[(size_t)i].nelems());
+			ASSERT_TRUE( elems_equal(N, vec[(size_t)i].ptr_begin(), i) );
+		}
+	}
+
+	ASSERT_FALSE( global_memory_allocation_monitor.has_pending() );
+}
+
+
+TEST( Blocks, ScopedBlockMove )
+{
+	ASSERT_FALSE( global_memory_allocation_monitor.has_pending() );
+
+	const index_t N = 5;
+	const int src[N] = {1, 3, 4, 5, 2};
+
+	{
+		scblk_t B1(N, src);
+		const int *p1 = B1.ptr_begin();
+		const size_t nr = global_memory_allocation_monitor.num_requests();
+
+		scblk_t B2(std::move(B1));
+		ASSERT_EQ(N, B2.nelems());
+		ASSERT_TRUE( B2.ptr_begin() == p1 );
+		ASSERT_EQ(0, B1.nelems());
+		ASSERT_EQ(BCS_NULL, B1.ptr_begin());
+		EXPECT_TRUE( elems_equal(N, B2.ptr_begin(), src) );
+
+		CHECK_MEM_PENDING(1);
+
+		scblk_t B3(3, 7);
+		B3 = std::move(B2);
+		ASSERT_EQ(N, B3.nelems());
+		ASSERT_TRUE( B3.ptr_begin() == p1 );
+		ASSERT_EQ(0, B2.nelems());
+
+		CHECK_MEM_PENDING(1);
+		ASSERT_EQ(nr + 1, global_memory_allocation_monitor.num_requests());
+	}
+
+	ASSERT_FALSE( global_memory_allocation_monitor.has_pending() );
+}
+
+
 TEST( Blocks, StaticBlock )
 {
 	const index_t N = 4;
@@ -8,6 +8,7 @@
 
 #include <gtest/gtest.h>
 #include <bcslib/core.h>
+#include <limits>
 
 using namespace bcs;
 
@@ -139,3 +140,124 @@ TEST( MemOp, StaticElemWise1D_N16 ) { test_static_elemwise1d<16>(); }
 
 
 
+
+
+#ifdef BCS_HAS_SIMD_MEMOP
+
+template<typename T>
+static void test_simd_memop_level(const int level)
+{
+	using detail::simd_memop;
+
+	const index_t lens[] = {1, 7, 16, 17, 33, 64, 101};
+	const index_t nlens = sizeof(lens) / sizeof(index_t);
+
+	T *src0 = new T[128 + 16];
+	T *dst0 = new T[128 + 16];
+
+	for (index_t il = 0; il < nlens; ++il)
+	for (index_t off = 0; off < 4; ++off)
+	{
+		const index_t n = lens[il];
+		T *src = src0 + off;
+		T *dst = dst0 + (3 - off);
+
+		for (index_t i = 0; i < 128 + 16; ++i) src0[i] = dst0[i] = T(-1);
+
+		// fill must touch exactly n elements
+
+		simd_memop<T>::fill(level, n, dst, T(3));
+		for (index_t i = 0; i < n; ++i) ASSERT_EQ( T(3), dst[i] );
+		ASSERT_EQ( T(-1), dst[n] );
+		ASSERT_TRUE( simd_memop<T>::equal(level, n, dst, T(3)) );
+
+		dst[n - 1] = T(2);
+		ASSERT_FALSE( simd_memop<T>::equal(level, n, dst, T(3)) );
+
+		// copy & pairwise comparison
+
+		for (index_t i = 0; i < n; ++i) src[i] = T(i + 1);
+		simd_memop<T>::copy(level, n, src, dst);
+		for (index_t i = 0; i < n; ++i) ASSERT_EQ( src[i], dst[i] );
+		ASSERT_EQ( T(-1), dst[n] );
+		ASSERT_TRUE( simd_memop<T>::equal(level, n, src, dst) );
+
+		dst[n / 2] = T(0);
+		ASSERT_FALSE( simd_memop<T>::equal(level, n, src, dst) );
+
+		// IEEE semantics: NaN != NaN, -0 == +0
+
+		dst[n / 2] = T(-0.0);
+		src[n / 2] = T(0);
+		ASSERT_TRUE( simd_memop<T>::equal(level, n, src, dst) );
+
+		src[n / 2] = dst[n / 2] = std::numeric_limits<T>::quiet_NaN();
+		ASSERT_FALSE( simd_memop<T>::equal(level, n, src, dst) );
+	}
+
+	delete[] src0;
+	delete[] dst0;
+}
+
+template<typename T>
+static void test_simd_memop()
+{
+	const int maxlevel = detail::simd_level();
+	ASSERT_GE( maxlevel, (int)detail::SIMD_SSE2 );
+
+	for (int level = detail::SIMD_SSE2; level <= maxlevel; ++level)
+	{
+		test_simd_memop_level<T>(level);
+	}
+}
+
+TEST( MemOp, SimdKernels_d ) { test_simd_memop<double>(); }
+TEST( MemOp, SimdKernels_s ) { test_simd_memop<float>(); }
+
+#endif
+
+
+template<typename T>
+static void test_elemwise2d_fp()
+{
+	const index_t m = 37;
+	const index_t n = 5;
+	const index_t ld = 41;
+
+	T *a = new T[ld * n];
+	T *b = new T[ld * n];
+
+	for (index_t i = 0; i < ld * n; ++i) { a[i] = T(i); b[i] = T(-1); }
+
+	// strided
+
+	copy_elems_2d(m, n, a, ld, b + 1, ld);
+	ASSERT_TRUE( elems_equal_2d(m, n, a, ld, b + 1, ld) );
+	ASSERT_EQ( T(-1), b[0] );
+	ASSERT_EQ( T(-1), b[m + 1] );
+
+	b[1 + 2 * ld + 20] = T(-5);
+	ASSERT_FALSE( elems_equal_2d(m, n, a, ld, b + 1, ld) );
+
+	fill_elems_2d(m, n, b, ld, T(2));
+	ASSERT_TRUE( elems_equal_2d(m, n, b, ld, T(2)) );
+	ASSERT_EQ( T(-1), b[m + 1] );
+
+	b[3 * ld + 30] = T(0);
+	ASSERT_FALSE( elems_equal_2d(m, n, b, ld, T(2)) );
+
+	// contiguous
+
+	copy_elems_2d(ld, n, a, ld, b, ld);
+	ASSERT_TRUE( elems_equal(ld * n, a, b) );
+
+	fill_elems_2d(ld, n, b, ld, T(4));
+	ASSERT_TRUE( elems_equal_2d(ld, n, b, ld, T(4)) );
+
+	delete[] a;
+	delete[] b;
+}
+
+TEST( MemOp, ElemWise2D_d ) { test_elemwise2d_fp<double>(); }
+TEST( MemOp, ElemWise2D_s ) { test_elemwise2d_fp<float>(); }
+
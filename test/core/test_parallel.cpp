@@ -0,0 +1,144 @@
+/**
+ * @file test_parallel.cpp
+ *
+ * Unit testing for the thread pool and parallel_for
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/core/parallel.h>
+
+#include <vector>
+#include <stdexcept>
+
+using namespace bcs;
+
+
+struct par_mark_task
+{
+	std::vector<int>& marks;
+	index_t grain;
+	bool *ok;
+
+	par_mark_task(std::vector<int>& m, index_t g, bool *ok_) : marks(m), grain(g), ok(ok_) { }
+
+	void operator() (const index_t i0, const index_t i1) const
+	{
+		if (i1 - i0 < grain) *ok = false;
+		for (index_t i = i0; i < i1; ++i) marks[(size_t)i] += 1;
+	}
+};
+
+struct par_throw_task
+{
+	void operator() (const index_t i0, const index_t i1) const
+	{
+		if (i0 > 0) throw std::runtime_error("par_throw_task");
+	}
+};
+
+struct par_nested_task
+{
+	std::vector<int>& marks;
+	bool *ok;
+
+	par_nested_task(std::vector<int>& m, bool *ok_) : marks(m), ok(ok_) { }
+
+	void operator() (const index_t i0, const index_t i1) const
+	{
+		// the inner loop runs serially within a task
+		parallel_for(i0, i1, 1, par_mark_task(marks, i1 - i0, ok));
+	}
+};
+
+
+static bool test_parallel_cover(const index_t begin, const index_t end, const index_t grain)
+{
+	std::vector<int> marks((size_t)end, 0);
+	bool ok = true;
+	parallel_for(begin, end, grain, par_mark_task(marks, end - begin < grain ? end - begin : grain, &ok));
+
+	for (index_t i = 0; i < end; ++i)
+	{
+		if (marks[(size_t)i] != (i >= begin ? 1 : 0)) return false;
+	}
+	return ok;
+}
+
+
+TEST( Parallel, Settings )
+{
+	set_num_threads(3);
+	ASSERT_EQ(3, get_num_threads());
+
+	set_parallel_grain(100);
+	ASSERT_EQ(100, get_parallel_grain());
+
+	ASSERT_FALSE( use_parallel(199) );
+	ASSERT_TRUE( use_parallel(200) );
+	ASSERT_EQ(10, parallel_column_grain(10));
+	ASSERT_EQ(34, parallel_column_grain(3));
+
+	set_num_threads(1);
+	ASSERT_FALSE( use_parallel(100000) );
+
+	set_num_threads(0);
+	ASSERT_TRUE( get_num_threads() >= 1 );
+
+	set_parallel_grain(0);
+	ASSERT_EQ(detail::default_parallel_grain(), get_parallel_grain());
+}
+
+
+TEST( Parallel, ParallelFor )
+{
+	const int nts[4] = {1, 2, 4, 7};
+
+	for (int t = 0; t < 4; ++t)
+	{
+		set_num_threads(nts[t]);
+
+		ASSERT_TRUE( test_parallel_cover(0, 0, 1) );
+		ASSERT_TRUE( test_parallel_cover(0, 1, 1) );
+		ASSERT_TRUE( test_parallel_cover(0, 5, 10) );
+		ASSERT_TRUE( test_parallel_cover(0, 1000, 1) );
+		ASSERT_TRUE( test_parallel_cover(3, 1000, 17) );
+		ASSERT_TRUE( test_parallel_cover(0, 1001, 250) );
+
+		// repeated runs reuse the pool
+		for (int k = 0; k < 20; ++k)
+			ASSERT_TRUE( test_parallel_cover(0, 997, 10) );
+	}
+
+	set_num_threads(0);
+}
+
+
+TEST( Parallel, Nested )
+{
+	set_num_threads(4);
+
+	std::vector<int> marks(1000, 0);
+	bool ok = true;
+	parallel_for(0, 1000, 10, par_nested_task(marks, &ok));
+
+	ASSERT_TRUE( ok );
+	for (size_t i = 0; i < 1000; ++i) ASSERT_EQ(1, marks[i]);
+
+	set_num_threads(0);
+}
+
+
+TEST( Parallel, Exceptions )
+{
+	set_num_threads(4);
+
+	ASSERT_THROW( parallel_for(0, 1000, 10, par_throw_task()), std::runtime_error );
+
+	// the pool remains usable
+	ASSERT_TRUE( test_parallel_cover(0, 1000, 10) );
+
+	set_num_threads(0);
+}
+
@@ -0,0 +1,159 @@
+/**
+ * @file test_scratch_pool.cpp
+ *
+ * Unit testing for the scratch arena and scratch_allocator
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/core.h>
+
+using namespace bcs;
+
+
+// explicit template instantiation for syntax check
+
+template class bcs::scratch_allocator<double>;
+template class bcs::block<double, scratch_allocator<double> >;
+template class bcs::scoped_block<double, scratch_allocator<double> >;
+
+
+static bool is_aligned_ptr(const void *p)
+{
+	return ((size_t)p & (BCS_DEFAULT_ALIGNMENT - 1)) == 0;
+}
+
+
+TEST( ScratchPool, Arena )
+{
+	scratch_arena a;
+
+	ASSERT_EQ(0, a.num_live());
+	ASSERT_EQ(0, a.num_chunks());
+	ASSERT_EQ(0, a.used_bytes());
+
+	void *p1 = a.allocate(100);
+	void *p2 = a.allocate(40);
+
+	ASSERT_TRUE( is_aligned_ptr(p1) );
+	ASSERT_TRUE( is_aligned_ptr(p2) );
+	ASSERT_EQ( (char*)p1 + 128, (char*)p2 );
+	ASSERT_EQ(2, a.num_live());
+	ASSERT_EQ(1, a.num_chunks());
+	ASSERT_EQ(192, a.used_bytes());
+
+	// the most recent one is popped back
+
+	a.release(p2, 40);
+	ASSERT_EQ(1, a.num_live());
+	ASSERT_EQ(128, a.used_bytes());
+
+	void *p3 = a.allocate(64);
+	ASSERT_EQ(p2, p3);
+
+	// out-of-order release leaves a hole until nothing is live
+
+	a.release(p1, 100);
+	ASSERT_EQ(1, a.num_live());
+	ASSERT_EQ(192, a.used_bytes());
+
+	a.release(p3, 64);
+	ASSERT_EQ(0, a.num_live());
+	ASSERT_EQ(0, a.used_bytes());
+
+	void *p4 = a.allocate(8);
+	ASSERT_EQ(p1, p4);
+	a.release(p4, 8);
+}
+
+
+TEST( ScratchPool, ArenaChunks )
+{
+	scratch_arena a;
+
+	const size_t nb = ScratchMaxBytes;
+	const size_t nper = ScratchChunkBytes / nb;
+
+	std::vector<void*> ps;
+	for (size_t i = 0; i < nper + 1; ++i) ps.push_back(a.allocate(nb));
+
+	ASSERT_EQ(2, a.num_chunks());
+	ASSERT_EQ(nper + 1, a.num_live());
+	ASSERT_EQ(ScratchChunkBytes + nb, a.used_bytes());
+
+	for (size_t i = nper + 1; i > 0; --i) a.release(ps[i-1], nb);
+
+	ASSERT_EQ(0, a.num_live());
+	ASSERT_EQ(0, a.used_bytes());
+
+	// chunks are kept for reuse
+
+	ASSERT_EQ(2, a.num_chunks());
+	void *q = a.allocate(nb);
+	ASSERT_EQ(ps[0], q);
+	a.release(q, nb);
+
+	a.trim();
+	ASSERT_EQ(0, a.num_chunks());
+}
+
+
+TEST( ScratchPool, Scope )
+{
+	scratch_arena& a = scratch_arena::local();
+	const size_t u0 = a.used_bytes();
+
+	void *p0 = a.allocate(32);
+
+	{
+		scratch_scope sc;
+
+		void *p1 = a.allocate(32);
+		void *p2 = a.allocate(32);
+		a.release(p1, 32);
+		a.release(p2, 32);
+
+		// the hole of p1 remains within the scope
+		ASSERT_EQ(u0 + 64, a.used_bytes());
+	}
+
+	ASSERT_EQ(u0 + 32, a.used_bytes());
+
+	a.release(p0, 32);
+	ASSERT_EQ(u0, a.used_bytes());
+}
+
+
+TEST( ScratchPool, Allocator )
+{
+	scratch_arena& a = scratch_arena::local();
+	const size_t nlive0 = a.num_live();
+
+	{
+		block<double, scratch_allocator<double> > b1(10, 1.0);
+		block<double, scratch_allocator<double> > b2(20, 2.0);
+
+		ASSERT_TRUE( b1.get_allocator().arena() == &a );
+		ASSERT_EQ(nlive0 + 2, a.num_live());
+		ASSERT_TRUE( is_aligned_ptr(b1.ptr_begin()) );
+		ASSERT_TRUE( is_aligned_ptr(b2.ptr_begin()) );
+		ASSERT_TRUE( elems_equal(10, b1.ptr_begin(), 1.0) );
+		ASSERT_TRUE( elems_equal(20, b2.ptr_begin(), 2.0) );
+
+		b1.resize(30);
+		ASSERT_EQ(30, b1.nelems());
+		ASSERT_EQ(nlive0 + 2, a.num_live());
+
+		// large requests bypass the arena
+
+		const index_t nbig = (index_t)(ScratchMaxBytes / sizeof(double)) + 1;
+		scoped_block<double, scratch_allocator<double> > b3(nbig, 3.0);
+		ASSERT_EQ(nlive0 + 2, a.num_live());
+		ASSERT_TRUE( elems_equal(nbig, b3.ptr_begin(), 3.0) );
+	}
+
+	ASSERT_EQ(nlive0, a.num_live());
+}
+
+
@@ -0,0 +1,367 @@
+/**
+ * @file test_native_blas.cpp
+ *
+ * Unit testing of the built-in BLAS implementation
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/engine/native_blas.h>
+
+#include <bcslib/matrix.h>
+#include <cstdio>
+
+using namespace bcs;
+
+
+template<typename T, class Mat>
+void native_init_mat(IDenseMatrix<Mat, T>& a, int p, int b)
+{
+	T *pa = a.ptr_data();
+	for (int i = 0; i < a.nelems(); ++i) pa[i] = T((i % p) - b);
+}
+
+template<typename T>
+inline T native_elem(const dense_matrix<T>& a, bool tr, index_t i, index_t j)
+{
+	return tr ? a(j, i) : a(i, j);
+}
+
+
+/************************************************
+ *
+ *  GEMM
+ *
+ ************************************************/
+
+template<typename T>
+void native_gemm_test(const char transa, const char transb, const int m, const int n, const int k)
+{
+	const bool ta = (transa == 'T');
+	const bool tb = (transb == 'T');
+
+	const int ld_add = 3;
+
+	const int ma = ta ? k : m;
+	const int na = ta ? m : k;
+	const int mb = tb ? n : k;
+	const int nb = tb ? k : n;
+
+	dense_matrix<T> a(ma + ld_add, na);
+	dense_matrix<T> b(mb + ld_add, nb);
+	dense_matrix<T> c0(m + ld_add, n);
+
+	native_init_mat(a, 7, 3);
+	native_init_mat(b, 5, 2);
+	native_init_mat(c0, 3, 0);
+
+	const T alpha_s[2] = {T(1), T(2)};
+	const T beta_s[3] = {T(0), T(1), T(2)};
+
+	for (int ja = 0; ja < 2; ++ja)
+	for (int jb = 0; jb < 3; ++jb)
+	{
+		const T alpha = alpha_s[ja];
+		const T beta = beta_s[jb];
+
+		dense_matrix<T> r(c0);
+		for (index_t j = 0; j < n; ++j)
+		{
+			for (index_t i = 0; i < m; ++i)
+			{
+				T s(0);
+				for (index_t u = 0; u < k; ++u)
+					s += native_elem(a, ta, i, u) * native_elem(b, tb, u, j);
+				r(i, j) = alpha * s + beta * c0(i, j);
+			}
+		}
+
+		dense_matrix<T> c(c0);
+		engine::native_gemm<T>::eval(transa, transb, m, n, k,
+				alpha, a.ptr_data(), (int)a.lead_dim(), b.ptr_data(), (int)b.lead_dim(),
+				beta, c.ptr_data(), (int)c.lead_dim());
+
+		// the padding rows must not be touched
+		ASSERT_TRUE( is_equal(c, r) );
+	}
+}
+
+template<typename T>
+void native_gemm_test_all(const int m, const int n, const int k)
+{
+	native_gemm_test<T>('N', 'N', m, n, k);
+	native_gemm_test<T>('N', 'T', m, n, k);
+	native_gemm_test<T>('T', 'N', m, n, k);
+	native_gemm_test<T>('T', 'T', m, n, k);
+}
+
+
+TEST( NativeBlasL3, Gemm_Tiny_d )
+{
+	native_gemm_test_all<double>(1, 1, 1);
+	native_gemm_test_all<double>(3, 2, 5);
+}
+
+TEST( NativeBlasL3, Gemm_Tiny_s )
+{
+	native_gemm_test_all<float>(1, 1, 1);
+	native_gemm_test_all<float>(3, 2, 5);
+}
+
+TEST( NativeBlasL3, Gemm_Edges_d )
+{
+	native_gemm_test_all<double>(8, 8, 8);
+	native_gemm_test_all<double>(13, 11, 9);
+	native_gemm_test_all<double>(33, 17, 21);
+}
+
+TEST( NativeBlasL3, Gemm_Edges_s )
+{
+	native_gemm_test_all<float>(8, 8, 8);
+	native_gemm_test_all<float>(13, 11, 9);
+	native_gemm_test_all<float>(33, 17, 21);
+}
+
+TEST( NativeBlasL3, Gemm_MultiBlocks_d )
+{
+	native_gemm_test_all<double>(37, 29, 300);  // k > KC
+	native_gemm_test_all<double>(203, 10, 20);  // m > MC
+}
+
+TEST( NativeBlasL3, Gemm_MultiBlocks_s )
+{
+	native_gemm_test_all<float>(37, 29, 300);   // k > KC
+	native_gemm_test_all<float>(203, 10, 20);   // m > MC
+}
+
+TEST( NativeBlasL3, Gemm_Parallel )
+{
+	// a tiny grain, such that every product is split among threads
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	native_gemm_test_all<double>(3, 2, 5);
+	native_gemm_test_all<double>(33, 17, 21);
+	native_gemm_test_all<double>(203, 45, 300);  // m > MC, k > KC
+	native_gemm_test_all<float>(13, 11, 9);
+	native_gemm_test_all<float>(301, 70, 260);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+/************************************************
+ *
+ *  SYRK
+ *
+ ************************************************/
+
+template<typename T>
+void native_syrk_test(const char uplo, const char trans, const int n, const int k)
+{
+	const bool ta = (trans == 'T');
+	const int ld_add = 3;
+
+	dense_matrix<T> a((ta ? k : n) + ld_add, ta ? n : k);
+	dense_matrix<T> c0(n + ld_add, n);
+
+	native_init_mat(a, 7, 3);
+	native_init_mat(c0, 3, 0);
+
+	const T beta_s[3] = {T(0), T(1), T(2)};
+
+	for (int jb = 0; jb < 3; ++jb)
+	{
+		const T alpha = T(2);
+		const T beta = beta_s[jb];
+
+		// the other triangle (and the padding rows) must not be touched
+
+		dense_matrix<T> r(c0);
+		for (index_t j = 0; j < n; ++j)
+		{
+			for (index_t i = 0; i < n; ++i)
+			{
+				if (uplo == 'U' ? i <= j : i >= j)
+				{
+					T s(0);
+					for (index_t u = 0; u < k; ++u)
+						s += native_elem(a, ta, i, u) * native_elem(a, ta, j, u);
+					r(i, j) = alpha * s + beta * c0(i, j);
+				}
+			}
+		}
+
+		dense_matrix<T> c(c0);
+		engine::native_syrk<T>::eval(uplo, trans, n, k,
+				alpha, a.ptr_data(), (int)a.lead_dim(), beta, c.ptr_data(), (int)c.lead_dim());
+
+		ASSERT_TRUE( is_equal(c, r) );
+	}
+}
+
+template<typename T>
+void native_syrk_test_all(const int n, const int k)
+{
+	native_syrk_test<T>('U', 'N', n, k);
+	native_syrk_test<T>('U', 'T', n, k);
+	native_syrk_test<T>('L', 'N', n, k);
+	native_syrk_test<T>('L', 'T', n, k);
+}
+
+TEST( NativeBlasL3, Syrk_d )
+{
+	native_syrk_test_all<double>(1, 3);
+	native_syrk_test_all<double>(13, 7);
+	native_syrk_test_all<double>(37, 300);	// k > KC
+	native_syrk_test_all<double>(150, 20);	// n > MC
+}
+
+TEST( NativeBlasL3, Syrk_s )
+{
+	native_syrk_test_all<float>(13, 7);
+	native_syrk_test_all<float>(150, 20);
+}
+
+TEST( NativeBlasL3, Syrk_Parallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	native_syrk_test_all<double>(5, 3);
+	native_syrk_test_all<double>(70, 30);
+	native_syrk_test_all<float>(150, 20);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+/************************************************
+ *
+ *  Triangular routines
+ *
+ ************************************************/
+
+template<typename T>
+void native_tri_mat(const char uplo, const char diag, const dense_matrix<T>& a, dense_matrix<T>& t)
+{
+	const index_t n = a.nrows();
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < n; ++i)
+		{
+			bool in_tri = (uplo == 'U' ? i <= j : i >= j);
+			t(i, j) = in_tri ? a(i, j) : T(0);
+		}
+		if (diag == 'U') t(j, j) = T(1);
+	}
+}
+
+template<typename T>
+void native_trmv_trsv_test(const char uplo, const char trans, const char diag)
+{
+	const int n = 7;
+	const int incx = 2;
+
+	dense_matrix<T> a(n, n);
+	native_init_mat(a, 5, 2);
+	for (index_t i = 0; i < n; ++i) a(i, i) = T(4 + i);
+
+	dense_matrix<T> t(n, n);
+	native_tri_mat(uplo, diag, a, t);
+
+	dense_col<T> x0(n * incx);
+	native_init_mat(x0, 7, 3);
+
+	// trmv
+
+	dense_col<T> r(x0);
+	for (index_t i = 0; i < n; ++i)
+	{
+		T s(0);
+		for (index_t j = 0; j < n; ++j) s += native_elem(t, trans == 'T', i, j) * x0[j * incx];
+		r[i * incx] = s;
+	}
+
+	dense_col<T> x(x0);
+	engine::native::trmv(uplo, trans, diag, n, a.ptr_data(), n, x.ptr_data(), incx);
+	ASSERT_TRUE( is_equal(x, r) );
+
+	// trsv (should recover x0)
+
+	engine::native::trsv(uplo, trans, diag, n, a.ptr_data(), n, x.ptr_data(), incx);
+	ASSERT_TRUE( is_approx(x, x0, T(1.0e-4)) );
+}
+
+template<typename T>
+void native_trmm_trsm_test(const char side, const char uplo, const char trans, const char diag)
+{
+	const int m = 5;
+	const int n = 6;
+	const int na = (side == 'L' ? m : n);
+	const T alpha = T(2);
+
+	dense_matrix<T> a(na, na);
+	native_init_mat(a, 5, 2);
+	for (index_t i = 0; i < na; ++i) a(i, i) = T(4 + i);
+
+	dense_matrix<T> t(na, na);
+	native_tri_mat(uplo, diag, a, t);
+
+	dense_matrix<T> b0(m, n);
+	native_init_mat(b0, 7, 3);
+
+	dense_matrix<T> r(m, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			T s(0);
+			if (side == 'L')
+				for (index_t u = 0; u < m; ++u) s += native_elem(t, trans == 'T', i, u) * b0(u, j);
+			else
+				for (index_t u = 0; u < n; ++u) s += b0(i, u) * native_elem(t, trans == 'T', u, j);
+			r(i, j) = alpha * s;
+		}
+	}
+
+	dense_matrix<T> b(b0);
+	engine::native::trmm(side, uplo, trans, diag, m, n, alpha, a.ptr_data(), na, b.ptr_data(), m);
+	ASSERT_TRUE( is_equal(b, r) );
+
+	engine::native::trsm(side, uplo, trans, diag, m, n, T(1) / alpha, a.ptr_data(), na, b.ptr_data(), m);
+	ASSERT_TRUE( is_approx(b, b0, T(1.0e-4)) );
+}
+
+template<typename T>
+void native_tri_test_all()
+{
+	const char uplos[2] = {'U', 'L'};
+	const char transs[2] = {'N', 'T'};
+	const char diags[2] = {'N', 'U'};
+	const char sides[2] = {'L', 'R'};
+
+	for (int iu = 0; iu < 2; ++iu)
+	for (int it = 0; it < 2; ++it)
+	for (int id = 0; id < 2; ++id)
+	{
+		native_trmv_trsv_test<T>(uplos[iu], transs[it], diags[id]);
+
+		for (int is = 0; is < 2; ++is)
+			native_trmm_trsm_test<T>(sides[is], uplos[iu], transs[it], diags[id]);
+	}
+}
+
+TEST( NativeBlasTri, AllCases_d )
+{
+	native_tri_test_all<double>();
+}
+
+TEST( NativeBlasTri, AllCases_s )
+{
+	native_tri_test_all<float>();
+}
+
@@ -0,0 +1,163 @@
+/**
+ * @file test_small_blas_dispatch.cpp
+ *
+ * Unit testing of the runtime-dimension dispatch of small kernels
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/engine/small_blas_dispatch.h>
+
+#include <vector>
+
+using namespace bcs;
+using namespace bcs::engine;
+
+
+// the runtime-size kernels serve as the reference
+
+template<typename T>
+bool test_gemm_dispatch(const bool ta, const bool tb, const T alpha, const T beta)
+{
+	const int D = SmallBlasMaxRtDim;
+	const int ld = D + 1;
+
+	std::vector<T> a(ld * D), b(ld * D), c0(ld * D);
+	for (int i = 0; i < ld * D; ++i)
+	{
+		a[i] = T(i % 7 + 1);
+		b[i] = T(i % 5 - 2);
+		c0[i] = T(i % 3);
+	}
+
+	for (int m = 1; m <= D; ++m)
+	for (int n = 1; n <= D; ++n)
+	for (int k = 1; k <= D; ++k)
+	{
+		std::vector<T> c(c0), r(c0);
+
+		small_gemm_dispatch<T>::eval(ta, tb, m, n, k, alpha, &a[0], ld, &b[0], ld, beta, &c[0], ld);
+
+		typedef small_gemm_rt<T> ref_t;
+		if (ta)
+		{
+			if (tb) ref_t::eval_tt(m, n, k, alpha, &a[0], ld, &b[0], ld, beta, &r[0], ld);
+			else    ref_t::eval_tn(m, n, k, alpha, &a[0], ld, &b[0], ld, beta, &r[0], ld);
+		}
+		else
+		{
+			if (tb) ref_t::eval_nt(m, n, k, alpha, &a[0], ld, &b[0], ld, beta, &r[0], ld);
+			else    ref_t::eval_nn(m, n, k, alpha, &a[0], ld, &b[0], ld, beta, &r[0], ld);
+		}
+
+		if (c != r) return false;
+	}
+
+	return true;
+}
+
+
+template<typename T>
+bool test_gemv_dispatch(const bool trans, const T alpha, const T beta)
+{
+	const int D = SmallBlasMaxRtDim;
+	const int ld = D + 2;
+
+	std::vector<T> a(ld * D), x(2 * D), y0(2 * D);
+	for (int i = 0; i < ld * D; ++i) a[i] = T(i % 7 + 1);
+	for (int i = 0; i < 2 * D; ++i)
+	{
+		x[i] = T(i % 5 - 2);
+		y0[i] = T(i % 3);
+	}
+
+	for (int m = 1; m <= D; ++m)
+	for (int n = 1; n <= D; ++n)
+	{
+		std::vector<T> y(y0), r(y0);
+
+		small_gemv_dispatch<T>::eval(trans, m, n, alpha, &a[0], ld, &x[0], 2, beta, &y[0], 2);
+
+		if (trans)
+			small_gemv_rt<T>::eval_t(m, n, alpha, &a[0], ld, &x[0], 2, beta, &r[0], 2);
+		else
+			small_gemv_rt<T>::eval_n(m, n, alpha, &a[0], ld, &x[0], 2, beta, &r[0], 2);
+
+		if (y != r) return false;
+	}
+
+	return true;
+}
+
+
+template<typename T>
+bool test_ger_dispatch(const T alpha)
+{
+	const int D = SmallBlasMaxRtDim;
+	const int ld = D + 1;
+
+	std::vector<T> x(D), y(D), a0(ld * D);
+	for (int i = 0; i < D; ++i)
+	{
+		x[i] = T(i + 1);
+		y[i] = T(i % 3 - 1);
+	}
+	for (int i = 0; i < ld * D; ++i) a0[i] = T(i % 4);
+
+	for (int m = 1; m <= D; ++m)
+	for (int n = 1; n <= D; ++n)
+	{
+		std::vector<T> a(a0), r(a0);
+
+		small_ger_dispatch<T>::eval(m, n, alpha, &x[0], 1, &y[0], 1, &a[0], ld);
+		small_ger_rt<T>::eval(m, n, alpha, &x[0], 1, &y[0], 1, &r[0], ld);
+
+		if (a != r) return false;
+	}
+
+	return true;
+}
+
+
+TEST( SmallBlasDispatch, Range )
+{
+	const int D = SmallBlasMaxRtDim;
+
+	ASSERT_TRUE( in_small_dispatch_range(1, 1, 1) );
+	ASSERT_TRUE( in_small_dispatch_range(D, D, D) );
+	ASSERT_TRUE( in_small_dispatch_range(3, 5) );
+
+	ASSERT_FALSE( in_small_dispatch_range(0, 2, 2) );
+	ASSERT_FALSE( in_small_dispatch_range(2, D + 1, 2) );
+	ASSERT_FALSE( in_small_dispatch_range(2, 2, D + 1) );
+}
+
+TEST( SmallBlasDispatch, Gemm )
+{
+	for (int t = 0; t < 4; ++t)
+	{
+		const bool ta = (t & 1) != 0;
+		const bool tb = (t & 2) != 0;
+
+		ASSERT_TRUE( test_gemm_dispatch<double>(ta, tb, 1.0, 0.0) );
+		ASSERT_TRUE( test_gemm_dispatch<double>(ta, tb, 2.0, 1.0) );
+		ASSERT_TRUE( test_gemm_dispatch<float>(ta, tb, 1.0f, 0.0f) );
+		ASSERT_TRUE( test_gemm_dispatch<float>(ta, tb, 2.0f, 3.0f) );
+	}
+}
+
+TEST( SmallBlasDispatch, Gemv )
+{
+	ASSERT_TRUE( test_gemv_dispatch<double>(false, 1.0, 0.0) );
+	ASSERT_TRUE( test_gemv_dispatch<double>(true,  2.0, 1.0) );
+	ASSERT_TRUE( test_gemv_dispatch<float>(false, 2.0f, 3.0f) );
+	ASSERT_TRUE( test_gemv_dispatch<float>(true,  1.0f, 0.0f) );
+}
+
+TEST( SmallBlasDispatch, Ger )
+{
+	ASSERT_TRUE( test_ger_dispatch<double>(1.0) );
+	ASSERT_TRUE( test_ger_dispatch<float>(2.0f) );
+}
+
@@ -737,6 +737,55 @@ TEST( SmallBlasL3, Gemm_666d )
 	gemm_test<double, 6, 6, 6>();
 }
 
+TEST( SmallBlasL3, Gemm_333d )
+{
+	gemm_test<double, 3, 3, 3>();
+}
+
+TEST( SmallBlasL3, Gemm_385d )
+{
+	gemm_test<double, 3, 8, 5>();
+}
+
+TEST( SmallBlasL3, Gemm_834d )
+{
+	gemm_test<double, 8, 3, 4>();
+}
+
+TEST( SmallBlasL3, Gemm_888d )
+{
+	gemm_test<double, 8, 8, 8>();
+}
+
+TEST( SmallBlasL3, Gemm_222f )
+{
+	gemm_test<float, 2, 2, 2>();
+}
+
+TEST( SmallBlasL3, Gemm_333f )
+{
+	gemm_test<float, 3, 3, 3>();
+}
+
+TEST( SmallBlasL3, Gemm_444f )
+{
+	gemm_test<float, 4, 4, 4>();
+}
+
+TEST( SmallBlasL3, Gemm_483f )
+{
+	gemm_test<float, 4, 8, 3>();
+}
+
+TEST( SmallBlasL3, Gemm_846f )
+{
+	gemm_test<float, 8, 4, 6>();
+}
+
+TEST( SmallBlasL3, Gemm_888f )
+{
+	gemm_test<float, 8, 8, 8>();
+}
 
 
 
@@ -0,0 +1,163 @@
+/**
+ * @file test_small_gemm_batch.cpp
+ *
+ * Unit testing of batched small matrix GEMM
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/engine/small_blas_batch.h>
+#include <bcslib/core/parallel.h>
+
+#include <vector>
+#include <cmath>
+
+using namespace bcs;
+
+
+// naive reference: c := alpha * op(a) * op(b) + beta * c
+
+template<typename T>
+void batch_naive_gemm(int m, int n, int k, bool ta, bool tb, const T alpha,
+		const T *a, int lda, const T *b, int ldb, const T beta, T *c, int ldc)
+{
+	for (int j = 0; j < n; ++j)
+	{
+		for (int i = 0; i < m; ++i)
+		{
+			T s(0);
+			for (int u = 0; u < k; ++u)
+			{
+				T av = ta ? a[u + i * lda] : a[i + u * lda];
+				T bv = tb ? b[j + u * ldb] : b[u + j * ldb];
+				s += av * bv;
+			}
+			c[i + j * ldc] = (beta == 0 ? alpha * s : alpha * s + beta * c[i + j * ldc]);
+		}
+	}
+}
+
+
+template<typename T, int M, int N, int K>
+struct batch_gemm_tester
+{
+	// padded leading dimensions, and gaps between problems
+
+	static const int LDA = (M > K ? M : K) + 1;
+	static const int LDB = (K > N ? K : N) + 1;
+	static const int LDC = M + 1;
+
+	static const index_t SA = LDA * (M > K ? M : K) + 3;
+	static const index_t SB = LDB * (K > N ? K : N) + 3;
+	static const index_t SC = LDC * N + 3;
+
+	static bool run(const index_t nb, bool ta, bool tb, const T alpha, const T beta, bool use_ptrs)
+	{
+		std::vector<T> a((size_t)(nb * SA));
+		std::vector<T> b((size_t)(nb * SB));
+		std::vector<T> c((size_t)(nb * SC));
+
+		for (size_t i = 0; i < a.size(); ++i) a[i] = T(int(i % 13) - 6);
+		for (size_t i = 0; i < b.size(); ++i) b[i] = T(int(i % 7) - 3);
+		for (size_t i = 0; i < c.size(); ++i) c[i] = T(int(i % 5) - 2);
+
+		std::vector<T> r(c);
+		for (index_t p = 0; p < nb; ++p)
+		{
+			batch_naive_gemm(M, N, K, ta, tb, alpha,
+					&a[(size_t)(p * SA)], LDA, &b[(size_t)(p * SB)], LDB,
+					beta, &r[(size_t)(p * SC)], LDC);
+		}
+
+		typedef engine::small_gemm_batch<T, M, N, K> bgemm;
+
+		if (use_ptrs)
+		{
+			std::vector<const T*> pa((size_t)nb);
+			std::vector<const T*> pb((size_t)nb);
+			std::vector<T*> pc((size_t)nb);
+			for (index_t p = 0; p < nb; ++p)
+			{
+				pa[(size_t)p] = &a[(size_t)(p * SA)];
+				pb[(size_t)p] = &b[(size_t)(p * SB)];
+				pc[(size_t)p] = &c[(size_t)(p * SC)];
+			}
+
+			if (!ta && !tb) bgemm::eval_nn(nb, alpha, &pa[0], LDA, &pb[0], LDB, beta, &pc[0], LDC);
+			if (!ta &&  tb) bgemm::eval_nt(nb, alpha, &pa[0], LDA, &pb[0], LDB, beta, &pc[0], LDC);
+			if ( ta && !tb) bgemm::eval_tn(nb, alpha, &pa[0], LDA, &pb[0], LDB, beta, &pc[0], LDC);
+			if ( ta &&  tb) bgemm::eval_tt(nb, alpha, &pa[0], LDA, &pb[0], LDB, beta, &pc[0], LDC);
+		}
+		else
+		{
+			if (!ta && !tb) bgemm::eval_nn(nb, alpha, &a[0], LDA, SA, &b[0], LDB, SB, beta, &c[0], LDC, SC);
+			if (!ta &&  tb) bgemm::eval_nt(nb, alpha, &a[0], LDA, SA, &b[0], LDB, SB, beta, &c[0], LDC, SC);
+			if ( ta && !tb) bgemm::eval_tn(nb, alpha, &a[0], LDA, SA, &b[0], LDB, SB, beta, &c[0], LDC, SC);
+			if ( ta &&  tb) bgemm::eval_tt(nb, alpha, &a[0], LDA, SA, &b[0], LDB, SB, beta, &c[0], LDC, SC);
+		}
+
+		for (size_t i = 0; i < c.size(); ++i)
+		{
+			if (std::fabs(c[i] - r[i]) > T(1.0e-4) * (T(1) + std::fabs(r[i]))) return false;
+		}
+		return true;
+	}
+
+	static bool run_all(const index_t nb)
+	{
+		for (int t = 0; t < 4; ++t)
+		{
+			bool ta = (t & 1) != 0;
+			bool tb = (t & 2) != 0;
+
+			if (!run(nb, ta, tb, T(1), T(0), false)) return false;
+			if (!run(nb, ta, tb, T(2), T(1), false)) return false;
+			if (!run(nb, ta, tb, T(1), T(-0.5), true)) return false;
+		}
+		return true;
+	}
+};
+
+
+TEST( SmallGemmBatch, Double )
+{
+	const index_t nbs[4] = {0, 1, 7, 37};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_TRUE( (batch_gemm_tester<double, 1, 1, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 2, 2, 2>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 3, 3, 3>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 4, 4, 4>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 2, 3, 4>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 6, 1, 5>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<double, 8, 8, 8>::run_all(nbs[i])) );
+	}
+}
+
+TEST( SmallGemmBatch, Float )
+{
+	const index_t nbs[4] = {0, 1, 7, 37};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_TRUE( (batch_gemm_tester<float, 1, 1, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<float, 3, 3, 3>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<float, 4, 2, 5>::run_all(nbs[i])) );
+		ASSERT_TRUE( (batch_gemm_tester<float, 8, 8, 8>::run_all(nbs[i])) );
+	}
+}
+
+TEST( SmallGemmBatch, Parallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(64);
+
+	ASSERT_TRUE( (batch_gemm_tester<double, 3, 3, 3>::run_all(203)) );
+	ASSERT_TRUE( (batch_gemm_tester<float, 4, 4, 4>::run_all(157)) );
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
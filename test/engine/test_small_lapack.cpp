@@ -0,0 +1,514 @@
+/**
+ * @file test_small_lapack.cpp
+ *
+ * Unit testing of small matrix factorizations and solvers
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/engine/small_lapack_batch.h>
+#include <bcslib/core/parallel.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace bcs;
+using namespace bcs::engine;
+
+
+template<typename T> struct lapack_tol;
+template<> struct lapack_tol<double> { static double get() { return 1.0e-10; } };
+template<> struct lapack_tol<float>  { static float  get() { return 1.0e-4f; } };
+
+// deterministic values in [-1, 1)
+inline double lapack_rval(unsigned& s)
+{
+	s = s * 1103515245u + 12345u;
+	return double((s >> 8) & 0xffff) / 32768.0 - 1.0;
+}
+
+// a well-conditioned symmetric positive definite matrix
+template<typename T, int N>
+void make_spd(unsigned seed, T *a, const int lda)
+{
+	double m[N * N];
+	for (int i = 0; i < N * N; ++i) m[i] = lapack_rval(seed);
+
+	for (int j = 0; j < N; ++j)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			double s = (i == j ? double(N) : 0.0);
+			for (int u = 0; u < N; ++u) s += m[i + u * N] * m[j + u * N];
+			a[i + j * lda] = T(s);
+		}
+	}
+}
+
+// a well-conditioned general matrix, with rows in reverse order
+// (such that pivoting is needed)
+template<typename T, int N>
+void make_gen(unsigned seed, T *a, const int lda)
+{
+	for (int j = 0; j < N; ++j)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			double v = lapack_rval(seed);
+			if (i == j) v += double(N + 1);
+			a[(N - 1 - i) + j * lda] = T(v);
+		}
+	}
+}
+
+// max_i |A * x - b| / (1 + max_i |b|), with A N x N, and x, b N x 1
+template<typename T, int N>
+T residual(const T *a, const int lda, const T *x, const T *b)
+{
+	T r(0), bm(0);
+	for (int i = 0; i < N; ++i)
+	{
+		T s(0);
+		for (int j = 0; j < N; ++j) s += a[i + j * lda] * x[j];
+		r = std::max(r, T(std::fabs(s - b[i])));
+		bm = std::max(bm, T(std::fabs(b[i])));
+	}
+	return r / (T(1) + bm);
+}
+
+
+/************************************************
+ *
+ *  single problems
+ *
+ ************************************************/
+
+template<typename T, int N>
+bool test_trsv()
+{
+	const int lda = N + 2;
+	std::vector<T> a(lda * N);
+	unsigned sa = 11;
+	for (int i = 0; i < lda * N; ++i) a[i] = T(lapack_rval(sa));
+	for (int j = 0; j < N; ++j) a[j + j * lda] = T(N + 1);
+
+	const char uplos[2] = {'L', 'U'};
+	const char transs[2] = {'N', 'T'};
+	const char diags[2] = {'N', 'U'};
+
+	for (int u = 0; u < 2; ++u)
+	for (int t = 0; t < 2; ++t)
+	for (int d = 0; d < 2; ++d)
+	{
+		const bool lower = (u == 0);
+		const bool unit = (d == 1);
+
+		// the triangular matrix op(A) in full (N x N)
+		std::vector<T> f(N * N, T(0));
+		for (int j = 0; j < N; ++j)
+		{
+			for (int i = 0; i < N; ++i)
+			{
+				bool in = lower ? i >= j : i <= j;
+				T v = in ? (i == j && unit ? T(1) : a[i + j * lda]) : T(0);
+				if (t == 0) f[i + j * N] = v; else f[j + i * N] = v;
+			}
+		}
+
+		T b[N], x[N];
+		unsigned s = 7;
+		for (int i = 0; i < N; ++i) x[i] = b[i] = T(lapack_rval(s));
+
+		small_trsv<T, N>::eval(uplos[u], transs[t], diags[d], &a[0], lda, x);
+		if (!(residual<T, N>(&f[0], N, x, b) < lapack_tol<T>::get())) return false;
+	}
+	return true;
+}
+
+template<typename T, int N>
+bool test_potrf()
+{
+	const int lda = N + 1;
+	std::vector<T> a(lda * N), a0;
+	make_spd<T, N>(3, &a[0], lda);
+
+	// the strictly upper part must be left untouched
+	for (int j = 1; j < N; ++j)
+		for (int i = 0; i < j; ++i) a[i + j * lda] = T(-99);
+	a0 = a;
+
+	if (small_potrf<T, N>::eval(&a[0], lda) != 0) return false;
+
+	for (int j = 0; j < N; ++j)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			if (i < j)
+			{
+				if (a[i + j * lda] != T(-99)) return false;
+			}
+			else
+			{
+				// (L * L')(i, j), with i >= j
+				T s(0);
+				for (int u = 0; u <= j; ++u) s += a[i + u * lda] * a[j + u * lda];
+
+				const T v = a0[i + j * lda];
+				if (!(std::fabs(s - v) < lapack_tol<T>::get() * (T(1) + std::fabs(v)))) return false;
+			}
+		}
+	}
+
+	// solve
+
+	std::vector<T> full(N * N);
+	make_spd<T, N>(3, &full[0], N);
+
+	T b[N], x[N];
+	unsigned s = 5;
+	for (int i = 0; i < N; ++i) x[i] = b[i] = T(lapack_rval(s));
+
+	small_potrs<T, N>::eval(&a[0], lda, x);
+	return residual<T, N>(&full[0], N, x, b) < lapack_tol<T>::get();
+}
+
+template<typename T, int N>
+bool test_getrf()
+{
+	const int lda = N + 1;
+	std::vector<T> a(lda * N), a0;
+	make_gen<T, N>(9, &a[0], lda);
+	a0 = a;
+
+	int ipiv[N];
+	if (small_getrf<T, N>::eval(&a[0], lda, ipiv) != 0) return false;
+
+	for (int j = 0; j < N; ++j)
+	{
+		if (ipiv[j] < j || ipiv[j] >= N) return false;
+	}
+
+	// solve with two right hand sides
+
+	const int ldb = N + 3;
+	T b[ldb * 2], x[ldb * 2];
+	unsigned s = 1;
+	for (int i = 0; i < ldb * 2; ++i) x[i] = b[i] = T(lapack_rval(s));
+
+	small_getrs<T, N>::eval(&a[0], lda, ipiv, x, ldb, 2);
+
+	return residual<T, N>(&a0[0], lda, x, b) < lapack_tol<T>::get() &&
+			residual<T, N>(&a0[0], lda, x + ldb, b + ldb) < lapack_tol<T>::get();
+}
+
+template<typename T, int N>
+bool test_inv()
+{
+	const int lda = N + 1;
+	const int ldb = N + 2;
+	std::vector<T> a(lda * N), b(ldb * N);
+	make_gen<T, N>(13, &a[0], lda);
+
+	if (small_inv<T, N>::eval(&a[0], lda, &b[0], ldb) != 0) return false;
+
+	// A * B = I
+	for (int j = 0; j < N; ++j)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			T s(0);
+			for (int u = 0; u < N; ++u) s += a[i + u * lda] * b[u + j * ldb];
+			if (!(std::fabs(s - T(i == j ? 1 : 0)) < lapack_tol<T>::get())) return false;
+		}
+	}
+	return true;
+}
+
+
+TEST( SmallLapack, Trsv )
+{
+	ASSERT_TRUE( (test_trsv<double, 1>()) );
+	ASSERT_TRUE( (test_trsv<double, 3>()) );
+	ASSERT_TRUE( (test_trsv<double, 8>()) );
+	ASSERT_TRUE( (test_trsv<float, 2>()) );
+	ASSERT_TRUE( (test_trsv<float, 6>()) );
+}
+
+TEST( SmallLapack, Potrf )
+{
+	ASSERT_TRUE( (test_potrf<double, 1>()) );
+	ASSERT_TRUE( (test_potrf<double, 2>()) );
+	ASSERT_TRUE( (test_potrf<double, 3>()) );
+	ASSERT_TRUE( (test_potrf<double, 6>()) );
+	ASSERT_TRUE( (test_potrf<double, 8>()) );
+	ASSERT_TRUE( (test_potrf<float, 3>()) );
+	ASSERT_TRUE( (test_potrf<float, 4>()) );
+	ASSERT_TRUE( (test_potrf<float, 7>()) );
+}
+
+TEST( SmallLapack, PotrfNotPD )
+{
+	// the leading minor of order 2 is singular
+	double a[9] = {1, 2, 0,  2, 4, 1,  0, 1, 5};
+	ASSERT_EQ( 2, (small_potrf<double, 3>::eval(a, 3)) );
+
+	float b[4] = {-1.f, 0.f, 0.f, 1.f};
+	ASSERT_EQ( 1, (small_potrf<float, 2>::eval(b, 2)) );
+}
+
+TEST( SmallLapack, Getrf )
+{
+	ASSERT_TRUE( (test_getrf<double, 1>()) );
+	ASSERT_TRUE( (test_getrf<double, 2>()) );
+	ASSERT_TRUE( (test_getrf<double, 3>()) );
+	ASSERT_TRUE( (test_getrf<double, 5>()) );
+	ASSERT_TRUE( (test_getrf<double, 8>()) );
+	ASSERT_TRUE( (test_getrf<float, 3>()) );
+	ASSERT_TRUE( (test_getrf<float, 6>()) );
+}
+
+TEST( SmallLapack, GetrfSingular )
+{
+	// the second column is twice the first
+	double a[9] = {1, 2, 4,  2, 4, 8,  0, 1, 5};
+	int ipiv[3];
+
+	ASSERT_EQ( 2, (small_getrf<double, 3>::eval(a, 3, ipiv)) );
+	ASSERT_EQ( 2, ipiv[0] );
+
+	double b[9];
+	double c[4] = {1, 2, 2, 4};
+	ASSERT_EQ( 2, (small_inv<double, 2>::eval(c, 2, b, 2)) );
+}
+
+TEST( SmallLapack, Inv )
+{
+	ASSERT_TRUE( (test_inv<double, 1>()) );
+	ASSERT_TRUE( (test_inv<double, 2>()) );
+	ASSERT_TRUE( (test_inv<double, 3>()) );
+	ASSERT_TRUE( (test_inv<double, 4>()) );
+	ASSERT_TRUE( (test_inv<double, 8>()) );
+	ASSERT_TRUE( (test_inv<float, 3>()) );
+	ASSERT_TRUE( (test_inv<float, 5>()) );
+}
+
+
+/************************************************
+ *
+ *  batches
+ *
+ ************************************************/
+
+template<typename T, int N, int NRHS>
+struct lapack_batch_tester
+{
+	static const int LDA = N + 1;
+	static const int LDB = N + 2;
+	static const index_t SA = LDA * N + 3;
+	static const index_t SB = LDB * NRHS + 1;
+
+	// every 5th matrix has its first row and column zeroed (so that
+	// it is neither positive definite nor invertible)
+	static void prepare(const index_t nb, bool spd, std::vector<T>& a, std::vector<T>& b)
+	{
+		a.assign((size_t)(nb * SA), T(-7));
+		b.assign((size_t)(nb * SB), T(-7));
+
+		for (index_t p = 0; p < nb; ++p)
+		{
+			T *ap = &a[(size_t)(p * SA)];
+			if (spd) make_spd<T, N>(unsigned(p + 1), ap, LDA);
+			else make_gen<T, N>(unsigned(p + 1), ap, LDA);
+
+			if (p % 5 == 3)
+			{
+				for (int i = 0; i < N; ++i) ap[i] = T(0);
+				for (int j = 0; j < N; ++j) ap[j * LDA] = T(0);
+			}
+
+			unsigned s = unsigned(p + 100);
+			T *bp = &b[(size_t)(p * SB)];
+			for (int j = 0; j < NRHS; ++j)
+				for (int i = 0; i < N; ++i) bp[i + j * LDB] = T(lapack_rval(s));
+		}
+	}
+
+	static bool check(const index_t nb, const std::vector<T>& a0, const std::vector<T>& b0,
+			const std::vector<T>& b, const std::vector<int>& info)
+	{
+		for (index_t p = 0; p < nb; ++p)
+		{
+			const T *a0p = &a0[(size_t)(p * SA)];
+			const T *b0p = &b0[(size_t)(p * SB)];
+			const T *bp = &b[(size_t)(p * SB)];
+
+			if (p % 5 == 3)
+			{
+				if (info[(size_t)p] != 1) return false;
+				for (index_t i = 0; i < SB; ++i) if (bp[i] != b0p[i]) return false;
+			}
+			else
+			{
+				if (info[(size_t)p] != 0) return false;
+				for (int j = 0; j < NRHS; ++j)
+				{
+					if (!(residual<T, N>(a0p, LDA, bp + j * LDB, b0p + j * LDB) < lapack_tol<T>::get()))
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	static bool run_posv(const index_t nb, bool use_ptrs)
+	{
+		std::vector<T> a, b;
+		prepare(nb, true, a, b);
+		std::vector<T> a0(a), b0(b);
+		std::vector<int> info((size_t)nb + 1, -1);
+
+		if (use_ptrs)
+		{
+			std::vector<T*> pa((size_t)nb + 1), pb((size_t)nb + 1);
+			for (index_t p = 0; p < nb; ++p)
+			{
+				pa[(size_t)p] = &a[(size_t)(p * SA)];
+				pb[(size_t)p] = &b[(size_t)(p * SB)];
+			}
+			small_posv_batch<T, N, NRHS>::eval(nb, &pa[0], LDA, &pb[0], LDB, &info[0]);
+		}
+		else
+		{
+			small_posv_batch<T, N, NRHS>::eval(nb, &a[0], LDA, SA, &b[0], LDB, SB, &info[0]);
+		}
+
+		return check(nb, a0, b0, b, info);
+	}
+
+	static bool run_potrf(const index_t nb)
+	{
+		std::vector<T> a, b;
+		prepare(nb, true, a, b);
+		std::vector<T> a1(a);
+		std::vector<int> info((size_t)nb + 1, -1), info1((size_t)nb + 1, -1);
+
+		small_potrf_batch<T, N>::eval(nb, &a[0], LDA, SA, &info[0]);
+
+		for (index_t p = 0; p < nb; ++p)
+			info1[(size_t)p] = small_potrf<T, N>::eval(&a1[(size_t)(p * SA)], LDA);
+
+		// the factors of the failed problems are undefined
+		for (index_t p = 0; p < nb; ++p)
+		{
+			if (info1[(size_t)p] != 0) continue;
+			for (index_t i = 0; i < SA; ++i)
+			{
+				const size_t k = (size_t)(p * SA + i);
+				if (!(std::fabs(a[k] - a1[k]) <= lapack_tol<T>::get() * (T(1) + std::fabs(a1[k])))) return false;
+			}
+		}
+		return info == info1;
+	}
+
+	static bool run_gesv(const index_t nb, bool use_ptrs)
+	{
+		std::vector<T> a, b;
+		prepare(nb, false, a, b);
+		std::vector<T> a0(a), b0(b);
+		std::vector<int> info((size_t)nb + 1, -1);
+
+		if (use_ptrs)
+		{
+			std::vector<T*> pa((size_t)nb + 1), pb((size_t)nb + 1);
+			for (index_t p = 0; p < nb; ++p)
+			{
+				pa[(size_t)p] = &a[(size_t)(p * SA)];
+				pb[(size_t)p] = &b[(size_t)(p * SB)];
+			}
+			small_gesv_batch<T, N, NRHS>::eval(nb, &pa[0], LDA, &pb[0], LDB, &info[0]);
+		}
+		else
+		{
+			small_gesv_batch<T, N, NRHS>::eval(nb, &a[0], LDA, SA, &b[0], LDB, SB, &info[0]);
+		}
+
+		return check(nb, a0, b0, b, info);
+	}
+
+	static bool run_inv(const index_t nb)
+	{
+		std::vector<T> a, b;
+		prepare(nb, false, a, b);
+
+		const index_t SR = LDB * N;
+		std::vector<T> r((size_t)(nb * SR), T(0));
+		std::vector<int> info((size_t)nb + 1, -1);
+
+		small_inv_batch<T, N>::eval(nb, &a[0], LDA, SA, &r[0], LDB, SR, &info[0]);
+
+		for (index_t p = 0; p < nb; ++p)
+		{
+			T r1[N * N];
+			const int i1 = small_inv<T, N>::eval(&a[(size_t)(p * SA)], LDA, r1, N);
+			if (info[(size_t)p] != i1) return false;
+			if (i1 != 0) continue;
+
+			for (int j = 0; j < N; ++j)
+				for (int i = 0; i < N; ++i)
+					if (r[(size_t)(p * SR + i + j * LDB)] != r1[i + j * N]) return false;
+		}
+		return true;
+	}
+
+	static bool run_all(const index_t nb)
+	{
+		return run_posv(nb, false) && run_posv(nb, true) &&
+				run_potrf(nb) &&
+				run_gesv(nb, false) && run_gesv(nb, true) &&
+				run_inv(nb);
+	}
+};
+
+
+TEST( SmallLapackBatch, Double )
+{
+	const index_t nbs[4] = {0, 1, 7, 37};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_TRUE( (lapack_batch_tester<double, 1, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<double, 2, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<double, 3, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<double, 3, 2>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<double, 6, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<double, 8, 3>::run_all(nbs[i])) );
+	}
+}
+
+TEST( SmallLapackBatch, Float )
+{
+	const index_t nbs[4] = {0, 1, 7, 37};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_TRUE( (lapack_batch_tester<float, 2, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<float, 3, 1>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<float, 4, 2>::run_all(nbs[i])) );
+		ASSERT_TRUE( (lapack_batch_tester<float, 6, 1>::run_all(nbs[i])) );
+	}
+}
+
+TEST( SmallLapackBatch, Parallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(64);
+
+	ASSERT_TRUE( (lapack_batch_tester<double, 3, 1>::run_all(203)) );
+	ASSERT_TRUE( (lapack_batch_tester<float, 6, 1>::run_all(157)) );
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
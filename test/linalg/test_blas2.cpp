@@ -21,25 +21,22 @@ using namespace bcs;
  *
  ************************************************/
 
-template<typename T>
-void test_gemv_n()
+template<typename T, int CM, int CN>
+void test_gemv_n(const index_t m, const index_t n)
 {
-	const index_t m = 5;
-	const index_t n = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(m, n);
+	dense_matrix<T, CM, CN> a(m, n);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_col<T> x(n);
+	dense_col<T, CN> x(n);
 	for (index_t i = 0; i < x.nelems(); ++i) x[i] = T(2 * i - 5);
 
-	dense_col<T> y0(m);
+	dense_col<T, CM> y0(m);
 	for (index_t i = 0; i < y0.nelems(); ++i) y0[i] = T(i+2);
 
-	dense_col<T> y(y0);
+	dense_col<T, CM> y(y0);
 	ASSERT_TRUE( y0.ptr_data() != y.ptr_data() );
 
 	my_mv(alpha, a, x, beta, y0);
@@ -48,28 +45,25 @@ void test_gemv_n()
 	ASSERT_TRUE( is_equal(y, y0) );
 }
 
-template<typename T>
-void test_gemv_t()
+template<typename T, int CM, int CN>
+void test_gemv_t(const index_t m, const index_t n)
 {
-	const index_t m = 5;
-	const index_t n = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(m, n);
+	dense_matrix<T, CM, CN> a(m, n);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_col<T> x(m);
+	dense_col<T, CM> x(m);
 	for (index_t i = 0; i < x.nelems(); ++i) x[i] = T(2 * i - 5);
 
-	dense_col<T> y0(n);
+	dense_col<T, CN> y0(n);
 	for (index_t i = 0; i < y0.nelems(); ++i) y0[i] = T(i+2);
 
-	dense_col<T> y(y0);
+	dense_col<T, CN> y(y0);
 	ASSERT_TRUE( y0.ptr_data() != y.ptr_data() );
 
-	dense_matrix<T> at = a.trans();
+	dense_matrix<T, CN, CM> at = a.trans();
 	my_mv(alpha, at, x, beta, y0);
 	blas::gemv_t(alpha, a, x, beta, y);
 
@@ -157,22 +151,62 @@ void test_gevm_t()
 
 TEST( MatrixBlasL2, GemvN_DDd )
 {
-	test_gemv_n<double>();
+	test_gemv_n<double, 0, 0>(5, 6);
 }
 
 TEST( MatrixBlasL2, GemvN_DDs )
 {
-	test_gemv_n<float>();
+	test_gemv_n<float, 0, 0>(5, 6);
+}
+
+TEST( MatrixBlasL2, GemvN_DDd_Large )
+{
+	test_gemv_n<double, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, GemvN_DDs_Large )
+{
+	test_gemv_n<float, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, GemvN_DDd_Static )
+{
+	test_gemv_n<double, 5, 6>(5, 6);
+}
+
+TEST( MatrixBlasL2, GemvN_DDs_Static )
+{
+	test_gemv_n<float, 5, 6>(5, 6);
 }
 
 TEST( MatrixBlasL2, GemvT_DDd )
 {
-	test_gemv_t<double>();
+	test_gemv_t<double, 0, 0>(5, 6);
 }
 
 TEST( MatrixBlasL2, GemvT_DDs )
 {
-	test_gemv_t<float>();
+	test_gemv_t<float, 0, 0>(5, 6);
+}
+
+TEST( MatrixBlasL2, GemvT_DDd_Large )
+{
+	test_gemv_t<double, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, GemvT_DDs_Large )
+{
+	test_gemv_t<float, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, GemvT_DDd_Static )
+{
+	test_gemv_t<double, 5, 6>(5, 6);
+}
+
+TEST( MatrixBlasL2, GemvT_DDs_Static )
+{
+	test_gemv_t<float, 5, 6>(5, 6);
 }
 
 TEST( MatrixBlasL2, GevmN_DDd )
@@ -202,24 +236,21 @@ TEST( MatrixBlasL2, GevmT_DDs )
  *
  ************************************************/
 
-template<typename T>
-void test_ger()
+template<typename T, int CM, int CN>
+void test_ger(const index_t m, const index_t n)
 {
 	const T alpha = T(0.5);
 
-	const index_t m = 5;
-	const index_t n = 6;
-
-	dense_matrix<T> a0(m, n);
+	dense_matrix<T, CM, CN> a0(m, n);
 	for (index_t i = 0; i < a0.nelems(); ++i) a0[i] = T(i+1);
-	dense_matrix<T> a(a0);
+	dense_matrix<T, CM, CN> a(a0);
 
 	ASSERT_TRUE( a0.ptr_data() != a.ptr_data() );
 
-	dense_col<T> x(m);
+	dense_col<T, CM> x(m);
 	for (index_t i = 0; i < m; ++i) x[i] = T(2 * i + 1);
 
-	dense_col<T> y(n);
+	dense_col<T, CN> y(n);
 	for (index_t i = 0; i < n; ++i) y[i] = T(3 * i - 5);
 
 
@@ -234,12 +265,32 @@ void test_ger()
 
 TEST( MatrixBlasL2, Ger_DDd )
 {
-	test_ger<double>();
+	test_ger<double, 0, 0>(5, 6);
 }
 
 TEST( MatrixBlasL2, Ger_DDs )
 {
-	test_ger<float>();
+	test_ger<float, 0, 0>(5, 6);
+}
+
+TEST( MatrixBlasL2, Ger_DDd_Large )
+{
+	test_ger<double, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, Ger_DDs_Large )
+{
+	test_ger<float, 0, 0>(40, 30);
+}
+
+TEST( MatrixBlasL2, Ger_DDd_Static )
+{
+	test_ger<double, 5, 6>(5, 6);
+}
+
+TEST( MatrixBlasL2, Ger_DDs_Static )
+{
+	test_ger<float, 5, 6>(5, 6);
 }
 
 
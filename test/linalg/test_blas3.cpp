@@ -21,26 +21,22 @@ using namespace bcs;
  *
  ************************************************/
 
-template<typename T>
-void test_gemm_nn()
+template<typename T, int CM, int CN, int CK>
+void test_gemm_nn(const index_t m, const index_t n, const index_t k)
 {
-	const index_t m = 4;
-	const index_t n = 5;
-	const index_t k = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(m, k);
+	dense_matrix<T, CM, CK> a(m, k);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_matrix<T> b(k, n);
+	dense_matrix<T, CK, CN> b(k, n);
 	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(2 * i - 10);
 
-	dense_matrix<T> c0(m, n);
+	dense_matrix<T, CM, CN> c0(m, n);
 	for (index_t i = 0; i < c0.nelems(); ++i) c0[i] = T(i+2);
 
-	dense_matrix<T> c(c0);
+	dense_matrix<T, CM, CN> c(c0);
 	ASSERT_TRUE( c0.ptr_data() != c.ptr_data() );
 
 	my_mm(alpha, a, b, beta, c0);
@@ -49,29 +45,25 @@ void test_gemm_nn()
 	ASSERT_TRUE( is_equal(c, c0) );
 }
 
-template<typename T>
-void test_gemm_nt()
+template<typename T, int CM, int CN, int CK>
+void test_gemm_nt(const index_t m, const index_t n, const index_t k)
 {
-	const index_t m = 4;
-	const index_t n = 5;
-	const index_t k = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(m, k);
+	dense_matrix<T, CM, CK> a(m, k);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_matrix<T> b(n, k);
+	dense_matrix<T, CN, CK> b(n, k);
 	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(2 * i - 10);
 
-	dense_matrix<T> c0(m, n);
+	dense_matrix<T, CM, CN> c0(m, n);
 	for (index_t i = 0; i < c0.nelems(); ++i) c0[i] = T(i+2);
 
-	dense_matrix<T> c(c0);
+	dense_matrix<T, CM, CN> c(c0);
 	ASSERT_TRUE( c0.ptr_data() != c.ptr_data() );
 
-	dense_matrix<T> bt = b.trans();
+	dense_matrix<T, CK, CN> bt = b.trans();
 
 	my_mm(alpha, a, bt, beta, c0);
 	blas::gemm_nt(alpha, a, b, beta, c);
@@ -79,29 +71,25 @@ void test_gemm_nt()
 	ASSERT_TRUE( is_equal(c, c0) );
 }
 
-template<typename T>
-void test_gemm_tn()
+template<typename T, int CM, int CN, int CK>
+void test_gemm_tn(const index_t m, const index_t n, const index_t k)
 {
-	const index_t m = 4;
-	const index_t n = 5;
-	const index_t k = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(k, m);
+	dense_matrix<T, CK, CM> a(k, m);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_matrix<T> b(k, n);
+	dense_matrix<T, CK, CN> b(k, n);
 	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(2 * i - 10);
 
-	dense_matrix<T> c0(m, n);
+	dense_matrix<T, CM, CN> c0(m, n);
 	for (index_t i = 0; i < c0.nelems(); ++i) c0[i] = T(i+2);
 
-	dense_matrix<T> c(c0);
+	dense_matrix<T, CM, CN> c(c0);
 	ASSERT_TRUE( c0.ptr_data() != c.ptr_data() );
 
-	dense_matrix<T> at = a.trans();
+	dense_matrix<T, CM, CK> at = a.trans();
 
 	my_mm(alpha, at, b, beta, c0);
 	blas::gemm_tn(alpha, a, b, beta, c);
@@ -109,30 +97,26 @@ void test_gemm_tn()
 	ASSERT_TRUE( is_equal(c, c0) );
 }
 
-template<typename T>
-void test_gemm_tt()
+template<typename T, int CM, int CN, int CK>
+void test_gemm_tt(const index_t m, const index_t n, const index_t k)
 {
-	const index_t m = 4;
-	const index_t n = 5;
-	const index_t k = 6;
-
 	T alpha = T(1.5);
 	T beta = T(0.5);
 
-	dense_matrix<T> a(k, m);
+	dense_matrix<T, CK, CM> a(k, m);
 	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i+1);
 
-	dense_matrix<T> b(n, k);
+	dense_matrix<T, CN, CK> b(n, k);
 	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(2 * i - 10);
 
-	dense_matrix<T> c0(m, n);
+	dense_matrix<T, CM, CN> c0(m, n);
 	for (index_t i = 0; i < c0.nelems(); ++i) c0[i] = T(i+2);
 
-	dense_matrix<T> c(c0);
+	dense_matrix<T, CM, CN> c(c0);
 	ASSERT_TRUE( c0.ptr_data() != c.ptr_data() );
 
-	dense_matrix<T> at = a.trans();
-	dense_matrix<T> bt = b.trans();
+	dense_matrix<T, CM, CK> at = a.trans();
+	dense_matrix<T, CK, CN> bt = b.trans();
 
 	my_mm(alpha, at, bt, beta, c0);
 	blas::gemm_tt(alpha, a, b, beta, c);
@@ -143,42 +127,122 @@ void test_gemm_tt()
 
 TEST( MatrixBlasL3, GemmNN_DDd )
 {
-	test_gemm_nn<double>();
+	test_gemm_nn<double, 0, 0, 0>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmNN_DDs )
 {
-	test_gemm_nn<float>();
+	test_gemm_nn<float, 0, 0, 0>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmNN_DDd_Large )
+{
+	test_gemm_nn<double, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmNN_DDs_Large )
+{
+	test_gemm_nn<float, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmNN_DDd_Static )
+{
+	test_gemm_nn<double, 4, 5, 6>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmNN_DDs_Static )
+{
+	test_gemm_nn<float, 4, 5, 6>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmNT_DDd )
 {
-	test_gemm_nt<double>();
+	test_gemm_nt<double, 0, 0, 0>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmNT_DDs )
 {
-	test_gemm_nt<float>();
+	test_gemm_nt<float, 0, 0, 0>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmNT_DDd_Large )
+{
+	test_gemm_nt<double, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmNT_DDs_Large )
+{
+	test_gemm_nt<float, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmNT_DDd_Static )
+{
+	test_gemm_nt<double, 4, 5, 6>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmNT_DDs_Static )
+{
+	test_gemm_nt<float, 4, 5, 6>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmTN_DDd )
 {
-	test_gemm_tn<double>();
+	test_gemm_tn<double, 0, 0, 0>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmTN_DDs )
 {
-	test_gemm_tn<float>();
+	test_gemm_tn<float, 0, 0, 0>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmTN_DDd_Large )
+{
+	test_gemm_tn<double, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmTN_DDs_Large )
+{
+	test_gemm_tn<float, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmTN_DDd_Static )
+{
+	test_gemm_tn<double, 4, 5, 6>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmTN_DDs_Static )
+{
+	test_gemm_tn<float, 4, 5, 6>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmTT_DDd )
 {
-	test_gemm_tt<double>();
+	test_gemm_tt<double, 0, 0, 0>(4, 5, 6);
 }
 
 TEST( MatrixBlasL3, GemmTT_DDs )
 {
-	test_gemm_tt<float>();
+	test_gemm_tt<float, 0, 0, 0>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmTT_DDd_Large )
+{
+	test_gemm_tt<double, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmTT_DDs_Large )
+{
+	test_gemm_tt<float, 0, 0, 0>(12, 10, 9);
+}
+
+TEST( MatrixBlasL3, GemmTT_DDd_Static )
+{
+	test_gemm_tt<double, 4, 5, 6>(4, 5, 6);
+}
+
+TEST( MatrixBlasL3, GemmTT_DDs_Static )
+{
+	test_gemm_tt<float, 4, 5, 6>(4, 5, 6);
 }
 
 
@@ -266,4 +330,57 @@ TEST( MatrixBlasL3, SymmR_DDs )
 }
 
 
+/************************************************
+ *
+ *  SYRK
+ *
+ ************************************************/
+
+template<typename T>
+void test_syrk(const char uplo)
+{
+	const index_t n = 5;
+	const index_t k = 6;
+
+	T alpha = T(1.5);
+	T beta = T(0.5);
+
+	dense_matrix<T> a(n, k);
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(2 * i - 10);
+
+	dense_matrix<T> at(k, n);
+	for (index_t j = 0; j < k; ++j)
+		for (index_t i = 0; i < n; ++i) at(j, i) = a(i, j);
+
+	dense_matrix<T> c0(n, n);
+	for (index_t i = 0; i < c0.nelems(); ++i) c0[i] = T(i + 2);
+
+	dense_matrix<T> r(c0);
+	my_mm(alpha, a, at, beta, r);
+
+	// only the uplo triangle is updated
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < n; ++i)
+			if (uplo == 'U' ? i > j : i < j) r(i, j) = c0(i, j);
+
+	dense_matrix<T> c(c0);
+	blas::syrk_n(alpha, a, beta, c, uplo);
+	ASSERT_TRUE( is_equal(c, r) );
+
+	c = c0;
+	blas::syrk_t(alpha, at, beta, c, uplo);
+	ASSERT_TRUE( is_equal(c, r) );
+}
+
+TEST( MatrixBlasL3, Syrk_DDd )
+{
+	test_syrk<double>('L');
+	test_syrk<double>('U');
+}
+
+TEST( MatrixBlasL3, Syrk_DDs )
+{
+	test_syrk<float>('L');
+	test_syrk<float>('U');
+}
 
@@ -0,0 +1,139 @@
+/**
+ * @file test_blas_backend.cpp
+ *
+ * Unit testing of the BLAS backend selection and profiling
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/linalg.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace bcs;
+
+
+static int custom_dgemm_calls = 0;
+
+static void custom_dgemm(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+		const double *alpha, const double *a, const int *lda, const double *b, const int *ldb,
+		const double *beta, double *c, const int *ldc)
+{
+	++ custom_dgemm_calls;
+	engine::native::dgemm(transa, transb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+template<typename T>
+static void fill_mat(dense_matrix<T>& a, const int s)
+{
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T((i * 7 + s) % 13) - T(6);
+}
+
+
+TEST( BlasBackend, Select )
+{
+	const engine::blas_backend *b0 = &engine::get_blas_backend();
+
+	ASSERT_TRUE( engine::find_blas_backend("native") == &engine::native_blas_backend() );
+	ASSERT_TRUE( engine::find_blas_backend("none") == BCS_NULL );
+
+	dense_matrix<double> a(20, 30), b(30, 25), c0(20, 25), c1(20, 25);
+	fill_mat(a, 1);
+	fill_mat(b, 2);
+
+	blas::gemm_nn(1.0, a, b, 0.0, c0);
+
+	engine::set_blas_backend(&engine::native_blas_backend());
+	ASSERT_STREQ( "native", engine::get_blas_backend().name );
+
+	blas::gemm_nn(1.0, a, b, 0.0, c1);
+	for (index_t i = 0; i < c0.nelems(); ++i) ASSERT_EQ( c0[i], c1[i] );
+
+	// a custom table, in which only dgemm is replaced
+
+	engine::blas_backend custom = engine::native_blas_backend();
+	custom.name = "custom";
+	custom.dgemm = custom_dgemm;
+
+	engine::set_blas_backend(&custom);
+	custom_dgemm_calls = 0;
+
+	blas::gemm_nn(1.0, a, b, 0.0, c1);
+	ASSERT_EQ( 1, custom_dgemm_calls );
+	for (index_t i = 0; i < c0.nelems(); ++i) ASSERT_EQ( c0[i], c1[i] );
+
+	// small products do not reach the backend
+	dense_matrix<double> s(3, 3), r(3, 3);
+	fill_mat(s, 3);
+	blas::gemm_nn(1.0, s, s, 0.0, r);
+	ASSERT_EQ( 1, custom_dgemm_calls );
+
+	engine::set_blas_backend(BCS_NULL);
+	ASSERT_TRUE( &engine::get_blas_backend() == b0 );
+}
+
+
+TEST( BlasBackend, Profile )
+{
+	engine::reset_blas_profile();
+	engine::enable_blas_profiling();
+	ASSERT_TRUE( engine::blas_profiling_enabled() );
+
+	dense_matrix<double> a(20, 30), b(30, 40), c(20, 40);
+	fill_mat(a, 1);
+	fill_mat(b, 2);
+
+	blas::gemm_nn(1.0, a, b, 0.0, c);
+	blas::gemm_nn(1.0, a, b, 1.0, c);
+
+	dense_matrix<double> s(3, 3), r(3, 3);
+	fill_mat(s, 3);
+	blas::gemm_nn(1.0, s, s, 0.0, r);
+
+	dense_matrix<float> x(100, 1), y(100, 1);
+	fill_mat(x, 4);
+	fill_mat(y, 5);
+	blas::dot(x, y);
+
+	engine::blas_stats g = engine::get_blas_stats<double>(engine::BLAS_GEMM);
+	ASSERT_EQ( 2, g.calls );
+	ASSERT_EQ( 1, g.small_calls );
+	ASSERT_EQ( 2 * 2 * 20 * 30 * 40, g.flops );
+	ASSERT_EQ( 2 * (30 * (20 + 40) + 2 * 20 * 40) * 8, g.bytes );
+	ASSERT_TRUE( g.secs >= 0.0 );
+
+	engine::blas_stats d = engine::get_blas_stats<float>(engine::BLAS_DOT);
+	ASSERT_EQ( 1, d.calls );
+	ASSERT_EQ( 200, d.flops );
+	ASSERT_EQ( 200 * 4, d.bytes );
+
+	ASSERT_EQ( 0, (engine::get_blas_stats<float>(engine::BLAS_GEMM).calls) );
+
+	// dump
+
+	std::FILE *fp = std::tmpfile();
+	ASSERT_TRUE( fp != BCS_NULL );
+	engine::dump_blas_profile(fp);
+
+	char buf[4096];
+	std::rewind(fp);
+	const size_t len = std::fread(buf, 1, sizeof(buf) - 1, fp);
+	buf[len] = '\0';
+	std::fclose(fp);
+
+	ASSERT_TRUE( std::strstr(buf, "dgemm") != BCS_NULL );
+	ASSERT_TRUE( std::strstr(buf, "sdot") != BCS_NULL );
+	ASSERT_TRUE( std::strstr(buf, "sgemm") == BCS_NULL );
+
+	// disabled: the counters are kept, but no longer updated
+
+	engine::enable_blas_profiling(false);
+	blas::gemm_nn(1.0, a, b, 0.0, c);
+	ASSERT_EQ( 2, (engine::get_blas_stats<double>(engine::BLAS_GEMM).calls) );
+
+	engine::reset_blas_profile();
+	ASSERT_EQ( 0, (engine::get_blas_stats<double>(engine::BLAS_GEMM).calls) );
+}
+
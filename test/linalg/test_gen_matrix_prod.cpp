@@ -342,3 +342,324 @@ TEST( GeneralMatrixProd, TMatTMat_DDs )
 
 
 
+
+
+template<typename T>
+void test_ge_fused(const index_t m, const index_t n, const index_t k)
+{
+	dense_matrix<T> a(m, k);
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i % 7) - T(3);
+
+	dense_matrix<T> b(k, n);
+	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(i % 5) - T(2);
+
+	dense_matrix<T> c(m, n);
+	for (index_t i = 0; i < c.nelems(); ++i) c[i] = T(i % 3);
+
+	dense_matrix<T> p(m, n, T(0));
+	my_mm(T(1), a, b, T(0), p);
+
+	dense_matrix<T> r0(m, n);
+
+	// A * B + C
+
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = p[i] + c[i];
+
+	dense_matrix<T> r = mm(a, b) + c;
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	r = c + mm(a, b);
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// alpha * A * B - beta * C
+
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = T(2) * p[i] - T(3) * c[i];
+
+	r = T(2) * mm(a, b) - c * T(3);
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// C - A * B, -C + A * B
+
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = c[i] - p[i];
+
+	r = c - mm(a, b);
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	r = -c - mm(a, b) * T(-1);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = -r0[i];
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// A * B - A * B
+
+	r = mm(a, b) - mm(a, b);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = T(0);
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// in-place updates of C
+
+	dense_matrix<T> d(c);
+	d = d - mm(a, b);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = c[i] - p[i];
+	ASSERT_TRUE( is_equal(d, r0) );
+
+	d -= mm(a, b) * T(-1);
+	ASSERT_TRUE( is_equal(d, c) );
+
+	d += mm(a, b);
+	d = mm(a, b) * T(-1) + d;
+	ASSERT_TRUE( is_equal(d, c) );
+}
+
+template<typename T>
+void test_ge_fused_aliased(const index_t n)
+{
+	dense_matrix<T> a(n, n);
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T(i % 7) - T(3);
+
+	dense_matrix<T> b(n, n);
+	for (index_t i = 0; i < b.nelems(); ++i) b[i] = T(i % 5) - T(2);
+
+	dense_matrix<T> c(n, n);
+	for (index_t i = 0; i < c.nelems(); ++i) c[i] = T(i % 3) + T(1);
+
+	dense_matrix<T> d0(n, n);
+	for (index_t i = 0; i < d0.nelems(); ++i) d0[i] = T(i % 4) - T(1);
+
+	dense_matrix<T> p(n, n, T(0));
+	dense_matrix<T> r0(n, n);
+
+	// D = D * B + C
+
+	my_mm(T(1), d0, b, T(0), p);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = p[i] + c[i];
+
+	dense_matrix<T> d(d0);
+	d = mm(d, b) + c;
+	ASSERT_TRUE( is_equal(d, r0) );
+
+	// D = A * D - C
+
+	fill(p, T(0));
+	my_mm(T(1), a, d0, T(0), p);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = p[i] - c[i];
+
+	d = d0;
+	d = mm(a, d) - c;
+	ASSERT_TRUE( is_equal(d, r0) );
+
+	// D = D * D + D
+
+	fill(p, T(0));
+	my_mm(T(1), d0, d0, T(0), p);
+	for (index_t i = 0; i < r0.nelems(); ++i) r0[i] = p[i] + d0[i];
+
+	d = d0;
+	d = mm(d, d) + d;
+	ASSERT_TRUE( is_equal(d, r0) );
+}
+
+TEST( GeneralMatrixProd, Fused_DDd )
+{
+	test_ge_fused<double>(4, 5, 6);
+}
+
+TEST( GeneralMatrixProd, Fused_DDs )
+{
+	test_ge_fused<float>(4, 5, 6);
+}
+
+TEST( GeneralMatrixProd, FusedAliased_DDd )
+{
+	test_ge_fused_aliased<double>(4);
+	test_ge_fused_aliased<double>(37);
+}
+
+TEST( GeneralMatrixProd, FusedAliased_DDs )
+{
+	test_ge_fused_aliased<float>(4);
+	test_ge_fused_aliased<float>(37);
+}
+
+TEST( GeneralMatrixProd, FusedSingleCall )
+{
+	const index_t m = 40, n = 30, k = 50;
+
+	dense_matrix<double> a(m, k, 1.0), b(k, n, 2.0), c(m, n, 3.0);
+	dense_col<double> x(k, 1.0), y(m, 2.0);
+
+	engine::reset_blas_profile();
+	engine::enable_blas_profiling();
+
+	c = mm(a, b) * 0.5 - c;
+	y = y + mm(a, x);
+
+	engine::enable_blas_profiling(false);
+
+	for (index_t i = 0; i < c.nelems(); ++i) ASSERT_EQ( 47.0, c[i] );
+	for (index_t i = 0; i < y.nelems(); ++i) ASSERT_EQ( 52.0, y[i] );
+
+	engine::blas_stats g = engine::get_blas_stats<double>(engine::BLAS_GEMM);
+	engine::blas_stats v = engine::get_blas_stats<double>(engine::BLAS_GEMV);
+	ASSERT_EQ( 1, g.calls + g.small_calls );
+	ASSERT_EQ( 1, v.calls + v.small_calls );
+
+	engine::reset_blas_profile();
+}
+
+
+TEST( GeneralMatrixProd, NonDenseOperands )
+{
+	const index_t m = 40, n = 30, k = 50;
+
+	dense_matrix<double> a(m, k), b(m, k), c(k, n);
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = double(i % 7) - 3.0;
+	for (index_t i = 0; i < b.nelems(); ++i) b[i] = double(i % 4) - 1.0;
+	for (index_t i = 0; i < c.nelems(); ++i) c[i] = double(i % 5) - 2.0;
+
+	dense_col<double> v(k);
+	for (index_t i = 0; i < k; ++i) v[i] = double(i % 3) - 1.0;
+
+	dense_matrix<double> ab(m, k);
+	for (index_t i = 0; i < ab.nelems(); ++i) ab[i] = a[i] + b[i];
+	dense_matrix<double> vr(k, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < k; ++i) vr(i, j) = v[i];
+	dense_matrix<double> abt = ab.trans();
+
+	dense_matrix<double> r0(m, n, 0.0), r1(m, n, 0.0), r2(k, k, 0.0);
+	my_mm(1.0, ab, c, 0.0, r0);
+	my_mm(1.0, ab, vr, 0.0, r1);
+	my_mm(1.0, abt, ab, 0.0, r2);
+
+	// with the native backend, the non-dense operands are packed directly
+
+	engine::set_blas_backend(&engine::native_blas_backend());
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+		{
+			set_num_threads(4);
+			set_parallel_grain(1);
+		}
+
+		dense_matrix<double> r = mm(a + b, c);
+		ASSERT_TRUE( is_equal(r, r0) );
+
+		r = mm(a + b, repeat_cols(v, n));
+		ASSERT_TRUE( is_equal(r, r1) );
+
+		typedef binary_ewise_expr<binary_plus<double>, dense_matrix<double>, dense_matrix<double> > sum_t;
+		dense_matrix<double> s = mm(transpose_expr<sum_t>(a + b), a + b);
+		ASSERT_TRUE( is_equal(s, r2) );
+	}
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+	engine::set_blas_backend(BCS_NULL);
+
+	// the default backend captures them
+
+	dense_matrix<double> r = mm(a + b, c);
+	ASSERT_TRUE( is_equal(r, r0) );
+}
+
+
+TEST( GeneralMatrixProd, NonDenseOperandsAliased )
+{
+	const index_t n = 64;
+
+	dense_matrix<double> d0(n, n), e(n, n), b(n, n);
+	for (index_t i = 0; i < d0.nelems(); ++i) d0[i] = double(i % 7) - 3.0;
+	for (index_t i = 0; i < e.nelems(); ++i) e[i] = double(i % 4) - 1.0;
+	for (index_t i = 0; i < b.nelems(); ++i) b[i] = double(i % 5) - 2.0;
+
+	dense_matrix<double> de(n, n);
+	for (index_t i = 0; i < de.nelems(); ++i) de[i] = d0[i] + e[i];
+
+	dense_matrix<double> r0(n, n, 0.0), r1(d0);
+	my_mm(1.0, de, b, 0.0, r0);
+	my_mm(1.0, de, b, 1.0, r1);
+
+	// the destination is read (through a non-dense operand) by the product
+
+	engine::set_blas_backend(&engine::native_blas_backend());
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+		{
+			set_num_threads(4);
+			set_parallel_grain(1);
+		}
+
+		dense_matrix<double> d(d0);
+		d = mm(d + e, b);
+		ASSERT_TRUE( is_equal(d, r0) );
+
+		d = d0;
+		d += mm(d + e, b);
+		ASSERT_TRUE( is_equal(d, r1) );
+	}
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+	engine::set_blas_backend(BCS_NULL);
+
+	dense_matrix<double> d(d0);
+	d = mm(d + e, b);
+	ASSERT_TRUE( is_equal(d, r0) );
+}
+
+
+TEST( GeneralMatrixProd, StridedVectors )
+{
+	const index_t m = 12, n = 9;
+
+	dense_matrix<double> a(m, n), x(5, m), z(n, 4);
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = double(i % 7) - 3.0;
+	for (index_t i = 0; i < x.nelems(); ++i) x[i] = double(i % 5) - 2.0;
+	for (index_t i = 0; i < z.nelems(); ++i) z[i] = double(i % 3) - 1.0;
+
+	dense_col<double> xr(m), zr(n);
+	for (index_t i = 0; i < m; ++i) xr[i] = x(2, i);
+	for (index_t i = 0; i < n; ++i) zr[i] = z(i, 1);
+
+	dense_col<double> y0(n, 0.0), u0(m, 0.0);
+	dense_matrix<double> at = a.trans();
+	my_mv(1.0, at, xr, 0.0, y0);
+	my_mv(1.0, a, zr, 0.0, u0);
+
+	// a row of a matrix on the left
+
+	dense_row<double> y = mm(x.row(2), a);
+	for (index_t i = 0; i < n; ++i) ASSERT_EQ( y0[i], y[i] );
+
+	// the transpose of a row of a matrix on the right (a strided column)
+
+	dense_col<double> w = mm(a.trans(), x.row(2).trans());
+	ASSERT_TRUE( is_equal(w, y0) );
+
+	dense_col<double> u = mm(a, z.column(1).trans().trans());
+	ASSERT_TRUE( is_equal(u, u0) );
+
+	dense_matrix<double> zt = z.trans();
+	u = mm(a, zt.row(1).trans());
+	ASSERT_TRUE( is_equal(u, u0) );
+
+	u += mm(a, zt.row(1).trans());
+	for (index_t i = 0; i < m; ++i) u0[i] *= 2.0;
+	ASSERT_TRUE( is_equal(u, u0) );
+
+	// symmetric matrix times a strided column
+
+	dense_matrix<double> s(n, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < n; ++i) s(i, j) = double((i + j) % 5) - 2.0;
+
+	dense_col<double> v0(n, 0.0);
+	my_mv(1.0, s, zr, 0.0, v0);
+
+	dense_col<double> v = mm(as_sym(s), zt.row(1).trans());
+	ASSERT_TRUE( is_equal(v, v0) );
+}
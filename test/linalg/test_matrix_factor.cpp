@@ -0,0 +1,104 @@
+/**
+ * @file test_matrix_factor.cpp
+ *
+ * Unit testing of the factorizations of small fixed-size matrices
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/linalg.h>
+
+#include <cmath>
+
+using namespace bcs;
+
+
+template<typename T, int M, int N>
+bool is_approx(const dense_matrix<T, M, N>& a, const dense_matrix<T, M, N>& b, const T tol)
+{
+	for (index_t i = 0; i < a.nelems(); ++i)
+	{
+		if (!(std::fabs(a[i] - b[i]) <= tol)) return false;
+	}
+	return true;
+}
+
+template<typename T, int M, int N, int K>
+dense_matrix<T, M, N> naive_mm(const dense_matrix<T, M, K>& a, const dense_matrix<T, K, N>& b)
+{
+	dense_matrix<T, M, N> c;
+	for (int j = 0; j < N; ++j)
+	{
+		for (int i = 0; i < M; ++i)
+		{
+			T s(0);
+			for (int u = 0; u < K; ++u) s += a(i, u) * b(u, j);
+			c(i, j) = s;
+		}
+	}
+	return c;
+}
+
+
+TEST( MatrixFactor, Chol )
+{
+	dense_matrix<double, 3, 3> a;
+	const double va[9] = {4, 2, -2,  2, 10, 2,  -2, 2, 6};
+	for (int i = 0; i < 9; ++i) a[i] = va[i];
+
+	dense_matrix<double, 3, 3> l;
+	ASSERT_TRUE( chol(a, l) );
+
+	ASSERT_EQ( 0.0, l(0, 1) );
+	ASSERT_EQ( 0.0, l(0, 2) );
+	ASSERT_EQ( 0.0, l(1, 2) );
+
+	dense_matrix<double, 3, 3> lt;
+	for (int j = 0; j < 3; ++j)
+		for (int i = 0; i < 3; ++i) lt(i, j) = l(j, i);
+
+	ASSERT_TRUE( is_approx(naive_mm(l, lt), a, 1.0e-12) );
+
+	dense_matrix<double, 3, 2> b, x;
+	for (int i = 0; i < 6; ++i) b[i] = double(i + 1);
+
+	ASSERT_TRUE( chol_solve(a, b, x) );
+	ASSERT_TRUE( is_approx(naive_mm(a, x), b, 1.0e-12) );
+
+	a(0, 0) = -1.0;
+	ASSERT_FALSE( chol(a, l) );
+	ASSERT_FALSE( chol_solve(a, b, x) );
+}
+
+TEST( MatrixFactor, LU )
+{
+	dense_matrix<float, 4, 4> a;
+	for (int j = 0; j < 4; ++j)
+		for (int i = 0; i < 4; ++i) a(i, j) = float(i == 3 - j ? 5 : (i + 2 * j) % 3);
+
+	dense_matrix<float, 4, 4> f;
+	int ipiv[4];
+	ASSERT_TRUE( lu(a, f, ipiv) );
+
+	dense_matrix<float, 4, 1> b, x;
+	for (int i = 0; i < 4; ++i) b[i] = float(i) - 1.5f;
+
+	ASSERT_TRUE( lu_solve(a, b, x) );
+	ASSERT_TRUE( is_approx(naive_mm(a, x), b, 1.0e-5f) );
+
+	dense_matrix<float, 4, 4> r;
+	ASSERT_TRUE( inv(a, r) );
+
+	dense_matrix<float, 4, 4> e;
+	for (int j = 0; j < 4; ++j)
+		for (int i = 0; i < 4; ++i) e(i, j) = float(i == j);
+
+	ASSERT_TRUE( is_approx(naive_mm(a, r), e, 1.0e-5f) );
+
+	for (int i = 0; i < 4; ++i) a(i, 1) = 2 * a(i, 0);
+	ASSERT_FALSE( lu(a, f, ipiv) );
+	ASSERT_FALSE( lu_solve(a, b, x) );
+	ASSERT_FALSE( inv(a, r) );
+}
+
@@ -0,0 +1,167 @@
+/**
+ * @file test_matrix_gram.cpp
+ *
+ * Unit testing of Gram matrices and pairwise squared distances
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/linalg.h>
+
+using namespace bcs;
+
+
+// small integers, such that all results are exact
+
+template<typename T>
+void gram_fill(dense_matrix<T>& a, const int s)
+{
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T((i * 7 + s) % 9) - T(4);
+}
+
+template<typename T>
+T naive_dot_cols(const dense_matrix<T>& x, const index_t i, const dense_matrix<T>& y, const index_t j)
+{
+	T s(0);
+	for (index_t u = 0; u < x.nrows(); ++u) s += x(u, i) * y(u, j);
+	return s;
+}
+
+template<typename T>
+T naive_sqdist_cols(const dense_matrix<T>& x, const index_t i, const dense_matrix<T>& y, const index_t j)
+{
+	T s(0);
+	for (index_t u = 0; u < x.nrows(); ++u)
+	{
+		const T v = x(u, i) - y(u, j);
+		s += v * v;
+	}
+	return s;
+}
+
+
+template<typename T>
+void test_gram(const index_t d, const index_t n)
+{
+	dense_matrix<T> x(d, n);
+	gram_fill(x, 1);
+
+	dense_matrix<T> g0(n, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < n; ++i) g0(i, j) = naive_dot_cols(x, i, x, j);
+
+	dense_matrix<T> g = gram(x);
+	ASSERT_EQ( n, g.nrows() );
+	ASSERT_EQ( n, g.ncolumns() );
+	ASSERT_TRUE( is_equal(g, g0) );
+}
+
+TEST( MatrixGram, Gram_d )
+{
+	test_gram<double>(3, 4);
+	test_gram<double>(20, 70);
+}
+
+TEST( MatrixGram, Gram_s )
+{
+	test_gram<float>(20, 70);
+}
+
+
+template<typename T>
+void test_pairwise_sqdist(const index_t d, const index_t m, const index_t n)
+{
+	dense_matrix<T> x(d, m), y(d, n);
+	gram_fill(x, 1);
+	gram_fill(y, 2);
+
+	dense_matrix<T> r0(m, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) r0(i, j) = naive_sqdist_cols(x, i, y, j);
+
+	dense_matrix<T> r = pairwise_sqdist(x, y);
+	ASSERT_EQ( m, r.nrows() );
+	ASSERT_EQ( n, r.ncolumns() );
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// to a sub-view
+
+	dense_matrix<T> big(m + 3, n, T(-1));
+	ref_matrix_ex<T> rs(big.ptr_data() + 1, m, n, m + 3);
+	pairwise_sqdist(x, y, rs);
+	ASSERT_TRUE( is_equal(rs, r0) );
+	for (index_t j = 0; j < n; ++j)
+	{
+		ASSERT_EQ( T(-1), big(0, j) );
+		ASSERT_EQ( T(-1), big(m + 1, j) );
+	}
+
+	// symmetric
+
+	dense_matrix<T> s0(m, m);
+	for (index_t j = 0; j < m; ++j)
+		for (index_t i = 0; i < m; ++i) s0(i, j) = naive_sqdist_cols(x, i, x, j);
+
+	dense_matrix<T> s = pairwise_sqdist(x);
+	ASSERT_TRUE( is_equal(s, s0) );
+}
+
+TEST( MatrixGram, PairwiseSqDist_d )
+{
+	test_pairwise_sqdist<double>(3, 5, 4);
+	test_pairwise_sqdist<double>(16, 300, 270);	// multiple tiles
+}
+
+TEST( MatrixGram, PairwiseSqDist_s )
+{
+	test_pairwise_sqdist<float>(16, 70, 50);
+}
+
+
+struct sqdist_tile_collector
+{
+	dense_matrix<double> *dst;
+	int *ntiles;
+
+	void operator() (const index_t i0, const index_t j0, const ref_matrix_ex<double>& t) const
+	{
+		for (index_t j = 0; j < t.ncolumns(); ++j)
+			for (index_t i = 0; i < t.nrows(); ++i) (*dst)(i0 + i, j0 + j) = t(i, j);
+		++ (*ntiles);
+	}
+};
+
+TEST( MatrixGram, PairwiseSqDistTiles )
+{
+	const index_t d = 8, m = 23, n = 17;
+
+	dense_matrix<double> x(d, m), y(d, n);
+	gram_fill(x, 3);
+	gram_fill(y, 4);
+
+	dense_matrix<double> r0 = pairwise_sqdist(x, y);
+
+	dense_matrix<double> r(m, n, -1.0);
+	int ntiles = 0;
+
+	sqdist_tile_collector f;
+	f.dst = &r;
+	f.ntiles = &ntiles;
+
+	pairwise_sqdist_tiles(x, y, 10, 6, f);
+
+	ASSERT_EQ( 3 * 3, ntiles );
+	ASSERT_TRUE( is_equal(r, r0) );
+}
+
+TEST( MatrixGram, NativeBackend )
+{
+	engine::set_blas_backend(&engine::native_blas_backend());
+
+	test_gram<double>(20, 70);
+	test_pairwise_sqdist<double>(16, 300, 270);
+	test_pairwise_sqdist<float>(16, 70, 50);
+
+	engine::set_blas_backend(BCS_NULL);
+}
@@ -0,0 +1,198 @@
+/**
+ * @file test_mm_chain.cpp
+ *
+ * Unit testing of the evaluation of matrix product chains
+ *
+ * @author Dahua Lin
+ */
+
+#include <gtest/gtest.h>
+#include <bcslib/linalg.h>
+
+#include "test_blas_aux.h"
+
+using namespace bcs;
+
+
+// small integers, so that the results do not depend on the order of evaluation
+
+template<typename T, class Mat>
+void fill_ints(IDenseMatrix<Mat, T>& a, const int s)
+{
+	for (index_t j = 0; j < a.ncolumns(); ++j)
+		for (index_t i = 0; i < a.nrows(); ++i)
+			a(i, j) = T((i * 3 + j * 7 + s) % 5) - T(2);
+}
+
+template<typename T, class MatA, class MatB>
+dense_matrix<T> naive_mm(const IDenseMatrix<MatA, T>& a, const IDenseMatrix<MatB, T>& b)
+{
+	dense_matrix<T> c(a.nrows(), b.ncolumns(), T(0));
+	dense_matrix<T> bc(b);
+	my_mm(T(1), a, bc, T(0), c);
+	return c;
+}
+
+static long gemm_calls()
+{
+	engine::blas_stats s = engine::get_blas_stats<double>(engine::BLAS_GEMM);
+	return s.calls + s.small_calls;
+}
+
+static long gemv_calls()
+{
+	engine::blas_stats s = engine::get_blas_stats<double>(engine::BLAS_GEMV);
+	return s.calls + s.small_calls;
+}
+
+
+TEST( MMChain, MatMatCol )
+{
+	const index_t m = 60, k = 50, n = 40;
+
+	dense_matrix<double> a(m, k), b(k, n);
+	dense_col<double> v(n);
+	fill_ints(a, 1);
+	fill_ints(b, 2);
+	fill_ints(v, 3);
+
+	dense_matrix<double> r0 = naive_mm(naive_mm(a, b), v);
+
+	engine::reset_blas_profile();
+	engine::enable_blas_profiling();
+
+	dense_col<double> r = mm(mm(a, b), v);
+
+	engine::enable_blas_profiling(false);
+
+	ASSERT_EQ( m, r.nrows() );
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// A * (B * v): two matrix-vector products
+	ASSERT_EQ( 0, gemm_calls() );
+	ASSERT_EQ( 2, gemv_calls() );
+
+	// with accumulation and scaling
+
+	dense_col<double> y(m);
+	fill_ints(y, 4);
+	dense_col<double> y0(y);
+	for (index_t i = 0; i < m; ++i) y0[i] += 6.0 * r0[i];
+
+	y += mm(mm(a, b) * 2.0, v) * 3.0;
+	ASSERT_TRUE( is_equal(y, y0) );
+
+	engine::reset_blas_profile();
+}
+
+TEST( MMChain, RowMatMat )
+{
+	const index_t m = 30, n = 45;
+
+	dense_row<double> x(m);
+	dense_matrix<double> a(m, n), b(n, m);
+	fill_ints(x, 1);
+	fill_ints(a, 2);
+	fill_ints(b, 3);
+
+	dense_matrix<double> r0 = naive_mm(naive_mm(x, a), b);
+
+	engine::reset_blas_profile();
+	engine::enable_blas_profiling();
+
+	dense_row<double> r = mm(x, mm(a, b));
+
+	engine::enable_blas_profiling(false);
+
+	ASSERT_TRUE( is_equal(r, r0) );
+	ASSERT_EQ( 0, gemm_calls() );
+	ASSERT_EQ( 2, gemv_calls() );
+
+	engine::reset_blas_profile();
+}
+
+TEST( MMChain, Quadratic )
+{
+	const index_t m = 20, n = 25;
+
+	dense_row<double> x(m);
+	dense_matrix<double> a(m, n);
+	dense_col<double> y(n);
+	fill_ints(x, 1);
+	fill_ints(a, 2);
+	fill_ints(y, 3);
+
+	dense_matrix<double> r0 = naive_mm(naive_mm(x, a), y);
+	dense_matrix<double> r = mm(mm(x, a), y);
+
+	ASSERT_EQ( 1, r.nrows() );
+	ASSERT_EQ( 1, r.ncolumns() );
+	ASSERT_EQ( r0(0, 0), r(0, 0) );
+}
+
+TEST( MMChain, FourFactors )
+{
+	// A' * B * C * D with unbalanced shapes
+
+	dense_matrix<double> a(70, 8), b(70, 60), c(60, 3), d(3, 50);
+	fill_ints(a, 1);
+	fill_ints(b, 2);
+	fill_ints(c, 3);
+	fill_ints(d, 4);
+
+	dense_matrix<double> at = a.trans();
+	dense_matrix<double> r0 = naive_mm(naive_mm(naive_mm(at, b), c), d);
+
+	dense_matrix<double> r1 = mm(mm(mm(a.trans(), b), c), d);
+	ASSERT_TRUE( is_equal(r1, r0) );
+
+	dense_matrix<double> r2 = mm(mm(a.trans(), b), mm(c, d) * 0.5) * 2.0;
+	ASSERT_TRUE( is_equal(r2, r0) );
+
+	dense_matrix<double> r3 = mm(a.trans(), mm(b, mm(c, d)));
+	ASSERT_TRUE( is_equal(r3, r0) );
+}
+
+TEST( MMChain, SymAndTrans )
+{
+	// the reordering may bring a symmetric factor next to a transposed one
+
+	const index_t n = 40;
+
+	dense_matrix<double> s(n, n), t(n, n), b(3, n);
+	dense_col<double> v(n);
+	fill_ints(b, 1);
+	fill_ints(v, 2);
+	fill_ints(t, 3);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < n; ++i) s(i, j) = double((i + j) % 7) - 3.0;
+
+	dense_matrix<double> bt = b.trans();
+	dense_matrix<double> u = naive_mm(b, v);
+	dense_matrix<double> r0 = naive_mm(s, naive_mm(bt, u));
+	dense_matrix<double> r1 = mm(as_sym(s), mm(b.trans(), mm(b, v)));
+	ASSERT_TRUE( is_equal(r1, r0) );
+
+	dense_matrix<double> st = naive_mm(s, s);
+	dense_matrix<double> r2 = mm(as_sym(s), mm(as_sym(s), t));
+	ASSERT_TRUE( is_equal(r2, naive_mm(st, t)) );
+
+	dense_matrix<double> r3 = mm(mm(t.trans(), as_sym(s)), v);
+	dense_matrix<double> tt = t.trans();
+	ASSERT_TRUE( is_equal(r3, naive_mm(naive_mm(tt, s), v)) );
+}
+
+TEST( MMChain, FixedSize )
+{
+	dense_matrix<float, 4, 6> a;
+	dense_matrix<float, 6, 5> b;
+	dense_matrix<float, 5, 2> c;
+	fill_ints(a, 1);
+	fill_ints(b, 2);
+	fill_ints(c, 3);
+
+	dense_matrix<float> r0 = naive_mm(naive_mm(a, b), c);
+	dense_matrix<float, 4, 2> r = mm(a, mm(b, c));
+
+	ASSERT_TRUE( is_equal(r, r0) );
+}
@@ -8,15 +8,22 @@
 
 #include <gtest/gtest.h>
 #include <bcslib/matrix.h>
+#include <bcslib/utils/monitored_allocator.h>
+
+#include <utility>
+#include <vector>
 
 using namespace bcs;
 
+bcs::memory_allocation_monitor bcs::global_memory_allocation_monitor;
+
 // explicit template for syntax check
 
 template class bcs::dense_matrix<double, DynamicDim, DynamicDim>;
 template class bcs::dense_matrix<double, DynamicDim, 1>;
 template class bcs::dense_matrix<double, 1, DynamicDim>;
 template class bcs::dense_matrix<double, 2, 2>;
+template class bcs::dense_matrix<double, DynamicDim, DynamicDim, scratch_allocator<double> >;
 
 template class bcs::dense_col<double, DynamicDim>;
 template class bcs::dense_col<double, 3>;
@@ -453,8 +460,166 @@ TEST( DenseVector, SRowVec )
 }
 
 
+TEST( DenseMatrix, ScratchMatrix )
+{
+	scratch_arena& arena = scratch_arena::local();
+	const size_t nlive0 = arena.num_live();
+	const size_t used0 = arena.used_bytes();
+
+	const index_t m = 5;
+	const index_t n = 6;
+
+	dense_matrix<double> A(m, n);
+	dense_matrix<double> C(n, m);
+	for (index_t i = 0; i < m * n; ++i) A[i] = double(i + 1);
+	for (index_t i = 0; i < m * n; ++i) C[i] = double(2 * i - 7);
 
+	dense_matrix<double> R0(m, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) R0(i, j) = A(i, j) + C(j, i);
+
+	{
+		typedef dense_matrix<double, DynamicDim, DynamicDim, scratch_allocator<double> > smat_t;
 
+		smat_t S(A + C.trans());
+		ASSERT_EQ(nlive0 + 1, arena.num_live());
+		ASSERT_EQ(m, S.nrows());
+		ASSERT_EQ(n, S.ncolumns());
+		ASSERT_TRUE( is_equal(S, R0) );
 
+		dense_matrix<double> R(S);
+		ASSERT_TRUE( is_equal(R, R0) );
+
+		S.resize(n, m);
+		S = C;
+		ASSERT_TRUE( is_equal(S, C) );
+		ASSERT_EQ(nlive0 + 1, arena.num_live());
+	}
+
+	ASSERT_EQ(nlive0, arena.num_live());
+	ASSERT_EQ(used0, arena.used_bytes());
+
+	// the cache of the transposed argument is drawn from the arena
+
+	dense_matrix<double> R = A + C.trans();
+	ASSERT_TRUE( is_equal(R, R0) );
+	ASSERT_EQ(nlive0, arena.num_live());
+	ASSERT_EQ(used0, arena.used_bytes());
+	ASSERT_TRUE( arena.num_chunks() > 0 );
+}
+
+
+typedef dense_matrix<double, DynamicDim, DynamicDim, monitored_allocator<double> > mon_mat_t;
+
+static mon_mat_t make_mon_mat(index_t m, index_t n, double v, bool flip)
+{
+	mon_mat_t a(m, n, v);
+	mon_mat_t b(n, m, -v);
+	if (flip) return b;   // NRVO does not apply here
+	return a;
+}
 
+TEST( DenseMatrix, Move )
+{
+	memory_allocation_monitor& mon = global_memory_allocation_monitor;
+	const size_t np0 = mon.num_pending_sections();
+
+	{
+		mon_mat_t A(3, 4, 1.0);
+		const double *pa = A.ptr_data();
+		const size_t nr = mon.num_requests();
+
+		// move construction
+
+		mon_mat_t B(std::move(A));
+		ASSERT_EQ(3, B.nrows());
+		ASSERT_EQ(4, B.ncolumns());
+		ASSERT_TRUE( B.ptr_data() == pa );
+		ASSERT_EQ(0, A.nelems());
+		ASSERT_EQ(0, A.nrows());
+		ASSERT_EQ(0, A.ncolumns());
+
+		// move assignment
+
+		mon_mat_t C(2, 2, 0.0);
+		C = std::move(B);
+		ASSERT_EQ(3, C.nrows());
+		ASSERT_EQ(4, C.ncolumns());
+		ASSERT_TRUE( C.ptr_data() == pa );
+		ASSERT_EQ(0, B.nelems());
+		ASSERT_TRUE( elems_equal(12, C.ptr_data(), 1.0) );
+
+		ASSERT_EQ(nr + 1, mon.num_requests());
+		ASSERT_EQ(np0 + 1, mon.num_pending_sections());
+
+		// return by value
+
+		const size_t nr1 = mon.num_requests();
+		mon_mat_t D = make_mon_mat(3, 5, 2.0, true);
+		ASSERT_EQ(5, D.nrows());
+		ASSERT_EQ(3, D.ncolumns());
+		ASSERT_TRUE( elems_equal(15, D.ptr_data(), -2.0) );
+		ASSERT_EQ(nr1 + 2, mon.num_requests());
+
+		C = make_mon_mat(2, 6, 3.0, false);
+		ASSERT_EQ(2, C.nrows());
+		ASSERT_EQ(6, C.ncolumns());
+		ASSERT_TRUE( elems_equal(12, C.ptr_data(), 3.0) );
+		ASSERT_EQ(nr1 + 4, mon.num_requests());
+		ASSERT_EQ(np0 + 2, mon.num_pending_sections());
+
+		// growing a vector of matrices moves them
+
+		const size_t nr2 = mon.num_requests();
+		std::vector<mon_mat_t> vec;
+		for (int i = 0; i < 20; ++i) vec.push_back(mon_mat_t(4, 3, double(i)));
+
+		ASSERT_EQ(nr2 + 20, mon.num_requests());
+		for (int i = 0; i < 20; ++i)
+			ASSERT_TRUE( elems_equal(12, vec[(size_t)i].ptr_data(), double(i)) );
+	}
+
+	ASSERT_EQ(np0, mon.num_pending_sections());
+}
+
+TEST( DenseVector, Move )
+{
+	dense_col<double> a(5, 1.0);
+	const double *pa = a.ptr_data();
+
+	dense_col<double> b(std::move(a));
+	ASSERT_EQ(5, b.nrows());
+	ASSERT_TRUE( b.ptr_data() == pa );
+	ASSERT_EQ(0, a.nelems());
+
+	dense_col<double> c;
+	c = std::move(b);
+	ASSERT_EQ(5, c.nrows());
+	ASSERT_TRUE( c.ptr_data() == pa );
+
+	dense_matrix<double, DynamicDim, 1> cm(std::move(c));
+	ASSERT_TRUE( cm.ptr_data() == pa );
+
+	dense_col<double> c2(std::move(cm));
+	ASSERT_TRUE( c2.ptr_data() == pa );
+
+	dense_row<double> r(6, 2.0);
+	const double *pr = r.ptr_data();
+
+	dense_row<double> r2(std::move(r));
+	ASSERT_EQ(6, r2.ncolumns());
+	ASSERT_TRUE( r2.ptr_data() == pr );
+	ASSERT_EQ(0, r.nelems());
+
+	dense_row<double> r3;
+	r3 = std::move(r2);
+	ASSERT_TRUE( r3.ptr_data() == pr );
+	ASSERT_TRUE( elems_equal(6, r3.ptr_data(), 2.0) );
+
+	// fixed-size vectors are copied
+
+	dense_col<double, 3> f(3, 4.0);
+	dense_col<double, 3> f2(std::move(f));
+	ASSERT_TRUE( elems_equal(3, f2.ptr_data(), 4.0) );
+}
 
@@ -304,3 +304,60 @@ TEST( BinaryMatrixReduction, MatLinfNormDiff )
 	double v0 = 48;
 	ASSERT_EQ(v0, Linfnorm_diff(A, B));
 }
+
+
+/************************************************
+ *
+ *  Long vectors (multi-accumulator paths)
+ *
+ ************************************************/
+
+template<typename T>
+void test_long_binary_reduction(const index_t m, const index_t n)
+{
+	const index_t len = m * n;
+
+	dense_matrix<T> a(m, n);
+	dense_matrix<T> b(m, n);
+	for (index_t i = 0; i < len; ++i)
+	{
+		a[i] = T(int((i * 7) % 23) - 11);
+		b[i] = T(int((i * 5) % 13) - 6);
+	}
+
+	T sd = 0, s1 = 0, s2 = 0, mi = 0;
+	for (index_t i = 0; i < len; ++i)
+	{
+		T d = a[i] - b[i];
+		sd += a[i] * b[i];
+		s1 += math::abs(d);
+		s2 += d * d;
+		mi = std::max(mi, math::abs(d));
+	}
+
+	ASSERT_EQ( sd, dot(a, b) );
+	ASSERT_EQ( s1, L1norm_diff(a, b) );
+	ASSERT_EQ( s2, sqL2norm_diff(a, b) );
+	ASSERT_EQ( mi, Linfnorm_diff(a, b) );
+}
+
+TEST( BinaryMatrixReduction, LongVectors_d )
+{
+	const index_t lens[] = {15, 16, 17, 33, 64, 101, 1001};
+	for (int k = 0; k < 7; ++k)
+	{
+		test_long_binary_reduction<double>(lens[k], 1);
+		test_long_binary_reduction<double>(lens[k], 3);
+	}
+}
+
+TEST( BinaryMatrixReduction, LongVectors_s )
+{
+	const index_t lens[] = {15, 16, 17, 33, 64, 101, 1001};
+	for (int k = 0; k < 7; ++k)
+	{
+		test_long_binary_reduction<float>(lens[k], 1);
+		test_long_binary_reduction<float>(lens[k], 3);
+	}
+}
+
@@ -874,3 +874,131 @@ TEST( MatrixEWise2,  BinaryDenseAndGrid11 )
 
 
 
+
+
+/************************************************
+ *
+ *  Packet-based evaluation
+ *
+ ************************************************/
+
+template<typename T>
+inline T packet_test_formula(T x, T y)
+{
+	T u = std::max(std::min(T(2) * x - y, T(30)), -(x / T(4)));
+	return std::abs(u - T(3)) + T(1) / (y * y + T(1)) - (T(2) - x * x * x) / T(8);
+}
+
+template<class XMat, class YMat>
+inline void packet_test_eval(const XMat& x, const YMat& y, ref_matrix_ex<typename XMat::value_type>& r)
+{
+	typedef typename XMat::value_type T;
+	r = abs(fmax(fmin(T(2) * x - y, T(30)), -(x / T(4))) - T(3)) +
+			rcp(sqr(y) + T(1)) - (T(2) - cube(x)) / T(8);
+}
+
+template<typename T>
+void test_packet_ewise(const index_t m, const index_t n, const index_t off)
+{
+	const index_t ld = m + 5;
+
+	dense_matrix<T> x(m, n);
+	dense_matrix<T> y(m, n);
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		x[i] = T(int(i % 17) - 8) / T(2);
+		y[i] = T(int(i % 11) - 5);
+	}
+
+	dense_matrix<T> r0(m, n);
+	for (index_t i = 0; i < m * n; ++i) r0[i] = packet_test_formula(x[i], y[i]);
+
+	// continuous destination (as a single vector), possibly misaligned
+
+	scoped_block<T> blk1(m * n + off + 1, T(-1));
+	ref_matrix_ex<T> r1(blk1.ptr_begin() + off, m, n, m);
+	packet_test_eval(x, y, r1);
+
+	ASSERT_TRUE( is_equal(r1, r0) );
+	ASSERT_EQ( T(-1), blk1[off + m * n] );
+	if (off > 0)
+	{
+		ASSERT_EQ( T(-1), blk1[off - 1] );
+	}
+
+	// strided destination (by columns)
+
+	scoped_block<T> blk2(ld * n + off, T(-1));
+	ref_matrix_ex<T> r2(blk2.ptr_begin() + off, m, n, ld);
+	packet_test_eval(x, y, r2);
+
+	ASSERT_TRUE( is_equal(r2, r0) );
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = m; i < ld && off + i + j * ld < ld * n + off; ++i)
+			ASSERT_EQ( T(-1), blk2[off + i + j * ld] );
+	}
+
+	// broadcasting a column / a row
+
+	dense_col<T> c(m);
+	for (index_t i = 0; i < m; ++i) c[i] = T(i) - T(2);
+
+	dense_row<T> b(n);
+	for (index_t j = 0; j < n; ++j) b[j] = T(3 * j) + T(1);
+
+	dense_matrix<T> rc(m, n);
+	rc = x - repeat_cols(c, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) ASSERT_EQ( x(i, j) - c[i], rc(i, j) );
+
+	dense_matrix<T> rb(m, n);
+	rb = x * repeat_rows(b, m);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) ASSERT_EQ( x(i, j) * b[j], rb(i, j) );
+}
+
+#ifdef BCS_HAS_PACKET
+
+TEST( MatrixEWisePacket, Dispatch )
+{
+	typedef dense_matrix<double> mat_t;
+	typedef binary_ewise_expr<binary_plus<double>, mat_t,
+			unary_ewise_expr<times_scalar<double>, mat_t> > expr_t;
+	typedef unary_ewise_expr<unary_sqrt<double>, mat_t> sqrt_expr_t;
+
+	const bool p1 = vec_reader<expr_t>::type::has_packet_access;
+	const bool p2 = colwise_reader_bank<expr_t>::type::reader_type::has_packet_access;
+	const bool p3 = vec_reader<sqrt_expr_t>::type::has_packet_access;
+	const bool p4 = vec_reader<dense_matrix<int> >::type::has_packet_access;
+
+	ASSERT_TRUE( p1 );
+	ASSERT_TRUE( p2 );
+	ASSERT_FALSE( p3 );
+	ASSERT_FALSE( p4 );
+}
+
+#endif
+
+TEST( MatrixEWisePacket, Double )
+{
+	for (index_t off = 0; off < 4; ++off)
+	{
+		test_packet_ewise<double>(1, 1, off);
+		test_packet_ewise<double>(7, 3, off);
+		test_packet_ewise<double>(33, 5, off);
+		test_packet_ewise<double>(64, 4, off);
+	}
+}
+
+TEST( MatrixEWisePacket, Float )
+{
+	for (index_t off = 0; off < 8; ++off)
+	{
+		test_packet_ewise<float>(1, 1, off);
+		test_packet_ewise<float>(7, 3, off);
+		test_packet_ewise<float>(33, 5, off);
+		test_packet_ewise<float>(64, 4, off);
+	}
+}
+
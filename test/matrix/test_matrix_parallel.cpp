@@ -0,0 +1,245 @@
+/**
+ * @file test_matrix_parallel.cpp
+ *
+ * Unit testing of parallel evaluation of matrix expressions
+ *
+ * @author Dahua Lin
+ */
+
+
+#include <gtest/gtest.h>
+#include <bcslib/matrix.h>
+
+using namespace bcs;
+
+
+// forces parallel evaluation on moderately sized matrices
+
+struct parallel_scope
+{
+	parallel_scope(int nthreads, index_t grain)
+	{
+		set_num_threads(nthreads);
+		set_parallel_grain(grain);
+	}
+
+	~parallel_scope()
+	{
+		set_num_threads(0);
+		set_parallel_grain(0);
+	}
+};
+
+
+template<typename T>
+void par_init_mat(dense_matrix<T>& a, int p, int b)
+{
+	for (index_t i = 0; i < a.nelems(); ++i) a[i] = T((i % p) - b);
+}
+
+
+TEST( MatrixParallel, EWise )
+{
+	parallel_scope ps(4, 64);
+
+	const index_t m = 37;
+	const index_t n = 29;
+
+	dense_matrix<double> A(m, n);
+	dense_matrix<double> B(m, n);
+	par_init_mat(A, 11, 5);
+	par_init_mat(B, 7, 2);
+
+	// as a single vector
+
+	dense_matrix<double> R0(m, n);
+	for (index_t i = 0; i < m * n; ++i) R0[i] = A[i] * B[i] + A[i];
+
+	dense_matrix<double> R = A * B + A;
+	ASSERT_TRUE( is_equal(R, R0) );
+
+	dense_matrix<float> Af(m, n);
+	dense_matrix<float> Bf(m, n);
+	par_init_mat(Af, 11, 5);
+	par_init_mat(Bf, 7, 2);
+
+	dense_matrix<float> Rf0(m, n);
+	for (index_t i = 0; i < m * n; ++i) Rf0[i] = Af[i] - Bf[i];
+
+	dense_matrix<float> Rf = Af - Bf;
+	ASSERT_TRUE( is_equal(Rf, Rf0) );
+
+	// by columns (on sub-views)
+
+	ref_matrix_ex<double> Asub(A.ptr_data() + 1, m - 3, n, m);
+	ref_matrix_ex<double> Bsub(B.ptr_data() + 2, m - 3, n, m);
+
+	dense_matrix<double> S0(m - 3, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m - 3; ++i) S0(i, j) = Asub(i, j) + Bsub(i, j);
+
+	dense_matrix<double> S(m, n, 0.0);
+	ref_matrix_ex<double> Ssub(S.ptr_data() + 3, m - 3, n, m);
+	Ssub = Asub + Bsub;
+
+	dense_matrix<double> Ssub_r(Ssub);
+	ASSERT_TRUE( is_equal(Ssub_r, S0) );
+
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < 3; ++i) ASSERT_EQ(0.0, S(i, j));
+
+	// with a cached argument
+
+	dense_matrix<double> C(n, m);
+	par_init_mat(C, 13, 6);
+
+	dense_matrix<double> T0(m, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) T0(i, j) = A(i, j) + C(j, i);
+
+	dense_matrix<double> T = A + C.trans();
+	ASSERT_TRUE( is_equal(T, T0) );
+}
+
+
+TEST( MatrixParallel, Broadcast )
+{
+	parallel_scope ps(3, 50);
+
+	const index_t m = 23;
+	const index_t n = 41;
+
+	dense_matrix<double> A(m, n);
+	par_init_mat(A, 9, 4);
+
+	dense_col<double> b(m);
+	dense_row<double> c(n);
+	for (index_t i = 0; i < m; ++i) b[i] = double(3 * i + 1);
+	for (index_t j = 0; j < n; ++j) c[j] = double(2 * j - 5);
+
+	dense_matrix<double> R0(m, n);
+	dense_matrix<double> Q0(m, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < m; ++i)
+		{
+			R0(i, j) = A(i, j) + b[i];
+			Q0(i, j) = A(i, j) * c[j];
+		}
+	}
+
+	dense_matrix<double> R = colwise(A) + b;
+	ASSERT_TRUE( is_equal(R, R0) );
+
+	dense_matrix<double> Q = rowwise(A) * c;
+	ASSERT_TRUE( is_equal(Q, Q0) );
+}
+
+
+TEST( MatrixParallel, Reduction )
+{
+	parallel_scope ps(4, 40);
+
+	const index_t m = 31;
+	const index_t n = 27;
+
+	dense_matrix<double> A(m, n);
+	dense_matrix<double> B(m, n);
+	par_init_mat(A, 11, 5);
+	par_init_mat(B, 7, 3);
+
+	dense_matrix<double> cs0(1, n);
+	dense_matrix<double> cd0(1, n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		double s(0), d(0);
+		for (index_t i = 0; i < m; ++i)
+		{
+			s += A(i, j);
+			d += A(i, j) * B(i, j);
+		}
+		cs0[j] = s;
+		cd0[j] = d;
+	}
+
+	dense_matrix<double> rs0(m, 1);
+	dense_matrix<double> rd0(m, 1);
+	for (index_t i = 0; i < m; ++i)
+	{
+		double s(0), d(0);
+		for (index_t j = 0; j < n; ++j)
+		{
+			s += A(i, j);
+			d += A(i, j) * B(i, j);
+		}
+		rs0[i] = s;
+		rd0[i] = d;
+	}
+
+	dense_matrix<double> cs = sum(colwise(A));
+	dense_matrix<double> cd = dot(colwise(A), colwise(B));
+	dense_matrix<double> rs = sum(rowwise(A));
+	dense_matrix<double> rd = dot(rowwise(A), rowwise(B));
+
+	ASSERT_TRUE( is_equal(cs, cs0) );
+	ASSERT_TRUE( is_equal(cd, cd0) );
+	ASSERT_TRUE( is_equal(rs, rs0) );
+	ASSERT_TRUE( is_equal(rd, rd0) );
+}
+
+
+TEST( MatrixParallel, Transpose )
+{
+	parallel_scope ps(4, 32);
+
+	const index_t ms[2] = {45, 17};
+	const index_t ns[2] = {17, 45};
+
+	for (int k = 0; k < 2; ++k)
+	{
+		const index_t m = ms[k];
+		const index_t n = ns[k];
+
+		dense_matrix<double> A(m, n);
+		par_init_mat(A, 101, 50);
+
+		dense_matrix<double> R0(n, m);
+		for (index_t j = 0; j < n; ++j)
+			for (index_t i = 0; i < m; ++i) R0(j, i) = A(i, j);
+
+		dense_matrix<double> R = A.trans();
+		ASSERT_TRUE( is_equal(R, R0) );
+	}
+}
+
+
+TEST( MatrixParallel, StreamedTranspose )
+{
+	parallel_scope ps(4, 500);
+
+	const index_t m = 150;
+	const index_t n = 1000;
+
+	dense_matrix<double> A(m, n);
+	dense_matrix<double> B(n, m);
+	par_init_mat(A, 97, 40);
+	par_init_mat(B, 13, 0);
+
+	dense_matrix<double> R0(n, m);
+	for (index_t j = 0; j < m; ++j)
+		for (index_t i = 0; i < n; ++i) R0(i, j) = A(j, i) - B(i, j);
+
+	dense_matrix<double> R = A.trans() - B;
+	ASSERT_TRUE( is_equal(R, R0) );
+
+	dense_matrix<double> rs0(n, 1);
+	for (index_t i = 0; i < n; ++i)
+	{
+		double s(0);
+		for (index_t j = 0; j < m; ++j) s += A(j, i);
+		rs0[i] = s;
+	}
+
+	dense_matrix<double> rs = sum(rowwise(A.trans()));
+	ASSERT_TRUE( is_equal(rs, rs0) );
+}
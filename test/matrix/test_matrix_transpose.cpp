@@ -428,3 +428,157 @@ TEST( RefExTranspose, SS55 )
 }
 
 
+
+
+template<typename T>
+void test_tiled_transpose(const index_t m, const index_t n)
+{
+	const index_t ldim = m + 3;
+
+	dense_matrix<T> amat(ldim, n);
+	for (index_t i = 0; i < ldim * n; ++i) amat[i] = T(i + 1);
+
+	cref_matrix_ex<T> a(amat.ptr_data(), m, n, ldim);
+
+	dense_matrix<T> r0(n, m);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < m; ++i) r0(j, i) = a(i, j);
+
+	dense_matrix<T> r = a.trans();
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	// into a sub-view (the padding must not be touched)
+
+	dense_matrix<T> bmat(n + 2, m, T(-1));
+	ref_matrix_ex<T> b(bmat.ptr_data() + 1, n, m, n + 2);
+	b = a.trans();
+
+	dense_matrix<T> br(b);
+	ASSERT_TRUE( is_equal(br, r0) );
+
+	for (index_t j = 0; j < m; ++j)
+	{
+		ASSERT_EQ(T(-1), bmat(0, j));
+		ASSERT_EQ(T(-1), bmat(n + 1, j));
+	}
+}
+
+template<typename T>
+void test_inplace_transpose(const index_t n)
+{
+	dense_matrix<T> a(n, n);
+	for (index_t i = 0; i < n * n; ++i) a[i] = T(i + 1);
+
+	dense_matrix<T> r0(n, n);
+	for (index_t j = 0; j < n; ++j)
+		for (index_t i = 0; i < n; ++i) r0(j, i) = a(i, j);
+
+	a = a.trans();
+	ASSERT_TRUE( is_equal(a, r0) );
+
+	// on a sub-view
+
+	const index_t ldim = n + 5;
+	dense_matrix<T> bmat(ldim, n);
+	for (index_t i = 0; i < ldim * n; ++i) bmat[i] = T(i + 1);
+	dense_matrix<T> bmat0(bmat);
+
+	ref_matrix_ex<T> b(bmat.ptr_data() + 2, n, n, ldim);
+	b = b.trans();
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		for (index_t i = 0; i < ldim; ++i)
+		{
+			if (i >= 2 && i < n + 2)
+				ASSERT_EQ(bmat0(j + 2, i - 2), bmat(i, j));
+			else
+				ASSERT_EQ(bmat0(i, j), bmat(i, j));
+		}
+	}
+}
+
+TEST( TiledTranspose, Double )
+{
+	test_tiled_transpose<double>(7, 9);
+	test_tiled_transpose<double>(32, 32);
+	test_tiled_transpose<double>(67, 45);
+	test_tiled_transpose<double>(45, 67);
+	test_tiled_transpose<double>(130, 3);
+	test_tiled_transpose<double>(3, 130);
+}
+
+TEST( TiledTranspose, Float )
+{
+	test_tiled_transpose<float>(7, 9);
+	test_tiled_transpose<float>(32, 32);
+	test_tiled_transpose<float>(67, 45);
+	test_tiled_transpose<float>(45, 67);
+	test_tiled_transpose<float>(130, 3);
+	test_tiled_transpose<float>(3, 130);
+}
+
+TEST( TiledTranspose, Int )
+{
+	test_tiled_transpose<int>(67, 45);
+	test_tiled_transpose<int>(45, 67);
+}
+
+TEST( TiledTranspose, InPlace )
+{
+	const index_t ns[6] = {1, 3, 8, 33, 64, 101};
+
+	for (int k = 0; k < 6; ++k)
+	{
+		test_inplace_transpose<double>(ns[k]);
+		test_inplace_transpose<float>(ns[k]);
+		test_inplace_transpose<int>(ns[k]);
+	}
+}
+
+
+TEST( StreamedTranspose, Dispatch )
+{
+	typedef transpose_expr<dense_matrix<double> > texpr_t;
+
+	const bool use_stream = is_same<colwise_reader_bank<texpr_t>::type, streamed_colreaders<texpr_t> >::value;
+	ASSERT_TRUE( use_stream );
+
+	const bool by_cols = vecacc_cost<texpr_t, by_columns_tag>::value < vecacc_cost<texpr_t, as_single_vector_tag>::value;
+	ASSERT_TRUE( by_cols );
+}
+
+TEST( StreamedTranspose, InExpressions )
+{
+	// each column of the transpose takes 8000 bytes, so the
+	// transpose is streamed in multiple panels
+
+	const index_t m = 150;
+	const index_t n = 1000;
+
+	dense_matrix<double> a(m, n);
+	dense_matrix<double> b(n, m);
+	for (index_t i = 0; i < m * n; ++i) a[i] = double(i % 97) - 40.0;
+	for (index_t i = 0; i < m * n; ++i) b[i] = double(i % 13);
+
+	dense_matrix<double> r0(n, m);
+	for (index_t j = 0; j < m; ++j)
+		for (index_t i = 0; i < n; ++i) r0(i, j) = a(j, i) * 2.0 + b(i, j);
+
+	dense_matrix<double> r = a.trans() * 2.0 + b;
+	ASSERT_TRUE( is_equal(r, r0) );
+
+	dense_row<double> cs0(m);
+	for (index_t j = 0; j < m; ++j)
+	{
+		double s(0);
+		for (index_t i = 0; i < n; ++i) s += a(j, i);
+		cs0[j] = s;
+	}
+
+	dense_row<double> cs = sum(colwise(a.trans()));
+	ASSERT_TRUE( is_equal(cs, cs0) );
+
+	ASSERT_EQ( sum(a), sum(a.trans()) );
+	ASSERT_EQ( dot(a.trans(), b), dot(a, b.trans()) );
+}
@@ -10,6 +10,11 @@
 #include <gtest/gtest.h>
 #include <bcslib/matrix.h>
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
 using namespace bcs;
 
 
@@ -567,3 +572,543 @@ TEST( MatrixUnaryParReduc, SliceWiseLinfNorm )
 
 
 
+
+
+// a reductor whose accumulator differs from its result
+// (the range max - min of the values)
+
+template<typename T>
+struct test_range_reductor
+{
+	typedef T argument_type;
+	typedef std::pair<T, T> accum_type;
+	typedef T result_type;
+
+	T empty_result() const { return T(0); }
+
+	accum_type init(const T& x) const { return accum_type(x, x); }
+
+	accum_type add(const accum_type& a, const T& x) const
+	{
+		return accum_type(std::min(a.first, x), std::max(a.second, x));
+	}
+
+	accum_type combine(const accum_type& a, const accum_type& a2) const
+	{
+		return accum_type(std::min(a.first, a2.first), std::max(a.second, a2.second));
+	}
+
+	T get(const accum_type& a, const index_t) const { return a.second - a.first; }
+};
+
+namespace bcs
+{
+	BCS_DECLARE_REDUCTOR( test_range_reductor, 1 )
+	BCS_DECLARE_ASSOCIATIVE_REDUCTOR( test_range_reductor )
+}
+
+
+void test_rowwise_reductions(const index_t m, const index_t n)
+{
+	dense_matrix<double> A(m, n), B(m, n);
+	for (index_t i = 0; i < m * n; ++i)
+	{
+		A[i] = double((i * 7) % 23) - 11.0;
+		B[i] = double((i * 5) % 13);
+	}
+
+	dense_col<double> s0(m), mn0(m), mx0(m), l20(m), d0(m), r0(m);
+	for (index_t i = 0; i < m; ++i)
+	{
+		double s = 0, q = 0, d = 0;
+		double a_min = A(i, 0), a_max = A(i, 0);
+		for (index_t j = 0; j < n; ++j)
+		{
+			const double a = A(i, j) + B(i, j);
+			s += a;
+			q += a * a;
+			d += A(i, j) * B(i, j);
+			a_min = std::min(a_min, A(i, j));
+			a_max = std::max(a_max, A(i, j));
+		}
+		s0[i] = s;
+		mn0[i] = a_min;
+		mx0[i] = a_max;
+		l20[i] = std::sqrt(q);
+		d0[i] = d;
+		r0[i] = a_max - a_min;
+	}
+
+	dense_col<double> r = sum(rowwise(A + B));
+	ASSERT_TRUE( is_equal(r, s0) );
+
+	r = mean(rowwise(A + B));
+	for (index_t i = 0; i < m; ++i) ASSERT_NEAR( s0[i] / double(n), r[i], 1.0e-12 );
+
+	r = min_val(rowwise(A));
+	ASSERT_TRUE( is_equal(r, mn0) );
+
+	r = max_val(rowwise(A));
+	ASSERT_TRUE( is_equal(r, mx0) );
+
+	r = L2norm(rowwise(A + B));
+	ASSERT_TRUE( is_approx(r, l20, 1.0e-12) );
+
+	r = dot(rowwise(A), rowwise(B));
+	ASSERT_TRUE( is_equal(r, d0) );
+
+	r = rowwise_reduce(test_range_reductor<double>(), A);
+	ASSERT_TRUE( is_equal(r, r0) );
+}
+
+TEST( MatrixUnaryParReduc, RowwiseBlocks )
+{
+	// more rows than fit in a block of accumulators
+	test_rowwise_reductions(2500, 7);
+	test_rowwise_reductions(13, 1);
+}
+
+TEST( MatrixUnaryParReduc, RowwiseParallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	test_rowwise_reductions(2500, 7);	// split by row blocks
+	test_rowwise_reductions(300, 50);
+	test_rowwise_reductions(10, 500);	// split by columns
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+template<typename T, int CTRows>
+void test_colwise_short_columns(const index_t m, const index_t n, const index_t ldim)
+{
+	dense_matrix<T> Amat(ldim, n), Bmat(ldim, n);
+	for (index_t i = 0; i < ldim * n; ++i)
+	{
+		Amat[i] = T((i * 7) % 23) - T(11);
+		Bmat[i] = T((i * 5) % 13);
+	}
+
+	ref_matrix_ex<T, CTRows, DynamicDim> A(Amat.ptr_data(), m, n, ldim);
+	ref_matrix_ex<T, CTRows, DynamicDim> B(Bmat.ptr_data(), m, n, ldim);
+
+	dense_row<T> s0(n), mn0(n), mx0(n), a0(n), q0(n), d0(n);
+	for (index_t j = 0; j < n; ++j)
+	{
+		T s(0), a(0), q(0), d(0);
+		T v_min = A(0, j), v_max = A(0, j);
+		for (index_t i = 0; i < m; ++i)
+		{
+			const T v = A(i, j);
+			s += v;
+			a += std::abs(v);
+			q += v * v;
+			d += v * B(i, j);
+			v_min = std::min(v_min, v);
+			v_max = std::max(v_max, v);
+		}
+		s0[j] = s;
+		mn0[j] = v_min;
+		mx0[j] = v_max;
+		a0[j] = a;
+		q0[j] = q;
+		d0[j] = d;
+	}
+
+	dense_row<T> r = sum(colwise(A));
+	ASSERT_TRUE( is_equal(r, s0) );
+
+	r = mean(colwise(A));
+	for (index_t j = 0; j < n; ++j) ASSERT_NEAR( s0[j] / T(m), r[j], 1.0e-5 );
+
+	r = min_val(colwise(A));
+	ASSERT_TRUE( is_equal(r, mn0) );
+
+	r = max_val(colwise(A));
+	ASSERT_TRUE( is_equal(r, mx0) );
+
+	r = L1norm(colwise(A));
+	ASSERT_TRUE( is_equal(r, a0) );
+
+	r = sqL2norm(colwise(A));
+	ASSERT_TRUE( is_equal(r, q0) );
+
+	r = L2norm(colwise(A));
+	for (index_t j = 0; j < n; ++j) ASSERT_NEAR( std::sqrt(q0[j]), r[j], 1.0e-4 );
+
+	r = dot(colwise(A), colwise(B));
+	ASSERT_TRUE( is_equal(r, d0) );
+}
+
+TEST( MatrixUnaryParReduc, ColwiseShortColumns )
+{
+	const index_t ms[] = {2, 3, 4, 5, 8, 13, 16, 17};
+
+	for (int k = 0; k < 8; ++k)
+	{
+		const index_t m = ms[k];
+		test_colwise_short_columns<double, DynamicDim>(m, 37, m);
+		test_colwise_short_columns<double, DynamicDim>(m, 37, m + 3);
+		test_colwise_short_columns<float, DynamicDim>(m, 37, m);
+	}
+
+	test_colwise_short_columns<double, 3>(3, 41, 3);
+	test_colwise_short_columns<double, 4>(4, 41, 5);
+	test_colwise_short_columns<float, 3>(3, 41, 3);
+	test_colwise_short_columns<float, 4>(4, 41, 4);
+}
+
+TEST( MatrixUnaryParReduc, ColwiseShortColumnsParallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	test_colwise_short_columns<double, DynamicDim>(3, 1001, 3);
+	test_colwise_short_columns<float, 4>(4, 1001, 4);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+// rowwise reduction of streamed operands (with transposed terms)
+
+void test_rowwise_transposed(const index_t m, const index_t n)
+{
+	dense_matrix<double> A(m, n), C(n, m), B(m, n);
+	for (index_t i = 0; i < m * n; ++i) A[i] = double((i * 7) % 23) - 11.0;
+	for (index_t i = 0; i < m * n; ++i) C[i] = double((i * 5) % 17) - 8.0;
+	for (index_t i = 0; i < m * n; ++i) B[i] = double(i % 3) - 1.0;
+
+	dense_col<double> s0(m), mx0(m), d0(m);
+	for (index_t i = 0; i < m; ++i)
+	{
+		double s = 0, mx = A(i, 0) + C(0, i), d = 0;
+		for (index_t j = 0; j < n; ++j)
+		{
+			const double x = A(i, j) + C(j, i);
+			s += x;
+			mx = std::max(mx, x);
+			d += x * B(i, j);
+		}
+		s0[i] = s;
+		mx0[i] = mx;
+		d0[i] = d;
+	}
+
+	dense_col<double> r = sum(rowwise(A + C.trans()));
+	ASSERT_TRUE( is_equal(r, s0) );
+
+	r = max_val(rowwise(A + C.trans()));
+	ASSERT_TRUE( is_equal(r, mx0) );
+
+	r = dot(rowwise(A + C.trans()), rowwise(B));
+	ASSERT_TRUE( is_equal(r, d0) );
+}
+
+TEST( MatrixUnaryParReduc, RowwiseTransposed )
+{
+	test_rowwise_transposed(5, 7);
+	test_rowwise_transposed(20000, 32);
+}
+
+TEST( MatrixUnaryParReduc, RowwiseTransposedParallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	test_rowwise_transposed(20000, 32);
+	test_rowwise_transposed(3, 1001);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+#ifndef BCSLIB_NO_THREADS
+
+// streamed operands used by the workers of a user-created pool, whose
+// indices may exceed get_num_threads()
+
+struct rowwise_transposed_job
+{
+	dense_matrix<double> A, C;
+	bool ok[8];
+
+	rowwise_transposed_job() : A(300, 9), C(9, 300)
+	{
+		for (index_t i = 0; i < A.nelems(); ++i) A[i] = double(i % 11);
+		for (index_t i = 0; i < C.nelems(); ++i) C[i] = double(i % 5);
+	}
+
+	static void run_task(void *ctx, int k)
+	{
+		rowwise_transposed_job& job = *static_cast<rowwise_transposed_job*>(ctx);
+		dense_col<double> r = sum(rowwise(job.A + job.C.trans()));
+
+		bool ok = true;
+		for (index_t i = 0; i < job.A.nrows(); ++i)
+		{
+			double s = 0;
+			for (index_t j = 0; j < job.A.ncolumns(); ++j) s += job.A(i, j) + job.C(j, i);
+			if (r[i] != s) ok = false;
+		}
+		job.ok[k] = ok;
+	}
+};
+
+TEST( MatrixUnaryParReduc, RowwiseTransposedInUserPool )
+{
+	set_num_threads(1);
+
+	rowwise_transposed_job job;
+	thread_pool pool(3);
+	ASSERT_TRUE( pool.run(8, &rowwise_transposed_job::run_task, &job) );
+	for (int k = 0; k < 8; ++k) ASSERT_TRUE( job.ok[k] );
+
+	set_num_threads(0);
+}
+
+#endif
+
+
+// one-pass statistics: variance and fused reductors
+
+typedef fused_reductor<mean_reductor<double>,
+		fused_reductor<var_reductor<double>,
+		fused_reductor<min_reductor<double>, max_reductor<double> > > > test_stats_reductor;
+
+static test_stats_reductor test_stats()
+{
+	return fuse(mean_reductor<double>(), var_reductor<double>(),
+			min_reductor<double>(), max_reductor<double>());
+}
+
+static void test_stats_of(const index_t n, const double *a, const index_t inc,
+		const test_stats_reductor::result_type& r)
+{
+	double s = 0, mn = a[0], mx = a[0];
+	for (index_t i = 0; i < n; ++i)
+	{
+		const double x = a[i * inc];
+		s += x;
+		mn = std::min(mn, x);
+		mx = std::max(mx, x);
+	}
+	const double mu = s / double(n);
+
+	double q = 0;
+	for (index_t i = 0; i < n; ++i) q += (a[i * inc] - mu) * (a[i * inc] - mu);
+	const double v = n > 1 ? q / double(n - 1) : 0.0;
+
+	ASSERT_NEAR( mu, fused_get<0>(r), 1.0e-9 );
+	ASSERT_NEAR( v, fused_get<1>(r), 1.0e-7 * (1.0 + v) );
+	ASSERT_EQ( mn, fused_get<2>(r) );
+	ASSERT_EQ( mx, fused_get<3>(r) );
+}
+
+void test_slicewise_stats(const index_t m, const index_t n, const double offset)
+{
+	dense_matrix<double> A(m, n);
+	for (index_t i = 0; i < m * n; ++i) A[i] = offset + double((i * 7) % 23) - 11.0;
+
+	typedef test_stats_reductor::result_type stats_t;
+
+	dense_row<stats_t> cr = colwise_reduce(test_stats(), A);
+	ASSERT_EQ( n, cr.nelems() );
+	for (index_t j = 0; j < n; ++j) test_stats_of(m, A.ptr_data() + j * m, 1, cr[j]);
+
+	dense_col<stats_t> rr = rowwise_reduce(test_stats(), A);
+	ASSERT_EQ( m, rr.nelems() );
+	for (index_t i = 0; i < m; ++i) test_stats_of(n, A.ptr_data() + i, m, rr[i]);
+
+	dense_row<double> cv = var(colwise(A));
+	for (index_t j = 0; j < n; ++j) ASSERT_EQ( fused_get<1>(cr[j]), cv[j] );
+
+	dense_col<double> rv = var(rowwise(A));
+	for (index_t i = 0; i < m; ++i) ASSERT_NEAR( fused_get<1>(rr[i]), rv[i], 1.0e-9 );
+}
+
+TEST( MatrixUnaryParReduc, SliceWiseStats )
+{
+	test_slicewise_stats(5, 6, 0.0);
+	test_slicewise_stats(1, 9, 0.0);
+	test_slicewise_stats(2500, 7, 0.0);
+	test_slicewise_stats(7, 2500, 1.0e8);
+}
+
+TEST( MatrixUnaryParReduc, SliceWiseStatsParallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	test_slicewise_stats(2500, 7, 0.0);
+	test_slicewise_stats(10, 500, 1.0e8);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+// argmin / argmax (ties are resolved to the first occurrence)
+
+template<typename T, class Better>
+static indexed_value<T> test_arg_extreme(Better better, const index_t n, const T *a, const index_t inc)
+{
+	indexed_value<T> r(a[0], 0);
+	for (index_t i = 1; i < n; ++i)
+	{
+		if (better(a[i * inc], r.value)) r = indexed_value<T>(a[i * inc], i);
+	}
+	return r;
+}
+
+template<typename T>
+static bool test_lt(const T& x, const T& y) { return x < y; }
+
+template<typename T>
+static bool test_gt(const T& x, const T& y) { return x > y; }
+
+template<typename T, class Mat>
+void check_colwise_args(const dense_matrix<T>& Amat, const index_t m, const index_t n, const Mat& A)
+{
+	const index_t ldim = Amat.nrows();
+
+	dense_row<indexed_value<T> > rmin = argmin(colwise(A));
+	dense_row<indexed_value<T> > rmax = argmax(colwise(A));
+	ASSERT_EQ( n, rmin.nelems() );
+
+	for (index_t j = 0; j < n; ++j)
+	{
+		indexed_value<T> r0 = test_arg_extreme(test_lt<T>, m, Amat.ptr_data() + j * ldim, 1);
+		ASSERT_EQ( r0.value, rmin[j].value );
+		ASSERT_EQ( r0.index, rmin[j].index );
+
+		indexed_value<T> r1 = test_arg_extreme(test_gt<T>, m, Amat.ptr_data() + j * ldim, 1);
+		ASSERT_EQ( r1.value, rmax[j].value );
+		ASSERT_EQ( r1.index, rmax[j].index );
+	}
+}
+
+template<typename T, class Mat>
+void check_rowwise_args(const dense_matrix<T>& Amat, const index_t m, const index_t n, const Mat& A)
+{
+	const index_t ldim = Amat.nrows();
+
+	dense_col<indexed_value<T> > rmin = argmin(rowwise(A));
+	dense_col<indexed_value<T> > rmax = argmax(rowwise(A));
+	ASSERT_EQ( m, rmin.nelems() );
+
+	for (index_t i = 0; i < m; ++i)
+	{
+		indexed_value<T> r0 = test_arg_extreme(test_lt<T>, n, Amat.ptr_data() + i, ldim);
+		ASSERT_EQ( r0.value, rmin[i].value );
+		ASSERT_EQ( r0.index, rmin[i].index );
+
+		indexed_value<T> r1 = test_arg_extreme(test_gt<T>, n, Amat.ptr_data() + i, ldim);
+		ASSERT_EQ( r1.value, rmax[i].value );
+		ASSERT_EQ( r1.index, rmax[i].index );
+	}
+}
+
+template<typename T, int CTRows>
+void test_slicewise_args(const index_t m, const index_t n, const index_t ldim)
+{
+	// few distinct values, hence many ties
+	dense_matrix<T> Amat(ldim, n);
+	for (index_t i = 0; i < ldim * n; ++i) Amat[i] = T((i * 7) % 11);
+
+	ref_matrix_ex<T, CTRows, DynamicDim> A(Amat.ptr_data(), m, n, ldim);
+	check_colwise_args(Amat, m, n, A);
+	check_rowwise_args(Amat, m, n, A);
+
+	// a non-dense expression (the generic way)
+	dense_matrix<T> B = A;
+	check_colwise_args(B, m, n, B + T(0));
+	check_rowwise_args(B, m, n, B + T(0));
+}
+
+TEST( MatrixUnaryParReduc, SliceWiseArgs )
+{
+	const index_t ms[] = {1, 2, 3, 4, 5, 8, 13, 16, 17, 40, 301};
+
+	for (int k = 0; k < 11; ++k)
+	{
+		const index_t m = ms[k];
+		test_slicewise_args<double, DynamicDim>(m, 37, m);
+		test_slicewise_args<double, DynamicDim>(m, 37, m + 3);
+		test_slicewise_args<float, DynamicDim>(m, 37, m);
+		test_slicewise_args<float, DynamicDim>(m, 1, m);
+	}
+
+	test_slicewise_args<double, 4>(4, 41, 5);
+	test_slicewise_args<float, 8>(8, 41, 8);
+}
+
+TEST( MatrixUnaryParReduc, SliceWiseArgsParallel )
+{
+	set_num_threads(4);
+	set_parallel_grain(1);
+
+	test_slicewise_args<double, DynamicDim>(3, 1001, 3);
+	test_slicewise_args<double, DynamicDim>(2500, 7, 2500);
+	test_slicewise_args<float, DynamicDim>(300, 50, 301);
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+
+template<typename T>
+void test_colwise_top_k(const index_t m, const index_t n, const index_t k)
+{
+	dense_matrix<T> A(m, n);
+	for (index_t i = 0; i < m * n; ++i) A[i] = T((i * 7) % 13);
+
+	dense_matrix<T> tv, bv;
+	dense_matrix<index_t> ti, bi;
+	top_k(colwise(A), k, tv, ti);
+	bottom_k(colwise(A + T(1)), k, bv, bi);
+
+	ASSERT_EQ( k, tv.nrows() );
+	ASSERT_EQ( n, tv.ncolumns() );
+	ASSERT_EQ( k, bi.nrows() );
+	ASSERT_EQ( n, bi.ncolumns() );
+
+	std::vector<std::pair<T, index_t> > c(m);
+	for (index_t j = 0; j < n; ++j)
+	{
+		// stable sort: equal values keep the order of indices
+
+		for (index_t i = 0; i < m; ++i) c[i] = std::make_pair(-A(i, j), i);
+		std::sort(c.begin(), c.end());
+		for (index_t r = 0; r < k; ++r)
+		{
+			ASSERT_EQ( -c[r].first, tv(r, j) );
+			ASSERT_EQ( c[r].second, ti(r, j) );
+		}
+
+		for (index_t i = 0; i < m; ++i) c[i] = std::make_pair(A(i, j), i);
+		std::sort(c.begin(), c.end());
+		for (index_t r = 0; r < k; ++r)
+		{
+			ASSERT_EQ( c[r].first + T(1), bv(r, j) );
+			ASSERT_EQ( c[r].second, bi(r, j) );
+		}
+	}
+}
+
+TEST( MatrixUnaryParReduc, ColwiseTopK )
+{
+	test_colwise_top_k<double>(10, 9, 3);
+	test_colwise_top_k<double>(10, 9, 1);
+	test_colwise_top_k<double>(10, 9, 10);
+	test_colwise_top_k<double>(10, 9, 0);
+	test_colwise_top_k<float>(200, 17, 5);
+
+	dense_matrix<double> A(4, 3, 0.0), v;
+	dense_matrix<index_t> ix;
+	ASSERT_THROW( top_k(colwise(A), 5, v, ix), invalid_argument );
+}
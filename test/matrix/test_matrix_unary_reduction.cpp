@@ -365,3 +365,333 @@ TEST( UnaryMatrixReduction, MatLinfNorm )
 
 
 
+
+
+/************************************************
+ *
+ *  Long vectors (multi-accumulator paths)
+ *
+ ************************************************/
+
+template<typename T>
+void test_long_unary_reduction(const index_t m, const index_t n)
+{
+	const index_t len = m * n;
+	const index_t ldim = m + 3;
+
+	dense_matrix<T> a(m, n);
+	for (index_t i = 0; i < len; ++i) a[i] = T(int((i * 7) % 23) - 11);
+	a[len / 2] = T(-40);
+	a[len - 1] = T(37);
+
+	dense_matrix<T> ablk(ldim, n, T(1000));
+	ref_matrix_ex<T> ar(ablk.ptr_data(), m, n, ldim);
+	ar = a;
+
+	T s = 0, s1 = 0, s2 = 0, mn = a[0], mx = a[0], mi = 0;
+	for (index_t i = 0; i < len; ++i)
+	{
+		s += a[i];
+		s1 += math::abs(a[i]);
+		s2 += a[i] * a[i];
+		mn = std::min(mn, a[i]);
+		mx = std::max(mx, a[i]);
+		mi = std::max(mi, math::abs(a[i]));
+	}
+
+	// values are small integers, hence exact in any order
+
+	ASSERT_EQ( s, sum(a) );
+	ASSERT_EQ( s / T(len), mean(a) );
+	ASSERT_EQ( mn, min_val(a) );
+	ASSERT_EQ( mx, max_val(a) );
+	ASSERT_EQ( s1, L1norm(a) );
+	ASSERT_EQ( s2, sqL2norm(a) );
+	ASSERT_EQ( mi, Linfnorm(a) );
+
+	ASSERT_EQ( s, sum(ar) );
+	ASSERT_EQ( mn, min_val(ar) );
+	ASSERT_EQ( mx, max_val(ar) );
+	ASSERT_EQ( s1, L1norm(ar) );
+	ASSERT_EQ( s2, sqL2norm(ar) );
+	ASSERT_EQ( mi, Linfnorm(ar) );
+
+	ASSERT_EQ( T(2) * s - T(len), sum(a * T(2) - T(1)) );
+}
+
+TEST( UnaryMatrixReduction, LongVectors_d )
+{
+	const index_t lens[] = {15, 16, 17, 33, 64, 101, 1001};
+	for (int k = 0; k < 7; ++k)
+	{
+		test_long_unary_reduction<double>(lens[k], 1);
+		test_long_unary_reduction<double>(lens[k], 3);
+	}
+}
+
+TEST( UnaryMatrixReduction, LongVectors_s )
+{
+	const index_t lens[] = {15, 16, 17, 33, 64, 101, 1001};
+	for (int k = 0; k < 7; ++k)
+	{
+		test_long_unary_reduction<float>(lens[k], 1);
+		test_long_unary_reduction<float>(lens[k], 3);
+	}
+}
+
+
+TEST( UnaryMatrixReduction, LongVectorsInexact )
+{
+	const index_t len = 100003;
+	dense_col<double> a(len);
+	for (index_t i = 0; i < len; ++i) a[i] = 1.0 / double(i + 1);
+
+	long double s0 = 0;
+	for (index_t i = 0; i < len; ++i) s0 += a[i];
+
+	ASSERT_NEAR( double(s0), sum(a), 1.0e-12 );
+}
+
+
+// a non-associative reductor must be accumulated from left to right
+
+struct halving_sum_reductor
+{
+	typedef double argument_type;
+	typedef double accum_type;
+	typedef double result_type;
+
+	double empty_result() const { return 0; }
+	double init(const double& x) const { return x; }
+	double add(const double& a, const double& x) const { return a * 0.5 + x; }
+	double combine(const double& a, const double& a2) const { return a + a2; }
+	double get(const double& a, const index_t) const { return a; }
+};
+
+namespace bcs
+{
+	template<> struct is_reductor<halving_sum_reductor, 1> { static const bool value = true; };
+}
+
+TEST( UnaryMatrixReduction, NonAssociativeOrder )
+{
+	const index_t len = 100;
+	dense_col<double> a(len);
+	for (index_t i = 0; i < len; ++i) a[i] = double(i % 5);
+
+	double s0 = a[0];
+	for (index_t i = 1; i < len; ++i) s0 = s0 * 0.5 + a[i];
+
+	ASSERT_EQ( s0, reduce(halving_sum_reductor(), a) );
+}
+
+
+
+/************************************************
+ *
+ *  Variance and fused statistics
+ *
+ ************************************************/
+
+static double two_pass_var(const index_t n, const double *a)
+{
+	double s = 0;
+	for (index_t i = 0; i < n; ++i) s += a[i];
+	const double mu = s / double(n);
+
+	double q = 0;
+	for (index_t i = 0; i < n; ++i) q += (a[i] - mu) * (a[i] - mu);
+	return q / double(n - 1);
+}
+
+TEST( UnaryMatrixReduction, MatVar )
+{
+	const index_t lens[] = {1, 2, 5, 17, 1001};
+	for (int k = 0; k < 5; ++k)
+	{
+		const index_t n = lens[k];
+		dense_col<double> a(n);
+		for (index_t i = 0; i < n; ++i) a[i] = double((i * 7) % 23) * 0.25 - 3.0;
+
+		double v0 = n > 1 ? two_pass_var(n, a.ptr_data()) : 0.0;
+		ASSERT_NEAR( v0, var(a), 1.0e-12 );
+	}
+}
+
+TEST( UnaryMatrixReduction, MatVarLargeOffset )
+{
+	// the naive sum-of-squares formula loses all precision here
+
+	const index_t n = 10007;
+	dense_col<double> a(n);
+	for (index_t i = 0; i < n; ++i) a[i] = 1.0e9 + double(i % 10);
+
+	double v0 = two_pass_var(n, a.ptr_data());
+	ASSERT_NEAR( v0, var(a), 1.0e-6 );
+}
+
+TEST( UnaryMatrixReduction, FusedStats )
+{
+	const index_t n = 1003;
+	mat_f64 A(17, 59);
+	for (index_t i = 0; i < A.nelems(); ++i) A[i] = double((i * 7) % 23) - 11.0;
+
+	typedef fused_reductor<mean_reductor<double>,
+			fused_reductor<var_reductor<double>,
+			fused_reductor<min_reductor<double>, max_reductor<double> > > > stats_t;
+
+	stats_t::result_type r = reduce(fuse(
+			mean_reductor<double>(), var_reductor<double>(),
+			min_reductor<double>(), max_reductor<double>()), A);
+
+	ASSERT_NEAR( mean(A), fused_get<0>(r), 1.0e-12 );
+	ASSERT_NEAR( two_pass_var(A.nelems(), A.ptr_data()), fused_get<1>(r), 1.0e-10 );
+	ASSERT_EQ( min_val(A), fused_get<2>(r) );
+	ASSERT_EQ( max_val(A), fused_get<3>(r) );
+
+	dense_col<double> a(n);
+	for (index_t i = 0; i < n; ++i) a[i] = double(i % 13);
+
+	fused_value<double, double> r2 = reduce(fuse(sum_reductor<double>(), sqL2norm_reductor<double>()), a);
+	ASSERT_EQ( sum(a), fused_get<0>(r2) );
+	ASSERT_EQ( sqL2norm(a), fused_get<1>(r2) );
+}
+
+TEST( UnaryMatrixReduction, MatArgMinMax )
+{
+	mat_f64 A(4, 5);
+	for (index_t i = 0; i < A.nelems(); ++i) A[i] = double((i * 7) % 11);
+
+	// 0 first occurs at 0, and 10 at 3; both also occur at 11 and 14
+	indexed_value<double> r = argmin(A);
+	ASSERT_EQ( 0.0, r.value );
+	ASSERT_EQ( 0, r.index );
+
+	r = argmax(A);
+	ASSERT_EQ( 10.0, r.value );
+	ASSERT_EQ( 3, r.index );
+
+	r = argmax(A.column(2) + A.column(4));
+	double v0 = A(0, 2) + A(0, 4);
+	index_t i0 = 0;
+	for (index_t i = 1; i < 4; ++i)
+	{
+		if (A(i, 2) + A(i, 4) > v0) { v0 = A(i, 2) + A(i, 4); i0 = i; }
+	}
+	ASSERT_EQ( v0, r.value );
+	ASSERT_EQ( i0, r.index );
+}
+
+
+
+/************************************************
+ *
+ *  Partitioned (parallel) full reductions
+ *
+ ************************************************/
+
+struct large_reduc_results
+{
+	double s, s1, s2, mn, mx, d, sc;
+
+	template<class Mat>
+	explicit large_reduc_results(const IMatrixXpr<Mat, double>& a)
+	{
+		s = sum(a);
+		s1 = L1norm(a);
+		s2 = sqL2norm(a);
+		mn = min_val(a);
+		mx = max_val(a);
+		d = dot(a, a);
+		sc = sum(a * 2.0 - 1.0);
+	}
+
+	// bitwise comparison (no tolerance)
+	bool operator == (const large_reduc_results& r) const
+	{
+		return s == r.s && s1 == r.s1 && s2 == r.s2 && mn == r.mn && mx == r.mx &&
+				d == r.d && sc == r.sc;
+	}
+};
+
+template<class Mat>
+static void test_large_reduction(const IMatrixXpr<Mat, double>& a)
+{
+	const index_t len = a.nelems();
+	dense_matrix<double> da(a);
+
+	long double s0 = 0, s1 = 0, s2 = 0;
+	double mn = da[0], mx = da[0];
+	for (index_t i = 0; i < len; ++i)
+	{
+		s0 += da[i];
+		s1 += math::abs(da[i]);
+		s2 += (long double)da[i] * da[i];
+		mn = std::min(mn, da[i]);
+		mx = std::max(mx, da[i]);
+	}
+
+	set_num_threads(1);
+	large_reduc_results r0(a);
+
+	// relative tolerance (as the sums have large magnitudes)
+	const double rtol = 1.0e-12;
+
+	ASSERT_NEAR( double(s0), r0.s, rtol * double(s1) );
+	ASSERT_NEAR( double(s1), r0.s1, rtol * double(s1) );
+	ASSERT_NEAR( double(s2), r0.s2, rtol * double(s2) );
+	ASSERT_NEAR( double(s2), r0.d, rtol * double(s2) );
+	ASSERT_NEAR( double(2 * s0 - len), r0.sc, rtol * double(2 * s1 + len) );
+	ASSERT_EQ( mn, r0.mn );
+	ASSERT_EQ( mx, r0.mx );
+
+	// results must not depend on the number of threads, nor vary between runs
+
+	const int nts[] = {2, 3, 4};
+	for (int t = 0; t < 3; ++t)
+	{
+		set_num_threads(nts[t]);
+		set_parallel_grain(1);
+		for (int rep = 0; rep < 3; ++rep)
+		{
+			ASSERT_TRUE( large_reduc_results(a) == r0 );
+		}
+
+		set_parallel_grain(0);
+		ASSERT_TRUE( large_reduc_results(a) == r0 );
+	}
+
+	set_num_threads(0);
+	set_parallel_grain(0);
+}
+
+TEST( UnaryMatrixReduction, LargeDeterministic )
+{
+	const index_t len = 600011;
+	dense_col<double> a(len);
+	for (index_t i = 0; i < len; ++i) a[i] = 1.0 / double(i + 1) - (i % 3 == 0 ? 0.2 : 0.0);
+
+	test_large_reduction(a);
+}
+
+TEST( UnaryMatrixReduction, LargeDeterministicByColumns )
+{
+	// long columns (split into row blocks)
+
+	const index_t m1 = 300007, n1 = 2, ld1 = m1 + 3;
+	dense_matrix<double> b1(ld1, n1, 1000.0);
+	for (index_t i = 0; i < ld1 * n1; ++i) b1[i] = 1.0 / double(i % ld1 + 1) - 0.1;
+	ref_matrix_ex<double> a1(b1.ptr_data(), m1, n1, ld1);
+
+	test_large_reduction(a1);
+
+	// short columns (grouped)
+
+	const index_t m2 = 1000, n2 = 701, ld2 = m2 + 3;
+	dense_matrix<double> b2(ld2, n2, 1000.0);
+	for (index_t i = 0; i < ld2 * n2; ++i) b2[i] = 1.0 / double(i + 1) - (i % 7 == 0 ? 0.05 : 0.0);
+	ref_matrix_ex<double> a2(b2.ptr_data(), m2, n2, ld2);
+
+	test_large_reduction(a2);
+}
+